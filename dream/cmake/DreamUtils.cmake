@@ -28,6 +28,14 @@ macro(DREAM_FIND_AND_LINK_LIBRARIES)
         message(STATUS "OPENGL_LIBRARIES = ${OPENGL_LIBRARIES}")
         link_libraries(${OPENGL_LIBRARIES})
 
+        # Link EGL library (optional, used for headless rendering in benchmarks)
+        find_package(OpenGL OPTIONAL_COMPONENTS EGL)
+        if(OpenGL_EGL_FOUND)
+            message(STATUS "EGL found, headless rendering enabled")
+            add_compile_definitions(DREAM_EGL)
+            link_libraries(OpenGL::EGL)
+        endif()
+
         # Link SDL2 library
         find_package(SDL2 REQUIRED)
         if(NOT SDL2_FOUND)
@@ -63,6 +71,8 @@ macro(DREAM_FIND_AND_LINK_LIBRARIES)
         include_directories(${BULLET_INCLUDE_DIRS})
         message(STATUS BULLET_LIBRARIES=${BULLET_LIBRARIES})
         link_libraries(${BULLET_LIBRARIES})
+        # bullet is built with the multithreading feature, which enables the multithreaded dynamics world
+        add_compile_definitions(BT_THREADSAFE=1)
 
         # Link OpenAL library
         find_package(OpenAL CONFIG REQUIRED)
@@ -132,7 +142,9 @@ endmacro()
 macro(DREAM_GLOB_TEST_CODE)
     # find sources filed for test code
     FILE(GLOB TEST_FILES
-            test/scene/*.cpp)
+            test/scene/*.cpp
+            test/renderer/*.cpp
+            test/util/*.cpp)
 endmacro()
 
 macro(DREAM_DEFINE_BINARY_OUTPUT_DIRS)
@@ -24,9 +24,8 @@
 #include "dream/window/Window.h"
 #include "dream/project/Project.h"
 #include "dream/editor/LogCollector.h"
-
-using namespace std::chrono_literals;
-constexpr std::chrono::nanoseconds timestep(16ms);
+#include "dream/util/WorkerThread.h"
+#include "dream/util/SimulationClock.h"
 
 namespace Dream {
     class Application {
@@ -46,11 +45,18 @@ namespace Dream {
         Window *window;
         Renderer *renderer;
         Editor *editor;
+        // runs the simulation of the next frame while the main thread submits the current one
+        WorkerThread *simulationThread;
 
         void fixedUpdate();
 
+        void simulate(float dt, int fixedSteps);
+
+        bool shouldOverlapSimulation();
+
         std::chrono::time_point<std::chrono::high_resolution_clock> currentTime;
-        std::chrono::nanoseconds lag;
+        // turns real time into fixed updates
+        SimulationClock simulationClock;
     };
 }
 
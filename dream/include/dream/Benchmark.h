@@ -0,0 +1,97 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_BENCHMARK_H
+#define DREAM_BENCHMARK_H
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "dream/window/Window.h"
+#include "dream/renderer/OpenGLRenderer.h"
+
+namespace Dream {
+    /**
+     * Renders a project headlessly along a scripted camera path and reports frame time percentiles
+     * and per-pass statistics as JSON (ex: dream benchmark --frames 300 --output benchmark.json)
+     */
+    class Benchmark {
+    public:
+        struct Options {
+            std::filesystem::path projectPath;
+            int frames = 300;
+            // frames rendered before measuring so shaders, meshes and render targets are warmed up
+            int warmupFrames = 10;
+            int width = 1280;
+            int height = 720;
+            std::filesystem::path outputPath = "benchmark.json";
+            // directory to write PNG frames to for image-diff regression checks, frames are not written when empty
+            std::filesystem::path frameDumpPath;
+            int frameDumpInterval = 30;
+            // rigid bodies added to the project to measure the physics step ("stack" of boxes or "crowd" of capsules
+            // pushed into each other), no bodies are added when empty
+            std::string physicsScene;
+            int physicsBodies = 1000;
+            bool multithreadedPhysics = false;
+        };
+
+        static Options parseOptions(int argCount, char **args);
+
+        explicit Benchmark(Options options);
+
+        ~Benchmark();
+
+        /**
+         * @return exit code of the process
+         */
+        int run();
+
+    private:
+        struct PassTotals {
+            int frames = 0;
+            double cpuTime = 0;
+            int gpuFrames = 0;
+            double gpuTime = 0;
+            RenderCounters counters;
+        };
+
+        void updateCamera(int frame);
+
+        void createPhysicsScene();
+
+        /**
+         * Push the crowd bodies towards the center so they keep colliding with each other
+         */
+        void pushCrowd();
+
+        void dumpFrame(int frame);
+
+        void writeReport(std::vector<double> frameTimes, std::vector<double> physicsTimes);
+
+        Options options;
+        Window *window;
+        OpenGLRenderer *renderer;
+        std::vector<Entity> crowdEntities;
+        // passes in the order they first executed
+        std::vector<std::string> passNames;
+        std::map<std::string, PassTotals> passTotals;
+    };
+}
+
+#endif //DREAM_BENCHMARK_H
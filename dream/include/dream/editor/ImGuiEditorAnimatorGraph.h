@@ -56,8 +56,9 @@ namespace Dream {
         std::string animatorFileGUID;
         std::vector<Component::AnimatorComponent::State> states;
         std::vector<Component::AnimatorComponent::Transition> transitions;
-        std::vector<std::string> variableNames;
-        std::vector<int> variableValues;
+        std::vector<Component::AnimatorComponent::Variable> variables;
+        // layers are not edited in the graph, they are kept so saving does not drop them
+        std::vector<AnimatorController::Description::Layer> layers;
         ImGui::FileBrowser *animationSelectorBrowser;
         std::string settingsFilePath;
 
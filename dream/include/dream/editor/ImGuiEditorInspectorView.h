@@ -87,6 +87,8 @@ namespace Dream {
 
         void renderAnimatorComponent();
 
+        void renderVertexAnimationComponent();
+
         void renderBoneComponent();
 
         void renderSceneCameraComponent();
@@ -27,7 +27,13 @@ namespace Dream {
         void update(int &rendererViewportWidth, int &rendererViewportHeight, unsigned int frameBufferTexture);
 
     private:
+        /**
+         * Window with rolling averages and histograms of the CPU / GPU time and counters of every render pass
+         */
+        void updateRenderStats();
+
         unsigned int playIcon, stopIcon, expandIcon, collapseIcon, wrenchIcon;
+        bool showRenderStats = false;
     };
 }
 
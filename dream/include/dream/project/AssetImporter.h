@@ -21,6 +21,9 @@
 
 #include <iostream>
 #include <filesystem>
+#include <string>
+#include <vector>
+#include "dream/scene/Entity.h"
 
 namespace Dream {
     class AssetImporter {
@@ -33,6 +36,16 @@ namespace Dream {
 
         void createMetaFile(std::filesystem::path path);
 
+        /**
+         * Bake clips of a rigged model into a vertex animation file next to the model, so crowds of it can be drawn
+         * without skeletons (see VertexAnimationComponent)
+         * @param modelEntity entity the model was loaded into, its submeshes are the mesh entities below it
+         * @param animationGuids animation files to bake
+         * @return guid of the vertex animation file, empty if nothing could be baked
+         */
+        std::string bakeVertexAnimation(Entity modelEntity, const std::vector<std::string> &animationGuids,
+                                        float framesPerSecond = 30.0f);
+
     private:
         void importAssetHelper(std::filesystem::path rootPath, std::filesystem::path relativePath);
     };
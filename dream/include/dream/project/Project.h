@@ -32,9 +32,21 @@ namespace Dream {
             bool physicsDebugger = false;
             bool physicsDebuggerWhilePlaying = false;
             bool depthTest = true;
+            // split the physics step across the thread pool (applies when the scene is reloaded)
+            bool multithreaded = false;
+        };
+        struct SimulationConfig {
+            // fixed updates (physics, scripts) per second
+            int tickRate = 60;
+            // fixed updates a single frame may run to catch up, time beyond that is dropped
+            int maxStepsPerFrame = 5;
+            // one fixed update per frame regardless of elapsed time (for replays and benchmarks)
+            bool deterministic = false;
         };
         struct AnimationConfig {
             bool playInEditor = true;
+            // update far away animators less often and skip posing animators outside the view
+            bool levelOfDetail = true;
         };
         struct RenderingConfig {
             enum RenderingType {
@@ -44,8 +56,11 @@ namespace Dream {
                 NORMAL
             };
             RenderingType renderingType = RenderingType::FINAL;
+            // skin animated meshes once per frame instead of in every pass that draws them
+            bool preSkinning = true;
         };
         PhysicsConfig physicsConfig;
+        SimulationConfig simulationConfig;
         AnimationConfig animationConfig;
         RenderingConfig renderingConfig;
     };
@@ -20,10 +20,16 @@
 #define DREAM_RESOURCEMANAGER_H
 
 #include <iostream>
+#include <memory>
 #include <unordered_map>
 #include <map>
 #include "dream/renderer/Texture.h"
 #include "dream/renderer/Mesh.h"
+#include "dream/renderer/AnimationClip.h"
+#include "dream/renderer/AnimationData.h"
+#include "dream/renderer/AnimationSkeleton.h"
+#include "dream/renderer/AnimatorController.h"
+#include "dream/renderer/VertexAnimationTexture.h"
 
 namespace Dream {
     class ResourceManager {
@@ -48,6 +54,41 @@ namespace Dream {
          * Value: mesh data
          */
         std::map<std::pair<std::string, std::string>, std::shared_ptr<Mesh>> meshDataMap;
+
+        /**
+         * Map to get the bones of a rigged model
+         * Key: guid of the model
+         * Value: bone info of each bone name
+         */
+        std::map<std::string, std::shared_ptr<const std::map<std::string, BoneInfo>>> boneDataMap;
+
+        /**
+         * Map to get the skeleton that animations of a rigged model are compiled against
+         * Key: guid of the model
+         * Value: skeleton
+         */
+        std::map<std::string, std::shared_ptr<const AnimationSkeleton>> animationSkeletonMap;
+
+        /**
+         * Map to get animations compiled for a rigged model, shared by every animator playing them on that model
+         * Key: <guid of the animation, guid of the model>
+         * Value: compiled animation
+         */
+        std::map<std::pair<std::string, std::string>, std::shared_ptr<const AnimationClip>> animationClipMap;
+
+        /**
+         * Map to get the compiled state machine of an animator file, shared by every animator using it
+         * Key: guid of the animator file
+         * Value: compiled state machine
+         */
+        std::map<std::string, std::shared_ptr<const AnimatorController>> animatorControllerMap;
+
+        /**
+         * Map to get baked vertex animations, shared by every crowd instance drawn with them
+         * Key: guid of the vertex animation file
+         * Value: baked vertex animation
+         */
+        std::map<std::string, std::shared_ptr<const VertexAnimationTexture>> vertexAnimationMap;
     public:
         /**
          * Get the path of a file given a GUID
@@ -74,6 +115,46 @@ namespace Dream {
         void storeMeshData(Mesh *texture, const std::string &guid, const std::string &fileID = "");
 
         bool hasMeshData(const std::string &guid, const std::string &fileID = "");
+
+        std::shared_ptr<const std::map<std::string, BoneInfo>> getBoneData(const std::string &guid);
+
+        void storeBoneData(std::map<std::string, BoneInfo> boneInfoMap, const std::string &guid);
+
+        bool hasBoneData(const std::string &guid);
+
+        std::shared_ptr<const AnimationSkeleton> getAnimationSkeleton(const std::string &modelGuid);
+
+        void storeAnimationSkeleton(const AnimationSkeleton *skeleton, const std::string &modelGuid);
+
+        bool hasAnimationSkeleton(const std::string &modelGuid);
+
+        std::shared_ptr<const AnimationClip> getAnimationClip(const std::string &guid, const std::string &modelGuid);
+
+        void storeAnimationClip(const AnimationClip *clip, const std::string &guid, const std::string &modelGuid);
+
+        bool hasAnimationClip(const std::string &guid, const std::string &modelGuid);
+
+        std::shared_ptr<const AnimatorController> getAnimatorController(const std::string &guid);
+
+        void storeAnimatorController(const AnimatorController *controller, const std::string &guid);
+
+        bool hasAnimatorController(const std::string &guid);
+
+        /**
+         * Forget the compiled state machine of an animator file so it is compiled again (ex: after it was edited)
+         */
+        void removeAnimatorController(const std::string &guid);
+
+        std::shared_ptr<const VertexAnimationTexture> getVertexAnimation(const std::string &guid);
+
+        void storeVertexAnimation(const VertexAnimationTexture *vertexAnimation, const std::string &guid);
+
+        bool hasVertexAnimation(const std::string &guid);
+
+        /**
+         * Forget a baked vertex animation so it is loaded again (ex: after it was baked again)
+         */
+        void removeVertexAnimation(const std::string &guid);
     };
 }
 
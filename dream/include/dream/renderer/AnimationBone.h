@@ -48,6 +48,12 @@ namespace Dream {
 
         int getScaleIndex(float animationTime);
 
+        const std::vector<KeyPosition> &getPositions() const;
+
+        const std::vector<KeyRotation> &getRotations() const;
+
+        const std::vector<KeyScale> &getScales() const;
+
     private:
         float getScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime);
 
@@ -0,0 +1,167 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_ANIMATIONCLIP_H
+#define DREAM_ANIMATIONCLIP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "dream/renderer/AnimationData.h"
+#include "dream/renderer/AnimationSkeleton.h"
+
+namespace Dream {
+    class Animation;
+
+    struct AnimationCompressionSettings {
+        // maximum distance a translation may be off by after dropping keys (in model units)
+        float translationTolerance = 0.01f;
+        // maximum angle a rotation may be off by after dropping keys (in radians), float precision limits how small an
+        // angle between two quaternions can be measured to about a thousandth of a radian
+        float rotationTolerance = 0.01f;
+    };
+
+    /**
+     * Animation compiled against a skeleton. Tracks are indexed by joint and their keyframes are stored contiguously
+     * (times separate from values), so sampling a pose does not allocate or look up names.
+     *
+     * Clips are compressed when they are compiled: keys that interpolation reproduces within a tolerance are dropped
+     * (constant tracks keep a single key), key times are quantized to 16 bits of the clip duration, translations to
+     * 16 bits per component of the range of their track and rotations to three 15-bit components (the largest
+     * component is dropped and recomputed when sampling).
+     */
+    class AnimationClip {
+    public:
+        /**
+         * Keyframe each track of an instance sampled last, playback usually advances by at most one keyframe
+         * between samples so this avoids searching the keyframes
+         */
+        struct Cursor {
+            std::vector<int> translationKeys;
+            std::vector<int> rotationKeys;
+        };
+
+        struct CompressionStats {
+            int sourceKeys = 0;
+            int compressedKeys = 0;
+            int constantTracks = 0;
+            // size of the keyframes as they were imported (including scale keys which poses do not use)
+            size_t sourceBytes = 0;
+            size_t compressedBytes = 0;
+            // largest error at the imported keyframes after compression
+            float maxTranslationError = 0;
+            float maxRotationError = 0;
+        };
+
+        /**
+         * Keyframes of one joint before compression
+         */
+        struct SourceTrack {
+            bool animated = false;
+            // local transform when the joint is not animated
+            glm::mat4 restTransform = glm::mat4(1.0f);
+            std::vector<KeyPosition> positions;
+            std::vector<KeyRotation> rotations;
+            int numScales = 0;
+        };
+
+        AnimationClip(Animation &animation, const AnimationSkeleton &skeleton, AnimationCompressionSettings settings = {});
+
+        /**
+         * @param tracks keyframes of each joint of the skeleton the clip is played on
+         */
+        AnimationClip(std::string name, float duration, float ticksPerSecond, const std::vector<SourceTrack> &tracks,
+                      AnimationCompressionSettings settings = {});
+
+        const std::string &getName() const;
+
+        float getDuration() const;
+
+        float getTicksPerSecond() const;
+
+        int getNumJoints() const;
+
+        /**
+         * @return whether the clip has keyframes for the joint (joints without them keep their rest transform)
+         */
+        bool isJointAnimated(int joint) const;
+
+        const CompressionStats &getCompressionStats() const;
+
+        void initCursor(Cursor &cursor) const;
+
+        /**
+         * Sample the local translation and rotation of every joint
+         * @param time time in ticks
+         * @param translations output with one element per joint
+         * @param rotations output with one element per joint
+         */
+        void sample(float time, Cursor &cursor, glm::vec3 *translations, glm::quat *rotations) const;
+
+    private:
+        struct TranslationTrack {
+            int firstKey = 0;
+            int numKeys = 0;
+            // quantized components are relative to the range of the track
+            glm::vec3 min = glm::vec3(0.0f);
+            glm::vec3 extent = glm::vec3(0.0f);
+        };
+
+        struct RotationTrack {
+            int firstKey = 0;
+            int numKeys = 0;
+        };
+
+        void compile(const std::vector<SourceTrack> &tracks, AnimationCompressionSettings settings);
+
+        void measureError(const std::vector<SourceTrack> &tracks);
+
+        glm::vec3 decodeTranslation(const TranslationTrack &track, int key) const;
+
+        glm::quat decodeRotation(int key) const;
+
+        /**
+         * @param time time in quantized units (ticks * timeScale)
+         * @return keyframe at or before the time, starting from (and updating) the cursor
+         */
+        static int findKey(const uint16_t *times, int numKeys, float time, int &cursor);
+
+        static float getInterpolationFactor(const uint16_t *times, int key, float time);
+
+        std::string name;
+        float duration = 0;
+        float ticksPerSecond = 0;
+        // converts ticks to quantized key times
+        float timeScale = 0;
+        std::vector<bool> animated;
+        // local transform of joints without keyframes
+        std::vector<glm::vec3> restTranslations;
+        std::vector<glm::quat> restRotations;
+        std::vector<TranslationTrack> translationTracks;
+        std::vector<uint16_t> translationTimes;
+        std::vector<uint16_t> translationValues;
+        std::vector<RotationTrack> rotationTracks;
+        std::vector<uint16_t> rotationTimes;
+        std::vector<uint16_t> rotationValues;
+        CompressionStats stats;
+    };
+}
+
+#endif //DREAM_ANIMATIONCLIP_H
@@ -0,0 +1,111 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_ANIMATIONPOSE_H
+#define DREAM_ANIMATIONPOSE_H
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Dream {
+    /**
+     * Local translation and rotation of every joint of a skeleton. Poses are blended in local space and only
+     * converted to matrices once the final pose of an animator is known
+     */
+    struct AnimationPose {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+
+        void resize(int numJoints);
+
+        /**
+         * Blend towards another pose in place (pose = mix(pose, other, weight)). Rotations are blended with nlerp
+         * rather than slerp, the loop has no trigonometry so it vectorizes, and the difference is small for the
+         * angles between two poses being blended
+         * @param mask weight of each joint (ex: only the upper body), nullptr for every joint
+         */
+        static void blend(const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                          glm::quat *outRotations, int numJoints, float weight, const float *mask = nullptr);
+
+        /**
+         * Add a weighted pose to a sum of poses (translations and rotations start at zero), rotations are flipped to
+         * the hemisphere of the sum so opposite quaternions do not cancel out. Rotations need normalizeRotations()
+         * once everything was added
+         */
+        static void accumulate(const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                               glm::quat *outRotations, int numJoints, float weight);
+
+        static void normalizeRotations(glm::quat *rotations, int numJoints);
+
+        /**
+         * Apply the difference between an additive pose and its reference pose (usually its first frame) on top of
+         * a pose, rotations are applied in the local space of each joint
+         */
+        static void addAdditive(const glm::vec3 *referenceTranslations, const glm::quat *referenceRotations,
+                                const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                                glm::quat *outRotations, int numJoints, float weight, const float *mask = nullptr);
+    };
+
+    /**
+     * Scratch poses for evaluating animators. Every thread has its own pool so animators evaluated in parallel
+     * share buffers without locking, and buffers are reused between frames instead of being kept by each animator
+     */
+    class AnimationPosePool {
+    public:
+        /**
+         * Pose borrowed from the pool of the thread that acquired it, returned when the handle is destroyed (on the
+         * same thread)
+         */
+        class Handle {
+        public:
+            explicit Handle(std::unique_ptr<AnimationPose> pose);
+
+            Handle(Handle &&other) noexcept;
+
+            Handle(const Handle &) = delete;
+
+            Handle &operator=(const Handle &) = delete;
+
+            ~Handle();
+
+            AnimationPose &operator*();
+
+            AnimationPose *operator->();
+
+        private:
+            std::unique_ptr<AnimationPose> pose;
+        };
+
+        /**
+         * @return pose with room for the joints, its contents are undefined
+         */
+        static Handle acquire(int numJoints);
+
+        /**
+         * @return number of poses waiting to be reused by the calling thread
+         */
+        static int getNumFreePoses();
+
+    private:
+        static std::vector<std::unique_ptr<AnimationPose>> &getFreePoses();
+    };
+}
+
+#endif //DREAM_ANIMATIONPOSE_H
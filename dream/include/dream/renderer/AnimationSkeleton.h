@@ -0,0 +1,81 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_ANIMATIONSKELETON_H
+#define DREAM_ANIMATIONSKELETON_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "dream/renderer/AnimationData.h"
+#include "dream/renderer/AssimpNodeData.h"
+
+namespace Dream {
+    /**
+     * Node hierarchy of an animated model flattened into joints, parents always come before their children so a pose
+     * can be evaluated front to back without recursion or name lookups
+     */
+    class AnimationSkeleton {
+    public:
+        AnimationSkeleton(const AssimpNodeData &rootNode, const std::map<std::string, BoneInfo> &boneInfoMap);
+
+        int getNumJoints() const;
+
+        /**
+         * @return index of the joint for the node with this name, -1 if there is none
+         */
+        int findJoint(const std::string &name) const;
+
+        const std::string &getJointName(int joint) const;
+
+        /**
+         * @return parent joint, -1 for the root
+         */
+        int getParent(int joint) const;
+
+        /**
+         * @return number of ancestors of the joint (0 for the root)
+         */
+        int getDepth(int joint) const;
+
+        /**
+         * @return index of the joint in the final bone matrices, -1 if no vertices are skinned to it
+         */
+        int getBoneIndex(int joint) const;
+
+        const glm::mat4 &getOffset(int joint) const;
+
+        /**
+         * @return local transform of the node when it is not animated
+         */
+        const glm::mat4 &getRestTransform(int joint) const;
+
+    private:
+        void addJoint(const AssimpNodeData &node, int parent, int depth, const std::map<std::string, BoneInfo> &boneInfoMap);
+
+        std::vector<std::string> names;
+        std::vector<int> parents;
+        std::vector<int> depths;
+        std::vector<int> boneIndices;
+        std::vector<glm::mat4> offsets;
+        std::vector<glm::mat4> restTransforms;
+    };
+}
+
+#endif //DREAM_ANIMATIONSKELETON_H
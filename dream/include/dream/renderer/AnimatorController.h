@@ -0,0 +1,268 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_ANIMATORCONTROLLER_H
+#define DREAM_ANIMATORCONTROLLER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Dream {
+    /**
+     * State machine of an animator file compiled for evaluation. Operators are resolved when compiling, transitions
+     * are grouped by the state they leave from and parameters are addressed by index, so evaluating a state only
+     * visits its own transitions and never compares strings. Controllers are immutable and shared by every animator
+     * using the same file, the parameter values are kept by each animator.
+     */
+    class AnimatorController {
+    public:
+        enum class ParameterType {
+            INT,
+            FLOAT,
+            BOOL,
+            // bool that is reset once a transition reading it is taken
+            TRIGGER
+        };
+
+        enum class BlendTreeType {
+            // the state plays a single animation
+            NONE,
+            // animations are placed on a line and the two around the parameter are blended
+            SIMPLE_1D,
+            // animations are placed on a plane and blended with gradient band interpolation
+            FREEFORM_2D
+        };
+
+        enum class Comparison {
+            EQUAL,
+            NOT_EQUAL,
+            GREATER,
+            LESS,
+            GREATER_EQUAL,
+            LESS_EQUAL
+        };
+
+        /**
+         * Contents of an animator file as they are authored in the editor
+         */
+        struct Description {
+            struct Motion {
+                std::string Guid = "";
+                // position of the animation in the blend tree
+                float X = 0;
+                float Y = 0;
+            };
+            struct State {
+                std::string Guid = "";
+                bool PlayOnce = true;
+                std::string Name = "";
+                // when the state is a blend tree its motions are played instead of Guid
+                BlendTreeType BlendType = BlendTreeType::NONE;
+                int BlendVariable1Idx = -1;
+                int BlendVariable2Idx = -1;
+                std::vector<Motion> Motions;
+            };
+            struct Condition {
+                int Variable1Idx = -1;
+                float Variable1 = 0;
+                std::string Operator = "==";
+                int Variable2Idx = -1;
+                float Variable2 = 0;
+            };
+            struct Transition {
+                int InputStateID;
+                int OutputStateID;
+                std::vector<Condition> Conditions;
+                bool Blend;
+            };
+            struct Variable {
+                std::string Name = "";
+                ParameterType Type = ParameterType::INT;
+                float Value = 0;
+            };
+            struct Layer {
+                std::string Name = "";
+                // played on top of the state machine, looping unless PlayOnce (restarts once the weight goes to 0)
+                State Motion;
+                // joints (with their descendants) the layer affects, every joint if empty
+                std::vector<std::string> Mask;
+                // add the difference from the first frame of the layer instead of replacing the pose
+                bool Additive = false;
+                // weight is multiplied by the variable when there is one
+                int WeightVariableIdx = -1;
+                float Weight = 1;
+            };
+            std::vector<State> states;
+            std::vector<Transition> transitions;
+            std::vector<Variable> variables;
+            std::vector<Layer> layers;
+        };
+
+        struct Parameter {
+            std::string name;
+            ParameterType type;
+            float defaultValue;
+        };
+
+        struct Motion {
+            std::string guid;
+            glm::vec2 position;
+        };
+
+        struct BlendTree {
+            BlendTreeType type;
+            int parameterX;
+            int parameterY;
+            // range of the motions of the tree, sorted by position for 1D trees
+            int firstMotion;
+            int numMotions;
+        };
+
+        struct State {
+            std::string name;
+            bool playOnce;
+            BlendTree motions;
+            // range of the transitions leaving this state
+            int firstTransition;
+            int numTransitions;
+        };
+
+        struct Condition {
+            // parameter index for each operand, -1 to use the constant instead
+            int parameter1;
+            float value1;
+            Comparison comparison;
+            int parameter2;
+            float value2;
+        };
+
+        struct Transition {
+            int targetState;
+            bool blend;
+            // range of the conditions that must all pass
+            int firstCondition;
+            int numConditions;
+            bool readsTriggers;
+        };
+
+        struct Layer {
+            std::string name;
+            bool playOnce;
+            BlendTree motions;
+            std::vector<std::string> mask;
+            bool additive;
+            int weightParameter;
+            float weight;
+        };
+
+        explicit AnimatorController(const Description &description);
+
+        /**
+         * @return comparison for an operator of an animator file ("==", ">", ...), EQUAL if it is unknown
+         */
+        static Comparison parseComparison(const std::string &op, bool *valid = nullptr);
+
+        static const char *getParameterTypeName(ParameterType type);
+
+        static const char *getBlendTreeTypeName(BlendTreeType type);
+
+        /**
+         * @return blend tree type for its name in an animator file ("1D", "2D"), NONE if it is unknown
+         */
+        static BlendTreeType parseBlendTreeType(const std::string &name);
+
+        /**
+         * @return parameter type for its name in an animator file ("Int", "Float", ...), INT if it is unknown
+         */
+        static ParameterType parseParameterType(const std::string &name);
+
+        /**
+         * Remove a variable of an animator file, conditions reading it are removed and blend trees or layer weights
+         * reading it no longer read a variable, indices of the variables after it are shifted down
+         */
+        static void removeVariable(Description &description, int variable);
+
+        int getNumStates() const;
+
+        const State &getState(int state) const;
+
+        const Transition &getTransition(int transition) const;
+
+        int getNumMotions() const;
+
+        const Motion &getMotion(int motion) const;
+
+        int getNumLayers() const;
+
+        const Layer &getLayer(int layer) const;
+
+        /**
+         * @return weight of the layer for the current parameters, between 0 and 1
+         */
+        float getLayerWeight(int layer, const float *values) const;
+
+        /**
+         * Weight of each motion of a blend tree for the current parameters, the weights add up to 1
+         * @param weights output indexed by motion (only the range of the tree is written)
+         */
+        void getMotionWeights(const BlendTree &tree, const float *values, float *weights) const;
+
+        int getNumParameters() const;
+
+        const Parameter &getParameter(int parameter) const;
+
+        /**
+         * @return index of the parameter used to get and set its value, -1 if there is none
+         */
+        int findParameter(const std::string &name) const;
+
+        /**
+         * Size the parameter values of an animator and set them to their defaults
+         */
+        void initParameters(std::vector<float> &values) const;
+
+        /**
+         * @return the first transition leaving the state whose conditions all pass, -1 if there is none
+         */
+        int findTransition(int state, const float *values) const;
+
+        /**
+         * Reset the triggers read by a transition once it is taken
+         */
+        void consumeTriggers(int transition, float *values) const;
+
+    private:
+        bool evaluate(const Condition &condition, const float *values) const;
+
+        BlendTree compileMotions(const Description::State &state);
+
+        int validParameter(int parameter) const;
+
+        std::vector<State> states;
+        std::vector<Motion> motions;
+        std::vector<Layer> layers;
+        std::vector<Transition> transitions;
+        std::vector<Condition> conditions;
+        std::vector<Parameter> parameters;
+        std::unordered_map<std::string, int> parameterIndices;
+    };
+}
+
+#endif //DREAM_ANIMATORCONTROLLER_H
@@ -0,0 +1,142 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_FRAMESNAPSHOT_H
+#define DREAM_FRAMESNAPSHOT_H
+
+#include <memory>
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "dream/project/Project.h"
+#include "dream/renderer/Camera.h"
+#include "dream/renderer/OpenGLMesh.h"
+#include "dream/renderer/OpenGLBaseTerrain.h"
+#include "dream/renderer/Texture.h"
+#include "dream/renderer/VertexAnimationTexture.h"
+
+namespace Dream {
+    struct MaterialSnapshot {
+        bool hasMaterial = false;
+        float shininess = 20.0f;
+        glm::vec4 diffuseColor = glm::vec4(1.0, 1.0, 1.0, 1.0);
+        glm::vec4 specularColor = glm::vec4(1.0, 1.0, 1.0, 1.0);
+        glm::vec4 ambientColor = glm::vec4(1.0, 1.0, 1.0, 1.0);
+        // null when the material does not use the texture (default texture is bound instead)
+        std::shared_ptr<Texture> diffuseTexture;
+        std::shared_ptr<Texture> specularTexture;
+        std::shared_ptr<Texture> normalTexture;
+        std::shared_ptr<Texture> heightTexture;
+        std::shared_ptr<Texture> ambientTexture;
+    };
+
+    struct LightSnapshot {
+        glm::vec3 position;
+        glm::vec3 direction;
+        glm::vec3 color;
+        float constant;
+        float linear;
+        float quadratic;
+        float cutOff;
+        float outerCutOff;
+    };
+
+    struct MeshDrawItem {
+        std::shared_ptr<OpenGLMesh> mesh;
+        glm::mat4 model;
+        MaterialSnapshot material;
+        // range of FrameSnapshot::bonePalettes used by this mesh, numBones is 0 for meshes without an animator
+        int bonePaletteOffset = 0;
+        int numBones = 0;
+        // index of the buffer the mesh is skinned into once per frame, -1 if it is skinned in every pass
+        int skinnedVertexBuffer = -1;
+    };
+
+    struct VertexAnimationInstance {
+        glm::mat4 model;
+        // frames to interpolate between (indices into all frames of the baked texture) and the amount of the second
+        glm::vec4 frames;
+    };
+
+    struct VertexAnimationSubMesh {
+        std::shared_ptr<OpenGLMesh> mesh;
+        // index into VertexAnimationTexture::getSubMeshes()
+        int subMesh = 0;
+        MaterialSnapshot material;
+    };
+
+    /**
+     * Instances drawn from the same baked vertex animation, meshes and materials are taken from the first instance
+     */
+    struct VertexAnimationBatch {
+        std::shared_ptr<const VertexAnimationTexture> vertexAnimation;
+        std::vector<VertexAnimationSubMesh> subMeshes;
+        std::vector<VertexAnimationInstance> instances;
+    };
+
+    struct TerrainDrawItem {
+        OpenGLBaseTerrain *terrain;
+        glm::mat4 model;
+        MaterialSnapshot material;
+    };
+
+    /**
+     * Everything the renderer needs to draw a frame, copied out of the scene so GL submission
+     * never reads the registry while the next frame is being simulated
+     */
+    struct FrameSnapshot {
+        int viewportWidth = 0;
+        int viewportHeight = 0;
+        bool fullscreen = false;
+        Config config;
+        // how far between the last two physics steps rigid bodies are drawn (0 to 1)
+        float interpolationAlpha = 1.0f;
+        std::optional<Camera> camera;
+        glm::vec3 shadowDirectionalLightDirection = glm::vec3(1, 0, 0);
+        std::vector<LightSnapshot> directionalLights;
+        std::vector<LightSnapshot> pointLights;
+        std::vector<LightSnapshot> spotLights;
+        std::vector<MeshDrawItem> meshes;
+        std::vector<VertexAnimationBatch> vertexAnimationBatches;
+        std::vector<TerrainDrawItem> terrains;
+        std::vector<glm::mat4> bonePalettes;
+        int numSkinnedMeshes = 0;
+        bool drawPhysicsDebug = false;
+        // pairs of line end points
+        std::vector<glm::vec3> physicsDebugLines;
+
+        /**
+         * Reset the snapshot for reuse, vectors keep their capacity
+         */
+        void clear() {
+            camera.reset();
+            directionalLights.clear();
+            pointLights.clear();
+            spotLights.clear();
+            meshes.clear();
+            vertexAnimationBatches.clear();
+            terrains.clear();
+            bonePalettes.clear();
+            numSkinnedMeshes = 0;
+            drawPhysicsDebug = false;
+            physicsDebugLines.clear();
+        }
+    };
+}
+
+#endif //DREAM_FRAMESNAPSHOT_H
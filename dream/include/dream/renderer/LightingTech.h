@@ -10,15 +10,21 @@
 #include "dream/scene/Entity.h"
 #include "OpenGLTexture.h"
 #include "OpenGLShadowMapFBO.h"
+#include "dream/renderer/FrameSnapshot.h"
 
 namespace Dream {
     class LightingTech {
     public:
         LightingTech();
         ~LightingTech();
-        void setTextureAndColorUniforms(Entity entity, std::vector<OpenGLShadowMapFBO *> shadowMapFbos, DirectionalLightShadowTech* directionalLightShadowTech, OpenGLShader *shader);
+        // copy material properties of the entity (textures that have not been loaded yet are left as defaults)
+        MaterialSnapshot getMaterial(Entity entity);
+        // copy lights of the scene into the frame snapshot
+        void getLights(FrameSnapshot &frame);
+        void setTextureAndColorUniforms(const FrameSnapshot &frame, const MaterialSnapshot &material, std::vector<OpenGLShadowMapFBO *> shadowMapFbos, DirectionalLightShadowTech* directionalLightShadowTech, OpenGLShader *shader);
     private:
-        void setLightShaderUniforms(OpenGLShader *shader);
+        void setLightShaderUniforms(const FrameSnapshot &frame, OpenGLShader *shader);
+        void bindTexture(OpenGLShader *shader, const std::string &uniform, int unit, const std::shared_ptr<Texture> &texture, OpenGLTexture *defaultTexture);
         OpenGLTexture *whiteTexture;
         OpenGLTexture *blackTexture;
     };
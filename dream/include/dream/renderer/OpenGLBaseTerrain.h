@@ -9,7 +9,10 @@
 #include "dream/renderer/OpenGLTriangleList.h"
 #include "dream/renderer/OpenGLTexture.h"
 #include "dream/renderer/OpenGLShader.h"
+#include "dream/util/HeightMapPyramid.h"
+#include "dream/util/TiledHeightMap.h"
 #include <ogldev/ogldev_array_2d.h>
+#include <optional>
 
 namespace Dream {
     class OpenGLBaseTerrain {
@@ -20,20 +23,56 @@ namespace Dream {
 
         void setShaderUniforms(OpenGLShader* shader);
 
-        void render();
+        /**
+         * Draw the visible chunks of the terrain at a level of detail based on their distance from the camera
+         * @param viewProjection view projection matrix of the pass, chunks outside of it are culled
+         * @param cameraPosition world position of the camera that levels of detail are chosen for
+         * @param lodBias added to the level of detail of every chunk (ex: coarser terrain for shadow maps)
+         * @param cullDepth whether to cull against the near / far planes, disabled for depth clamped shadow maps
+         */
+        void render(const glm::mat4 &model, const glm::mat4 &viewProjection, glm::vec3 cameraPosition,
+                    int lodBias = 0, bool cullDepth = true);
 
         void loadFromFile(const char* pFilename);
 
+        /**
+         * Apply height map tiles that finished loading in the background, request the tiles around the camera and
+         * upload the chunks of the terrain that were modified, must be called on the thread that owns the GL context
+         */
         void refreshTerrainTriangleList();
 
+        /**
+         * Save the height map as a tiled height map, only the tiles that were modified are rewritten when saving
+         * to the file the terrain was loaded from
+         */
         void saveToFile(const char* pFilename);
 
+        /**
+         * Load the tiles within the (inclusive) rectangle that have not been loaded yet on the calling thread
+         * (ex: before sculpting them or before rigid bodies reach them)
+         * @return whether any tile was loaded
+         */
+        bool loadTiles(int minX, int minZ, int maxX, int maxZ);
+
         float getHeight(glm::vec2 vec) const;
 
         float getHeight(int x, int z) const;
 
         void setHeight(int x, int z, float y);
 
+        /**
+         * Notify the terrain that heights within the (inclusive) rectangle were written through getHeightMapData()
+         */
+        void markHeightsModified(int minX, int minZ, int maxX, int maxZ);
+
+        /**
+         * Intersect a ray with the terrain surface
+         * @param origin ray origin in the local space of the terrain
+         * @param direction ray direction in the local space of the terrain
+         * @return closest hit in the local space of the terrain
+         */
+        std::optional<glm::vec3> raycast(glm::vec3 origin, glm::vec3 direction) const;
+
         float getWorldScale() const;
 
         float getSize() const;
@@ -42,17 +81,38 @@ namespace Dream {
 
         Array2D<float> getHeightMap();
 
+        /**
+         * @return row-major heights (z * size + x) of the terrain, valid until another height map is loaded
+         */
+        const float *getHeightMapData() const;
+
+        float *getHeightMapData();
+
         float getMinHeight();
 
         float getMaxHeight();
     protected:
         void loadHeightMapFile(const char* pFilename);
+        void onHeightsChanged(int minX, int minZ, int maxX, int maxZ);
+        void requestTilesNearCamera();
+        std::vector<int> getTiles(int minX, int minZ, int maxX, int maxZ) const;
         int m_terrainSize = 0;
         float m_textureScale = 1.0f;
         float m_worldScale = 1.0f;
         float m_minHeight = 0.0f;
         float m_maxHeight = 0.0f;
         Array2D<float> m_heightMap;
+        HeightMapPyramid m_heightMapPyramid;
+        TiledHeightMap m_tiledHeightMap;
+        int m_tileSize = 64;
+        int m_numTilesPerSide = 0;
+        std::vector<bool> m_tileLoaded;
+        std::vector<bool> m_tileRequested;
+        std::vector<bool> m_tileModified;
+        // tiles are loaded lazily, nearest first, within this distance (local space) of the camera. Loaded tiles stay in
+        // the height map, which is allocated for the whole terrain, so this bounds load time IO and not memory
+        float m_tileLoadDistance = 2048.0f;
+        glm::vec3 m_tileLoadOrigin = {0, 0, 0};
         OpenGLTriangleList m_triangleList;
 
         OpenGLTexture *textureDiffuse0;
@@ -48,7 +48,7 @@ namespace Dream {
 
     private:
         int width, height;
-        unsigned int framebuffer, textureColorbuffer, rbo, screenQuadVAO;
+        unsigned int framebuffer, textureColorbuffer, rbo, screenQuadVAO, screenQuadVBO;
         OpenGLShader *screenShader;
     };
 }
@@ -0,0 +1,55 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_OPENGLGPUTIMER_H
+#define DREAM_OPENGLGPUTIMER_H
+
+namespace Dream {
+    /**
+     * Measures GPU time between begin() and end() with GL_TIME_ELAPSED queries. Results are read back a few frames
+     * later from a ring of queries so the CPU never stalls waiting on the GPU. Timer queries are not available in
+     * WebGL so the timer never reports a result there.
+     */
+    class OpenGLGPUTimer {
+    public:
+        OpenGLGPUTimer();
+
+        ~OpenGLGPUTimer();
+
+        void begin();
+
+        void end();
+
+        /**
+         * @return most recent GPU time in milliseconds that has been read back, or -1 if none is available yet
+         */
+        double getElapsedTime();
+
+        static bool isSupported();
+
+    private:
+        // number of frames a query may stay in flight before its result is read back
+        static constexpr int latency = 4;
+        unsigned int queries[latency] = {};
+        bool pending[latency] = {};
+        int current = 0;
+        double elapsedTime = -1;
+    };
+}
+
+#endif //DREAM_OPENGLGPUTIMER_H
@@ -26,7 +26,9 @@ namespace Dream {
         virtual void reportErrorWarning(const char *);
         virtual void draw3dText(const btVector3 &, const char *);
         virtual void setDebugMode(int p);
-        void doDrawing();
+        // move the lines collected since the last call into points (pairs of end points)
+        void takeLines(std::vector<glm::vec3> &points);
+        static void drawLines(const std::vector<glm::vec3> &points);
         int getDebugMode(void) const;
         #ifndef EMSCRIPTEN
         [[nodiscard]] btIDebugDraw::DefaultColors getDefaultColors() const;
@@ -0,0 +1,124 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_OPENGLRENDERGRAPH_H
+#define DREAM_OPENGLRENDERGRAPH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "dream/renderer/OpenGLRenderTargetPool.h"
+#include "dream/renderer/OpenGLRenderStats.h"
+
+namespace Dream {
+    /**
+     * Frame graph that is rebuilt every frame. Passes declare the render targets they read and write,
+     * passes that do not contribute to the output are culled, and transient render targets with
+     * non-overlapping lifetimes are aliased onto the same pooled GPU memory.
+     */
+    class OpenGLRenderGraph {
+    public:
+        struct Pass {
+            std::string name;
+            std::vector<int> reads;
+            std::vector<int> writes;
+            std::function<void()> execute;
+            bool enabled = true;
+            // computed during compile()
+            bool culled = false;
+            // measured during execute(), GPU time is from a few frames ago (-1 if unavailable)
+            double cpuTime = 0;
+            double gpuTime = -1;
+            RenderCounters counters;
+        };
+
+        struct Resource {
+            std::string name;
+            RenderTargetDescription description;
+            // computed during compile()
+            int firstUse = -1;
+            int lastUse = -1;
+            int physicalIndex = -1;
+        };
+
+        ~OpenGLRenderGraph();
+
+        /**
+         * Remove all passes and resources so the graph can be rebuilt for the next frame
+         */
+        void reset();
+
+        /**
+         * Declare a transient render target
+         * @return handle of the render target used when declaring passes
+         */
+        int createRenderTarget(const std::string &name, RenderTargetDescription description);
+
+        /**
+         * Declare a pass, passes execute in the order they are added. Enabled passes that write no render target
+         * are never culled since their results live outside the graph
+         * @param enabled disabled passes are culled along with any pass that only feeds them
+         */
+        void addPass(const std::string &name, std::vector<int> reads, std::vector<int> writes,
+                     std::function<void()> execute, bool enabled = true);
+
+        /**
+         * Mark the render target that is presented / sampled by the editor after the graph executes
+         */
+        void setOutput(int resource);
+
+        /**
+         * Cull passes and compute lifetimes and memory aliasing of render targets
+         */
+        void compile();
+
+        /**
+         * Acquire render targets from the pool, run the passes that were not culled and release the transient targets
+         */
+        void execute(OpenGLRenderTargetPool *pool);
+
+        OpenGLFrameBuffer *getFrameBuffer(int resource);
+
+        OpenGLShadowMapFBO *getShadowMap(int resource);
+
+        /**
+         * Frame buffer of the output from the last time the graph executed
+         */
+        OpenGLFrameBuffer *getOutputFrameBuffer();
+
+        const std::vector<Pass> &getPasses();
+
+        const std::vector<Resource> &getResources();
+
+        int getNumPhysicalRenderTargets();
+
+    private:
+        OpenGLRenderTarget *getRenderTarget(int resource);
+
+        std::vector<Pass> passes;
+        std::vector<Resource> resources;
+        std::vector<RenderTargetDescription> physicalDescriptions;
+        std::vector<OpenGLRenderTarget *> physicalRenderTargets;
+        int output = -1;
+        // the output is kept until the next frame since the editor samples it after rendering
+        OpenGLRenderTarget *retainedOutput = nullptr;
+        OpenGLRenderTargetPool *retainedOutputPool = nullptr;
+    };
+}
+
+#endif //DREAM_OPENGLRENDERGRAPH_H
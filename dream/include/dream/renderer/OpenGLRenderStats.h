@@ -0,0 +1,122 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_OPENGLRENDERSTATS_H
+#define DREAM_OPENGLRENDERSTATS_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "dream/renderer/OpenGLGPUTimer.h"
+
+namespace Dream {
+    struct RenderCounters {
+        long long drawCalls = 0;
+        long long triangles = 0;
+        long long textureBinds = 0;
+        long long programSwitches = 0;
+        long long uniformUploads = 0;
+
+        RenderCounters operator-(const RenderCounters &other) const;
+
+        RenderCounters &operator+=(const RenderCounters &other);
+    };
+
+    /**
+     * Running totals of the GL work issued by the renderer along with a rolling history of CPU time, GPU time and
+     * counters for every pass (render graph passes and the editor)
+     */
+    class OpenGLRenderStats {
+    public:
+        struct Sample {
+            double cpuTime = 0;
+            // -1 when no GPU timing is available (ex: WebGL)
+            double gpuTime = -1;
+            RenderCounters counters;
+        };
+
+        struct PassHistory {
+            std::string name;
+            // ring buffer of the most recent samples, next is the index that is overwritten next
+            std::vector<Sample> samples;
+            int next = 0;
+            OpenGLGPUTimer *gpuTimer = nullptr;
+
+            /**
+             * @return samples ordered from oldest to newest
+             */
+            std::vector<Sample> getOrderedSamples() const;
+
+            double getAverageCPUTime() const;
+
+            /**
+             * @return average GPU time of the samples that have one, or -1 if none do
+             */
+            double getAverageGPUTime() const;
+
+            RenderCounters getLatestCounters() const;
+        };
+
+        static const RenderCounters &getCounters();
+
+        static void countDrawCall(long long triangles);
+
+        static void countTextureBind();
+
+        static void countProgramSwitch();
+
+        static void countUniformUpload();
+
+        /**
+         * Start timing a pass on the CPU and GPU, passes cannot be nested since GPU timer queries cannot be nested
+         */
+        static void beginPass(const std::string &name);
+
+        /**
+         * Stop timing the current pass and add a sample to its history
+         * @return sample that was recorded, its GPU time is from a few frames ago since queries are read back late
+         */
+        static Sample endPass();
+
+        static const std::vector<PassHistory> &getPassHistories();
+
+        /**
+         * Remove all samples from the pass histories
+         */
+        static void clearPassHistories();
+
+        /**
+         * Write every sample in the pass histories to a CSV file
+         * @return whether the file could be written
+         */
+        static bool exportCSV(const std::filesystem::path &path);
+
+        // number of samples kept per pass (a few seconds at 60 fps)
+        static constexpr int historySize = 240;
+
+    private:
+        inline static RenderCounters counters;
+        inline static std::vector<PassHistory> passHistories;
+        inline static int currentPass = -1;
+        inline static RenderCounters currentPassCounters;
+        inline static std::chrono::high_resolution_clock::time_point currentPassStart;
+    };
+}
+
+#endif //DREAM_OPENGLRENDERSTATS_H
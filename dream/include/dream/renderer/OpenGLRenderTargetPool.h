@@ -0,0 +1,85 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_OPENGLRENDERTARGETPOOL_H
+#define DREAM_OPENGLRENDERTARGETPOOL_H
+
+#include <vector>
+#include "dream/renderer/OpenGLFrameBuffer.h"
+#include "dream/renderer/OpenGLShadowMapFBO.h"
+
+namespace Dream {
+    struct RenderTargetDescription {
+        enum Type {
+            COLOR_DEPTH, DEPTH
+        };
+        Type type = COLOR_DEPTH;
+        int width = 0;
+        int height = 0;
+
+        bool operator==(const RenderTargetDescription &other) const;
+
+        bool operator!=(const RenderTargetDescription &other) const;
+    };
+
+    struct OpenGLRenderTarget {
+        RenderTargetDescription description;
+        // only one of these is created depending on the description type
+        OpenGLFrameBuffer *frameBuffer = nullptr;
+        OpenGLShadowMapFBO *shadowMap = nullptr;
+        // runtime bookkeeping for the pool
+        bool inUse = false;
+        int lastUsedFrame = 0;
+    };
+
+    class OpenGLRenderTargetPool {
+    public:
+        ~OpenGLRenderTargetPool();
+
+        /**
+         * Advance the frame counter and free render targets that have not been used for a few frames
+         * (ex: output targets from before the viewport was resized)
+         */
+        void beginFrame();
+
+        /**
+         * Get an unused render target matching the description, creating one if none is available
+         * @param description size and attachments of the render target
+         * @return render target that stays reserved until it is released
+         */
+        OpenGLRenderTarget *acquire(const RenderTargetDescription &description);
+
+        /**
+         * Return a render target to the pool so later passes or frames can reuse its memory
+         * @param renderTarget render target previously returned by acquire()
+         */
+        void release(OpenGLRenderTarget *renderTarget);
+
+        int getNumRenderTargets();
+
+    private:
+        void destroy(OpenGLRenderTarget *renderTarget);
+
+        std::vector<OpenGLRenderTarget *> renderTargets;
+        int frame = 0;
+        // number of frames an unused render target is kept alive before its memory is freed
+        inline static int maxUnusedFrames = 3;
+    };
+}
+
+#endif //DREAM_OPENGLRENDERTARGETPOOL_H
@@ -33,7 +33,12 @@
 #include "dream/renderer/LightingTech.h"
 #include "Camera.h"
 #include "SkinningTech.h"
+#include "dream/renderer/VertexAnimationTech.h"
 #include "dream/renderer/OpenGLBaseTerrain.h"
+#include "dream/renderer/OpenGLRenderGraph.h"
+#include "dream/renderer/OpenGLRenderTargetPool.h"
+#include "dream/renderer/FrameSnapshot.h"
+#include "dream/util/TripleBuffer.h"
 
 namespace Dream {
     class OpenGLRenderer : public Renderer {
@@ -42,10 +47,17 @@ namespace Dream {
 
         ~OpenGLRenderer();
 
-        void render(int viewportWidth, int viewportHeight, bool fullscreen) override;
+        void prepare() override;
+
+        void extract(int viewportWidth, int viewportHeight, bool fullscreen) override;
+
+        void submit() override;
 
         unsigned int getOutputRenderTexture() override;
 
+        // graph of the last submitted frame (pass timings, draw calls, etc.)
+        OpenGLRenderGraph *getRenderGraph();
+
     private:
         OpenGLShader *lightingShader;
         OpenGLShader *singleTextureShader;
@@ -53,24 +65,50 @@ namespace Dream {
         OpenGLShader *skyboxShader;
         OpenGLShader *simpleDepthShader;
         OpenGLShader *terrainShader;
-        OpenGLFrameBuffer *outputRenderTextureFbo;
+        OpenGLRenderGraph *renderGraph;
+        OpenGLRenderTargetPool *renderTargetPool;
+        // shadow maps of the current frame, assigned from the render graph before the lighting passes run
         std::vector<OpenGLShadowMapFBO *> shadowMapFbos;
         LightingTech *lightingTech;
         DirectionalLightShadowTech *directionalLightShadowTech;
         SkinningTech *skinningTech;
+        VertexAnimationTech *vertexAnimationTech;
         OpenGLSkybox *skybox;
-
-        void resizeFrameBuffer();
+        // written by extract() on the simulation thread and read by submit()
+        TripleBuffer<FrameSnapshot> frameSnapshots;
 
         void printGLVersion();
 
-        void drawTerrains(Camera camera, OpenGLShader* shader);
+        /**
+         * @param bonePaletteOffset bone palette range of the closest animated ancestor, used when skinning meshes of the entity
+         */
+        void extractEntities(Entity entity, FrameSnapshot &frame, int bonePaletteOffset = 0, int numBones = 0);
+
+        /**
+         * @param viewProjection view projection matrix of the pass, used to cull terrain chunks
+         * @param lodBias added to the terrain level of detail (ex: coarser terrain for shadow cascades)
+         * @param cullDepth whether to cull terrain chunks against the near / far planes
+         */
+        void drawTerrains(const FrameSnapshot &frame, OpenGLShader *shader, const glm::mat4 &viewProjection,
+                          int lodBias = 0, bool cullDepth = true);
+
+        void drawMeshes(const FrameSnapshot &frame, OpenGLShader *shader);
 
-        void drawEntities(Entity entity, Camera camera, OpenGLShader *shader);
+        /**
+         * Draw the instances of every batch of baked vertex animations
+         */
+        void drawVertexAnimations(const FrameSnapshot &frame, OpenGLShader *shader);
 
-        void drawMesh(std::shared_ptr<OpenGLMesh> openGLMesh);
+        /**
+         * Set the camera and shadow cascade uniforms of the lit shaders
+         */
+        void setCameraUniforms(OpenGLShader *shader, Camera &camera, const std::vector<glm::mat4> &lightSpaceMatrices,
+                               const FrameSnapshot &frame);
 
-        std::pair<int, int> getViewportDimensions();
+        /**
+         * @param vao vertex array to draw, either the one of the mesh or its pre-skinned vertices
+         */
+        void drawMesh(std::shared_ptr<OpenGLMesh> openGLMesh, unsigned int vao);
 
     };
 }
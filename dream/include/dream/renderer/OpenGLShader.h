@@ -20,6 +20,8 @@
 #define DREAM_OPENGLSHADER_H
 
 #include <iostream>
+#include <string>
+#include <vector>
 #include <glm/glm.hpp>
 
 namespace Dream {
@@ -27,7 +29,11 @@ namespace Dream {
     public:
         unsigned int ID;
 
-        OpenGLShader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr);
+        /**
+         * @param transformFeedbackVaryings vertex shader outputs captured (interleaved) with transform feedback
+         */
+        OpenGLShader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr,
+                     const std::vector<std::string> &transformFeedbackVaryings = {});
 
         void use();
 
@@ -53,10 +59,18 @@ namespace Dream {
 
         void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
+        /**
+         * Upload consecutive elements of a matrix array uniform in one call
+         */
+        void setMat4Array(const std::string &name, const glm::mat4 *mats, int count) const;
+
         static std::string getShaderVersion();
 
     private:
         void checkCompileErrors(int shader, std::string type);
+
+        // program that was last bound through use()
+        inline static unsigned int currentProgram = 0;
     };
 }
 
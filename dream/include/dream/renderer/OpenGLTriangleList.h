@@ -5,22 +5,95 @@
 #ifndef DREAM_OPENGLTRIANGLELIST_H
 #define DREAM_OPENGLTRIANGLELIST_H
 
+#include <map>
+#include <tuple>
+#include <utility>
 #include <vector>
-#include "glm/vec3.hpp"
+#include <glm/glm.hpp>
 #include "Mesh.h"
 
 namespace Dream {
     class OpenGLBaseTerrain;
 
+    /**
+     * Terrain grid split into square chunks that each have their own vertex buffer, so editing the height map
+     * only re-uploads the rows of the chunks that changed. Chunks are the leaves of a quadtree that is used to
+     * frustum cull them, and every chunk is drawn at a level of detail (geomipmapping) picked from its distance
+     * to the camera. Edges next to coarser chunks are stitched to the coarser vertices so there are no cracks.
+     */
     class OpenGLTriangleList {
     public:
+        struct Chunk {
+            // first vertex of the chunk in the height map, neighboring chunks share their border vertices
+            int startX = 0;
+            int startZ = 0;
+            // number of vertices along each axis
+            int width = 0;
+            int depth = 0;
+            float minHeight = 0.0f;
+            float maxHeight = 0.0f;
+            unsigned int vao = 0;
+            unsigned int vb = 0;
+            // full resolution index buffer, shared by all chunks with the same width and depth
+            unsigned int ib = 0;
+            // coarsest level of detail whose vertex step evenly divides the chunk
+            int maxLod = 0;
+            // rows (relative to startZ) that changed since the last upload, -1 when the chunk is up-to-date
+            int dirtyMinZ = -1;
+            int dirtyMaxZ = -1;
+        };
+
         OpenGLTriangleList();
 
+        ~OpenGLTriangleList();
+
         void createTriangleList(int width, int depth, const OpenGLBaseTerrain* pTerrain);
 
-        void render();
+        /**
+         * Mark the vertices within the (inclusive) rectangle as modified
+         */
+        void markDirty(int minX, int minZ, int maxX, int maxZ);
+
+        /**
+         * Regenerate and upload the modified rows of every dirty chunk, and recompute their min / max heights
+         * @return whether any chunk was updated
+         */
+        bool updateDirtyChunks(const OpenGLBaseTerrain* pTerrain);
+
+        /**
+         * Draw the chunks inside the frustum
+         * @param clipFromLocal transforms terrain-local positions to clip space, used for frustum culling
+         * @param lodOrigin terrain-local position that levels of detail are chosen relative to (ex: camera position)
+         * @param lodBias added to the level of detail of every chunk (ex: coarser terrain for shadow maps)
+         * @param cullDepth whether to cull against the near / far planes, disabled for depth clamped shadow maps
+         */
+        void render(const glm::mat4 &clipFromLocal, glm::vec3 lodOrigin, int lodBias = 0, bool cullDepth = true);
+
+        const std::vector<Chunk> &getChunks() const;
+
+        // number of quads along each side of a chunk
+        static constexpr int chunkSize = 64;
 
     private:
+        struct Node {
+            // range of chunks (inclusive) covered by this node
+            int minChunkX = 0;
+            int minChunkZ = 0;
+            int maxChunkX = 0;
+            int maxChunkZ = 0;
+            glm::vec3 boundsMin = glm::vec3(0);
+            glm::vec3 boundsMax = glm::vec3(0);
+            // -1 for children that do not exist (leaves cover a single chunk)
+            int children[4] = {-1, -1, -1, -1};
+        };
+
+        struct IndexBuffer {
+            unsigned int ib = 0;
+            int numIndices = 0;
+        };
+
+        // chunk width, chunk depth, vertex step, and the vertex step of the left, right, bottom and top edges
+        using IndexBufferKey = std::tuple<int, int, int, int, int, int, int>;
         struct Vertex {
             glm::vec3 position;
             glm::vec2 uv;
@@ -35,17 +108,35 @@ namespace Dream {
             void initVertex(const OpenGLBaseTerrain* pTerrain, int x, int z);
         };
 
-        void createGLState();
+        void destroy();
+
+        int buildNode(int minChunkX, int minChunkZ, int maxChunkX, int maxChunkZ);
+
+        void updateNodeBounds(int nodeIndex);
+
+        void collectVisibleChunks(int nodeIndex, const glm::vec4 *planes, int numPlanes, std::vector<int> &visibleChunks);
+
+        int selectLod(const Chunk &chunk, glm::vec3 lodOrigin, int lodBias) const;
+
+        const IndexBuffer &getIndexBuffer(const IndexBufferKey &key);
+
+        void createGLState(Chunk &chunk);
 
-        void populateBuffers(const OpenGLBaseTerrain* pTerrain);
-        void initVertices(const OpenGLBaseTerrain* pTerrain, std::vector<Vertex>& Vertices);
-        void initIndices(std::vector<unsigned int>& Indices);
+        void populateBuffers(const OpenGLBaseTerrain* pTerrain, Chunk &chunk);
+        void initVertices(const OpenGLBaseTerrain* pTerrain, const Chunk &chunk, int minZ, int maxZ, std::vector<Vertex>& Vertices);
+        void initIndices(const IndexBufferKey &key, std::vector<unsigned int>& Indices);
+        void updateHeightRange(const OpenGLBaseTerrain* pTerrain, Chunk &chunk);
 
         int m_width = 0;
         int m_depth = 0;
-        unsigned int m_vao = -1;
-        unsigned int m_vb = -1;
-        unsigned int m_ib = -1;
+        int m_numChunksX = 0;
+        int m_numChunksZ = 0;
+        float m_worldScale = 1.0f;
+        std::vector<Chunk> m_chunks;
+        std::vector<Node> m_nodes;
+        // level of detail of every chunk for the current render() call
+        std::vector<int> m_chunkLods;
+        std::map<IndexBufferKey, IndexBuffer> m_indexBuffers;
     };
 }
 
@@ -22,8 +22,28 @@
 namespace Dream {
     class Renderer {
     public:
+        /**
+         * Render a frame on the calling thread, same as calling prepare(), extract() and submit()
+         */
         virtual void render(int viewportWidth, int viewportHeight, bool fullscreen);
 
+        /**
+         * Create GPU resources for anything new in the scene, has to run on the thread that owns the graphics context
+         * while the scene is not being simulated
+         */
+        virtual void prepare();
+
+        /**
+         * Copy everything needed to draw the scene into a frame snapshot, does not call the graphics API
+         * so it can run on the simulation thread
+         */
+        virtual void extract(int viewportWidth, int viewportHeight, bool fullscreen);
+
+        /**
+         * Draw the most recently extracted frame snapshot, does not read the scene
+         */
+        virtual void submit();
+
         virtual unsigned int getOutputRenderTexture();
 
     protected:
@@ -5,13 +5,52 @@
 #ifndef DREAM_SKINNINGTECH_H
 #define DREAM_SKINNINGTECH_H
 
+#include <memory>
+#include <vector>
 #include "OpenGLShader.h"
 #include "dream/scene/Entity.h"
+#include "dream/renderer/FrameSnapshot.h"
 
 namespace Dream {
     class SkinningTech {
     public:
-        void setJointUniforms(Entity entity, OpenGLShader *shader);
+        SkinningTech();
+
+        ~SkinningTech();
+
+        // load the mesh bones and state machine of animated entities (must run on the main thread)
+        void loadAnimator(Entity entity);
+
+        // copy the current pose of an animated entity into the bone palettes of the frame, the range is left
+        // unchanged for other entities so meshes below an animator are skinned with its pose
+        void getJointMatrices(Entity entity, FrameSnapshot &frame, int &bonePaletteOffset, int &numBones);
+
+        void setJointUniforms(const FrameSnapshot &frame, const MeshDrawItem &drawItem, OpenGLShader *shader);
+
+        // whether meshes can be skinned once per frame (the project has the skinning shader)
+        bool canPreSkin();
+
+        // skin every mesh of the frame that has a skinned vertex buffer using transform feedback, so the shadow
+        // cascades and main pass draw the result like a static mesh instead of blending bones again
+        void skinMeshes(const FrameSnapshot &frame);
+
+        // vertex array to draw the mesh of the draw item with (pre-skinned vertices if it was skinned this frame)
+        unsigned int getVertexArray(const MeshDrawItem &drawItem);
+
+    private:
+        struct SkinnedVertexBuffer {
+            unsigned int vao = 0;
+            unsigned int vbo = 0;
+            int capacity = 0;
+            // mesh the vertex array sources uvs, bitangents and indices from
+            std::weak_ptr<OpenGLMesh> mesh;
+        };
+
+        void prepareSkinnedVertexBuffer(SkinnedVertexBuffer &buffer, const std::shared_ptr<OpenGLMesh> &mesh);
+
+        OpenGLShader *skinningShader = nullptr;
+        // indexed by MeshDrawItem::skinnedVertexBuffer, draw order is stable so buffers rarely change meshes
+        std::vector<SkinnedVertexBuffer> skinnedVertexBuffers;
     };
 }
 
@@ -0,0 +1,93 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_VERTEXANIMATIONTECH_H
+#define DREAM_VERTEXANIMATIONTECH_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "dream/renderer/OpenGLShader.h"
+#include "dream/renderer/LightingTech.h"
+#include "dream/scene/Entity.h"
+#include "dream/renderer/FrameSnapshot.h"
+
+namespace Dream {
+    /**
+     * Draws crowds of entities from clips baked into vertex animation textures, with one instanced draw call per
+     * submesh of each baked model and no skeleton on the CPU
+     */
+    class VertexAnimationTech {
+    public:
+        enum ShaderType {
+            LIT, SINGLE_TEXTURE, DEPTH
+        };
+
+        VertexAnimationTech();
+
+        ~VertexAnimationTech();
+
+        // load the baked clips of entities with a vertex animation (must run on the main thread)
+        void loadVertexAnimation(Entity entity);
+
+        // add the entity to the batch of its baked clips if it is drawn from them this frame
+        // @return whether it was added, the meshes below it are then not extracted
+        bool getInstance(Entity entity, FrameSnapshot &frame, LightingTech *lightingTech);
+
+        // whether the project has the vertex animation shader
+        bool canDraw();
+
+        // upload the instances of every batch and the textures of newly baked clips
+        void prepareBatches(const FrameSnapshot &frame);
+
+        OpenGLShader *getShader(ShaderType type);
+
+        // draw every instance of a submesh of a batch, camera and material uniforms must already be set
+        void drawInstances(const FrameSnapshot &frame, int batch, int subMesh, OpenGLShader *shader);
+
+    private:
+        struct VertexAnimationTextures {
+            // keeps the baked clips alive as long as their textures
+            std::shared_ptr<const VertexAnimationTexture> vertexAnimation;
+            unsigned int positions = 0;
+            unsigned int normals = 0;
+            int framesSinceUse = 0;
+        };
+
+        struct InstanceBuffer {
+            unsigned int vbo = 0;
+            int capacity = 0;
+            // vertex array of each submesh, sourcing uvs / tangents / indices from the mesh and the rest per instance
+            std::vector<unsigned int> vaos;
+            std::vector<std::weak_ptr<OpenGLMesh>> meshes;
+        };
+
+        void prepareVertexArray(InstanceBuffer &buffer, int subMesh, const std::shared_ptr<OpenGLMesh> &mesh);
+
+        OpenGLShader *shaders[3] = {nullptr, nullptr, nullptr};
+        std::map<const VertexAnimationTexture *, VertexAnimationTextures> textures;
+        // indexed by batch, batches are usually found in the same order every frame
+        std::vector<InstanceBuffer> instanceBuffers;
+        // textures of baked clips no instance used for this many frames are freed
+        inline static int maxUnusedFrames = 60;
+        inline static int positionTextureUnit = 14;
+        inline static int normalTextureUnit = 15;
+    };
+}
+
+#endif //DREAM_VERTEXANIMATIONTECH_H
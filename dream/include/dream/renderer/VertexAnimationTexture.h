@@ -0,0 +1,147 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_VERTEXANIMATIONTEXTURE_H
+#define DREAM_VERTEXANIMATIONTEXTURE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "dream/renderer/AnimationClip.h"
+#include "dream/renderer/AnimationSkeleton.h"
+#include "dream/renderer/Mesh.h"
+
+namespace Dream {
+    /**
+     * Clips of a rigged model baked into the skinned position and normal of every vertex at a fixed frame rate, so
+     * the model can be drawn animated without a skeleton. Frames of every clip are stored one after another with the
+     * vertices of all submeshes in each frame, and the texels wrap into rows of textureWidth so large models still
+     * fit into a texture.
+     */
+    class VertexAnimationTexture {
+    public:
+        struct SubMesh {
+            std::string fileId;
+            int firstVertex = 0;
+            int numVertices = 0;
+        };
+
+        struct Clip {
+            std::string name;
+            // guid of the animation file the clip was baked from
+            std::string guid;
+            int firstFrame = 0;
+            int numFrames = 0;
+            // in seconds
+            float duration = 0;
+        };
+
+        /**
+         * Submesh of the model to bake
+         */
+        struct SourceMesh {
+            std::string fileId;
+            std::vector<Vertex> vertices;
+        };
+
+        /**
+         * Clip to bake
+         */
+        struct SourceClip {
+            std::string guid;
+            std::shared_ptr<const AnimationClip> clip;
+        };
+
+        /**
+         * Skin the meshes with every clip, sampled at the frame rate (the last frame of a clip is at its end)
+         * @param numBones size of the bone palette the bone ids of the vertices index into
+         */
+        static VertexAnimationTexture *bake(const AnimationSkeleton &skeleton, int numBones, const std::vector<SourceMesh> &meshes,
+                                            const std::vector<SourceClip> &clips, float framesPerSecond = 30.0f);
+
+        /**
+         * @return nullptr if the file does not exist or is not a vertex animation file
+         */
+        static VertexAnimationTexture *load(const std::string &path);
+
+        bool save(const std::string &path) const;
+
+        float getFramesPerSecond() const;
+
+        int getNumVertices() const;
+
+        int getNumFrames() const;
+
+        const std::vector<SubMesh> &getSubMeshes() const;
+
+        /**
+         * @return index of the submesh baked from this mesh, -1 if there is none
+         */
+        int findSubMesh(const std::string &fileId) const;
+
+        int getNumClips() const;
+
+        const Clip &getClip(int clip) const;
+
+        /**
+         * @return index of the clip baked from this animation file, -1 if there is none
+         */
+        int findClip(const std::string &guid) const;
+
+        /**
+         * Frames to interpolate between for a playback time, time loops over the duration of the clip
+         * @return the two frames (indices into all frames of the texture) and the amount of the second frame
+         */
+        glm::vec3 getFrameBlend(int clip, float time) const;
+
+        int getTextureWidth() const;
+
+        int getTextureHeight() const;
+
+        /**
+         * @return textureWidth * textureHeight texels, xyz of the position (w is 1) / normal (w is 0) of each vertex
+         * in each frame
+         */
+        const std::vector<glm::vec4> &getPositions() const;
+
+        const std::vector<glm::vec4> &getNormals() const;
+
+        inline static const int textureWidth = 2048;
+
+    private:
+        VertexAnimationTexture() = default;
+
+        void allocate(int numFrames);
+
+        float framesPerSecond = 30.0f;
+        int numVertices = 0;
+        int numFrames = 0;
+        int textureHeight = 0;
+        std::vector<SubMesh> subMeshes;
+        std::vector<Clip> clips;
+        std::vector<glm::vec4> positions;
+        std::vector<glm::vec4> normals;
+
+        inline static const char magic[4] = {'D', 'V', 'A', 'T'};
+        inline static const uint32_t version = 1;
+    };
+}
+
+#endif //DREAM_VERTEXANIMATIONTEXTURE_H
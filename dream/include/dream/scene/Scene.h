@@ -70,6 +70,8 @@ namespace Dream {
 
         PhysicsComponentSystem* getPhysicsComponentSystem();
 
+        TerrainComponentSystem* getTerrainComponentSystem();
+
     private:
         entt::registry entityRegistry;
 
@@ -27,10 +27,19 @@
 #include "dream/scene/Entity.h"
 #include "dream/renderer/Mesh.h"
 #include "dream/renderer/Texture.h"
+#include "dream/renderer/AnimationClip.h"
 #include "dream/renderer/AnimationData.h"
+#include "dream/renderer/AnimationPose.h"
+#include "dream/renderer/AnimationSkeleton.h"
+#include "dream/renderer/AnimatorController.h"
 #include "dream/renderer/AssimpNodeData.h"
 #include "dream/renderer/Camera.h"
 #include "dream/renderer/OpenGLBaseTerrain.h"
+#include "dream/renderer/VertexAnimationTexture.h"
+
+namespace Dream {
+    class TerrainHeightfieldShape;
+}
 
 namespace Dream::Component {
     struct Component {
@@ -114,6 +123,12 @@ namespace Dream::Component {
 
         glm::mat4 getTransform(Entity &curEntity);
 
+        /**
+         * Same as getTransform() but rigid bodies (and their children) are placed between their last two physics steps
+         * @param alpha 0 is the previous step, 1 the latest
+         */
+        glm::mat4 getInterpolatedTransform(Entity &curEntity, float alpha);
+
         glm::vec3 getFront();
 
         glm::vec3 getLeft();
@@ -141,8 +156,8 @@ namespace Dream::Component {
         std::string guid;
         inline static std::string k_fileId = "fileId";
         std::string fileId;
-        // runtime for bone info map
-        std::map<std::string, BoneInfo> m_BoneInfoMap;
+        // runtime for bone info map (shared by every instance of the model)
+        std::shared_ptr<const std::map<std::string, BoneInfo>> m_BoneInfoMap;
         int m_BoneCount = 0;
         // cache mesh in memory for quick usage during runtime
         bool needsToLoadBones = true;
@@ -249,28 +264,22 @@ namespace Dream::Component {
     };
 
     struct AnimatorComponent : public Component {
-        struct State {
-            std::string Guid = "";
-            bool PlayOnce = true;
-            std::string Name = "";
-        };
-        struct Condition {
-            int Variable1Idx = -1;
-            int Variable1 = 0;
-            std::string Operator = "==";
-            int Variable2Idx = -1;
-            int Variable2 = 0;
-        };
-        struct Transition {
-            int InputStateID;
-            int OutputStateID;
-            std::vector<Condition> Conditions;
-            bool Blend;
+        // contents of the animator file, compiled into an AnimatorController when loaded
+        using State = AnimatorController::Description::State;
+        using Condition = AnimatorController::Description::Condition;
+        using Transition = AnimatorController::Description::Transition;
+        using Variable = AnimatorController::Description::Variable;
+        struct BoneTransform {
+            int joint;
+            glm::vec3 translation;
+            glm::quat rotation;
+            glm::vec3 scale;
         };
         inline static std::string componentName = "AnimatorComponent";
         inline static std::string k_guid = "guid";          // guid of the animator file
         std::string guid;
-        std::map<std::string, void *> animationObjects;      // each model file could have multiple animations
+        std::shared_ptr<const AnimationSkeleton> skeleton;
+        std::vector<std::shared_ptr<const AnimationClip>> clips;  // compiled animation of each controller motion (shared)
         std::vector<glm::mat4> m_FinalBoneMatrices;
 //        void *m_CurrentAnimation = nullptr;
         float m_CurrentTime = 0;
@@ -282,38 +291,92 @@ namespace Dream::Component {
         // state machine variables
         int currentState, nextState;
         inline static std::string k_states = "States";
-        std::vector<State> states;
         inline static std::string k_transitions = "Transitions";
         inline static std::string k_transition_InputStateID = "To";
         inline static std::string k_transition_OutputStateID = "From";
         inline static std::string k_transition_Conditions = "Conditions";
-        std::vector<Transition> transitions;
         inline static std::string k_variables = "Variables";
         inline static std::string k_variable_name = "Name";
+        inline static std::string k_variable_type = "Type";
         inline static std::string k_variable_value = "Value";
-        std::vector<std::string> variableNames;
-        std::vector<int> variableValues;
+        inline static std::string k_layers = "Layers";
+        std::shared_ptr<const AnimatorController> controller;    // compiled state machine (shared)
+        std::vector<float> variableValues;                       // indexed by AnimatorController parameter
+        // normalized time (0 to 1) of the state blended from and the current state, they advance at the same rate
         float currentTimeLayered = 0.0f;
         float currentTimeBase = 0.0f;
+        std::vector<float> layerTimes;                       // normalized time of each layer
+        // sized when the state machine is loaded so evaluating does not allocate, temporary poses come from the
+        // AnimationPosePool of the thread evaluating the animator
+        std::vector<AnimationClip::Cursor> cursors;          // indexed by controller motion
+        std::vector<float> motionWeights;                    // blend tree weights, indexed by controller motion
+        std::vector<std::vector<float>> layerMasks;          // weight of each joint for each layer (empty if unmasked)
+        std::vector<AnimationPose> additiveReferencePoses;   // first frame of each additive layer
+        std::vector<bool> jointIsAnimated;                   // whether any motion has keyframes for the joint
+        AnimationPose evaluatedPose;                         // pose of the last evaluation
+        std::vector<glm::mat4> jointTransforms;              // model space transform of each joint
+        std::vector<Entity> jointEntities;                   // bone entity driven by each joint (if any)
+        std::vector<BoneTransform> pendingBoneTransforms;    // local transforms waiting to be written to bone entities
+        // level of detail, set by AnimatorComponentSystem before every update
+        bool isVisible = true;                               // otherwise only time advances (drawn from a vertex animation)
+        int updateInterval = 1;                              // frames between evaluating the pose
+        bool evaluatePose = true;                            // otherwise this frame interpolates between evaluated poses
+        int framesSinceEvaluation = -1;                      // -1 when there is no evaluated pose to interpolate from
+        AnimationPose previousPose;                          // pose of the evaluation before the last
+        glm::vec3 boundsCenter = glm::vec3(0.0f);            // model space sphere around the joints of the last pose
+        float boundsRadius = 0.0f;
+        // bone entities are only written when something reads them (attachments, scripts) or in the editor
+        std::vector<bool> jointHasReaders;
+        bool writeAllBoneTransforms = true;
+        int framesUntilReaderCheck = 0;
         std::string getCurrentStateName();
 
         explicit AnimatorComponent();
 
-        ~AnimatorComponent();
-
         AnimatorComponent(std::string animatorGUID);
 
 //        void calculateBoneTransform(const AssimpNodeData *node, glm::mat4 parentTransform, int depth = 0);
 
-        void blendTwoAnimations(void *pBaseAnimationV, void *pLayeredAnimationV, float blendFactor, float deltaTime);
+        /**
+         * Advance the time of the states being blended and the layers, and pose the skeleton
+         */
+        void blendTwoAnimations(int baseState, int layeredState, float blendFactor, float deltaTime);
+
+        /**
+         * Sample both states at their current times, blend them and apply the layers on top into the evaluated pose
+         */
+        void calculateBlendedPose(int baseState, int layeredState, float blendFactor);
 
-        void calculateBlendedBoneTransform(
-                void *pAnimationBaseV, const AssimpNodeData *node,
-                void *pAnimationLayerV, const AssimpNodeData *nodeLayered,
-                const float currentTimeBase, const float currentTimeLayered,
-                const glm::mat4 &parentTransform,
-                const float blendFactor,
-                int depth = 0);
+        /**
+         * Sample the motions of a blend tree (using the weights from the last computeMotionWeights()) into a pose
+         * @param time normalized time of the tree
+         */
+        void sampleMotions(const AnimatorController::BlendTree &tree, float time, AnimationPose &pose);
+
+        /**
+         * Compute the weights of the motions of a blend tree
+         * @return duration of the tree in seconds for these weights
+         */
+        float computeMotionWeights(const AnimatorController::BlendTree &tree);
+
+        /**
+         * Compute the model space transform of every joint from a local pose and write the final bone matrices.
+         * Only touches data of this component, so animators can be posed in parallel; bone entity transforms are
+         * queued for writeBoneTransforms()
+         */
+        void calculateBoneTransforms(const glm::vec3 *translations, const glm::quat *rotations);
+
+        /**
+         * Find the joints whose bone entity has an attachment (child that is not a bone), a script or was handed to
+         * a script on any entity, along with their ancestors since the local transforms of those are needed too
+         */
+        void findBoneReaders();
+
+        /**
+         * Copy the transforms queued by the last pose evaluation to the bone entities (must run on the thread
+         * that updates the scene)
+         */
+        void writeBoneTransforms();
 
         void updateAnimation(float dt);
 
@@ -321,12 +384,48 @@ namespace Dream::Component {
 
         void loadStateMachine(Entity modelEntity);
 
+        /**
+         * Get an animation compiled against the skeleton of the model (compiling it if no animator has yet)
+         */
+        static std::shared_ptr<const AnimationClip> loadAnimationClip(const std::string &animationGuid, Entity modelEntity);
+
+        /**
+         * Get the compiled state machine of the animator file (compiling it if no animator has yet) and reset the
+         * variables to their defaults if it changed
+         */
+        void loadController();
+
+        /**
+         * Read the states, transitions and variables of an animator file
+         */
+        static AnimatorController::Description loadAnimatorFile(const std::string &filePath);
+
+        static void saveAnimatorFile(const std::string &filePath, const AnimatorController::Description &description);
+
         void loadBoneEntities(Entity entity);
 
 //        void playAnimation(int stateID);
 
         int setVariable(const std::string &variableName, int value);
 
+        /**
+         * @return handle used to get and set a variable without looking up its name, -1 if there is none
+         */
+        int findVariable(const std::string &variableName);
+
+        void setInt(int variable, int value);
+
+        void setFloat(int variable, float value);
+
+        void setBool(int variable, bool value);
+
+        /**
+         * Set a trigger variable, it stays set until a transition reading it is taken
+         */
+        void setTrigger(int variable);
+
+        float getVariable(int variable);
+
 //        std::vector<glm::mat4> computeFinalBoneMatrices(Entity armatureEntity, std::vector<Entity> bones);
 
         static void deserialize(YAML::Node node, Entity &entity);
@@ -334,10 +433,51 @@ namespace Dream::Component {
         static void serialize(YAML::Emitter &out, Entity &entity);
     };
 
+    struct VertexAnimationComponent : public Component {
+        inline static std::string componentName = "VertexAnimationComponent";
+        inline static std::string k_guid = "guid";                      // guid of the baked vertex animation file
+        std::string guid;
+        inline static std::string k_clip = "clip";
+        int clip = 0;                                                  // clip played when there is no animator to follow
+        inline static std::string k_timeOffset = "timeOffset";
+        float timeOffset = 0.0f;                                       // in seconds, so a crowd does not move in step
+        inline static std::string k_speed = "speed";
+        float speed = 1.0f;
+        inline static std::string k_switchDistance = "switchDistance";
+        float switchDistance = 30.0f;                                  // an animator on the entity is used closer than this
+        std::shared_ptr<const VertexAnimationTexture> vertexAnimation; // baked clips (shared)
+        bool needsToLoad = true;
+        float time = 0.0f;
+        // set by AnimatorComponentSystem before every render
+        bool isActive = false;                                         // drawn from the baked clips instead of skinned
+        int activeClip = 0;
+        float activeTime = 0.0f;                                       // in seconds
+
+        explicit VertexAnimationComponent(std::string guid = "");
+
+        /**
+         * Get the baked clips of the vertex animation file (loading it if no instance has yet)
+         */
+        void loadVertexAnimation();
+
+        /**
+         * Advance playback, an animator on the same entity picks the clip and time so switching between the two
+         * does not pop
+         * @param animator animator of the entity (nullptr if there is none)
+         */
+        void update(float dt, const AnimatorComponent *animator);
+
+        static void deserialize(YAML::Node node, Entity &entity);
+
+        static void serialize(YAML::Emitter &out, Entity &entity);
+    };
+
     struct BoneComponent : public Component {
         inline static std::string componentName = "BoneComponent";
         inline static std::string k_boneID = "boneID";
         int boneID;
+        // a script got this entity (ex: by tag), so its animator writes the bone transform while playing
+        bool readByScript = false;
 
         explicit BoneComponent(int boneID);
 
@@ -373,7 +513,11 @@ namespace Dream::Component {
 
         void updateCameraVectors();
 
-        void updateRendererCamera(Camera &camera, Entity &sceneCameraEntity);
+        /**
+         * @param interpolationAlpha the camera (or a rigid body it is attached to) is placed between the last two
+         * physics steps like the meshes it looks at
+         */
+        void updateRendererCamera(Camera &camera, Entity &sceneCameraEntity, float interpolationAlpha = 1.0f);
 
         void lookAt(Entity sceneCamera, glm::vec3 lookAtPos);
     };
@@ -456,11 +600,8 @@ namespace Dream::Component {
         // runtime created collider shape
         int colliderShapeIndex = -1;
 
-        // runtime height map
-        float *heightMapData = nullptr;
-//        Array2D<float> heightMapData;
-//        std::vector<std::vector<float>> heightMapData;
-//        float heightMapData[257][257];
+        // runtime height map collider, references the height map of the terrain component
+        TerrainHeightfieldShape *heightfieldShape = nullptr;
 
         CollisionComponent();
 
@@ -468,6 +609,11 @@ namespace Dream::Component {
 
         void updateColliderShape(Entity &entity);
 
+        /**
+         * Grow the bounds of the height map collider when sculpting extends the height range of the terrain
+         */
+        void updateHeightfieldBounds(Entity &entity);
+
         static void deserialize(YAML::Node node, Entity &entity);
 
         static void serialize(YAML::Emitter &out, Entity &entity);
@@ -503,9 +649,15 @@ namespace Dream::Component {
         // setting to 1 means a moving body will never come to a stop (unless colliding with other bodies with restitutions below 1, or unless a stop is scripted)
         inline static std::string k_restitution = "restitution";
         float restitution = 0.5f;
+        // trigger bodies report overlaps to scripts (onTriggerEnter, ...) but do not collide with other bodies
+        inline static std::string k_isTrigger = "isTrigger";
+        bool isTrigger = false;
 
         // runtime created rigid body
         int rigidBodyIndex = -1;
+        // transform before the last physics step that moved the body, the renderer interpolates from it
+        glm::vec3 previousTranslation = {0, 0, 0};
+        glm::quat previousRotation = {1, 0, 0, 0};
 
         bool shouldBeAddedToWorld = true;
 
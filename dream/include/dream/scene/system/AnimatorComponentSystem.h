@@ -19,12 +19,48 @@
 #ifndef DREAM_ANIMATORCOMPONENTSYSTEM_H
 #define DREAM_ANIMATORCOMPONENTSYSTEM_H
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Dream::Component {
+    struct AnimatorComponent;
+    struct VertexAnimationComponent;
+}
+
 namespace Dream {
     class AnimatorComponentSystem {
     public:
         void init();
 
+        /**
+         * Evaluate the poses of all animators in parallel, then write bone transforms to the scene on this thread.
+         * Entities with a baked vertex animation far from the camera skip posing and are drawn from it instead
+         */
         void update(float dt);
+
+    private:
+        /**
+         * Pick how often the animator is evaluated from how big it is on screen (the least often when offscreen)
+         */
+        void updateLevelOfDetail(Component::AnimatorComponent &animator, const glm::mat4 &model, uint32_t phase);
+
+        std::vector<Component::AnimatorComponent *> animators;
+        // animator of each vertex animation instance (nullptr if it has none)
+        std::vector<std::pair<Component::VertexAnimationComponent *, Component::AnimatorComponent *>> vertexAnimations;
+        int frame = 0;
+        bool levelOfDetail = false;
+        // view of the camera the scene is rendered from this update
+        bool hasView = false;
+        glm::vec4 frustumPlanes[6];
+        glm::vec3 viewPosition;
+        float tanHalfFov = 1.0f;
+        // animators covering less than each fraction of the screen height update at the next interval
+        inline static float lodScreenSizes[] = {0.3f, 0.12f, 0.05f};
+        inline static int lodUpdateIntervals[] = {1, 2, 4, 8};
+        // frames between checking which bone entities have attachments or scripts
+        inline static int readerCheckInterval = 30;
     };
 }
 
@@ -20,7 +20,11 @@
 #define DREAM_LUASCRIPTCOMPONENTSYSTEM_H
 
 #include <sol/sol.hpp>
+#include <array>
+#include <filesystem>
 #include <set>
+#include <unordered_map>
+#include "dream/scene/system/PhysicsContactTracker.h"
 
 namespace Dream {
     class LuaScriptComponentSystem {
@@ -35,8 +39,65 @@ namespace Dream {
 
         inline static std::set<std::string> errorPrintedForScript = {};
         inline static std::set<std::string> modifiedScripts = {};
+        /**
+         * Folder of the precompiled bytecode of scripts, one file per script asset. Bytecode depends on the lua build,
+         * so the folder is generated, safe to delete and ignored by version control
+         */
+        static std::filesystem::path getBytecodeCachePath();
     private:
+        // script compiled once into its own environment, shared by every entity using the script
+        struct CompiledScript {
+            std::string scriptPath;
+            std::filesystem::file_time_type lastWriteTime;
+            // update of the last change detection, so the file is checked once per update instead of once per entity
+            int lastCheckedUpdate = -1;
+            bool valid = false;
+            // log once the script runs without errors after it was edited
+            bool reportNextSuccess = false;
+            sol::environment environment;
+            sol::protected_function updateFunction;
+            // invalid if the script does not define the handler
+            std::array<sol::protected_function, 6> contactHandlers;
+        };
+
+        /**
+         * Get the compiled script for a script asset, compiling it only if it is new or was modified since
+         * it was last compiled (saved from the editor or changed on disk)
+         * @return nullptr if the script has errors
+         */
+        CompiledScript *getCompiledScript(const std::string &scriptGuid, const std::string &scriptPath);
+
+        /**
+         * Load the chunk of a script from the bytecode cache if its source is unchanged, otherwise compile the
+         * source and write its bytecode to the cache
+         * @return invalid function if the script could not be read or has syntax errors
+         */
+        sol::protected_function loadScript(const std::string &scriptGuid, const std::string &scriptPath);
+
+        static std::string loadBytecode(const std::filesystem::path &path, const std::string &sourceHash);
+
+        static void saveBytecode(const std::filesystem::path &path, const std::string &sourceHash,
+                                 const sol::protected_function &chunk);
+
+        /**
+         * Call the contact handlers of scripts for the physics events queued since the last update
+         */
+        void dispatchContactEvents();
+
+        void dispatchContactEvent(const PhysicsContactEvent &event, entt::entity entityHandle,
+                                  entt::entity otherEntityHandle, glm::vec3 normal);
+
+        // handler of each contact event, indexed by (trigger ? 3 : 0) + phase
+        inline static const std::array<std::string, 6> contactHandlerNames = {
+                "onCollisionEnter", "onCollisionStay", "onCollisionExit",
+                "onTriggerEnter", "onTriggerStay", "onTriggerExit"
+        };
         sol::state lua;
+        // declared after the lua state so the references are released before the state is closed
+        std::unordered_map<std::string, CompiledScript> compiledScripts;
+        int updateCount = 0;
+        inline static const char bytecodeMagic[4] = {'D', 'L', 'U', 'A'};
+        inline static const uint32_t bytecodeVersion = 1;
     };
 }
 
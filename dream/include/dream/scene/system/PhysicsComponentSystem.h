@@ -24,8 +24,13 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include "dream/renderer/OpenGLPhysicsDebugDrawer.h"
+#include "dream/scene/system/PhysicsContactTracker.h"
+#include "dream/scene/system/PhysicsMotionState.h"
+#include "dream/scene/system/PhysicsQueryBatch.h"
 
 namespace Dream {
+    class PhysicsShapeCache;
+
     class PhysicsComponentSystem {
     public:
         PhysicsComponentSystem();
@@ -34,18 +39,81 @@ namespace Dream {
 
         void init();
 
+        /**
+         * Step the world and write the transforms of bodies that moved back to their entities (while playing), or move
+         * bodies whose entity was moved (while editing)
+         */
         void update(float dt);
 
+        /**
+         * Step the world by dt and write the transforms of bodies that moved back to their entities, this is what
+         * update() does while playing
+         */
+        void step(float dt);
+
+        /**
+         * @return whether the world splits its step across the thread pool (Config::PhysicsConfig::multithreaded
+         * when the system was created)
+         */
+        bool isMultithreaded();
+
+        /**
+         * Motion state for a new rigid body of the entity, owned by the rigid body once it is constructed
+         */
+        btMotionState *createMotionState(entt::entity entityHandle, const btTransform &transform);
+
+        /**
+         * Report a transform that was set on a body outside the simulation (ex: a script moving a kinematic body), so it
+         * is written back to the entity after the next step
+         */
+        void setRigidBodyTransform(int index, const btTransform &transform);
+
+        /**
+         * @param alpha how far the simulation time is between the last two steps (0 to 1), used to interpolate rigid bodies
+         */
+        void setInterpolationAlpha(float alpha);
+
+        float getInterpolationAlpha();
+
         bool checkRaycast(glm::vec3 rayFromWorld, glm::vec3 rayToWorld);
 
+        /**
+         * @return closest hit point of the ray, or (0, 0, 0) if nothing was hit
+         */
         glm::vec3 raycastGetFirstHit(glm::vec3 rayFromWorld, glm::vec3 rayToWorld);
 
-        void debugDrawWorld();
+        /**
+         * Run every query of the batch and write the closest hit of each to its result, raycasts and sweeps are split
+         * across the thread pool when bullet is thread safe while overlaps run on this thread after them. Must not be
+         * called while the world is stepping.
+         */
+        void query(PhysicsQueryBatch &batch);
+
+        /**
+         * Report the contacts of a body as events (ex: the script of its entity handles collisions or triggers), only
+         * pairs where at least one body reports contacts are tracked
+         */
+        void setContactEventsEnabled(int rigidBodyIndex, bool enabled);
+
+        /**
+         * Enter, stay and exit events of every step since the events were last cleared
+         */
+        const std::vector<PhysicsContactEvent> &getContactEvents();
+
+        void clearContactEvents();
+
+        // append debug lines of the world (pairs of end points) so they can be drawn later by the renderer
+        void getDebugLines(std::vector<glm::vec3> &points);
 
         int addColliderShape(btCompoundShape* colliderShape);
 
         btCompoundShape* getColliderShape(int index);
 
+        /**
+         * Shared child shapes of the collider compound shapes
+         */
+        PhysicsShapeCache *getShapeCache();
+
         int addRigidBody(btRigidBody* rigidBody);
 
         btRigidBody* getRigidBody(int index);
@@ -55,14 +123,43 @@ namespace Dream {
         void deleteCollisionShape(int index);
 
     private:
+        /**
+         * Create and add to the world the rigid bodies of entities that do not have one yet
+         */
+        void createRigidBodies();
+
+        void runQuery(const PhysicsQuery &query, PhysicsQueryHit &hit);
+
+        /**
+         * Walk the contact manifolds of the last step and hand the touching pairs to the contact tracker
+         */
+        void collectContacts();
+
+        /**
+         * @return entity that owns the collision object, or entt::null if it is not a rigid body of an entity
+         */
+        static entt::entity getEntityHandle(const btCollisionObject *collisionObject);
+
         btDefaultCollisionConfiguration *collisionConfiguration;
         btCollisionDispatcher *dispatcher;
         btBroadphaseInterface *overlappingPairCache;
-        btSequentialImpulseConstraintSolver *solver;
+        btConstraintSolver *solver;
+        // one solver per thread (multithreaded world only)
+        btConstraintSolver *solverPool = nullptr;
         btDiscreteDynamicsWorld *dynamicsWorld;
+        bool multithreaded = false;
         OpenGLPhysicsDebugDrawer openGlPhysicsDebugDrawer;
         std::vector<btCompoundShape*> colliderShapes;
+        PhysicsShapeCache *shapeCache;
         std::vector<btRigidBody*> rigidBodies;
+        // motion states whose body moved during the current step
+        std::vector<PhysicsMotionState *> changedMotionStates;
+        // entities moved by the previous step, their previous transform catches up once they stop
+        std::vector<entt::entity> movedEntities;
+        float interpolationAlpha = 1.0f;
+        PhysicsContactTracker contactTracker;
+        // user index 2 of bodies that report contacts (bullet defaults it to -1)
+        inline static const int contactEventsUserIndex = 1;
     };
 }
 
@@ -0,0 +1,84 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_PHYSICSCONTACTTRACKER_H
+#define DREAM_PHYSICSCONTACTTRACKER_H
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+namespace Dream {
+    struct PhysicsContactEvent {
+        enum Phase {
+            ENTER, STAY, EXIT
+        };
+        Phase phase = ENTER;
+        // whether either body is a trigger (it reports overlaps but does not collide)
+        bool trigger = false;
+        entt::entity entityA = entt::null;
+        entt::entity entityB = entt::null;
+        // deepest contact point, normal points from B towards A (exit events keep the last contact)
+        glm::vec3 point = {0, 0, 0};
+        glm::vec3 normal = {0, 0, 0};
+    };
+
+    /**
+     * Turns the pairs of entities touching after each physics step into a flat queue of enter, stay and exit events
+     * by comparing them with the pairs of the previous step. Events are queued until they are dispatched, so the
+     * events of every step run in a frame are kept in order.
+     */
+    class PhysicsContactTracker {
+    public:
+        /**
+         * Record a pair of entities touching in the current step, later reports of the same pair are ignored
+         */
+        void addContact(entt::entity entityA, entt::entity entityB, bool trigger, glm::vec3 point, glm::vec3 normal);
+
+        /**
+         * Queue events for the pairs reported since the last call and start the next step
+         */
+        void endStep();
+
+        /**
+         * Forget the pairs and queued events of an entity whose body is removed from the world
+         */
+        void removeEntity(entt::entity entityHandle);
+
+        const std::vector<PhysicsContactEvent> &getEvents();
+
+        /**
+         * Called once the events have been dispatched, keeps the allocated memory
+         */
+        void clearEvents();
+
+    private:
+        static uint64_t getPairKey(entt::entity entityA, entt::entity entityB);
+
+        // pairs touching in the current and previous step (phase is unused)
+        std::vector<PhysicsContactEvent> contacts;
+        std::vector<PhysicsContactEvent> previousContacts;
+        std::unordered_set<uint64_t> contactKeys;
+        std::unordered_set<uint64_t> previousContactKeys;
+        std::vector<PhysicsContactEvent> events;
+    };
+}
+
+#endif //DREAM_PHYSICSCONTACTTRACKER_H
@@ -0,0 +1,67 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_PHYSICSMOTIONSTATE_H
+#define DREAM_PHYSICSMOTIONSTATE_H
+
+#include <vector>
+#include <LinearMath/btMotionState.h>
+#include <LinearMath/btTransform.h>
+#include <entt/entt.hpp>
+
+namespace Dream {
+    /**
+     * Motion state of a rigid body. Bullet only reports transforms of active (awake, non static) bodies through it,
+     * and bodies that did not move are skipped, so after a step the changed list holds exactly the entities whose
+     * transform has to be written back to the scene.
+     */
+    class PhysicsMotionState : public btMotionState {
+    public:
+        /**
+         * @param changed list the motion state appends itself to (once) when its transform changes
+         */
+        PhysicsMotionState(const btTransform &transform, entt::entity entityHandle,
+                           std::vector<PhysicsMotionState *> *changed);
+
+        void getWorldTransform(btTransform &worldTrans) const override;
+
+        void setWorldTransform(const btTransform &worldTrans) override;
+
+        /**
+         * Move the body's transform without reporting it as changed (ex: the editor moved the entity)
+         */
+        void resetWorldTransform(const btTransform &worldTrans);
+
+        /**
+         * Called once the change has been written back to the scene
+         */
+        void clearChanged();
+
+        const btTransform &getTransform() const;
+
+        entt::entity getEntityHandle() const;
+
+    private:
+        btTransform transform;
+        entt::entity entityHandle;
+        std::vector<PhysicsMotionState *> *changed;
+        bool isChanged = false;
+    };
+}
+
+#endif //DREAM_PHYSICSMOTIONSTATE_H
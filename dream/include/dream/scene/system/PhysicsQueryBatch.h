@@ -0,0 +1,108 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_PHYSICSQUERYBATCH_H
+#define DREAM_PHYSICSQUERYBATCH_H
+
+#include <vector>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+namespace Dream {
+    struct PhysicsQuery {
+        enum QueryType {
+            RAYCAST, SPHERE_SWEEP, CAPSULE_SWEEP, SPHERE_OVERLAP
+        };
+        QueryType type = RAYCAST;
+        // start and end of the ray / sweep, overlaps only use from as the center
+        glm::vec3 from = {0, 0, 0};
+        glm::vec3 to = {0, 0, 0};
+        // (sweeps and overlaps only) radius of the sphere or capsule
+        float radius = 0;
+        // (capsule only) tip-to-tip height of the capsule, aligned with the Y axis
+        float height = 0;
+    };
+
+    struct PhysicsQueryHit {
+        bool hit = false;
+        entt::entity entityHandle = entt::null;
+        glm::vec3 point = {0, 0, 0};
+        glm::vec3 normal = {0, 0, 0};
+        // fraction of the way from the start to the end where the closest hit is (0 for overlaps)
+        float fraction = 1.0f;
+    };
+
+    /**
+     * Queries that are run against the physics world in one call, the closest hit of each query is written to the
+     * result at the same index. Clearing a batch keeps its memory so batches can be reused every tick without
+     * allocating.
+     */
+    class PhysicsQueryBatch {
+    public:
+        /**
+         * @param capacity number of queries to preallocate room for
+         */
+        explicit PhysicsQueryBatch(int capacity = 0);
+
+        /**
+         * Remove all queries and results, keeping the allocated memory
+         */
+        void clear();
+
+        /**
+         * @return index of the query and its result
+         */
+        int addRaycast(glm::vec3 from, glm::vec3 to);
+
+        int addSphereSweep(glm::vec3 from, glm::vec3 to, float radius);
+
+        int addCapsuleSweep(glm::vec3 from, glm::vec3 to, float radius, float height);
+
+        int addSphereOverlap(glm::vec3 center, float radius);
+
+        int size() const;
+
+        const std::vector<PhysicsQuery> &getQueries() const;
+
+        std::vector<PhysicsQueryHit> &getHits();
+
+        bool hasHit(int index) const;
+
+        entt::entity getHitEntityHandle(int index) const;
+
+        glm::vec3 getHitPoint(int index) const;
+
+        glm::vec3 getHitNormal(int index) const;
+
+        float getHitFraction(int index) const;
+
+    private:
+        int addQuery(const PhysicsQuery &query);
+
+        /**
+         * @return hit of the query, a miss if the index is out of range
+         */
+        const PhysicsQueryHit &getHit(int index) const;
+
+        std::vector<PhysicsQuery> queries;
+        std::vector<PhysicsQueryHit> hits;
+        inline static const PhysicsQueryHit missedHit = {};
+    };
+}
+
+#endif //DREAM_PHYSICSQUERYBATCH_H
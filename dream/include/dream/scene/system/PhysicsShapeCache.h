@@ -0,0 +1,102 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_PHYSICSSHAPECACHE_H
+#define DREAM_PHYSICSSHAPECACHE_H
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+#include "dream/scene/component/Component.h"
+
+namespace Dream {
+    /**
+     * Collision shapes shared by every collider with the same parameters. Shapes are immutable once created (colliders
+     * are positioned by their compound shape), so one shape can be a child of many compound shapes. Shapes are
+     * reference counted and freed when the last collider using them is released. BVHs of mesh colliders are serialized
+     * to a folder of the project (getBvhCachePath()), which is generated and safe to delete.
+     */
+    class PhysicsShapeCache {
+    public:
+        ~PhysicsShapeCache();
+
+        /**
+         * Get the shape for a collider, creating it the first time parameters are seen. Mesh colliders build a
+         * triangle mesh shape from every mesh of the model asset, reusing a previously serialized BVH when the
+         * triangles have not changed
+         * @return shape that must be given back with release(), nullptr if it could not be created
+         */
+        btCollisionShape *acquire(const Component::CollisionComponent::Collider &collider);
+
+        /**
+         * Give back a shape returned by acquire()
+         */
+        void release(btCollisionShape *shape);
+
+        int getNumShapes();
+
+        /**
+         * Folder of the serialized BVHs of mesh colliders, one file per model asset. They depend on the machine
+         * (memory layout), so the folder is ignored by version control
+         */
+        static std::filesystem::path getBvhCachePath();
+
+        /**
+         * Load the serialized BVH of a model if it was built from the same triangles
+         * @param bvhBuffer set to the buffer the BVH lives in, which must be freed with btAlignedFree()
+         * @return nullptr if there is no up-to-date BVH on disk
+         */
+        static btOptimizedBvh *loadBvh(const std::filesystem::path &path, const std::string &trianglesHash,
+                                       void *&bvhBuffer);
+
+        static void saveBvh(const std::filesystem::path &path, const std::string &trianglesHash, btOptimizedBvh *bvh);
+
+    private:
+        // triangles of a mesh collider, the shape references them so they live as long as the shape
+        struct MeshData {
+            std::vector<btScalar> positions;
+            std::vector<int> indices;
+            btTriangleIndexVertexArray *meshInterface = nullptr;
+            // buffer a serialized BVH was loaded in place from (nullptr if the BVH was built)
+            void *bvhBuffer = nullptr;
+        };
+
+        struct CachedShape {
+            btCollisionShape *shape = nullptr;
+            int references = 0;
+            MeshData *meshData = nullptr;
+        };
+
+        static std::string getKey(const Component::CollisionComponent::Collider &collider);
+
+        static btCollisionShape *createPrimitiveShape(const Component::CollisionComponent::Collider &collider);
+
+        btCollisionShape *createMeshShape(const std::string &assetGUID, MeshData *meshData);
+
+        static void destroy(CachedShape &cachedShape);
+
+        std::unordered_map<std::string, CachedShape> shapes;
+        std::unordered_map<btCollisionShape *, std::string> shapeKeys;
+        inline static const char bvhMagic[4] = {'D', 'B', 'V', 'H'};
+        inline static const uint32_t bvhVersion = 1;
+    };
+}
+
+#endif //DREAM_PHYSICSSHAPECACHE_H
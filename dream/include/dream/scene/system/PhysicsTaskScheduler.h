@@ -0,0 +1,58 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_PHYSICSTASKSCHEDULER_H
+#define DREAM_PHYSICSTASKSCHEDULER_H
+
+#ifdef BT_THREADSAFE
+
+#include <LinearMath/btThreads.h>
+
+namespace Dream {
+    /**
+     * Runs the parallel loops of bullet's multithreaded world on the engine's thread pool, so physics does not bring
+     * its own set of threads competing with animation and terrain jobs for the same cores
+     */
+    class PhysicsTaskScheduler : public btITaskScheduler {
+    public:
+        static PhysicsTaskScheduler &getInstance();
+
+        int getMaxNumThreads() const override;
+
+        /**
+         * Pool workers, the main thread and the simulation thread, since the world can be stepped from either
+         */
+        int getNumThreads() const override;
+
+        /**
+         * The thread pool has a fixed size, so this is ignored
+         */
+        void setNumThreads(int numThreads) override;
+
+        void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) override;
+
+        btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) override;
+
+    private:
+        PhysicsTaskScheduler();
+    };
+}
+
+#endif
+
+#endif //DREAM_PHYSICSTASKSCHEDULER_H
@@ -0,0 +1,69 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_TERRAINBRUSH_H
+#define DREAM_TERRAINBRUSH_H
+
+#include <optional>
+#include <vector>
+
+namespace Dream {
+    /**
+     * Sculpting brush for terrain height maps. The falloff kernel is computed once per radius and the rows it covers
+     * are split across the thread pool.
+     */
+    class TerrainBrush {
+    public:
+        enum Mode {
+            RAISE, LOWER, SMOOTH, FLATTEN
+        };
+
+        struct Region {
+            int minX, minZ, maxX, maxZ;
+        };
+
+        Mode mode = RAISE;
+        // radius in height map vertices
+        int radius = 4;
+        // height added / removed per second at the center of the brush (raise and lower)
+        float strength = 32.0f;
+        // fraction of the way to the target height moved per second at the center of the brush (smooth and flatten)
+        float blendRate = 4.0f;
+
+        /**
+         * Apply the brush to a square height map
+         * @param heights row-major heights (z * size + x)
+         * @param size number of vertices along each side of the height map
+         * @return inclusive region of the height map that was modified, empty if the brush is outside the height map
+         */
+        std::optional<Region> apply(float *heights, int size, int centerX, int centerZ, float dt);
+
+        /**
+         * @return weights of the brush (2 * radius + 1 squared, row-major), 1 at the center falling off to 0 at the radius
+         */
+        const std::vector<float> &getKernel();
+
+    private:
+        std::vector<float> kernel;
+        int kernelRadius = -1;
+        // copy of the region (with a one vertex border) read by the smooth brush
+        std::vector<float> snapshot;
+    };
+}
+
+#endif //DREAM_TERRAINBRUSH_H
@@ -19,12 +19,29 @@
 #ifndef DREAM_TERRAINCOMPONENTSYSTEM_H
 #define DREAM_TERRAINCOMPONENTSYSTEM_H
 
+#include "dream/scene/system/TerrainBrush.h"
+
 namespace Dream {
     class TerrainComponentSystem {
     public:
         void init();
 
         void update(float dt);
+
+        /**
+         * Load the terrain tiles that moving rigid bodies can reach before the next frame, so they never collide with
+         * the flat placeholder of a tile that has not been loaded (or is too far from the camera to be loaded).
+         * Must be called while nothing else is touching the scene.
+         */
+        void loadCollisionTiles();
+
+        /**
+         * Brush used to sculpt terrains while the scene camera is in terrain paint mode
+         */
+        TerrainBrush &getBrush();
+
+    private:
+        TerrainBrush brush;
     };
 }
 
@@ -0,0 +1,45 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_TERRAINHEIGHTFIELDSHAPE_H
+#define DREAM_TERRAINHEIGHTFIELDSHAPE_H
+
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+namespace Dream {
+    /**
+     * Heightfield collider that reads heights directly from the terrain's height map (no copy), so sculpted heights
+     * are picked up immediately. Only the vertical bounds need to be updated when the height range of the terrain grows.
+     */
+    class TerrainHeightfieldShape : public btHeightfieldTerrainShape {
+    public:
+        /**
+         * @param heightData row-major heights (width * length floats) that must outlive the shape
+         */
+        TerrainHeightfieldShape(int width, int length, const float *heightData, float minHeight, float maxHeight);
+
+        /**
+         * Grow the vertical bounds of the shape to include the height range. Bounds stay centered on the origin the
+         * shape was created with, so the collider does not move relative to its rigid body.
+         * @return whether the bounds changed
+         */
+        bool includeHeightRange(float minHeight, float maxHeight);
+    };
+}
+
+#endif //DREAM_TERRAINHEIGHTFIELDSHAPE_H
@@ -0,0 +1,81 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_HEIGHTMAPPYRAMID_H
+#define DREAM_HEIGHTMAPPYRAMID_H
+
+#include <optional>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Dream {
+    /**
+     * Min / max mip hierarchy over a square height map used for exact ray casts against the terrain surface. Level 0
+     * holds the height range of every cell (quad between four vertices) and every level above halves the resolution,
+     * so a ray cast only visits the cells whose ancestors the ray passes through.
+     */
+    class HeightMapPyramid {
+    public:
+        /**
+         * @param heights row-major heights (z * size + x) that must outlive the pyramid
+         * @param size number of vertices along each side of the height map
+         */
+        void build(const float *heights, int size);
+
+        /**
+         * Recompute the height ranges that depend on the vertices within the (inclusive) rectangle
+         */
+        void update(int minX, int minZ, int maxX, int maxZ);
+
+        /**
+         * Intersect a ray with the triangles of the height map (triangulated the same way the terrain is rendered)
+         * @param origin ray origin in height map coordinates (x and z in vertices, y is the height)
+         * @param direction ray direction in height map coordinates
+         * @return closest hit in height map coordinates
+         */
+        std::optional<glm::vec3> raycast(glm::vec3 origin, glm::vec3 direction) const;
+
+        int getNumLevels() const;
+
+        /**
+         * @return minimum and maximum height of a node (cell at level 0)
+         */
+        std::pair<float, float> getHeightRange(int level, int x, int z) const;
+
+    private:
+        struct Level {
+            int width = 0;
+            std::vector<float> minHeights;
+            std::vector<float> maxHeights;
+        };
+
+        void updateNode(int level, int x, int z);
+
+        void raycastNode(int level, int x, int z, glm::vec3 origin, glm::vec3 direction, glm::vec3 inverseDirection,
+                         float &closestT) const;
+
+        void raycastCell(int x, int z, glm::vec3 origin, glm::vec3 direction, float &closestT) const;
+
+        const float *heights = nullptr;
+        int size = 0;
+        std::vector<Level> levels;
+    };
+}
+
+#endif //DREAM_HEIGHTMAPPYRAMID_H
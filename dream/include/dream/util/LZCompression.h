@@ -0,0 +1,43 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_LZCOMPRESSION_H
+#define DREAM_LZCOMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Dream {
+    /**
+     * Byte oriented LZ77 compression in the style of an LZ4 block (literal runs followed by back references of at
+     * least four bytes), favouring decompression speed over compression ratio
+     */
+    class LZCompression {
+    public:
+        static std::vector<uint8_t> compress(const uint8_t *source, size_t sourceSize);
+
+        /**
+         * @param destinationSize exact size of the uncompressed data
+         * @return false if the compressed data is corrupt or does not decompress to exactly destinationSize bytes
+         */
+        static bool decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize);
+    };
+}
+
+#endif //DREAM_LZCOMPRESSION_H
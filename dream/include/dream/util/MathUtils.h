@@ -38,6 +38,12 @@ namespace Dream {
         static glm::quat quatSlerp(glm::quat q1, glm::quat q2, float blend);
         static glm::vec3 vec3Lerp(glm::vec3 x, glm::vec3 y, float t);
         static float distance(glm::vec3 p1, glm::vec3 p2);
+        /**
+         * Frustum planes (Gribb-Hartmann) in the space clipFromLocal transforms from, ordered left, right, bottom,
+         * top, near, far. Planes are not normalized and point inwards.
+         */
+        static void getFrustumPlanes(const glm::mat4 &clipFromLocal, glm::vec4 planes[6]);
+        static bool isSphereInFrustum(const glm::vec4 planes[6], glm::vec3 center, float radius);
     };
 }
 
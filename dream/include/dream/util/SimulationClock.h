@@ -0,0 +1,89 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_SIMULATIONCLOCK_H
+#define DREAM_SIMULATIONCLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace Dream {
+    /**
+     * Accumulates real time and hands it out as fixed simulation ticks. The number of ticks per frame is clamped so a
+     * slow frame cannot make the next one slower, and what is left in the accumulator is exposed as the interpolation
+     * alpha between the last two ticks.
+     */
+    class SimulationClock {
+    public:
+        /**
+         * @param tickRate fixed updates per second
+         * @param maxStepsPerFrame time beyond this many ticks in one frame is dropped (the simulation slows down instead)
+         */
+        explicit SimulationClock(int tickRate = 60, int maxStepsPerFrame = 5);
+
+        void setTickRate(int tickRate);
+
+        int getTickRate() const;
+
+        void setMaxStepsPerFrame(int maxStepsPerFrame);
+
+        /**
+         * Run exactly one tick per frame no matter how much real time passed, so replays and benchmarks see the same
+         * sequence of steps on every machine
+         */
+        void setDeterministic(bool deterministic);
+
+        bool isDeterministic() const;
+
+        /**
+         * Add the real time that passed since the last frame
+         * @return number of fixed ticks to run this frame
+         */
+        int advance(std::chrono::nanoseconds elapsed);
+
+        /**
+         * @return seconds per tick
+         */
+        double getFixedDeltaTime() const;
+
+        /**
+         * @return how far the simulation time is between the last tick and the next one (0 to 1)
+         */
+        float getAlpha() const;
+
+        /**
+         * @return ticks run since the clock was created
+         */
+        uint64_t getTick() const;
+
+        /**
+         * @return ticks that were dropped by the per frame clamp since the clock was created
+         */
+        uint64_t getDroppedTicks() const;
+
+    private:
+        std::chrono::nanoseconds step;
+        std::chrono::nanoseconds accumulator{0};
+        int maxStepsPerFrame;
+        bool deterministic = false;
+        uint64_t tick = 0;
+        uint64_t droppedTicks = 0;
+    };
+}
+
+#endif //DREAM_SIMULATIONCLOCK_H
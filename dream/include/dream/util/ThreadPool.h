@@ -0,0 +1,54 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_THREADPOOL_H
+#define DREAM_THREADPOOL_H
+
+#include <functional>
+#include <vector>
+#include "dream/util/WorkerThread.h"
+
+namespace Dream {
+    /**
+     * Fixed set of worker threads (one less than the number of cores) used to split loops across cores. Builds
+     * without thread support (web) and nested calls run the loop on the calling thread.
+     */
+    class ThreadPool {
+    public:
+        static ThreadPool &getInstance();
+
+        ~ThreadPool();
+
+        /**
+         * Split [begin, end) into contiguous ranges and run job(rangeBegin, rangeEnd) on each of them in parallel,
+         * returns once every range has finished
+         * @param minRangeSize ranges are never smaller than this so tiny loops do not pay for waking up workers
+         */
+        void parallelFor(int begin, int end, const std::function<void(int, int)> &job, int minRangeSize = 1);
+
+        int getNumThreads();
+
+    private:
+        ThreadPool();
+
+        std::vector<WorkerThread *> workers;
+        inline static thread_local bool insideParallelFor = false;
+    };
+}
+
+#endif //DREAM_THREADPOOL_H
@@ -0,0 +1,136 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_TILEDHEIGHTMAP_H
+#define DREAM_TILEDHEIGHTMAP_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dream/util/WorkerThread.h"
+
+namespace Dream {
+    /**
+     * Height map file split into square tiles. Each tile stores its height range and its heights quantized to 16 bits
+     * relative to that range, delta encoded and LZ compressed, so tiles can be read (on a background thread) and
+     * rewritten independently of each other.
+     */
+    class TiledHeightMap {
+    public:
+        struct Tile {
+            uint64_t offset = 0;
+            uint32_t compressedSize = 0;
+            // bytes reserved in the file, a rewritten tile that still fits is written in place
+            uint32_t capacity = 0;
+            float minHeight = 0;
+            float maxHeight = 0;
+        };
+
+        ~TiledHeightMap();
+
+        /**
+         * Read the header and tile directory of a tiled height map file
+         * @return false if the file does not exist or is not a tiled height map
+         */
+        bool open(const std::string &path);
+
+        /**
+         * Write a complete height map to a new tiled height map file
+         * @param heights row-major heights (z * size + x)
+         */
+        static bool write(const std::string &path, const float *heights, int size, int tileSize = 64);
+
+        /**
+         * Re-encode the given tiles of the opened file, leaving every other tile untouched
+         */
+        bool writeTiles(const float *heights, const std::vector<int> &tiles);
+
+        /**
+         * Decode a tile on the calling thread
+         * @param heights row-major heights of the whole height map that the tile is written into
+         */
+        bool readTile(int tile, float *heights);
+
+        /**
+         * Queue tiles to be decoded on the background thread, tiles earlier in the list are decoded first
+         */
+        void requestTiles(const std::vector<int> &tiles);
+
+        /**
+         * @return tiles finished by the background thread since the last call, with the heights of each tile
+         * (row-major, tile width wide)
+         */
+        std::vector<std::pair<int, std::vector<float>>> takeLoadedTiles();
+
+        bool isLoading();
+
+        const std::string &getPath();
+
+        int getSize();
+
+        int getTileSize();
+
+        int getNumTilesPerSide();
+
+        int getNumTiles();
+
+        Tile getTile(int tile);
+
+        /**
+         * @return first vertex (inclusive) and last vertex (exclusive) of a tile along x and z
+         */
+        void getTileBounds(int tile, int &minX, int &minZ, int &maxX, int &maxZ);
+
+    private:
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t size;
+            uint32_t tileSize;
+        };
+
+        static std::vector<uint8_t> encodeTile(const float *heights, int size, int minX, int minZ, int maxX, int maxZ,
+                                               float &minHeight, float &maxHeight);
+
+        bool decodeTile(int tile, std::vector<float> &tileHeights);
+
+        void loadRequestedTiles();
+
+        inline static const char magic[4] = {'D', 'R', 'H', 'M'};
+        inline static const uint32_t version = 1;
+
+        std::string path;
+        int size = 0;
+        int tileSize = 0;
+        int numTilesPerSide = 0;
+        std::vector<Tile> tiles;
+        // guards the tile directory and the file
+        std::mutex fileMutex;
+
+        WorkerThread *loader = nullptr;
+        std::mutex queueMutex;
+        std::deque<int> requestedTiles;
+        std::vector<std::pair<int, std::vector<float>>> loadedTiles;
+        bool loading = false;
+    };
+}
+
+#endif //DREAM_TILEDHEIGHTMAP_H
@@ -0,0 +1,78 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_TRIPLEBUFFER_H
+#define DREAM_TRIPLEBUFFER_H
+
+#include <atomic>
+
+namespace Dream {
+    /**
+     * Lock-free single producer / single consumer handoff. The producer fills the back buffer and publishes it,
+     * the consumer picks up the most recently published buffer. Neither side ever waits on the other and
+     * buffers are reused so their allocations carry over between frames.
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        /**
+         * Buffer owned by the producer, it holds stale data from an older publish and should be overwritten
+         */
+        T &getWriteBuffer() {
+            return buffers[backIndex];
+        }
+
+        /**
+         * Hand the write buffer over to the consumer
+         */
+        void publish() {
+            int previous = middle.exchange(backIndex | dirtyBit, std::memory_order_acq_rel);
+            backIndex = previous & indexMask;
+        }
+
+        /**
+         * Swap in the most recently published buffer if there is one
+         * @return true if the read buffer changed
+         */
+        bool update() {
+            if ((middle.load(std::memory_order_acquire) & dirtyBit) == 0) {
+                return false;
+            }
+            int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previous & indexMask;
+            return true;
+        }
+
+        /**
+         * Buffer owned by the consumer, it is not modified by the producer until the consumer calls update() again
+         */
+        const T &getReadBuffer() {
+            return buffers[frontIndex];
+        }
+
+    private:
+        inline static const int dirtyBit = 4;
+        inline static const int indexMask = 3;
+        T buffers[3];
+        int backIndex = 0;
+        std::atomic<int> middle{1};
+        int frontIndex = 2;
+    };
+}
+
+#endif //DREAM_TRIPLEBUFFER_H
@@ -0,0 +1,58 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_WORKERTHREAD_H
+#define DREAM_WORKERTHREAD_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Dream {
+    /**
+     * Long-lived thread that runs one job at a time, used to overlap work with the main thread
+     * without paying for thread creation every frame
+     */
+    class WorkerThread {
+    public:
+        ~WorkerThread();
+
+        /**
+         * Start a job on the worker, waits for the previous job if it is still running
+         */
+        void run(std::function<void()> job);
+
+        /**
+         * Block until the current job (if any) has finished
+         */
+        void wait();
+
+    private:
+        void loop();
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::function<void()> job;
+        bool busy = false;
+        bool stopping = false;
+    };
+}
+
+#endif //DREAM_WORKERTHREAD_H
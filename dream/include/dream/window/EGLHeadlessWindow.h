@@ -0,0 +1,52 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#ifndef DREAM_EGLHEADLESSWINDOW_H
+#define DREAM_EGLHEADLESSWINDOW_H
+
+#ifdef DREAM_EGL
+
+#include <EGL/egl.h>
+#include "dream/window/Window.h"
+
+namespace Dream {
+    /**
+     * OpenGL context without a window (ex: for benchmarks in CI), works with software rasterizers like llvmpipe
+     */
+    class EGLHeadlessWindow : public Window {
+    public:
+        EGLHeadlessWindow(int width, int height);
+
+        ~EGLHeadlessWindow();
+
+        void swapBuffers() override;
+
+        std::pair<int, int> getWindowDimensions() override;
+
+    private:
+        EGLDisplay display;
+        EGLSurface surface;
+        EGLContext context;
+        int width;
+        int height;
+    };
+}
+
+#endif
+
+#endif //DREAM_EGLHEADLESSWINDOW_H
@@ -19,6 +19,7 @@
 #include "dream/Application.h"
 
 #include "dream/renderer/OpenGLRenderer.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 #include "dream/editor/ImGuiSDL2OpenGLEditor.h"
 #include "dream/window/SDL2OpenGLWindow.h"
 #include "dream/util/Logger.h"
@@ -35,11 +36,14 @@ namespace Dream {
         this->renderer = new OpenGLRenderer();
         this->editor = new ImGuiSDL2OpenGLEditor(this->window);
         this->editor->setLogCollector(logCollector);
+        this->simulationThread = new WorkerThread();
 //        this->startTime = std::chrono::high_resolution_clock::now();
         this->currentTime = clock::now();
     }
 
     Application::~Application() {
+        // simulation thread might still be using the scene and renderer
+        delete this->simulationThread;
         delete this->logCollector;
         delete this->window;
         delete this->renderer;
@@ -47,44 +51,84 @@ namespace Dream {
     }
 
     void Application::update() {
-        auto deltaTime = clock::now() - currentTime;
-        this->currentTime = clock::now();
-        this->lag += std::chrono::duration_cast<std::chrono::nanoseconds>(deltaTime);
-        float dt = std::chrono::duration_cast<std::chrono::milliseconds>(deltaTime).count() * 0.001f;
+        // the simulation of this frame may have been started while the previous frame was being rendered
+        this->simulationThread->wait();
+        auto now = clock::now();
+        auto deltaTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - currentTime);
+        this->currentTime = now;
+        const auto &simulationConfig = Project::getConfig().simulationConfig;
+        simulationClock.setTickRate(simulationConfig.tickRate);
+        simulationClock.setMaxStepsPerFrame(simulationConfig.maxStepsPerFrame);
+        simulationClock.setDeterministic(simulationConfig.deterministic);
+        int fixedSteps = simulationClock.advance(deltaTime);
+        // a deterministic frame is exactly one tick long for everything (animations included)
+        float dt = simulationClock.isDeterministic() ? (float) simulationClock.getFixedDeltaTime()
+                                                     : std::chrono::duration<float>(deltaTime).count();
         // update startup logo and other window-specific logic
         this->window->update(dt);
         // poll for input
         this->window->pollEvents(dt);
-        // fixed update (physics, scripts, etc.)
-        while (lag >= timestep) {
-            this->fixedUpdate();
-            lag -= timestep;
-        }
-        // not fixed update (ex: animations)
-        Project::getScene()->update(dt);
-        // render
         std::pair<int, int> rendererViewportDimensions;
         if (Project::isFullscreen()) {
             rendererViewportDimensions = this->window->getWindowDimensions();
         } else {
             rendererViewportDimensions = this->editor->getRendererViewportDimensions();
         }
-        this->renderer->render(rendererViewportDimensions.first, rendererViewportDimensions.second,
-                               Project::isFullscreen());
-        if (!Project::isFullscreen()) {
-            // TODO: create fixed update for editor for more costly computations
-            this->editor->update(this->window, this->renderer->getOutputRenderTexture());
+        bool fullscreen = Project::isFullscreen();
+        // create GPU resources for anything new in the scene while nothing else is touching it
+        this->renderer->prepare();
+        // physics reads terrain heights on the simulation thread, so tiles rigid bodies can reach are loaded here
+        Project::getScene()->getTerrainComponentSystem()->loadCollisionTiles();
+        if (this->shouldOverlapSimulation()) {
+            // simulate and extract this frame on the simulation thread while the previously extracted frame is drawn
+            this->simulationThread->run([this, dt, fixedSteps, rendererViewportDimensions, fullscreen]() {
+                this->simulate(dt, fixedSteps);
+                this->renderer->extract(rendererViewportDimensions.first, rendererViewportDimensions.second, fullscreen);
+            });
+            this->renderer->submit();
+        } else {
+            this->simulate(dt, fixedSteps);
+            this->renderer->extract(rendererViewportDimensions.first, rendererViewportDimensions.second, fullscreen);
+            this->renderer->submit();
+            if (!fullscreen) {
+                // TODO: create fixed update for editor for more costly computations
+                OpenGLRenderStats::beginPass("editor");
+                this->editor->update(this->window, this->renderer->getOutputRenderTexture());
+                OpenGLRenderStats::endPass();
+            }
         }
         this->window->swapBuffers();
         this->window->setIsLoading(false);
     }
 
+    void Application::simulate(float dt, int fixedSteps) {
+        // fixed update (physics, scripts, etc.)
+        for (int i = 0; i < fixedSteps; i++) {
+            this->fixedUpdate();
+        }
+        // rigid bodies are drawn between their last two steps so they move smoothly at any frame rate
+        Project::getScene()->getPhysicsComponentSystem()->setInterpolationAlpha(simulationClock.getAlpha());
+        // not fixed update (ex: animations)
+        Project::getScene()->update(dt);
+    }
+
+    bool Application::shouldOverlapSimulation() {
+#ifdef EMSCRIPTEN
+        // no threads on the web build
+        return false;
+#else
+        // the editor reads and writes the scene every frame, so simulation can only overlap rendering
+        // when the game is running fullscreen
+        return Project::isFullscreen() && Project::isPlaying();
+#endif
+    }
+
     bool Application::shouldClose() {
         return this->window->shouldClose();
     }
 
     void Application::fixedUpdate() {
-        Project::getScene()->fixedUpdate(1.0 / 60.0);
+        Project::getScene()->fixedUpdate((float) simulationClock.getFixedDeltaTime());
     }
 
     std::filesystem::path Application::getResourcesRoot() {
@@ -0,0 +1,331 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "dream/Application.h"
+#include "dream/project/Project.h"
+#include "dream/scene/component/Component.h"
+#include "dream/util/Logger.h"
+#include "dream/window/EGLHeadlessWindow.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace Dream {
+    namespace {
+        std::string escapeJSON(const std::string &text) {
+            std::string escaped;
+            for (char c: text) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        double percentile(const std::vector<double> &sortedValues, double fraction) {
+            auto index = (int) std::ceil(fraction * (double) sortedValues.size()) - 1;
+            return sortedValues.at(std::clamp(index, 0, (int) sortedValues.size() - 1));
+        }
+    }
+
+    Benchmark::Options Benchmark::parseOptions(int argCount, char **args) {
+        Options options;
+        options.projectPath = Application::getResourcesRoot().append("examples").append("sample-project");
+        // first two arguments are the executable and the benchmark command
+        for (int i = 2; i < argCount; i++) {
+            std::string arg = args[i];
+            if (i + 1 >= argCount) {
+                Logger::fatal("Missing value for benchmark argument " + arg);
+            }
+            std::string value = args[++i];
+            if (arg == "--project") {
+                options.projectPath = value;
+            } else if (arg == "--frames") {
+                options.frames = std::stoi(value);
+            } else if (arg == "--warmup") {
+                options.warmupFrames = std::stoi(value);
+            } else if (arg == "--width") {
+                options.width = std::stoi(value);
+            } else if (arg == "--height") {
+                options.height = std::stoi(value);
+            } else if (arg == "--output") {
+                options.outputPath = value;
+            } else if (arg == "--dump-frames") {
+                options.frameDumpPath = value;
+            } else if (arg == "--dump-interval") {
+                options.frameDumpInterval = std::max(std::stoi(value), 1);
+            } else if (arg == "--physics") {
+                if (value != "stack" && value != "crowd") {
+                    Logger::fatal("Unknown benchmark physics scene " + value + " (expected stack or crowd)");
+                }
+                options.physicsScene = value;
+            } else if (arg == "--bodies") {
+                options.physicsBodies = std::max(std::stoi(value), 1);
+            } else if (arg == "--multithreaded-physics") {
+                options.multithreadedPhysics = std::stoi(value) != 0;
+            } else {
+                Logger::fatal("Unknown benchmark argument " + arg);
+            }
+        }
+        if (options.frames <= 0) {
+            Logger::fatal("Benchmark needs at least one frame");
+        }
+        return options;
+    }
+
+    Benchmark::Benchmark(Options options) : options(std::move(options)) {
+        Project::open(this->options.projectPath);
+#ifdef DREAM_EGL
+        this->window = new EGLHeadlessWindow(this->options.width, this->options.height);
+#else
+        this->window = nullptr;
+        Logger::fatal("Headless rendering requires EGL");
+#endif
+        this->renderer = new OpenGLRenderer();
+        if (!this->options.physicsScene.empty()) {
+            // the dynamics world is built with the physics system, so it has to be recreated for the option to apply
+            Project::getConfig().physicsConfig.multithreaded = this->options.multithreadedPhysics;
+            Project::getScene()->resetComponentSystems();
+            createPhysicsScene();
+        }
+    }
+
+    Benchmark::~Benchmark() {
+        delete this->renderer;
+        delete this->window;
+    }
+
+    int Benchmark::run() {
+        if (!options.frameDumpPath.empty()) {
+            std::filesystem::create_directories(options.frameDumpPath);
+        }
+        std::vector<double> frameTimes;
+        std::vector<double> physicsTimes;
+        for (int frame = -options.warmupFrames; frame < options.frames; frame++) {
+            updateCamera(std::max(frame, 0));
+            // one tick per frame (like the deterministic simulation mode) so every run simulates the same thing
+            float dt = 1.0f / (float) std::max(Project::getConfig().simulationConfig.tickRate, 1);
+            Project::getScene()->fixedUpdate(dt);
+            Project::getScene()->update(dt);
+            if (!options.physicsScene.empty()) {
+                // the editor does not step the world, so step it the way playing would
+                pushCrowd();
+                auto physicsStart = std::chrono::high_resolution_clock::now();
+                Project::getScene()->getPhysicsComponentSystem()->step(dt);
+                double physicsTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - physicsStart).count();
+                if (frame >= 0) {
+                    physicsTimes.push_back(physicsTime);
+                }
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            // renderer draws at twice the viewport size (for high-dpi displays) so halve it to get the requested size
+            renderer->render(options.width / 2, options.height / 2, false);
+            window->swapBuffers();
+            double frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            if (frame < 0) {
+                continue;
+            }
+            frameTimes.push_back(frameTime);
+            for (const auto &pass: renderer->getRenderGraph()->getPasses()) {
+                if (pass.culled) {
+                    continue;
+                }
+                if (passTotals.count(pass.name) == 0) {
+                    passNames.push_back(pass.name);
+                }
+                auto &totals = passTotals[pass.name];
+                totals.frames++;
+                totals.cpuTime += pass.cpuTime;
+                if (pass.gpuTime >= 0) {
+                    totals.gpuFrames++;
+                    totals.gpuTime += pass.gpuTime;
+                }
+                totals.counters += pass.counters;
+            }
+            if (!options.frameDumpPath.empty() && frame % options.frameDumpInterval == 0) {
+                dumpFrame(frame);
+            }
+        }
+        writeReport(frameTimes, physicsTimes);
+        return EXIT_SUCCESS;
+    }
+
+    void Benchmark::createPhysicsScene() {
+        auto *scene = Project::getScene();
+        Entity ground = scene->createEntity("Benchmark Ground");
+        ground.getComponent<Component::TransformComponent>().translation = {0, -0.5f, 0};
+        ground.getComponent<Component::TransformComponent>().scale = {100, 1, 100};
+        ground.addComponent<Component::MeshComponent>(Component::MeshComponent::PRIMITIVE_CUBE, std::map<std::string, float>());
+        ground.addComponent<Component::CollisionComponent>().colliders.push_back({.halfExtents={50, 0.5f, 50}});
+        ground.addComponent<Component::RigidBodyComponent>().type = Component::RigidBodyComponent::STATIC;
+
+        bool stack = options.physicsScene == "stack";
+        // stacks are 10 boxes high, the crowd stands on a single layer
+        int height = stack ? 10 : 1;
+        int columns = std::max((int) std::ceil(std::sqrt((float) options.physicsBodies / (float) height)), 1);
+        for (int i = 0; i < options.physicsBodies; i++) {
+            int level = i % height;
+            int column = i / height;
+            float x = (float) (column % columns) - (float) columns * 0.5f;
+            float z = (float) (column / columns) - (float) columns * 0.5f;
+            Entity body = scene->createEntity("Benchmark Body");
+            auto &transform = body.getComponent<Component::TransformComponent>();
+            Component::CollisionComponent::Collider collider;
+            if (stack) {
+                // boxes touch their neighbours so the stacks lean on each other
+                transform.translation = {x, 0.5f + (float) level, z};
+                collider.halfExtents = {0.5f, 0.5f, 0.5f};
+                body.addComponent<Component::MeshComponent>(Component::MeshComponent::PRIMITIVE_CUBE, std::map<std::string, float>());
+            } else {
+                transform.translation = {x * 1.5f, 1.0f, z * 1.5f};
+                transform.scale = {0.4f, 1.0f, 0.4f};
+                collider.type = Component::CollisionComponent::CAPSULE;
+                collider.radius = 0.4f;
+                collider.height = 2.0f;
+                body.addComponent<Component::MeshComponent>(Component::MeshComponent::PRIMITIVE_SPHERE, std::map<std::string, float>());
+            }
+            body.addComponent<Component::CollisionComponent>().colliders.push_back(collider);
+            auto &rigidBody = body.addComponent<Component::RigidBodyComponent>();
+            if (!stack) {
+                // characters stay upright
+                rigidBody.angularFactor = {0, 0, 0};
+                crowdEntities.push_back(body);
+            }
+        }
+    }
+
+    void Benchmark::pushCrowd() {
+        for (auto &entity: crowdEntities) {
+            auto &rigidBody = entity.getComponent<Component::RigidBodyComponent>();
+            if (rigidBody.rigidBodyIndex == -1) {
+                continue;
+            }
+            glm::vec3 position = entity.getComponent<Component::TransformComponent>().translation;
+            glm::vec3 toCenter = glm::vec3(-position.x, 0, -position.z);
+            float distance = glm::length(toCenter);
+            if (distance > 0.001f) {
+                glm::vec3 velocity = rigidBody.getLinearVelocity();
+                glm::vec3 target = toCenter / distance * 3.0f;
+                rigidBody.setLinearVelocity({target.x, velocity.y, target.z});
+            }
+        }
+    }
+
+    void Benchmark::updateCamera(int frame) {
+        // orbit around the origin once over the course of the benchmark
+        auto sceneCamera = Project::getScene()->getSceneCamera();
+        if (!sceneCamera) {
+            Logger::fatal("Benchmark project does not have a scene camera");
+        }
+        float angle = 2.0f * (float) M_PI * (float) frame / (float) options.frames;
+        float radius = 30.0f;
+        sceneCamera.getComponent<Component::TransformComponent>().translation = {radius * std::cos(angle), 10.0f, radius * std::sin(angle)};
+        sceneCamera.getComponent<Component::SceneCameraComponent>().lookAt(sceneCamera, glm::vec3(0, 0, 0));
+    }
+
+    void Benchmark::dumpFrame(int frame) {
+        auto outputFrameBuffer = renderer->getRenderGraph()->getOutputFrameBuffer();
+        int width = outputFrameBuffer->getWidth();
+        int height = outputFrameBuffer->getHeight();
+        std::vector<unsigned char> pixels(width * height * 3);
+        outputFrameBuffer->bindForWriting();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "frame_%05d.png", frame);
+        auto path = std::filesystem::path(options.frameDumpPath).append(fileName);
+        stbi_flip_vertically_on_write(1);
+        if (!stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3)) {
+            Logger::error("Unable to write benchmark frame " + path.string());
+        }
+    }
+
+    void Benchmark::writeReport(std::vector<double> frameTimes, std::vector<double> physicsTimes) {
+        std::sort(frameTimes.begin(), frameTimes.end());
+        double totalFrameTime = 0;
+        for (double frameTime: frameTimes) {
+            totalFrameTime += frameTime;
+        }
+
+        std::ofstream out(options.outputPath);
+        out << "{\n";
+        out << "  \"project\": \"" << escapeJSON(options.projectPath.string()) << "\",\n";
+        out << "  \"frames\": " << frameTimes.size() << ",\n";
+        out << "  \"width\": " << options.width << ",\n";
+        out << "  \"height\": " << options.height << ",\n";
+        out << "  \"glRenderer\": \"" << escapeJSON((const char *) glGetString(GL_RENDERER)) << "\",\n";
+        out << "  \"glVersion\": \"" << escapeJSON((const char *) glGetString(GL_VERSION)) << "\",\n";
+        out << "  \"frameTimeMs\": {\n";
+        out << "    \"mean\": " << totalFrameTime / (double) frameTimes.size() << ",\n";
+        out << "    \"min\": " << frameTimes.front() << ",\n";
+        out << "    \"p50\": " << percentile(frameTimes, 0.50) << ",\n";
+        out << "    \"p90\": " << percentile(frameTimes, 0.90) << ",\n";
+        out << "    \"p95\": " << percentile(frameTimes, 0.95) << ",\n";
+        out << "    \"p99\": " << percentile(frameTimes, 0.99) << ",\n";
+        out << "    \"max\": " << frameTimes.back() << "\n";
+        out << "  },\n";
+        if (!physicsTimes.empty()) {
+            std::sort(physicsTimes.begin(), physicsTimes.end());
+            double totalPhysicsTime = 0;
+            for (double physicsTime: physicsTimes) {
+                totalPhysicsTime += physicsTime;
+            }
+            out << "  \"physics\": {\n";
+            out << "    \"scene\": \"" << options.physicsScene << "\",\n";
+            out << "    \"bodies\": " << options.physicsBodies << ",\n";
+            out << "    \"multithreaded\": " << (Project::getScene()->getPhysicsComponentSystem()->isMultithreaded() ? "true" : "false") << ",\n";
+            out << "    \"stepTimeMs\": {\n";
+            out << "      \"mean\": " << totalPhysicsTime / (double) physicsTimes.size() << ",\n";
+            out << "      \"p50\": " << percentile(physicsTimes, 0.50) << ",\n";
+            out << "      \"p95\": " << percentile(physicsTimes, 0.95) << ",\n";
+            out << "      \"max\": " << physicsTimes.back() << "\n";
+            out << "    }\n";
+            out << "  },\n";
+        }
+        out << "  \"passes\": [\n";
+        for (int i = 0; i < passNames.size(); i++) {
+            const auto &totals = passTotals[passNames.at(i)];
+            auto frames = (double) totals.frames;
+            out << "    {\"name\": \"" << escapeJSON(passNames.at(i)) << "\", "
+                << "\"frames\": " << totals.frames << ", "
+                << "\"cpuTimeMs\": " << totals.cpuTime / frames << ", "
+                << "\"gpuTimeMs\": " << (totals.gpuFrames > 0 ? totals.gpuTime / totals.gpuFrames : -1) << ", "
+                << "\"drawCalls\": " << (double) totals.counters.drawCalls / frames << ", "
+                << "\"triangles\": " << (double) totals.counters.triangles / frames << ", "
+                << "\"textureBinds\": " << (double) totals.counters.textureBinds / frames << ", "
+                << "\"programSwitches\": " << (double) totals.counters.programSwitches / frames << ", "
+                << "\"uniformUploads\": " << (double) totals.counters.uniformUploads / frames << "}"
+                << (i + 1 < passNames.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+        Logger::info("Wrote benchmark results to " + options.outputPath.string());
+    }
+}
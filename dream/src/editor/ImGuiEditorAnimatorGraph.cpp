@@ -27,6 +27,7 @@
 #include <iostream>
 #include <utility>
 #include <fstream>
+#include <cmath>
 
 namespace Dream {
     ImGuiEditorAnimatorGraph::ImGuiEditorAnimatorGraph() {
@@ -251,54 +252,12 @@ namespace Dream {
         if (animatorFileGUID.empty()) {
             Logger::fatal("No file specified for animator (2)");
         }
-        states.clear();
-        variableNames.clear();
-        variableValues.clear();
         std::string animatorFilePath = Project::getResourceManager()->getFilePathFromGUID(animatorFileGUID);
-        YAML::Node doc = YAML::LoadFile(animatorFilePath);
-        // deserialize states
-        auto statesNode = doc[Component::AnimatorComponent::k_states].as<std::vector<YAML::Node>>();
-        for (const YAML::Node &animationNode: statesNode) {
-            states.push_back(Component::AnimatorComponent::State{
-                    .Guid=animationNode["Guid"].as<std::string>(),
-                    .PlayOnce=animationNode["PlayOnce"].as<bool>(),
-                    .Name=animationNode["Name"].as<std::string>()
-            });
-        }
-        // deserialize transitions
-        auto transitionsNodes = doc[Component::AnimatorComponent::k_transitions].as<std::vector<YAML::Node>>();
-        for (const YAML::Node &transitionNode: transitionsNodes) {
-            std::vector<Component::AnimatorComponent::Condition> conditions;
-            auto conditionNodes = transitionNode[Component::AnimatorComponent::k_transition_Conditions].as<std::vector<YAML::Node>>();
-            for (const YAML::Node &conditionNode: conditionNodes) {
-                Component::AnimatorComponent::Condition condition = {
-                        .Variable1Idx=conditionNode["Variable1Idx"] ? conditionNode["Variable1Idx"].as<int>() : -1,
-                        .Variable1=conditionNode["Variable1"] ? conditionNode["Variable1"].as<int>() : 0,
-                        .Operator=conditionNode["Operator"] ? conditionNode["Operator"].as<std::string>() : "==",
-                        .Variable2Idx=conditionNode["Variable2Idx"] ? conditionNode["Variable2Idx"].as<int>() : -1,
-                        .Variable2=conditionNode["Variable2"] ? conditionNode["Variable2"].as<int>() : 0,
-                };
-                conditions.push_back(condition);
-            }
-            auto inputNodeID = transitionNode[Component::AnimatorComponent::k_transition_InputStateID].as<int>();
-            auto outputNodeID = transitionNode[Component::AnimatorComponent::k_transition_OutputStateID].as<int>();
-            auto blend = transitionNode["Blend"].as<bool>();
-            Component::AnimatorComponent::Transition transition = {
-                    .InputStateID=inputNodeID,
-                    .OutputStateID=outputNodeID,
-                    .Conditions=conditions,
-                    .Blend=blend
-            };
-            transitions.push_back(transition);
-        }
-        // deserialize variables
-        auto variablesNode = doc[Component::AnimatorComponent::k_variables].as<std::vector<YAML::Node>>();
-        for (const YAML::Node &variableNode: variablesNode) {
-            auto name = variableNode[Component::AnimatorComponent::k_variable_name].as<std::string>();
-            int value = variableNode[Component::AnimatorComponent::k_variable_value].as<int>();
-            variableNames.push_back(name);
-            variableValues.push_back(value);
-        }
+        auto description = Component::AnimatorComponent::loadAnimatorFile(animatorFilePath);
+        states = std::move(description.states);
+        transitions = std::move(description.transitions);
+        variables = std::move(description.variables);
+        layers = std::move(description.layers);
     }
 
     void ImGuiEditorAnimatorGraph::serializeStateMachine() {
@@ -307,56 +266,14 @@ namespace Dream {
         }
         // update the animator file
         std::string animatorFilePath = Project::getResourceManager()->getFilePathFromGUID(animatorFileGUID);
-        YAML::Emitter out;
-        out << YAML::BeginMap;
-        // serialize states
-        out << YAML::Key << Component::AnimatorComponent::k_states;
-        YAML::Node statesNode = YAML::Node(YAML::NodeType::Sequence);
-        for (const auto &state: states) {
-            YAML::Node stateNode = YAML::Node(YAML::NodeType::Map);
-            stateNode["Guid"] = state.Guid;
-            stateNode["PlayOnce"] = state.PlayOnce;
-            stateNode["Name"] = state.Name;
-            statesNode.push_back(stateNode);
-        }
-        out << YAML::Value << statesNode;
-        // serialize transitions
-        out << YAML::Key << Component::AnimatorComponent::k_transitions;
-        YAML::Node transitionsNode = YAML::Node(YAML::NodeType::Sequence);
-        for (const auto &transition: transitions) {
-            YAML::Node transitionNode;
-            transitionNode[Component::AnimatorComponent::k_transition_InputStateID] = transition.InputStateID;
-            transitionNode[Component::AnimatorComponent::k_transition_OutputStateID] = transition.OutputStateID;
-            YAML::Node conditionsNode = YAML::Node(YAML::NodeType::Sequence);
-            for (const auto &condition: transition.Conditions) {
-                YAML::Node conditionNode;
-                conditionNode["Variable1Idx"] = condition.Variable1Idx;
-                conditionNode["Variable1"] = condition.Variable1;
-                conditionNode["Operator"] = condition.Operator;
-                conditionNode["Variable2Idx"] = condition.Variable2Idx;
-                conditionNode["Variable2"] = condition.Variable2;
-                conditionsNode.push_back(conditionNode);
-            }
-            transitionNode[Component::AnimatorComponent::k_transition_Conditions] = conditionsNode;
-            transitionNode["Blend"] = transition.Blend;
-            transitionsNode.push_back(transitionNode);
-        }
-        out << YAML::Value << transitionsNode;
-        // serialize variables
-        out << YAML::Key << Component::AnimatorComponent::k_variables;
-        YAML::Node variablesNode = YAML::Node(YAML::NodeType::Sequence);
-        for (int i = 0; i < variableNames.size(); ++i) {
-            YAML::Node variableNode;
-            variableNode[Component::AnimatorComponent::k_variable_name] = variableNames[i];
-            variableNode[Component::AnimatorComponent::k_variable_value] = variableValues[i];
-            variablesNode.push_back(variableNode);
-        }
-        out << YAML::Value << variablesNode;
-        out << YAML::EndMap;
-        std::ofstream fout(animatorFilePath.c_str());
-        fout << out.c_str();
-        fout.close();
+        Component::AnimatorComponent::saveAnimatorFile(animatorFilePath, {
+                .states=states,
+                .transitions=transitions,
+                .variables=variables,
+                .layers=layers
+        });
         // update all entities with this animator
+        Project::getResourceManager()->removeAnimatorController(animatorFileGUID);
         auto animatorEntities = Project::getScene()->getEntitiesWithComponents<Component::AnimatorComponent>();
         for (auto entityHandle: animatorEntities) {
             Entity entity = {entityHandle, Project::getScene()};
@@ -539,13 +456,13 @@ namespace Dream {
                             ImGui::SetNextItemWidth(100);
                             auto uniqueLabel = std::to_string(i) + "/" + std::to_string(j);
                             if (ImGui::BeginCombo(("##Var1/" + uniqueLabel).c_str(),
-                                                  condition.Variable1Idx == -1 ? "Custom" : variableNames.at(
-                                                          condition.Variable1Idx).c_str())) {
+                                                  condition.Variable1Idx == -1 ? "Custom" : variables.at(
+                                                          condition.Variable1Idx).Name.c_str())) {
                                 if (ImGui::Selectable("custom")) {
                                     condition.Variable1Idx = -1;
                                 }
-                                for (int k = 0; k < variableNames.size(); ++k) {
-                                    if (ImGui::Selectable(variableNames[k].c_str())) {
+                                for (int k = 0; k < variables.size(); ++k) {
+                                    if (ImGui::Selectable(variables[k].Name.c_str())) {
                                         condition.Variable1Idx = k;
                                     }
                                 }
@@ -554,7 +471,7 @@ namespace Dream {
                             if (condition.Variable1Idx == -1) {
                                 ImGui::SameLine();
                                 ImGui::SetNextItemWidth(20);
-                                ImGui::InputInt(("##Var1Input/" + uniqueLabel).c_str(), &condition.Variable1, 0);
+                                ImGui::InputFloat(("##Var1Input/" + uniqueLabel).c_str(), &condition.Variable1, 0, 0, "%g");
                             }
                         }
                         {
@@ -569,6 +486,7 @@ namespace Dream {
                                 operators.emplace_back("<");
                                 operators.emplace_back(">=");
                                 operators.emplace_back("<=");
+                                operators.emplace_back("!=");
                                 for (auto const &op: operators) {
                                     if (ImGui::Selectable(op.c_str())) {
                                         condition.Operator = op;
@@ -583,13 +501,13 @@ namespace Dream {
                             ImGui::SetNextItemWidth(100);
                             auto uniqueLabel = std::to_string(i) + "/" + std::to_string(j);
                             if (ImGui::BeginCombo(("##Var2/" + uniqueLabel).c_str(),
-                                                  condition.Variable2Idx == -1 ? "Custom" : variableNames.at(
-                                                          condition.Variable2Idx).c_str())) {
+                                                  condition.Variable2Idx == -1 ? "Custom" : variables.at(
+                                                          condition.Variable2Idx).Name.c_str())) {
                                 if (ImGui::Selectable("custom")) {
                                     condition.Variable2Idx = -1;
                                 }
-                                for (int k = 0; k < variableNames.size(); ++k) {
-                                    if (ImGui::Selectable(variableNames[k].c_str())) {
+                                for (int k = 0; k < variables.size(); ++k) {
+                                    if (ImGui::Selectable(variables[k].Name.c_str())) {
                                         condition.Variable2Idx = k;
                                     }
                                 }
@@ -598,7 +516,7 @@ namespace Dream {
                             if (condition.Variable2Idx == -1) {
                                 ImGui::SameLine();
                                 ImGui::SetNextItemWidth(20);
-                                ImGui::InputInt(("##Var2Input/" + uniqueLabel).c_str(), &condition.Variable2, 0);
+                                ImGui::InputFloat(("##Var2Input/" + uniqueLabel).c_str(), &condition.Variable2, 0, 0, "%g");
                             }
                         }
                         // remove condition
@@ -639,40 +557,64 @@ namespace Dream {
         if (ImGui::TreeNodeEx("variables", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanFullWidth)) {
             auto cursorPosX2 = ImGui::GetCursorPosX();
             auto treeNodeWidth = ImGui::GetWindowContentRegionWidth() - (cursorPosX2 - cursorPosX1);
-            for (int i = 0; i < variableNames.size(); ++i) {
+            for (int i = 0; i < variables.size(); ++i) {
+                auto &variable = variables[i];
                 float InputWidth = 40.0f;
-                ImGui::SetNextItemWidth(treeNodeWidth - InputWidth - 25);
-                ImGui::InputText(("##variable" + std::to_string(i)).c_str(), &variableNames[i]);
+                float TypeWidth = 60.0f;
+                ImGui::SetNextItemWidth(treeNodeWidth - InputWidth - TypeWidth - 33);
+                ImGui::InputText(("##variable" + std::to_string(i)).c_str(), &variable.Name);
                 ImGui::SameLine();
-                ImGui::SetNextItemWidth(InputWidth - 8);
-                ImGui::InputInt(("##variable-edit" + std::to_string(i)).c_str(), &variableValues[i], 0);
-                ImGui::SameLine();
-                if (ImGui::Button(("X##VariableRemoveBtn/" + std::to_string(i)).c_str())) {
-                    variableNames.erase(variableNames.begin() + i);
-                    variableValues.erase(variableValues.begin() + i);
-                    for (auto &transition: transitions) {
-                        // remove conditions that rely on this variable
-                        for (int j = (int) transition.Conditions.size() - 1; j >= 0; --j) {
-                            if (transition.Conditions[j].Variable1Idx == i ||
-                                transition.Conditions[j].Variable2Idx == i) {
-                                transition.Conditions.erase(transition.Conditions.begin() + j);
-                            }
-                        }
-                        // update variable indices for transition conditions
-                        for (auto &condition: transition.Conditions) {
-                            if (condition.Variable1Idx > i) {
-                                condition.Variable1Idx--;
-                            }
-                            if (condition.Variable2Idx > i) {
-                                condition.Variable2Idx--;
+                ImGui::SetNextItemWidth(TypeWidth);
+                if (ImGui::BeginCombo(("##variable-type" + std::to_string(i)).c_str(),
+                                      AnimatorController::getParameterTypeName(variable.Type))) {
+                    for (auto type: {AnimatorController::ParameterType::INT, AnimatorController::ParameterType::FLOAT,
+                                     AnimatorController::ParameterType::BOOL, AnimatorController::ParameterType::TRIGGER}) {
+                        if (ImGui::Selectable(AnimatorController::getParameterTypeName(type))) {
+                            variable.Type = type;
+                            if (type != AnimatorController::ParameterType::FLOAT) {
+                                variable.Value = type == AnimatorController::ParameterType::INT ? std::round(variable.Value)
+                                                                                                : (float) (variable.Value != 0);
                             }
                         }
                     }
+                    ImGui::EndCombo();
+                }
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(InputWidth - 8);
+                auto valueLabel = "##variable-edit" + std::to_string(i);
+                if (variable.Type == AnimatorController::ParameterType::FLOAT) {
+                    ImGui::InputFloat(valueLabel.c_str(), &variable.Value, 0, 0, "%g");
+                } else if (variable.Type == AnimatorController::ParameterType::INT) {
+                    int value = (int) variable.Value;
+                    if (ImGui::InputInt(valueLabel.c_str(), &value, 0)) {
+                        variable.Value = (float) value;
+                    }
+                } else {
+                    bool value = variable.Value != 0;
+                    if (ImGui::Checkbox(valueLabel.c_str(), &value)) {
+                        variable.Value = value ? 1.0f : 0.0f;
+                    }
+                }
+                ImGui::SameLine();
+                if (ImGui::Button(("X##VariableRemoveBtn/" + std::to_string(i)).c_str())) {
+                    // transitions, blend trees and layers reference variables by index
+                    AnimatorController::Description description = {
+                            .states=std::move(states),
+                            .transitions=std::move(transitions),
+                            .variables=std::move(variables),
+                            .layers=std::move(layers)
+                    };
+                    AnimatorController::removeVariable(description, i);
+                    states = std::move(description.states);
+                    transitions = std::move(description.transitions);
+                    variables = std::move(description.variables);
+                    layers = std::move(description.layers);
                 }
             }
             if (ImGui::Button("Add", ImVec2(treeNodeWidth, 0))) {
-                variableNames.emplace_back("variable");
-                variableValues.push_back(0);
+                variables.push_back(Component::AnimatorComponent::Variable{
+                        .Name="variable"
+                });
             }
             ImGui::TreePop();
         }
@@ -18,6 +18,8 @@
 
 #include "dream/editor/ImGuiEditorInspectorView.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <misc/cpp/imgui_stdlib.h>
@@ -84,6 +86,7 @@ namespace Dream {
                 renderMaterialComponent();
                 renderLuaScriptComponent();
                 renderAnimatorComponent();
+                renderVertexAnimationComponent();
                 renderBoneComponent();
                 renderSceneCameraComponent();
                 renderCameraComponent();
@@ -109,6 +112,8 @@ namespace Dream {
                 selectedEntity.addComponent<Component::LuaScriptComponent>("");
             } else if (componentID == Component::AnimatorComponent::componentName) {
                 selectedEntity.addComponent<Component::AnimatorComponent>();
+            } else if (componentID == Component::VertexAnimationComponent::componentName) {
+                selectedEntity.addComponent<Component::VertexAnimationComponent>();
             } else if (componentID == Component::SceneCameraComponent::componentName) {
                 selectedEntity.addComponent<Component::SceneCameraComponent>(45.0f);
                 selectedEntity.getComponent<Component::TransformComponent>().rotation = {0, 0, -0.707, 0.707};
@@ -157,6 +162,10 @@ namespace Dream {
             components.insert(std::make_pair("Animator", Component::AnimatorComponent::componentName));
         }
 
+        if (!selectedEntity.hasComponent<Component::VertexAnimationComponent>()) {
+            components.insert(std::make_pair("Vertex Animation", Component::VertexAnimationComponent::componentName));
+        }
+
         if (!selectedEntity.hasComponent<Component::SceneCameraComponent>() && !Project::getScene()->getSceneCamera()) {
             components.insert(std::make_pair("Scene Camera", Component::SceneCameraComponent::componentName));
         }
@@ -684,6 +693,114 @@ namespace Dream {
         }
     }
 
+    void ImGuiEditorInspectorView::renderVertexAnimationComponent() {
+        if (selectedEntity.hasComponent<Component::VertexAnimationComponent>()) {
+            auto &component = selectedEntity.getComponent<Component::VertexAnimationComponent>();
+            bool treeNodeOpen = ImGui::TreeNodeEx("##Vertex Animation",
+                                                  ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanFullWidth |
+                                                  ImGuiTreeNodeFlags_AllowItemOverlap);
+
+            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+            ImGui::SameLine();
+            ImGui::Text("Vertex Animation");
+            ImGui::SameLine(ImGui::GetWindowContentRegionWidth() - 5);
+            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.f, 0.f));
+            if (ImGui::Button("X", ImVec2(0.f, 0.f))) {
+                selectedEntity.removeComponent<Component::VertexAnimationComponent>();
+                ImGui::PopStyleVar();
+                ImGui::PopStyleColor();
+                if (treeNodeOpen) {
+                    ImGui::TreePop();
+                }
+                return;
+            }
+            ImGui::PopStyleVar();
+            ImGui::PopStyleColor();
+            auto cursorPosX1 = ImGui::GetCursorPosX();
+
+            if (treeNodeOpen) {
+                auto cursorPosX2 = ImGui::GetCursorPosX();
+                auto treeNodeWidth = ImGui::GetWindowContentRegionWidth() - (cursorPosX2 - cursorPosX1);
+                float floatInputWidth = 100.0f;
+
+                std::string vertexAnimationPath = Project::getResourceManager()->getFilePathFromGUID(component.guid);
+                std::string shortVertexAnimationPath = StringUtils::getFilePathRelativeToProjectFolder(
+                        vertexAnimationPath);
+                ImGui::SetNextItemWidth(ImGui::GetWindowContentRegionWidth() - (cursorPosX2) - 50);
+                ImGui::InputText("##VertexAnimationPath", &shortVertexAnimationPath, ImGuiInputTextFlags_ReadOnly);
+
+                // bake every motion of the animator on the entity (the model is the entity itself)
+                ImGui::SameLine();
+                if (ImGui::Button("Bake", ImVec2(40, 0))) {
+                    std::vector<std::string> animationGuids;
+                    if (selectedEntity.hasComponent<Component::AnimatorComponent>()) {
+                        auto &animator = selectedEntity.getComponent<Component::AnimatorComponent>();
+                        if (animator.controller) {
+                            for (int i = 0; i < animator.controller->getNumMotions(); i++) {
+                                const std::string &guid = animator.controller->getMotion(i).guid;
+                                if (std::find(animationGuids.begin(), animationGuids.end(), guid) ==
+                                    animationGuids.end()) {
+                                    animationGuids.push_back(guid);
+                                }
+                            }
+                        }
+                    }
+                    std::string guid = Project::getAssetImporter()->bakeVertexAnimation(selectedEntity,
+                                                                                         animationGuids);
+                    if (!guid.empty()) {
+                        component.guid = guid;
+                        component.needsToLoad = true;
+                    }
+                }
+
+                // clip input
+                {
+                    auto cursorPosX3 = ImGui::GetCursorPosX();
+                    ImGui::Text("Clip");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                    ImGui::SetNextItemWidth(floatInputWidth);
+                    int maxClip = component.vertexAnimation ? component.vertexAnimation->getNumClips() - 1 : 0;
+                    ImGui::DragInt("##VertexAnimationComponentClip", &component.clip, 0.1f, 0, maxClip);
+                }
+
+                // time offset input
+                {
+                    auto cursorPosX3 = ImGui::GetCursorPosX();
+                    ImGui::Text("Time Offset");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                    ImGui::SetNextItemWidth(floatInputWidth);
+                    ImGui::DragFloat("##VertexAnimationComponentTimeOffset", &component.timeOffset, 0.01f, 0.0f,
+                                     FLT_MAX, "%.3f");
+                }
+
+                // speed input
+                {
+                    auto cursorPosX3 = ImGui::GetCursorPosX();
+                    ImGui::Text("Speed");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                    ImGui::SetNextItemWidth(floatInputWidth);
+                    ImGui::DragFloat("##VertexAnimationComponentSpeed", &component.speed, 0.01f, 0.0f, FLT_MAX,
+                                     "%.3f");
+                }
+
+                // switch distance input
+                {
+                    auto cursorPosX3 = ImGui::GetCursorPosX();
+                    ImGui::Text("Switch Distance");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                    ImGui::SetNextItemWidth(floatInputWidth);
+                    ImGui::DragFloat("##VertexAnimationComponentSwitchDistance", &component.switchDistance, 0.1f,
+                                     0.0f, FLT_MAX, "%.3f");
+                }
+                ImGui::TreePop();
+            }
+        }
+    }
+
     void ImGuiEditorInspectorView::renderBoneComponent() {
         if (selectedEntity.hasComponent<Component::BoneComponent>()) {
             auto &component = selectedEntity.getComponent<Component::BoneComponent>();
@@ -1179,6 +1296,16 @@ namespace Dream {
                     component.restitution = fmin(component.restitution, 1.0f);
                     component.restitution = fmax(component.restitution, 0.0f);
                 }
+                // trigger input
+                {
+                    auto cursorPosX3 = ImGui::GetCursorPosX();
+                    ImGui::Text("Trigger");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - ImGui::GetFrameHeight());
+                    if (ImGui::Checkbox("##RigidBodyIsTrigger", &component.isTrigger)) {
+                        updateColliderAndRigidBody();
+                    }
+                }
                 ImGui::TreePop();
             }
         }
@@ -1347,16 +1474,58 @@ namespace Dream {
                         }
                     }
                 }
+                // brush settings
+                if (Project::getScene()->getTerrainComponentSystem()) {
+                    auto &brush = Project::getScene()->getTerrainComponentSystem()->getBrush();
+                    float floatInputWidth = 100.0f;
+                    // brush mode
+                    {
+                        auto cursorPosX3 = ImGui::GetCursorPosX();
+                        ImGui::Text("Brush");
+                        ImGui::SameLine();
+                        const char *brushModes[] = {"Raise", "Lower", "Smooth", "Flatten"};
+                        ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                        ImGui::SetNextItemWidth(floatInputWidth);
+                        if (ImGui::BeginCombo("##TerrainBrushMode", brushModes[brush.mode])) {
+                            for (int i = 0; i < IM_ARRAYSIZE(brushModes); i++) {
+                                if (ImGui::Selectable(brushModes[i], brush.mode == i)) {
+                                    brush.mode = static_cast<TerrainBrush::Mode>(i);
+                                }
+                            }
+                            ImGui::EndCombo();
+                        }
+                    }
+                    // brush radius
+                    {
+                        auto cursorPosX3 = ImGui::GetCursorPosX();
+                        ImGui::Text("Radius");
+                        ImGui::SameLine();
+                        ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                        ImGui::SetNextItemWidth(floatInputWidth);
+                        ImGui::SliderInt("##TerrainBrushRadius", &brush.radius, 1, 64);
+                    }
+                    // brush strength (raise / lower) or blend rate (smooth / flatten)
+                    {
+                        auto cursorPosX3 = ImGui::GetCursorPosX();
+                        bool changesHeight = brush.mode == TerrainBrush::RAISE || brush.mode == TerrainBrush::LOWER;
+                        ImGui::Text(changesHeight ? "Strength" : "Blend Rate");
+                        ImGui::SameLine();
+                        ImGui::SetCursorPosX(cursorPosX3 + treeNodeWidth - floatInputWidth);
+                        ImGui::SetNextItemWidth(floatInputWidth);
+                        if (changesHeight) {
+                            ImGui::DragFloat("##TerrainBrushStrength", &brush.strength, 0.5f, 0.0f, 1000.0f, "%.3f");
+                        } else {
+                            ImGui::DragFloat("##TerrainBrushBlendRate", &brush.blendRate, 0.05f, 0.0f, 60.0f, "%.3f");
+                        }
+                    }
+                }
                 // button to clear
                 {
                     if (ImGui::Button("Clear")) {
                         if (component.terrain) {
-                            for (int x = 0; x < component.terrain->getSize(); ++x) {
-                                for (int z = 0; z < component.terrain->getSize(); ++z) {
-                                    component.terrain->setHeight(x, z, 0.0f);
-                                }
-                            }
-                            component.terrain->refreshTerrainTriangleList();
+                            int terrainSize = (int) component.terrain->getSize();
+                            std::fill_n(component.terrain->getHeightMapData(), terrainSize * terrainSize, 0.0f);
+                            component.terrain->markHeightsModified(0, 0, terrainSize - 1, terrainSize - 1);
                         }
                     }
                 }
@@ -20,7 +20,9 @@
 #include "dream/project/Project.h"
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
+#include <algorithm>
 #include "dream/renderer/OpenGLTexture.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 #include "dream/window/Input.h"
 #include "dream/Application.h"
 
@@ -103,7 +105,20 @@ namespace Dream {
                 ImGui::Checkbox("Physics debugger", &(Project::getConfig().physicsConfig.physicsDebugger));
                 ImGui::Checkbox("Physics debugger depth test", &(Project::getConfig().physicsConfig.depthTest));
                 ImGui::Checkbox("Physics debugger while playing", &(Project::getConfig().physicsConfig.physicsDebuggerWhilePlaying));
+                // the dynamics world is only built when the scene loads
+                if (ImGui::Checkbox("Multithreaded physics", &(Project::getConfig().physicsConfig.multithreaded)) && !Project::isPlaying()) {
+                    Project::saveScene(true);
+                    Project::reloadScene();
+                }
                 ImGui::Checkbox("Play animation in editor", &(Project::getConfig().animationConfig.playInEditor));
+                ImGui::Checkbox("Animation level of detail", &(Project::getConfig().animationConfig.levelOfDetail));
+                ImGui::Checkbox("Pre-skin animated meshes", &(Project::getConfig().renderingConfig.preSkinning));
+                ImGui::Checkbox("Deterministic simulation", &(Project::getConfig().simulationConfig.deterministic));
+                ImGui::PushItemWidth(ImGui::GetWindowContentRegionWidth() * 0.4f);
+                ImGui::DragInt("Tick rate", &(Project::getConfig().simulationConfig.tickRate), 1.0f, 10, 240);
+                ImGui::DragInt("Max steps per frame", &(Project::getConfig().simulationConfig.maxStepsPerFrame), 0.1f, 1, 20);
+                ImGui::PopItemWidth();
+                ImGui::Checkbox("Render stats", &showRenderStats);
                 // drop-down for rendering debugger views
                 {
                     ImGui::PushItemWidth(ImGui::GetWindowContentRegionWidth());
@@ -177,5 +192,91 @@ namespace Dream {
         }
         ImGui::End();
         ImGui::PopStyleColor();
+        if (showRenderStats) {
+            updateRenderStats();
+        }
+    }
+
+    void ImGuiEditorRendererView::updateRenderStats() {
+        ImGui::Begin("Render Stats", &showRenderStats);
+        if (ImGui::Button("Export CSV")) {
+            OpenGLRenderStats::exportCSV(Project::getPath().append("render_stats.csv"));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            OpenGLRenderStats::clearPassHistories();
+        }
+        if (!OpenGLGPUTimer::isSupported()) {
+            ImGui::TextDisabled("GPU timer queries are not supported on this platform");
+        }
+        ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+        if (ImGui::BeginTable("##RenderStats", 8, tableFlags)) {
+            ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("GPU (ms)");
+            ImGui::TableSetupColumn("Draws");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("Textures");
+            ImGui::TableSetupColumn("Programs");
+            ImGui::TableSetupColumn("Uniforms");
+            ImGui::TableHeadersRow();
+            for (const auto &passHistory: OpenGLRenderStats::getPassHistories()) {
+                auto counters = passHistory.getLatestCounters();
+                double gpuTime = passHistory.getAverageGPUTime();
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                bool expanded = ImGui::TreeNodeEx(passHistory.name.c_str(), ImGuiTreeNodeFlags_SpanFullWidth);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f", passHistory.getAverageCPUTime());
+                ImGui::TableSetColumnIndex(2);
+                if (gpuTime >= 0) {
+                    ImGui::Text("%.3f", gpuTime);
+                } else {
+                    ImGui::TextDisabled("-");
+                }
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%lld", counters.drawCalls);
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%lld", counters.triangles);
+                ImGui::TableSetColumnIndex(5);
+                ImGui::Text("%lld", counters.textureBinds);
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%lld", counters.programSwitches);
+                ImGui::TableSetColumnIndex(7);
+                ImGui::Text("%lld", counters.uniformUploads);
+                if (expanded) {
+                    // timeline of the rolling window and a histogram of how the times are distributed
+                    std::vector<float> cpuTimes, gpuTimes;
+                    for (const auto &sample: passHistory.getOrderedSamples()) {
+                        cpuTimes.push_back((float) sample.cpuTime);
+                        if (sample.gpuTime >= 0) {
+                            gpuTimes.push_back((float) sample.gpuTime);
+                        }
+                    }
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    for (const auto &[label, times]: {std::make_pair("CPU", &cpuTimes), std::make_pair("GPU", &gpuTimes)}) {
+                        if (times->empty()) {
+                            continue;
+                        }
+                        const int numBuckets = 20;
+                        float maxTime = *std::max_element(times->begin(), times->end());
+                        std::vector<float> buckets(numBuckets, 0);
+                        for (float time: *times) {
+                            int bucket = maxTime > 0 ? (int) (time / maxTime * (numBuckets - 1)) : 0;
+                            buckets.at(bucket)++;
+                        }
+                        std::string overlay = std::string(label) + " 0 - " + std::to_string(maxTime) + " ms";
+                        ImGui::PlotLines((std::string("##Timeline") + label + passHistory.name).c_str(), times->data(),
+                                         (int) times->size(), 0, label, 0.0f, FLT_MAX, ImVec2(0, 40));
+                        ImGui::PlotHistogram((std::string("##Histogram") + label + passHistory.name).c_str(), buckets.data(),
+                                             numBuckets, 0, overlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 40));
+                    }
+                    ImGui::TreePop();
+                }
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
     }
 }
@@ -17,6 +17,7 @@
  **********************************************************************************/
 
 #include "dream/Application.h"
+#include "dream/Benchmark.h"
 #include <fstream>
 #include <iostream>
 #include <quickjs.h>
@@ -149,6 +150,13 @@ int main(int ArgCount, char **Args) {
 #ifndef EMSCRIPTEN
         ::testing::InitGoogleTest(&ArgCount, Args);
         return RUN_ALL_TESTS();
+#endif
+    } else if (ArgCount >= 2 && std::string(Args[1]) == "benchmark") {
+#ifndef EMSCRIPTEN
+        auto *benchmark = new Dream::Benchmark(Dream::Benchmark::parseOptions(ArgCount, Args));
+        int exitCode = benchmark->run();
+        delete benchmark;
+        return exitCode;
 #endif
     } else {
         test_quickjs();
@@ -15,10 +15,14 @@
  *  You should have received a copy of the GNU Affero General Public License
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  **********************************************************************************/
+#include <algorithm>
+#include <memory>
 #include <utility>
 #include <fstream>
 #include "dream/project/AssetImporter.h"
 #include "dream/project/Project.h"
+#include "dream/renderer/VertexAnimationTexture.h"
+#include "dream/scene/component/Component.h"
 #include "dream/util/IDUtils.h"
 #include "dream/util/Logger.h"
 
@@ -85,4 +89,78 @@ namespace Dream {
             fout << out.c_str();
         }
     }
+
+    std::string AssetImporter::bakeVertexAnimation(Entity modelEntity, const std::vector<std::string> &animationGuids,
+                                                   float framesPerSecond) {
+        if (!modelEntity.hasComponent<Component::MeshComponent>() || animationGuids.empty()) {
+            Logger::error("Vertex animations are baked from a model entity and at least one animation");
+            return "";
+        }
+        auto &meshComponent = modelEntity.getComponent<Component::MeshComponent>();
+        meshComponent.loadMesh();
+        auto *resourceManager = Project::getResourceManager();
+        std::string modelGuid = meshComponent.guid;
+
+        // every submesh of the model below the entity, in hierarchy order
+        std::vector<VertexAnimationTexture::SourceMesh> meshes;
+        std::vector<Entity> entities = {modelEntity};
+        while (!entities.empty()) {
+            Entity entity = entities.back();
+            entities.pop_back();
+            if (entity.hasComponent<Component::MeshComponent>()) {
+                auto &subMesh = entity.getComponent<Component::MeshComponent>();
+                bool isNewSubMesh = std::none_of(meshes.begin(), meshes.end(), [&](const auto &mesh) {
+                    return mesh.fileId == subMesh.fileId;
+                });
+                if (subMesh.guid == modelGuid && !subMesh.fileId.empty() && isNewSubMesh) {
+                    subMesh.loadMesh();
+                    meshes.push_back({
+                            .fileId=subMesh.fileId,
+                            .vertices=resourceManager->getMeshData(modelGuid, subMesh.fileId)->getVertices()
+                    });
+                }
+            }
+            std::vector<Entity> children;
+            Entity child = entity.getComponent<Component::HierarchyComponent>().first;
+            while (child) {
+                children.push_back(child);
+                child = child.getComponent<Component::HierarchyComponent>().next;
+            }
+            entities.insert(entities.end(), children.rbegin(), children.rend());
+        }
+
+        std::vector<VertexAnimationTexture::SourceClip> clips;
+        for (const auto &animationGuid: animationGuids) {
+            clips.push_back({
+                    .guid=animationGuid,
+                    .clip=Component::AnimatorComponent::loadAnimationClip(animationGuid, modelEntity)
+            });
+        }
+        auto skeleton = resourceManager->getAnimationSkeleton(modelGuid);
+        if (meshes.empty() || !skeleton) {
+            Logger::error("No skinned meshes to bake vertex animation for " + resourceManager->getFilePathFromGUID(modelGuid));
+            return "";
+        }
+
+        std::unique_ptr<VertexAnimationTexture> vertexAnimation(
+                VertexAnimationTexture::bake(*skeleton, meshComponent.m_BoneCount, meshes, clips, framesPerSecond));
+        auto path = std::filesystem::path(resourceManager->getFilePathFromGUID(modelGuid)).replace_extension(".vat");
+        if (!vertexAnimation->save(path)) {
+            return "";
+        }
+        createMetaFile(path);
+        Project::recognizeResources();
+        std::string guid = IDUtils::getGUIDForFile(path);
+        // instances pick up the new bake the next time they load it
+        resourceManager->removeVertexAnimation(guid);
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::VertexAnimationComponent>()) {
+            Entity entity = {entityHandle, Project::getScene()};
+            if (entity.getComponent<Component::VertexAnimationComponent>().guid == guid) {
+                entity.getComponent<Component::VertexAnimationComponent>().needsToLoad = true;
+            }
+        }
+        Logger::info("Baked " + std::to_string(vertexAnimation->getNumFrames()) + " frames of " +
+                     std::to_string(vertexAnimation->getNumVertices()) + " vertices into " + path.string());
+        return guid;
+    }
 }
@@ -53,4 +53,76 @@ namespace Dream {
     bool ResourceManager::hasMeshData(const std::string &guid, const std::string &fileID) {
         return meshDataMap.count(std::make_pair(guid, fileID)) > 0;
     }
+
+    std::shared_ptr<const std::map<std::string, BoneInfo>> ResourceManager::getBoneData(const std::string &guid) {
+        return boneDataMap[guid];
+    }
+
+    void ResourceManager::storeBoneData(std::map<std::string, BoneInfo> boneInfoMap, const std::string &guid) {
+        boneDataMap[guid] = std::make_shared<const std::map<std::string, BoneInfo>>(std::move(boneInfoMap));
+    }
+
+    bool ResourceManager::hasBoneData(const std::string &guid) {
+        return boneDataMap.count(guid) > 0;
+    }
+
+    std::shared_ptr<const AnimationSkeleton> ResourceManager::getAnimationSkeleton(const std::string &modelGuid) {
+        return animationSkeletonMap[modelGuid];
+    }
+
+    void ResourceManager::storeAnimationSkeleton(const AnimationSkeleton *skeleton, const std::string &modelGuid) {
+        std::shared_ptr<const AnimationSkeleton> ptr(skeleton);
+        animationSkeletonMap[modelGuid] = ptr;
+    }
+
+    bool ResourceManager::hasAnimationSkeleton(const std::string &modelGuid) {
+        return animationSkeletonMap.count(modelGuid) > 0;
+    }
+
+    std::shared_ptr<const AnimationClip> ResourceManager::getAnimationClip(const std::string &guid, const std::string &modelGuid) {
+        return animationClipMap[std::make_pair(guid, modelGuid)];
+    }
+
+    void ResourceManager::storeAnimationClip(const AnimationClip *clip, const std::string &guid, const std::string &modelGuid) {
+        std::shared_ptr<const AnimationClip> ptr(clip);
+        animationClipMap[std::make_pair(guid, modelGuid)] = ptr;
+    }
+
+    bool ResourceManager::hasAnimationClip(const std::string &guid, const std::string &modelGuid) {
+        return animationClipMap.count(std::make_pair(guid, modelGuid)) > 0;
+    }
+
+    std::shared_ptr<const AnimatorController> ResourceManager::getAnimatorController(const std::string &guid) {
+        return animatorControllerMap[guid];
+    }
+
+    void ResourceManager::storeAnimatorController(const AnimatorController *controller, const std::string &guid) {
+        std::shared_ptr<const AnimatorController> ptr(controller);
+        animatorControllerMap[guid] = ptr;
+    }
+
+    bool ResourceManager::hasAnimatorController(const std::string &guid) {
+        return animatorControllerMap.count(guid) > 0;
+    }
+
+    void ResourceManager::removeAnimatorController(const std::string &guid) {
+        animatorControllerMap.erase(guid);
+    }
+
+    std::shared_ptr<const VertexAnimationTexture> ResourceManager::getVertexAnimation(const std::string &guid) {
+        return vertexAnimationMap[guid];
+    }
+
+    void ResourceManager::storeVertexAnimation(const VertexAnimationTexture *vertexAnimation, const std::string &guid) {
+        std::shared_ptr<const VertexAnimationTexture> ptr(vertexAnimation);
+        vertexAnimationMap[guid] = ptr;
+    }
+
+    bool ResourceManager::hasVertexAnimation(const std::string &guid) {
+        return vertexAnimationMap.count(guid) > 0;
+    }
+
+    void ResourceManager::removeVertexAnimation(const std::string &guid) {
+        vertexAnimationMap.erase(guid);
+    }
 }
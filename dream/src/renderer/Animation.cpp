@@ -72,7 +72,9 @@ namespace Dream {
     void Animation::readMissingBones(const aiAnimation *animation, Entity &modelEntity) {
         int size = animation->mNumChannels;
 
-        auto &boneInfoMap = modelEntity.getComponent<Component::MeshComponent>().m_BoneInfoMap;//getting m_BoneInfoMap from Model class
+        static const std::map<std::string, BoneInfo> noBones;
+        auto &meshBoneInfoMap = modelEntity.getComponent<Component::MeshComponent>().m_BoneInfoMap;//getting m_BoneInfoMap from Model class
+        const auto &boneInfoMap = meshBoneInfoMap ? *meshBoneInfoMap : noBones;
         int &boneCount = modelEntity.getComponent<Component::MeshComponent>().m_BoneCount; //getting the m_BoneCounter from Model class
 
         //reading channels(bones engaged in an animation and their keyframes)
@@ -87,7 +89,10 @@ namespace Dream {
 //                boneCount++;
 //            }
 
-            bones.emplace_back(channel->mNodeName.data, boneInfoMap[channel->mNodeName.data].id, channel);
+            // the bone map is shared by every instance of the model, so channels for nodes that are not bones
+            // (ex: helper nodes) are not added to it
+            auto boneInfo = boneInfoMap.find(boneName);
+            bones.emplace_back(channel->mNodeName.data, boneInfo != boneInfoMap.end() ? boneInfo->second.id : -1, channel);
         }
 
         animationBoneInfoMap = boneInfoMap;
@@ -98,6 +98,18 @@ namespace Dream {
         assert(0);
     }
 
+    const std::vector<KeyPosition> &AnimationBone::getPositions() const {
+        return positions;
+    }
+
+    const std::vector<KeyRotation> &AnimationBone::getRotations() const {
+        return rotations;
+    }
+
+    const std::vector<KeyScale> &AnimationBone::getScales() const {
+        return scales;
+    }
+
     float AnimationBone::getScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime) {
         float scaleFactor = 0.0f;
         float midWayLength = animationTime - lastTimeStamp;
@@ -0,0 +1,365 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include "dream/renderer/Animation.h"
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    namespace {
+        const float maxSmallestThree = 0.70710678f;  // sqrt(0.5), largest value of a component that is not the largest
+
+        void collectNodeTransforms(const AssimpNodeData &node, std::map<std::string, glm::mat4> &transforms) {
+            transforms.emplace(node.name, node.transformation);
+            for (const auto &child: node.children) {
+                collectNodeTransforms(child, transforms);
+            }
+        }
+
+        float getRotationError(const glm::quat &a, const glm::quat &b) {
+            float cosHalfAngle = std::min(std::abs(glm::dot(glm::normalize(a), glm::normalize(b))), 1.0f);
+            return 2.0f * std::acos(cosHalfAngle);
+        }
+
+        /**
+         * Cheaper measure of how far apart two unit quaternions are than getRotationError(), 1 - cos(angle / 2)
+         */
+        float getRotationDistance(const glm::quat &a, const glm::quat &b) {
+            return 1.0f - std::min(std::abs(glm::dot(a, b)), 1.0f);
+        }
+
+        /**
+         * Greedily drop keys that interpolating between the surrounding kept keys reproduces within the tolerance
+         * @return indices of the keys to keep
+         */
+        template<typename Key, typename Interpolate, typename Error>
+        std::vector<int> reduceKeys(const std::vector<Key> &keys, float tolerance, Interpolate interpolate, Error error) {
+            int numKeys = (int) keys.size();
+            bool constant = true;
+            for (int key = 1; key < numKeys && constant; key++) {
+                constant = error(keys[0], keys[key]) <= tolerance;
+            }
+            if (numKeys <= 1 || constant) {
+                return {0};
+            }
+            std::vector<int> kept = {0};
+            int anchor = 0;
+            for (int candidate = 2; candidate < numKeys; candidate++) {
+                float span = keys[candidate].timeStamp - keys[anchor].timeStamp;
+                for (int key = anchor + 1; key < candidate; key++) {
+                    float factor = span > 0.0f ? (keys[key].timeStamp - keys[anchor].timeStamp) / span : 0.0f;
+                    if (error(interpolate(keys[anchor], keys[candidate], factor), keys[key]) > tolerance) {
+                        // the previous key is needed, start a new span from it
+                        anchor = candidate - 1;
+                        kept.push_back(anchor);
+                        break;
+                    }
+                }
+            }
+            kept.push_back(numKeys - 1);
+            return kept;
+        }
+    }
+
+    AnimationClip::AnimationClip(Animation &animation, const AnimationSkeleton &skeleton, AnimationCompressionSettings settings) {
+        name = animation.getName();
+        duration = animation.getDuration();
+        ticksPerSecond = animation.getTicksPerSecond();
+
+        // nodes without keyframes keep the transform they have in the file of this clip
+        std::map<std::string, glm::mat4> nodeTransforms;
+        collectNodeTransforms(animation.getRootNode(), nodeTransforms);
+
+        std::vector<SourceTrack> tracks(skeleton.getNumJoints());
+        for (int joint = 0; joint < skeleton.getNumJoints(); joint++) {
+            const auto &jointName = skeleton.getJointName(joint);
+            auto nodeTransform = nodeTransforms.find(jointName);
+            tracks[joint].restTransform = nodeTransform != nodeTransforms.end() ? nodeTransform->second : skeleton.getRestTransform(joint);
+            if (AnimationBone *bone = animation.findBone(jointName)) {
+                tracks[joint].animated = true;
+                tracks[joint].positions = bone->getPositions();
+                tracks[joint].rotations = bone->getRotations();
+                tracks[joint].numScales = (int) bone->getScales().size();
+            }
+        }
+        compile(tracks, settings);
+        Logger::debug("Compressed animation " + name + " from " + std::to_string(stats.sourceBytes) + " to " +
+                      std::to_string(stats.compressedBytes) + " bytes (" + std::to_string(stats.sourceKeys) + " to " +
+                      std::to_string(stats.compressedKeys) + " keys, " + std::to_string(stats.constantTracks) +
+                      " constant tracks), max error " + std::to_string(stats.maxTranslationError) + " units " +
+                      std::to_string(stats.maxRotationError) + " radians");
+    }
+
+    AnimationClip::AnimationClip(std::string name, float duration, float ticksPerSecond,
+                                 const std::vector<SourceTrack> &tracks, AnimationCompressionSettings settings)
+            : name(std::move(name)), duration(duration), ticksPerSecond(ticksPerSecond) {
+        compile(tracks, settings);
+    }
+
+    void AnimationClip::compile(const std::vector<SourceTrack> &tracks, AnimationCompressionSettings settings) {
+        timeScale = duration > 0.0f ? 65535.0f / duration : 0.0f;
+        auto quantizeTime = [this](float time) {
+            return (uint16_t) std::lround(std::clamp(time * timeScale, 0.0f, 65535.0f));
+        };
+
+        int numJoints = (int) tracks.size();
+        animated.resize(numJoints, false);
+        restTranslations.resize(numJoints);
+        restRotations.resize(numJoints);
+        translationTracks.resize(numJoints);
+        rotationTracks.resize(numJoints);
+        stats = {};
+        for (int joint = 0; joint < numJoints; joint++) {
+            const SourceTrack &track = tracks[joint];
+            // scale is not part of a pose, blending poses has always dropped it
+            const glm::mat4 &restTransform = track.restTransform;
+            restTranslations[joint] = glm::vec3(restTransform[3]);
+            restRotations[joint] = glm::normalize(glm::quat_cast(glm::mat3(glm::normalize(glm::vec3(restTransform[0])),
+                                                                           glm::normalize(glm::vec3(restTransform[1])),
+                                                                           glm::normalize(glm::vec3(restTransform[2])))));
+            animated[joint] = track.animated;
+            stats.sourceKeys += (int) (track.positions.size() + track.rotations.size()) + track.numScales;
+            stats.sourceBytes += track.positions.size() * sizeof(KeyPosition) + track.rotations.size() * sizeof(KeyRotation) +
+                                 track.numScales * sizeof(KeyScale);
+
+            if (!track.positions.empty()) {
+                auto kept = reduceKeys(track.positions, settings.translationTolerance,
+                                       [](const KeyPosition &a, const KeyPosition &b, float factor) {
+                                           return KeyPosition{.position=glm::mix(a.position, b.position, factor)};
+                                       },
+                                       [](const KeyPosition &a, const KeyPosition &b) {
+                                           return glm::length(a.position - b.position);
+                                       });
+                auto &translationTrack = translationTracks[joint];
+                translationTrack.firstKey = (int) translationTimes.size();
+                translationTrack.numKeys = (int) kept.size();
+                glm::vec3 max = track.positions[kept[0]].position;
+                translationTrack.min = max;
+                for (int key: kept) {
+                    translationTrack.min = glm::min(translationTrack.min, track.positions[key].position);
+                    max = glm::max(max, track.positions[key].position);
+                }
+                translationTrack.extent = max - translationTrack.min;
+                for (int key: kept) {
+                    translationTimes.push_back(quantizeTime(track.positions[key].timeStamp));
+                    glm::vec3 normalized = (track.positions[key].position - translationTrack.min) / glm::max(translationTrack.extent, glm::vec3(1e-12f));
+                    for (int i = 0; i < 3; i++) {
+                        translationValues.push_back((uint16_t) std::lround(std::clamp(normalized[i], 0.0f, 1.0f) * 65535.0f));
+                    }
+                }
+                stats.constantTracks += kept.size() == 1 && track.positions.size() > 1 ? 1 : 0;
+            }
+
+            if (!track.rotations.empty()) {
+                // keep neighboring keys in the same hemisphere so interpolating them takes the short way around
+                std::vector<KeyRotation> rotations = track.rotations;
+                for (int key = 0; key < rotations.size(); key++) {
+                    rotations[key].orientation = glm::normalize(rotations[key].orientation);
+                    if (key > 0 && glm::dot(rotations[key - 1].orientation, rotations[key].orientation) < 0.0f) {
+                        rotations[key].orientation = -rotations[key].orientation;
+                    }
+                }
+                // acos is too imprecise near 1 to tell apart angles close to the tolerance, so keys are compared by
+                // the cosine of the half angle instead
+                float rotationTolerance = 1.0f - std::cos(settings.rotationTolerance * 0.5f);
+                auto kept = reduceKeys(rotations, rotationTolerance,
+                                       [](const KeyRotation &a, const KeyRotation &b, float factor) {
+                                           return KeyRotation{.orientation=glm::slerp(a.orientation, b.orientation, factor)};
+                                       },
+                                       [](const KeyRotation &a, const KeyRotation &b) {
+                                           return getRotationDistance(a.orientation, b.orientation);
+                                       });
+                auto &rotationTrack = rotationTracks[joint];
+                rotationTrack.firstKey = (int) rotationTimes.size();
+                rotationTrack.numKeys = (int) kept.size();
+                for (int key: kept) {
+                    rotationTimes.push_back(quantizeTime(rotations[key].timeStamp));
+                    // smallest three: the largest component is made positive and rebuilt from the other three
+                    glm::quat q = rotations[key].orientation;
+                    float components[4] = {q.x, q.y, q.z, q.w};
+                    int largest = 0;
+                    for (int i = 1; i < 4; i++) {
+                        if (std::abs(components[i]) > std::abs(components[largest])) {
+                            largest = i;
+                        }
+                    }
+                    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+                    uint16_t packed[3];
+                    for (int i = 0, j = 0; i < 4; i++) {
+                        if (i != largest) {
+                            float normalized = std::clamp(sign * components[i] / maxSmallestThree * 0.5f + 0.5f, 0.0f, 1.0f);
+                            packed[j++] = (uint16_t) std::lround(normalized * 32767.0f);
+                        }
+                    }
+                    // index of the dropped component goes in the spare top bits
+                    rotationValues.push_back(packed[0] | (uint16_t) ((largest >> 1) << 15));
+                    rotationValues.push_back(packed[1] | (uint16_t) ((largest & 1) << 15));
+                    rotationValues.push_back(packed[2]);
+                }
+                stats.constantTracks += kept.size() == 1 && track.rotations.size() > 1 ? 1 : 0;
+            }
+        }
+
+        stats.compressedKeys = (int) (translationTimes.size() + rotationTimes.size());
+        stats.compressedBytes = (translationTimes.size() + translationValues.size() + rotationTimes.size() + rotationValues.size()) * sizeof(uint16_t) +
+                                translationTracks.size() * sizeof(TranslationTrack) + rotationTracks.size() * sizeof(RotationTrack) +
+                                restTranslations.size() * sizeof(glm::vec3) + restRotations.size() * sizeof(glm::quat) +
+                                (animated.size() + 7) / 8;
+        measureError(tracks);
+    }
+
+    void AnimationClip::measureError(const std::vector<SourceTrack> &tracks) {
+        Cursor cursor;
+        initCursor(cursor);
+        for (int joint = 0; joint < tracks.size(); joint++) {
+            const auto &translationTrack = translationTracks[joint];
+            for (const auto &key: tracks[joint].positions) {
+                const uint16_t *times = translationTimes.data() + translationTrack.firstKey;
+                int k = findKey(times, translationTrack.numKeys, key.timeStamp * timeScale, cursor.translationKeys[joint]);
+                glm::vec3 value = decodeTranslation(translationTrack, k);
+                if (k + 1 < translationTrack.numKeys) {
+                    value = glm::mix(value, decodeTranslation(translationTrack, k + 1), getInterpolationFactor(times, k, key.timeStamp * timeScale));
+                }
+                stats.maxTranslationError = std::max(stats.maxTranslationError, glm::length(value - key.position));
+            }
+            const auto &rotationTrack = rotationTracks[joint];
+            for (const auto &key: tracks[joint].rotations) {
+                const uint16_t *times = rotationTimes.data() + rotationTrack.firstKey;
+                int k = findKey(times, rotationTrack.numKeys, key.timeStamp * timeScale, cursor.rotationKeys[joint]);
+                glm::quat value = decodeRotation(rotationTrack.firstKey + k);
+                if (k + 1 < rotationTrack.numKeys) {
+                    value = glm::slerp(value, decodeRotation(rotationTrack.firstKey + k + 1), getInterpolationFactor(times, k, key.timeStamp * timeScale));
+                }
+                stats.maxRotationError = std::max(stats.maxRotationError, getRotationError(value, key.orientation));
+            }
+        }
+    }
+
+    const std::string &AnimationClip::getName() const {
+        return name;
+    }
+
+    float AnimationClip::getDuration() const {
+        return duration;
+    }
+
+    float AnimationClip::getTicksPerSecond() const {
+        return ticksPerSecond;
+    }
+
+    int AnimationClip::getNumJoints() const {
+        return (int) animated.size();
+    }
+
+    bool AnimationClip::isJointAnimated(int joint) const {
+        return animated.at(joint);
+    }
+
+    const AnimationClip::CompressionStats &AnimationClip::getCompressionStats() const {
+        return stats;
+    }
+
+    void AnimationClip::initCursor(Cursor &cursor) const {
+        cursor.translationKeys.assign(animated.size(), 0);
+        cursor.rotationKeys.assign(animated.size(), 0);
+    }
+
+    void AnimationClip::sample(float time, Cursor &cursor, glm::vec3 *translations, glm::quat *rotations) const {
+        float quantizedTime = time * timeScale;
+        for (int joint = 0; joint < animated.size(); joint++) {
+            const TranslationTrack &translationTrack = translationTracks[joint];
+            if (translationTrack.numKeys == 0) {
+                translations[joint] = restTranslations[joint];
+            } else {
+                const uint16_t *times = translationTimes.data() + translationTrack.firstKey;
+                int key = findKey(times, translationTrack.numKeys, quantizedTime, cursor.translationKeys[joint]);
+                if (key + 1 < translationTrack.numKeys) {
+                    translations[joint] = glm::mix(decodeTranslation(translationTrack, key), decodeTranslation(translationTrack, key + 1),
+                                                   getInterpolationFactor(times, key, quantizedTime));
+                } else {
+                    translations[joint] = decodeTranslation(translationTrack, key);
+                }
+            }
+
+            const RotationTrack &rotationTrack = rotationTracks[joint];
+            if (rotationTrack.numKeys == 0) {
+                rotations[joint] = restRotations[joint];
+            } else {
+                const uint16_t *times = rotationTimes.data() + rotationTrack.firstKey;
+                int key = findKey(times, rotationTrack.numKeys, quantizedTime, cursor.rotationKeys[joint]);
+                if (key + 1 < rotationTrack.numKeys) {
+                    rotations[joint] = glm::normalize(glm::slerp(decodeRotation(rotationTrack.firstKey + key), decodeRotation(rotationTrack.firstKey + key + 1),
+                                                                 getInterpolationFactor(times, key, quantizedTime)));
+                } else {
+                    rotations[joint] = decodeRotation(rotationTrack.firstKey + key);
+                }
+            }
+        }
+    }
+
+    glm::vec3 AnimationClip::decodeTranslation(const TranslationTrack &track, int key) const {
+        const uint16_t *value = translationValues.data() + (track.firstKey + key) * 3;
+        return track.min + track.extent * glm::vec3(value[0], value[1], value[2]) * (1.0f / 65535.0f);
+    }
+
+    glm::quat AnimationClip::decodeRotation(int key) const {
+        const uint16_t *value = rotationValues.data() + key * 3;
+        int largest = (value[0] >> 15) << 1 | (value[1] >> 15);
+        float smallest[3];
+        float sumOfSquares = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            smallest[i] = ((float) (value[i] & 0x7FFF) * (1.0f / 32767.0f) * 2.0f - 1.0f) * maxSmallestThree;
+            sumOfSquares += smallest[i] * smallest[i];
+        }
+        float components[4];
+        for (int i = 0, j = 0; i < 4; i++) {
+            components[i] = i == largest ? std::sqrt(std::max(1.0f - sumOfSquares, 0.0f)) : smallest[j++];
+        }
+        return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+    }
+
+    int AnimationClip::findKey(const uint16_t *times, int numKeys, float time, int &cursor) {
+        int key = std::clamp(cursor, 0, numKeys - 1);
+        if (times[key] <= time && (key + 1 >= numKeys || time < times[key + 1])) {
+            // same keyframe as last time
+        } else if (key + 2 < numKeys && times[key + 1] <= time && time < times[key + 2]) {
+            // next keyframe
+            key++;
+        } else {
+            // playback jumped (looped, blended in or skipped frames), last keyframe at or before the time
+            key = (int) (std::upper_bound(times, times + numKeys, time,
+                                          [](float time, uint16_t keyTime) { return time < (float) keyTime; }) - times) - 1;
+            key = std::max(key, 0);
+        }
+        cursor = key;
+        return key;
+    }
+
+    float AnimationClip::getInterpolationFactor(const uint16_t *times, int key, float quantizedTime) {
+        float framesDiff = (float) times[key + 1] - (float) times[key];
+        if (framesDiff <= 0.0f) {
+            return 0.0f;
+        }
+        return std::clamp((quantizedTime - (float) times[key]) / framesDiff, 0.0f, 1.0f);
+    }
+}
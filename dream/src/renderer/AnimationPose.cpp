@@ -0,0 +1,126 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/AnimationPose.h"
+
+#include <utility>
+
+namespace Dream {
+    void AnimationPose::resize(int numJoints) {
+        translations.resize(numJoints);
+        rotations.resize(numJoints);
+    }
+
+    void AnimationPose::blend(const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                              glm::quat *outRotations, int numJoints, float weight, const float *mask) {
+        if (mask) {
+            for (int joint = 0; joint < numJoints; joint++) {
+                float jointWeight = weight * mask[joint];
+                outTranslations[joint] += (translations[joint] - outTranslations[joint]) * jointWeight;
+                // take the short way around
+                float otherWeight = glm::dot(outRotations[joint], rotations[joint]) < 0.0f ? -jointWeight : jointWeight;
+                glm::quat blended = outRotations[joint] * (1.0f - jointWeight) + rotations[joint] * otherWeight;
+                outRotations[joint] = blended * glm::inversesqrt(glm::dot(blended, blended));
+            }
+            return;
+        }
+        for (int joint = 0; joint < numJoints; joint++) {
+            outTranslations[joint] += (translations[joint] - outTranslations[joint]) * weight;
+        }
+        for (int joint = 0; joint < numJoints; joint++) {
+            float otherWeight = glm::dot(outRotations[joint], rotations[joint]) < 0.0f ? -weight : weight;
+            glm::quat blended = outRotations[joint] * (1.0f - weight) + rotations[joint] * otherWeight;
+            outRotations[joint] = blended * glm::inversesqrt(glm::dot(blended, blended));
+        }
+    }
+
+    void AnimationPose::accumulate(const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                                   glm::quat *outRotations, int numJoints, float weight) {
+        for (int joint = 0; joint < numJoints; joint++) {
+            outTranslations[joint] += translations[joint] * weight;
+        }
+        for (int joint = 0; joint < numJoints; joint++) {
+            float rotationWeight = glm::dot(outRotations[joint], rotations[joint]) < 0.0f ? -weight : weight;
+            outRotations[joint] += rotations[joint] * rotationWeight;
+        }
+    }
+
+    void AnimationPose::normalizeRotations(glm::quat *rotations, int numJoints) {
+        for (int joint = 0; joint < numJoints; joint++) {
+            rotations[joint] = rotations[joint] * glm::inversesqrt(glm::dot(rotations[joint], rotations[joint]));
+        }
+    }
+
+    void AnimationPose::addAdditive(const glm::vec3 *referenceTranslations, const glm::quat *referenceRotations,
+                                    const glm::vec3 *translations, const glm::quat *rotations, glm::vec3 *outTranslations,
+                                    glm::quat *outRotations, int numJoints, float weight, const float *mask) {
+        const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+        for (int joint = 0; joint < numJoints; joint++) {
+            float jointWeight = mask ? weight * mask[joint] : weight;
+            outTranslations[joint] += (translations[joint] - referenceTranslations[joint]) * jointWeight;
+            // scale the difference by blending it with the identity rotation
+            glm::quat difference = glm::conjugate(referenceRotations[joint]) * rotations[joint];
+            float differenceWeight = difference.w < 0.0f ? -jointWeight : jointWeight;
+            glm::quat scaled = identity * (1.0f - jointWeight) + difference * differenceWeight;
+            scaled = scaled * glm::inversesqrt(glm::dot(scaled, scaled));
+            glm::quat result = outRotations[joint] * scaled;
+            outRotations[joint] = result * glm::inversesqrt(glm::dot(result, result));
+        }
+    }
+
+    AnimationPosePool::Handle::Handle(std::unique_ptr<AnimationPose> pose) : pose(std::move(pose)) {}
+
+    AnimationPosePool::Handle::Handle(Handle &&other) noexcept: pose(std::move(other.pose)) {}
+
+    AnimationPosePool::Handle::~Handle() {
+        if (pose) {
+            getFreePoses().push_back(std::move(pose));
+        }
+    }
+
+    AnimationPose &AnimationPosePool::Handle::operator*() {
+        return *pose;
+    }
+
+    AnimationPose *AnimationPosePool::Handle::operator->() {
+        return pose.get();
+    }
+
+    AnimationPosePool::Handle AnimationPosePool::acquire(int numJoints) {
+        auto &freePoses = getFreePoses();
+        std::unique_ptr<AnimationPose> pose;
+        if (freePoses.empty()) {
+            pose = std::make_unique<AnimationPose>();
+        } else {
+            pose = std::move(freePoses.back());
+            freePoses.pop_back();
+        }
+        // buffers only grow, so once every skeleton was seen acquiring does not allocate
+        pose->resize(numJoints);
+        return Handle(std::move(pose));
+    }
+
+    int AnimationPosePool::getNumFreePoses() {
+        return (int) getFreePoses().size();
+    }
+
+    std::vector<std::unique_ptr<AnimationPose>> &AnimationPosePool::getFreePoses() {
+        thread_local std::vector<std::unique_ptr<AnimationPose>> freePoses;
+        return freePoses;
+    }
+}
@@ -0,0 +1,82 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/AnimationSkeleton.h"
+
+namespace Dream {
+    AnimationSkeleton::AnimationSkeleton(const AssimpNodeData &rootNode, const std::map<std::string, BoneInfo> &boneInfoMap) {
+        addJoint(rootNode, -1, 0, boneInfoMap);
+    }
+
+    int AnimationSkeleton::getNumJoints() const {
+        return (int) names.size();
+    }
+
+    int AnimationSkeleton::findJoint(const std::string &name) const {
+        for (int joint = 0; joint < names.size(); joint++) {
+            if (names[joint] == name) {
+                return joint;
+            }
+        }
+        return -1;
+    }
+
+    const std::string &AnimationSkeleton::getJointName(int joint) const {
+        return names.at(joint);
+    }
+
+    int AnimationSkeleton::getParent(int joint) const {
+        return parents.at(joint);
+    }
+
+    int AnimationSkeleton::getDepth(int joint) const {
+        return depths.at(joint);
+    }
+
+    int AnimationSkeleton::getBoneIndex(int joint) const {
+        return boneIndices.at(joint);
+    }
+
+    const glm::mat4 &AnimationSkeleton::getOffset(int joint) const {
+        return offsets.at(joint);
+    }
+
+    const glm::mat4 &AnimationSkeleton::getRestTransform(int joint) const {
+        return restTransforms.at(joint);
+    }
+
+    void AnimationSkeleton::addJoint(const AssimpNodeData &node, int parent, int depth,
+                                     const std::map<std::string, BoneInfo> &boneInfoMap) {
+        int joint = (int) names.size();
+        names.push_back(node.name);
+        parents.push_back(parent);
+        depths.push_back(depth);
+        restTransforms.push_back(node.transformation);
+        auto boneInfo = boneInfoMap.find(node.name);
+        if (boneInfo != boneInfoMap.end()) {
+            boneIndices.push_back(boneInfo->second.id);
+            offsets.push_back(boneInfo->second.offset);
+        } else {
+            boneIndices.push_back(-1);
+            offsets.emplace_back(1.0f);
+        }
+        for (const auto &child: node.children) {
+            addJoint(child, joint, depth + 1, boneInfoMap);
+        }
+    }
+}
@@ -0,0 +1,409 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/AnimatorController.h"
+
+#include <algorithm>
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    AnimatorController::AnimatorController(const Description &description) {
+        for (const auto &variable: description.variables) {
+            if (parameterIndices.count(variable.Name) > 0) {
+                Logger::warn("Animator has more than one variable named " + variable.Name);
+            } else {
+                parameterIndices[variable.Name] = (int) parameters.size();
+            }
+            parameters.push_back(Parameter{
+                    .name=variable.Name,
+                    .type=variable.Type,
+                    .defaultValue=variable.Value
+            });
+        }
+
+        // transitions are stored grouped by the state they leave from, keeping their order within a state since
+        // the first one that passes is taken
+        for (int state = 0; state < description.states.size(); state++) {
+            const auto &stateDescription = description.states.at(state);
+            states.push_back(State{
+                    .name=stateDescription.Name,
+                    .playOnce=stateDescription.PlayOnce,
+                    .motions=compileMotions(stateDescription),
+                    .firstTransition=(int) transitions.size(),
+                    .numTransitions=0
+            });
+            for (const auto &transitionDescription: description.transitions) {
+                if (transitionDescription.OutputStateID != state) {
+                    continue;
+                }
+                if (transitionDescription.InputStateID < 0 || transitionDescription.InputStateID >= description.states.size()) {
+                    Logger::error("Animator transition from state " + std::to_string(state) + " goes to unknown state " +
+                                  std::to_string(transitionDescription.InputStateID));
+                    continue;
+                }
+                Transition transition = {
+                        .targetState=transitionDescription.InputStateID,
+                        .blend=transitionDescription.Blend,
+                        .firstCondition=(int) conditions.size(),
+                        .numConditions=(int) transitionDescription.Conditions.size(),
+                        .readsTriggers=false
+                };
+                for (const auto &conditionDescription: transitionDescription.Conditions) {
+                    bool valid;
+                    Condition condition = {
+                            .parameter1=validParameter(conditionDescription.Variable1Idx),
+                            .value1=conditionDescription.Variable1,
+                            .comparison=parseComparison(conditionDescription.Operator, &valid),
+                            .parameter2=validParameter(conditionDescription.Variable2Idx),
+                            .value2=conditionDescription.Variable2
+                    };
+                    if (!valid) {
+                        Logger::error("Unknown operator for animator state machine " + conditionDescription.Operator);
+                    }
+                    for (int parameter: {condition.parameter1, condition.parameter2}) {
+                        if (parameter != -1 && parameters.at(parameter).type == ParameterType::TRIGGER) {
+                            transition.readsTriggers = true;
+                        }
+                    }
+                    conditions.push_back(condition);
+                }
+                transitions.push_back(transition);
+                states.back().numTransitions++;
+            }
+        }
+
+        for (const auto &layerDescription: description.layers) {
+            layers.push_back(Layer{
+                    .name=layerDescription.Name,
+                    .playOnce=layerDescription.Motion.PlayOnce,
+                    .motions=compileMotions(layerDescription.Motion),
+                    .mask=layerDescription.Mask,
+                    .additive=layerDescription.Additive,
+                    .weightParameter=validParameter(layerDescription.WeightVariableIdx),
+                    .weight=layerDescription.Weight
+            });
+        }
+    }
+
+    AnimatorController::BlendTree AnimatorController::compileMotions(const Description::State &state) {
+        BlendTree tree = {
+                .type=state.BlendType,
+                .parameterX=validParameter(state.BlendVariable1Idx),
+                .parameterY=validParameter(state.BlendVariable2Idx),
+                .firstMotion=(int) motions.size(),
+                .numMotions=0
+        };
+        if (tree.type == BlendTreeType::NONE || state.Motions.empty()) {
+            tree.type = BlendTreeType::NONE;
+            motions.push_back(Motion{
+                    .guid=state.Guid,
+                    .position=glm::vec2(0.0f)
+            });
+        } else {
+            for (const auto &motion: state.Motions) {
+                motions.push_back(Motion{
+                        .guid=motion.Guid,
+                        .position=glm::vec2(motion.X, motion.Y)
+                });
+            }
+        }
+        tree.numMotions = (int) motions.size() - tree.firstMotion;
+        if (tree.type == BlendTreeType::SIMPLE_1D) {
+            std::stable_sort(motions.begin() + tree.firstMotion, motions.end(), [](const Motion &a, const Motion &b) {
+                return a.position.x < b.position.x;
+            });
+        }
+        return tree;
+    }
+
+    int AnimatorController::validParameter(int parameter) const {
+        if (parameter >= (int) parameters.size()) {
+            Logger::error("Animator uses unknown variable " + std::to_string(parameter));
+            return -1;
+        }
+        return parameter;
+    }
+
+    AnimatorController::Comparison AnimatorController::parseComparison(const std::string &op, bool *valid) {
+        if (valid) {
+            *valid = true;
+        }
+        if (op == "==") {
+            return Comparison::EQUAL;
+        } else if (op == "!=") {
+            return Comparison::NOT_EQUAL;
+        } else if (op == ">") {
+            return Comparison::GREATER;
+        } else if (op == "<") {
+            return Comparison::LESS;
+        } else if (op == ">=") {
+            return Comparison::GREATER_EQUAL;
+        } else if (op == "<=") {
+            return Comparison::LESS_EQUAL;
+        }
+        if (valid) {
+            *valid = false;
+        }
+        return Comparison::EQUAL;
+    }
+
+    const char *AnimatorController::getParameterTypeName(ParameterType type) {
+        switch (type) {
+            case ParameterType::INT:
+                return "Int";
+            case ParameterType::FLOAT:
+                return "Float";
+            case ParameterType::BOOL:
+                return "Bool";
+            case ParameterType::TRIGGER:
+                return "Trigger";
+        }
+        return "Int";
+    }
+
+    const char *AnimatorController::getBlendTreeTypeName(BlendTreeType type) {
+        switch (type) {
+            case BlendTreeType::NONE:
+                return "None";
+            case BlendTreeType::SIMPLE_1D:
+                return "1D";
+            case BlendTreeType::FREEFORM_2D:
+                return "2D";
+        }
+        return "None";
+    }
+
+    AnimatorController::BlendTreeType AnimatorController::parseBlendTreeType(const std::string &name) {
+        for (auto type: {BlendTreeType::NONE, BlendTreeType::SIMPLE_1D, BlendTreeType::FREEFORM_2D}) {
+            if (name == getBlendTreeTypeName(type)) {
+                return type;
+            }
+        }
+        Logger::warn("Unknown animator blend tree type " + name);
+        return BlendTreeType::NONE;
+    }
+
+    AnimatorController::ParameterType AnimatorController::parseParameterType(const std::string &name) {
+        for (auto type: {ParameterType::INT, ParameterType::FLOAT, ParameterType::BOOL, ParameterType::TRIGGER}) {
+            if (name == getParameterTypeName(type)) {
+                return type;
+            }
+        }
+        Logger::warn("Unknown animator variable type " + name);
+        return ParameterType::INT;
+    }
+
+    void AnimatorController::removeVariable(Description &description, int variable) {
+        if (variable < 0 || variable >= description.variables.size()) {
+            return;
+        }
+        description.variables.erase(description.variables.begin() + variable);
+        auto updateIndex = [variable](int &index) {
+            if (index == variable) {
+                index = -1;
+            } else if (index > variable) {
+                index--;
+            }
+        };
+        for (auto &transition: description.transitions) {
+            // remove conditions that rely on this variable
+            for (int j = (int) transition.Conditions.size() - 1; j >= 0; --j) {
+                if (transition.Conditions[j].Variable1Idx == variable ||
+                    transition.Conditions[j].Variable2Idx == variable) {
+                    transition.Conditions.erase(transition.Conditions.begin() + j);
+                }
+            }
+            for (auto &condition: transition.Conditions) {
+                updateIndex(condition.Variable1Idx);
+                updateIndex(condition.Variable2Idx);
+            }
+        }
+        for (auto &state: description.states) {
+            updateIndex(state.BlendVariable1Idx);
+            updateIndex(state.BlendVariable2Idx);
+        }
+        for (auto &layer: description.layers) {
+            updateIndex(layer.Motion.BlendVariable1Idx);
+            updateIndex(layer.Motion.BlendVariable2Idx);
+            updateIndex(layer.WeightVariableIdx);
+        }
+    }
+
+    int AnimatorController::getNumStates() const {
+        return (int) states.size();
+    }
+
+    const AnimatorController::State &AnimatorController::getState(int state) const {
+        return states.at(state);
+    }
+
+    const AnimatorController::Transition &AnimatorController::getTransition(int transition) const {
+        return transitions.at(transition);
+    }
+
+    int AnimatorController::getNumMotions() const {
+        return (int) motions.size();
+    }
+
+    const AnimatorController::Motion &AnimatorController::getMotion(int motion) const {
+        return motions.at(motion);
+    }
+
+    int AnimatorController::getNumLayers() const {
+        return (int) layers.size();
+    }
+
+    const AnimatorController::Layer &AnimatorController::getLayer(int layer) const {
+        return layers.at(layer);
+    }
+
+    float AnimatorController::getLayerWeight(int layer, const float *values) const {
+        const Layer &l = layers[layer];
+        float weight = l.weightParameter != -1 ? l.weight * values[l.weightParameter] : l.weight;
+        return std::clamp(weight, 0.0f, 1.0f);
+    }
+
+    void AnimatorController::getMotionWeights(const BlendTree &tree, const float *values, float *weights) const {
+        const Motion *treeMotions = motions.data() + tree.firstMotion;
+        float *treeWeights = weights + tree.firstMotion;
+        std::fill(treeWeights, treeWeights + tree.numMotions, 0.0f);
+        if (tree.type == BlendTreeType::NONE || tree.numMotions == 1) {
+            treeWeights[0] = 1.0f;
+            return;
+        }
+        glm::vec2 point(tree.parameterX != -1 ? values[tree.parameterX] : 0.0f,
+                        tree.parameterY != -1 ? values[tree.parameterY] : 0.0f);
+        if (tree.type == BlendTreeType::SIMPLE_1D) {
+            // motions are sorted, blend the two on either side of the parameter (clamped to the ends)
+            if (point.x <= treeMotions[0].position.x) {
+                treeWeights[0] = 1.0f;
+                return;
+            }
+            for (int i = 0; i + 1 < tree.numMotions; i++) {
+                float start = treeMotions[i].position.x;
+                float end = treeMotions[i + 1].position.x;
+                if (point.x < end) {
+                    float t = end > start ? (point.x - start) / (end - start) : 1.0f;
+                    treeWeights[i] = 1.0f - t;
+                    treeWeights[i + 1] = t;
+                    return;
+                }
+            }
+            treeWeights[tree.numMotions - 1] = 1.0f;
+            return;
+        }
+        // gradient band interpolation, each motion is weighted by how far the point is from it towards every other
+        // motion (0 once the point is past another motion), which stays smooth for arbitrary layouts
+        float totalWeight = 0.0f;
+        for (int i = 0; i < tree.numMotions; i++) {
+            glm::vec2 fromMotion = point - treeMotions[i].position;
+            float weight = 1.0f;
+            for (int j = 0; j < tree.numMotions && weight > 0.0f; j++) {
+                if (i == j) {
+                    continue;
+                }
+                glm::vec2 toOther = treeMotions[j].position - treeMotions[i].position;
+                float lengthSquared = glm::dot(toOther, toOther);
+                if (lengthSquared > 0.0f) {
+                    weight = std::min(weight, std::clamp(1.0f - glm::dot(fromMotion, toOther) / lengthSquared, 0.0f, 1.0f));
+                }
+            }
+            treeWeights[i] = weight;
+            totalWeight += weight;
+        }
+        if (totalWeight <= 0.0f) {
+            treeWeights[0] = 1.0f;
+            return;
+        }
+        for (int i = 0; i < tree.numMotions; i++) {
+            treeWeights[i] /= totalWeight;
+        }
+    }
+
+    int AnimatorController::getNumParameters() const {
+        return (int) parameters.size();
+    }
+
+    const AnimatorController::Parameter &AnimatorController::getParameter(int parameter) const {
+        return parameters.at(parameter);
+    }
+
+    int AnimatorController::findParameter(const std::string &name) const {
+        auto iter = parameterIndices.find(name);
+        return iter != parameterIndices.end() ? iter->second : -1;
+    }
+
+    void AnimatorController::initParameters(std::vector<float> &values) const {
+        values.resize(parameters.size());
+        for (int i = 0; i < parameters.size(); i++) {
+            values[i] = parameters[i].defaultValue;
+        }
+    }
+
+    int AnimatorController::findTransition(int state, const float *values) const {
+        const State &source = states[state];
+        for (int t = source.firstTransition; t < source.firstTransition + source.numTransitions; t++) {
+            const Transition &transition = transitions[t];
+            bool allConditionsPassed = true;
+            for (int c = transition.firstCondition; c < transition.firstCondition + transition.numConditions; c++) {
+                if (!evaluate(conditions[c], values)) {
+                    allConditionsPassed = false;
+                    break;
+                }
+            }
+            if (allConditionsPassed) {
+                return t;
+            }
+        }
+        return -1;
+    }
+
+    void AnimatorController::consumeTriggers(int transition, float *values) const {
+        const Transition &taken = transitions[transition];
+        if (!taken.readsTriggers) {
+            return;
+        }
+        for (int c = taken.firstCondition; c < taken.firstCondition + taken.numConditions; c++) {
+            for (int parameter: {conditions[c].parameter1, conditions[c].parameter2}) {
+                if (parameter != -1 && parameters[parameter].type == ParameterType::TRIGGER) {
+                    values[parameter] = 0.0f;
+                }
+            }
+        }
+    }
+
+    bool AnimatorController::evaluate(const Condition &condition, const float *values) const {
+        float value1 = condition.parameter1 != -1 ? values[condition.parameter1] : condition.value1;
+        float value2 = condition.parameter2 != -1 ? values[condition.parameter2] : condition.value2;
+        switch (condition.comparison) {
+            case Comparison::EQUAL:
+                return value1 == value2;
+            case Comparison::NOT_EQUAL:
+                return value1 != value2;
+            case Comparison::GREATER:
+                return value1 > value2;
+            case Comparison::LESS:
+                return value1 < value2;
+            case Comparison::GREATER_EQUAL:
+                return value1 >= value2;
+            case Comparison::LESS_EQUAL:
+                return value1 <= value2;
+        }
+        return false;
+    }
+}
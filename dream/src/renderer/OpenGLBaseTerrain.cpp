@@ -15,6 +15,7 @@
 #include <cerrno>
 #include <string.h>
 #include <fstream>
+#include <algorithm>
 
 //#define STB_IMAGE_IMPLEMENTATION
 //#include <stb_image_write.h>
@@ -74,21 +75,14 @@ namespace Dream {
         textureNormal2->bind(5);
     }
 
-    void OpenGLBaseTerrain::render() {
-//        auto projection = camera.getProjectionMatrix();
-//        auto view = camera.getViewMatrix();
-//        Matrix4f VP = Camera.GetViewProjMatrix();
-
-//        m_terrainTech.enable();
-//        m_terrainTech.SetVP(VP);
-//        m_terrainTech.setProjection(projection);
-//        m_terrainTech.setView(view);
-
-        // TODO: pass in projection and view to shader
-
-
-
-        m_triangleList.render();
+    void OpenGLBaseTerrain::render(const glm::mat4 &model, const glm::mat4 &viewProjection, glm::vec3 cameraPosition,
+                                   int lodBias, bool cullDepth) {
+        glm::vec3 lodOrigin = glm::inverse(model) * glm::vec4(cameraPosition, 1.0f);
+        if (cullDepth) {
+            // passes that cull against the near / far planes are drawn from the camera, shadow maps are not
+            m_tileLoadOrigin = lodOrigin;
+        }
+        m_triangleList.render(viewProjection * model, lodOrigin, lodBias, cullDepth);
     }
 
     void OpenGLBaseTerrain::loadFromFile(const char *pFilename) {
@@ -98,13 +92,17 @@ namespace Dream {
     }
 
     void OpenGLBaseTerrain::refreshTerrainTriangleList() {
-        m_triangleList.createTriangleList(m_terrainSize, m_terrainSize, this);
+        requestTilesNearCamera();
+        if (!m_triangleList.updateDirtyChunks(this)) {
+            return;
+        }
 
+        // chunks track their own height range, so only the chunks need to be scanned
         m_minHeight = 0;
-        for (int x = 0; x < m_terrainSize; x++) {
-            for (int y = 0; y < m_terrainSize; y++) {
-                m_maxHeight = max(m_maxHeight, m_heightMap.Get(x, y));
-            }
+        m_maxHeight = 0;
+        for (const auto &chunk: m_triangleList.getChunks()) {
+            m_minHeight = min(m_minHeight, chunk.minHeight);
+            m_maxHeight = max(m_maxHeight, chunk.maxHeight);
         }
     }
 
@@ -120,28 +118,144 @@ namespace Dream {
     }
 
     void OpenGLBaseTerrain::loadHeightMapFile(const char *pFilename) {
-        int FileSize = 0;
-        unsigned char* p = (unsigned char*)ReadBinaryFile(pFilename, FileSize);
+        if (m_tiledHeightMap.open(pFilename)) {
+            // only the directory is read here, tiles start out flat at their lowest height and are loaded when needed
+            m_terrainSize = m_tiledHeightMap.getSize();
+            m_tileSize = m_tiledHeightMap.getTileSize();
+            m_numTilesPerSide = m_tiledHeightMap.getNumTilesPerSide();
+            m_heightMap.InitArray2D(m_terrainSize, m_terrainSize);
+            m_minHeight = 0;
+            for (int tile = 0; tile < m_tiledHeightMap.getNumTiles(); tile++) {
+                auto tileInfo = m_tiledHeightMap.getTile(tile);
+                int minX, minZ, maxX, maxZ;
+                m_tiledHeightMap.getTileBounds(tile, minX, minZ, maxX, maxZ);
+                for (int z = minZ; z < maxZ; z++) {
+                    std::fill_n(m_heightMap.GetBaseAddr() + z * m_terrainSize + minX, maxX - minX, tileInfo.minHeight);
+                }
+                m_minHeight = min(m_minHeight, tileInfo.minHeight);
+                m_maxHeight = max(m_maxHeight, tileInfo.maxHeight);
+            }
+            m_tileLoaded.assign(m_numTilesPerSide * m_numTilesPerSide, false);
+        } else {
+            // raw 32-bit floats from before height maps were tiled
+            int FileSize = 0;
+            unsigned char* p = (unsigned char*)ReadBinaryFile(pFilename, FileSize);
+
+            if (FileSize % sizeof(float) != 0) {
+                printf("%s:%d - '%s' does not contain an whole number of floats (size %d)\n", __FILE__, __LINE__, pFilename, FileSize);
+                exit(0);
+            }
+
+            m_terrainSize = (int)sqrtf((float)FileSize / (float)sizeof(float));
 
-        if (FileSize % sizeof(float) != 0) {
-            printf("%s:%d - '%s' does not contain an whole number of floats (size %d)\n", __FILE__, __LINE__, pFilename, FileSize);
-            exit(0);
+            if ((m_terrainSize * m_terrainSize) != (FileSize / sizeof(float))) {
+                printf("%s:%d - '%s' does not contain a square height map - size %d\n", __FILE__, __LINE__, pFilename, FileSize);
+                exit(0);
+            }
+
+            m_heightMap.InitArray2D(m_terrainSize, m_terrainSize, (float*)p);
+            m_minHeight = 0;
+            for (int x = 0; x < m_terrainSize; x++) {
+                for (int y = 0; y < m_terrainSize; y++) {
+                    m_maxHeight = max(m_maxHeight, m_heightMap.Get(x, y));
+                }
+            }
+            m_numTilesPerSide = (m_terrainSize + m_tileSize - 1) / m_tileSize;
+            m_tileLoaded.assign(m_numTilesPerSide * m_numTilesPerSide, true);
         }
+        m_tileRequested = m_tileLoaded;
+        m_tileModified.assign(m_numTilesPerSide * m_numTilesPerSide, false);
+        m_heightMapPyramid.build(m_heightMap.GetBaseAddr(), m_terrainSize);
+    }
 
-        m_terrainSize = (int)sqrtf((float)FileSize / (float)sizeof(float));
+    void OpenGLBaseTerrain::onHeightsChanged(int minX, int minZ, int maxX, int maxZ) {
+        // normals of the neighboring vertices depend on these heights as well
+        m_triangleList.markDirty(minX - 1, minZ - 1, maxX + 1, maxZ + 1);
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                m_minHeight = min(m_minHeight, m_heightMap.Get(x, z));
+                m_maxHeight = max(m_maxHeight, m_heightMap.Get(x, z));
+            }
+        }
+        m_heightMapPyramid.update(minX, minZ, maxX, maxZ);
+    }
 
-        if ((m_terrainSize * m_terrainSize) != (FileSize / sizeof(float))) {
-            printf("%s:%d - '%s' does not contain a square height map - size %d\n", __FILE__, __LINE__, pFilename, FileSize);
-            exit(0);
+    void OpenGLBaseTerrain::requestTilesNearCamera() {
+        if (m_tiledHeightMap.getNumTiles() == 0) {
+            return;
+        }
+        for (auto &[tile, tileHeights]: m_tiledHeightMap.takeLoadedTiles()) {
+            // tiles that were loaded synchronously or overwritten while they were loading keep their heights
+            if (m_tileLoaded[tile]) {
+                continue;
+            }
+            int minX, minZ, maxX, maxZ;
+            m_tiledHeightMap.getTileBounds(tile, minX, minZ, maxX, maxZ);
+            for (int z = minZ; z < maxZ; z++) {
+                std::copy_n(tileHeights.data() + (z - minZ) * (maxX - minX), maxX - minX, m_heightMap.GetBaseAddr() + z * m_terrainSize + minX);
+            }
+            m_tileLoaded[tile] = true;
+            onHeightsChanged(minX, minZ, maxX - 1, maxZ - 1);
         }
 
-        m_heightMap.InitArray2D(m_terrainSize, m_terrainSize, (float*)p);
-        m_minHeight = 0;
-        for (int x = 0; x < m_terrainSize; x++) {
-            for (int y = 0; y < m_terrainSize; y++) {
-                m_maxHeight = max(m_maxHeight, m_heightMap.Get(x, y));
+        // request the tiles around the camera, nearest first
+        std::vector<std::pair<float, int>> tilesByDistance;
+        for (int tile = 0; tile < m_tileRequested.size(); tile++) {
+            if (m_tileRequested[tile]) {
+                continue;
+            }
+            int minX, minZ, maxX, maxZ;
+            m_tiledHeightMap.getTileBounds(tile, minX, minZ, maxX, maxZ);
+            glm::vec2 tileMin = glm::vec2(minX, minZ) * m_worldScale;
+            glm::vec2 tileMax = glm::vec2(maxX - 1, maxZ - 1) * m_worldScale;
+            glm::vec2 camera = {m_tileLoadOrigin.x, m_tileLoadOrigin.z};
+            float distance = glm::length(camera - glm::clamp(camera, tileMin, tileMax));
+            if (distance <= m_tileLoadDistance) {
+                tilesByDistance.emplace_back(distance, tile);
             }
         }
+        if (tilesByDistance.empty()) {
+            return;
+        }
+        std::sort(tilesByDistance.begin(), tilesByDistance.end());
+        std::vector<int> tiles;
+        for (const auto &[distance, tile]: tilesByDistance) {
+            tiles.push_back(tile);
+            m_tileRequested[tile] = true;
+        }
+        m_tiledHeightMap.requestTiles(tiles);
+    }
+
+    std::vector<int> OpenGLBaseTerrain::getTiles(int minX, int minZ, int maxX, int maxZ) const {
+        std::vector<int> tiles;
+        int minTileX = std::max(minX, 0) / m_tileSize;
+        int minTileZ = std::max(minZ, 0) / m_tileSize;
+        int maxTileX = std::min(maxX, m_terrainSize - 1) / m_tileSize;
+        int maxTileZ = std::min(maxZ, m_terrainSize - 1) / m_tileSize;
+        for (int tileZ = minTileZ; tileZ <= maxTileZ; tileZ++) {
+            for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
+                tiles.push_back(tileZ * m_numTilesPerSide + tileX);
+            }
+        }
+        return tiles;
+    }
+
+    bool OpenGLBaseTerrain::loadTiles(int minX, int minZ, int maxX, int maxZ) {
+        bool loaded = false;
+        for (int tile: getTiles(minX, minZ, maxX, maxZ)) {
+            if (m_tileLoaded[tile]) {
+                continue;
+            }
+            if (m_tiledHeightMap.readTile(tile, m_heightMap.GetBaseAddr())) {
+                int tileMinX, tileMinZ, tileMaxX, tileMaxZ;
+                m_tiledHeightMap.getTileBounds(tile, tileMinX, tileMinZ, tileMaxX, tileMaxZ);
+                onHeightsChanged(tileMinX, tileMinZ, tileMaxX - 1, tileMaxZ - 1);
+            }
+            m_tileLoaded[tile] = true;
+            m_tileRequested[tile] = true;
+            loaded = true;
+        }
+        return loaded;
     }
 
     float OpenGLBaseTerrain::getSize() const {
@@ -171,23 +285,64 @@ namespace Dream {
     }
 
     void OpenGLBaseTerrain::saveToFile(const char *pFilename) {
-        std::ofstream out;
-        out.open(pFilename, std::ios::out | std::ios::binary);
-        float* f = m_heightMap.GetBaseAddr();
-        out.write( reinterpret_cast<const char*>( f ), m_terrainSize * m_terrainSize * sizeof( float ));
-        out.close();
+        if (m_tiledHeightMap.getNumTiles() > 0 && m_tiledHeightMap.getPath() == pFilename) {
+            std::vector<int> modifiedTiles;
+            for (int tile = 0; tile < m_tileModified.size(); tile++) {
+                if (m_tileModified[tile]) {
+                    modifiedTiles.push_back(tile);
+                }
+            }
+            if (!modifiedTiles.empty() && m_tiledHeightMap.writeTiles(m_heightMap.GetBaseAddr(), modifiedTiles)) {
+                m_tileModified.assign(m_tileModified.size(), false);
+            }
+            return;
+        }
+        // every tile ends up in a new file, so tiles that have not been loaded yet are needed now
+        loadTiles(0, 0, m_terrainSize - 1, m_terrainSize - 1);
+        if (TiledHeightMap::write(pFilename, m_heightMap.GetBaseAddr(), m_terrainSize, m_tileSize) && m_tiledHeightMap.open(pFilename)) {
+            m_tileModified.assign(m_tileModified.size(), false);
+        }
     }
 
     void OpenGLBaseTerrain::setHeight(int x, int z, float y) {
         if (x >= 0 && z >= 0 && x < (int) getSize() && z < (int) getSize()) {
             m_heightMap.Set(x, z, y);
+            markHeightsModified(x, z, x, z);
+        }
+    }
+
+    void OpenGLBaseTerrain::markHeightsModified(int minX, int minZ, int maxX, int maxZ) {
+        onHeightsChanged(minX, minZ, maxX, maxZ);
+        // edited heights take precedence over tiles that are still loading
+        for (int tile: getTiles(minX, minZ, maxX, maxZ)) {
+            m_tileModified[tile] = true;
+            m_tileLoaded[tile] = true;
+            m_tileRequested[tile] = true;
+        }
+    }
+
+    std::optional<glm::vec3> OpenGLBaseTerrain::raycast(glm::vec3 origin, glm::vec3 direction) const {
+        // height map space has one unit per vertex horizontally
+        glm::vec3 toHeightMap = {1.0f / m_worldScale, 1.0f, 1.0f / m_worldScale};
+        auto hit = m_heightMapPyramid.raycast(origin * toHeightMap, direction * toHeightMap);
+        if (!hit) {
+            return std::nullopt;
         }
+        return *hit / toHeightMap;
     }
 
     Array2D<float> OpenGLBaseTerrain::getHeightMap() {
         return m_heightMap;
     }
 
+    const float *OpenGLBaseTerrain::getHeightMapData() const {
+        return m_heightMap.GetBaseAddr();
+    }
+
+    float *OpenGLBaseTerrain::getHeightMapData() {
+        return m_heightMap.GetBaseAddr();
+    }
+
     float OpenGLBaseTerrain::getMinHeight() {
         return this->m_minHeight;
     }
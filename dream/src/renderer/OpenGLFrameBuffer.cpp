@@ -21,6 +21,7 @@
 #include <iostream>
 #include <glad/glad.h>
 #include "dream/project/Project.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 
 Dream::OpenGLFrameBuffer::OpenGLFrameBuffer() {
     screenShader = new OpenGLShader(
@@ -38,7 +39,6 @@ Dream::OpenGLFrameBuffer::OpenGLFrameBuffer() {
             1.0f, -1.0f, 1.0f, 0.0f,
             1.0f, 1.0f, 1.0f, 1.0f
     };
-    unsigned int screenQuadVBO;
     glGenVertexArrays(1, &screenQuadVAO);
     glGenBuffers(1, &screenQuadVBO);
     glBindVertexArray(screenQuadVAO);
@@ -94,7 +94,8 @@ void Dream::OpenGLFrameBuffer::resize(int fbWidth, int fbHeight) {
 }
 
 void Dream::OpenGLFrameBuffer::bindTexture() {
-    glBindTexture(GL_TEXTURE_2D, textureColorbuffer);;
+    glBindTexture(GL_TEXTURE_2D, textureColorbuffer);
+    OpenGLRenderStats::countTextureBind();
 }
 
 int Dream::OpenGLFrameBuffer::getTexture() {
@@ -118,10 +119,16 @@ void Dream::OpenGLFrameBuffer::renderScreenQuad() {
     glBindVertexArray(screenQuadVAO);
     this->bindTexture();
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    OpenGLRenderStats::countDrawCall(2);
 }
 
 Dream::OpenGLFrameBuffer::~OpenGLFrameBuffer() {
     delete this->screenShader;
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &textureColorbuffer);
+    glDeleteRenderbuffers(1, &rbo);
+    glDeleteVertexArrays(1, &screenQuadVAO);
+    glDeleteBuffers(1, &screenQuadVBO);
 }
 
 void Dream::OpenGLFrameBuffer::clear() {
@@ -0,0 +1,83 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/OpenGLGPUTimer.h"
+
+#include <glad/glad.h>
+
+namespace Dream {
+    OpenGLGPUTimer::OpenGLGPUTimer() {
+        if (isSupported()) {
+            glGenQueries(latency, queries);
+        }
+    }
+
+    OpenGLGPUTimer::~OpenGLGPUTimer() {
+        if (isSupported()) {
+            glDeleteQueries(latency, queries);
+        }
+    }
+
+    void OpenGLGPUTimer::begin() {
+#ifndef EMSCRIPTEN
+        // read back every query that finished, oldest first, so elapsedTime ends up being the latest result
+        for (int i = 1; i <= latency; i++) {
+            int query = (current + i) % latency;
+            if (!pending[query]) {
+                continue;
+            }
+            GLint available = 0;
+            glGetQueryObjectiv(queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &nanoseconds);
+                elapsedTime = (double) nanoseconds / 1000000.0;
+                pending[query] = false;
+            }
+        }
+        current = (current + 1) % latency;
+        if (pending[current]) {
+            // GPU is more than a few frames behind, so wait on the oldest query before reusing it
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &nanoseconds);
+            elapsedTime = (double) nanoseconds / 1000000.0;
+            pending[current] = false;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+#endif
+    }
+
+    void OpenGLGPUTimer::end() {
+#ifndef EMSCRIPTEN
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+#endif
+    }
+
+    double OpenGLGPUTimer::getElapsedTime() {
+        return elapsedTime;
+    }
+
+    bool OpenGLGPUTimer::isSupported() {
+#ifdef EMSCRIPTEN
+        return false;
+#else
+        return true;
+#endif
+    }
+}
@@ -4,6 +4,7 @@
 
 #include "dream/renderer/OpenGLPhysicsDebugDrawer.h"
 #include "dream/util/Logger.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 #include <iostream>
 
 namespace Dream {
@@ -52,13 +53,17 @@ namespace Dream {
     }
     #endif
 
-    void OpenGLPhysicsDebugDrawer::doDrawing() {
-        // TODO: fix fact that this causes crash when running for a long time
-        if (!lines.empty()) {
-//            if (lines.size() % 2 != 0) {
-//                Logger::error("Uneven number of physics debug lines to be drawn");
-//            }
+    void OpenGLPhysicsDebugDrawer::takeLines(std::vector<glm::vec3> &points) {
+        for (const auto &line : lines) {
+            points.push_back(line.p1);
+            points.push_back(line.p2);
+        }
+        lines.clear();
+    }
 
+    void OpenGLPhysicsDebugDrawer::drawLines(const std::vector<glm::vec3> &points) {
+        // TODO: fix fact that this causes crash when running for a long time
+        if (!points.empty()) {
             unsigned int vao = 0;
             unsigned int vbo = 0;
 
@@ -69,7 +74,7 @@ namespace Dream {
             // configure vertex attributes (only on vertex data size() > 0)
             glBindVertexArray(vao);
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(lines) * 2, &lines[0], GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (points.size() * sizeof(glm::vec3)), &points[0], GL_STATIC_DRAW);
 
             // calculate stride from number of non-empty vertex attribute arrays
             size_t stride = 3 * sizeof(float);  // positions
@@ -78,17 +83,15 @@ namespace Dream {
             size_t offset = 0;
             glEnableVertexAttribArray(0);
             glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-            offset += 3 * sizeof(float);
 
             glBindVertexArray(vao);
-            glDrawArrays(GL_LINES, 0, (int) lines.size() * 2);
+            glDrawArrays(GL_LINES, 0, (int) points.size());
+            OpenGLRenderStats::countDrawCall(0);
 
             glDeleteVertexArrays(1, &vao);
             glDeleteBuffers(1, &vbo);
 
             glBindVertexArray(0);
-
-            lines.clear();
         }
     }
 }
@@ -0,0 +1,221 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/OpenGLRenderGraph.h"
+
+#include <utility>
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    OpenGLRenderGraph::~OpenGLRenderGraph() {
+        if (retainedOutput && retainedOutputPool) {
+            retainedOutputPool->release(retainedOutput);
+        }
+    }
+
+    void OpenGLRenderGraph::reset() {
+        passes.clear();
+        resources.clear();
+        physicalDescriptions.clear();
+        physicalRenderTargets.clear();
+        output = -1;
+    }
+
+    int OpenGLRenderGraph::createRenderTarget(const std::string &name, RenderTargetDescription description) {
+        resources.push_back(Resource{
+                .name=name,
+                .description=description
+        });
+        return (int) resources.size() - 1;
+    }
+
+    void OpenGLRenderGraph::addPass(const std::string &name, std::vector<int> reads, std::vector<int> writes,
+                                    std::function<void()> execute, bool enabled) {
+        for (int resource: reads) {
+            if (resource < 0 || resource >= resources.size()) {
+                Logger::fatal("Render pass " + name + " reads unknown render target " + std::to_string(resource));
+            }
+        }
+        for (int resource: writes) {
+            if (resource < 0 || resource >= resources.size()) {
+                Logger::fatal("Render pass " + name + " writes unknown render target " + std::to_string(resource));
+            }
+        }
+        passes.push_back(Pass{
+                .name=name,
+                .reads=std::move(reads),
+                .writes=std::move(writes),
+                .execute=std::move(execute),
+                .enabled=enabled
+        });
+    }
+
+    void OpenGLRenderGraph::setOutput(int resource) {
+        output = resource;
+    }
+
+    void OpenGLRenderGraph::compile() {
+        // walk backwards from the output and only keep passes that write something a kept pass (or the output) needs
+        std::vector<bool> needed(resources.size(), false);
+        if (output != -1) {
+            needed[output] = true;
+        }
+        for (int i = (int) passes.size() - 1; i >= 0; i--) {
+            auto &pass = passes.at(i);
+            pass.culled = true;
+            if (!pass.enabled) {
+                continue;
+            }
+            // passes without writes only have side effects outside the graph (ex: filling vertex buffers)
+            if (pass.writes.empty()) {
+                pass.culled = false;
+            }
+            for (int resource: pass.writes) {
+                if (needed[resource]) {
+                    pass.culled = false;
+                }
+            }
+            if (!pass.culled) {
+                for (int resource: pass.reads) {
+                    needed[resource] = true;
+                }
+            }
+        }
+
+        // lifetime of each render target in terms of pass indices
+        for (auto &resource: resources) {
+            resource.firstUse = -1;
+            resource.lastUse = -1;
+            resource.physicalIndex = -1;
+        }
+        for (int i = 0; i < passes.size(); i++) {
+            const auto &pass = passes.at(i);
+            if (pass.culled) {
+                continue;
+            }
+            for (const auto &resourceList: {pass.reads, pass.writes}) {
+                for (int resourceIndex: resourceList) {
+                    auto &resource = resources.at(resourceIndex);
+                    if (resource.firstUse == -1) {
+                        resource.firstUse = i;
+                    }
+                    resource.lastUse = i;
+                }
+            }
+        }
+        if (output != -1 && resources.at(output).firstUse != -1) {
+            // output outlives the graph so nothing may alias it
+            resources.at(output).lastUse = (int) passes.size();
+        }
+
+        // alias render targets of the same description whose lifetimes do not overlap
+        physicalDescriptions.clear();
+        std::vector<int> physicalLastUse;
+        for (int i = 0; i < passes.size(); i++) {
+            for (auto &resource: resources) {
+                if (resource.firstUse != i) {
+                    continue;
+                }
+                for (int p = 0; p < physicalDescriptions.size(); p++) {
+                    if (physicalDescriptions.at(p) == resource.description && physicalLastUse.at(p) < i) {
+                        resource.physicalIndex = p;
+                        break;
+                    }
+                }
+                if (resource.physicalIndex == -1) {
+                    physicalDescriptions.push_back(resource.description);
+                    physicalLastUse.push_back(resource.lastUse);
+                    resource.physicalIndex = (int) physicalDescriptions.size() - 1;
+                } else {
+                    physicalLastUse.at(resource.physicalIndex) = resource.lastUse;
+                }
+            }
+        }
+    }
+
+    void OpenGLRenderGraph::execute(OpenGLRenderTargetPool *pool) {
+        // previous output is no longer sampled, so it can go back to the pool (and most likely be handed out again)
+        if (retainedOutput && retainedOutputPool) {
+            retainedOutputPool->release(retainedOutput);
+        }
+        retainedOutput = nullptr;
+        retainedOutputPool = pool;
+
+        pool->beginFrame();
+        physicalRenderTargets.clear();
+        for (const auto &description: physicalDescriptions) {
+            physicalRenderTargets.push_back(pool->acquire(description));
+        }
+
+        for (auto &pass: passes) {
+            if (!pass.culled) {
+                OpenGLRenderStats::beginPass(pass.name);
+                pass.execute();
+                auto sample = OpenGLRenderStats::endPass();
+                pass.cpuTime = sample.cpuTime;
+                pass.gpuTime = sample.gpuTime;
+                pass.counters = sample.counters;
+            }
+        }
+
+        int outputPhysicalIndex = output != -1 ? resources.at(output).physicalIndex : -1;
+        for (int p = 0; p < physicalRenderTargets.size(); p++) {
+            if (p == outputPhysicalIndex) {
+                retainedOutput = physicalRenderTargets.at(p);
+            } else {
+                pool->release(physicalRenderTargets.at(p));
+            }
+        }
+    }
+
+    OpenGLRenderTarget *OpenGLRenderGraph::getRenderTarget(int resource) {
+        int physicalIndex = resources.at(resource).physicalIndex;
+        if (physicalIndex == -1 || physicalIndex >= physicalRenderTargets.size()) {
+            Logger::fatal("Render target " + resources.at(resource).name + " is not used by any pass that executes");
+            return nullptr;
+        }
+        return physicalRenderTargets.at(physicalIndex);
+    }
+
+    OpenGLFrameBuffer *OpenGLRenderGraph::getFrameBuffer(int resource) {
+        return getRenderTarget(resource)->frameBuffer;
+    }
+
+    OpenGLShadowMapFBO *OpenGLRenderGraph::getShadowMap(int resource) {
+        return getRenderTarget(resource)->shadowMap;
+    }
+
+    OpenGLFrameBuffer *OpenGLRenderGraph::getOutputFrameBuffer() {
+        if (retainedOutput) {
+            return retainedOutput->frameBuffer;
+        }
+        return nullptr;
+    }
+
+    const std::vector<OpenGLRenderGraph::Pass> &OpenGLRenderGraph::getPasses() {
+        return passes;
+    }
+
+    const std::vector<OpenGLRenderGraph::Resource> &OpenGLRenderGraph::getResources() {
+        return resources;
+    }
+
+    int OpenGLRenderGraph::getNumPhysicalRenderTargets() {
+        return (int) physicalDescriptions.size();
+    }
+}
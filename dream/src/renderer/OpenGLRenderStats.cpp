@@ -0,0 +1,188 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/OpenGLRenderStats.h"
+
+#include <fstream>
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    RenderCounters RenderCounters::operator-(const RenderCounters &other) const {
+        RenderCounters difference;
+        difference.drawCalls = drawCalls - other.drawCalls;
+        difference.triangles = triangles - other.triangles;
+        difference.textureBinds = textureBinds - other.textureBinds;
+        difference.programSwitches = programSwitches - other.programSwitches;
+        difference.uniformUploads = uniformUploads - other.uniformUploads;
+        return difference;
+    }
+
+    RenderCounters &RenderCounters::operator+=(const RenderCounters &other) {
+        drawCalls += other.drawCalls;
+        triangles += other.triangles;
+        textureBinds += other.textureBinds;
+        programSwitches += other.programSwitches;
+        uniformUploads += other.uniformUploads;
+        return *this;
+    }
+
+    std::vector<OpenGLRenderStats::Sample> OpenGLRenderStats::PassHistory::getOrderedSamples() const {
+        if (samples.size() < historySize) {
+            return samples;
+        }
+        std::vector<Sample> orderedSamples(samples.begin() + next, samples.end());
+        orderedSamples.insert(orderedSamples.end(), samples.begin(), samples.begin() + next);
+        return orderedSamples;
+    }
+
+    double OpenGLRenderStats::PassHistory::getAverageCPUTime() const {
+        if (samples.empty()) {
+            return 0;
+        }
+        double total = 0;
+        for (const auto &sample: samples) {
+            total += sample.cpuTime;
+        }
+        return total / (double) samples.size();
+    }
+
+    double OpenGLRenderStats::PassHistory::getAverageGPUTime() const {
+        double total = 0;
+        int count = 0;
+        for (const auto &sample: samples) {
+            if (sample.gpuTime >= 0) {
+                total += sample.gpuTime;
+                count++;
+            }
+        }
+        return count > 0 ? total / count : -1;
+    }
+
+    RenderCounters OpenGLRenderStats::PassHistory::getLatestCounters() const {
+        if (samples.empty()) {
+            return {};
+        }
+        return samples.at((next + (int) samples.size() - 1) % (int) samples.size()).counters;
+    }
+
+    const RenderCounters &OpenGLRenderStats::getCounters() {
+        return counters;
+    }
+
+    void OpenGLRenderStats::countDrawCall(long long triangles) {
+        counters.drawCalls++;
+        counters.triangles += triangles;
+    }
+
+    void OpenGLRenderStats::countTextureBind() {
+        counters.textureBinds++;
+    }
+
+    void OpenGLRenderStats::countProgramSwitch() {
+        counters.programSwitches++;
+    }
+
+    void OpenGLRenderStats::countUniformUpload() {
+        counters.uniformUploads++;
+    }
+
+    void OpenGLRenderStats::beginPass(const std::string &name) {
+        if (currentPass != -1) {
+            Logger::fatal("Cannot begin pass " + name + " while pass " + passHistories.at(currentPass).name + " is running");
+        }
+        for (int i = 0; i < passHistories.size(); i++) {
+            if (passHistories.at(i).name == name) {
+                currentPass = i;
+                break;
+            }
+        }
+        if (currentPass == -1) {
+            passHistories.push_back(PassHistory{
+                    .name=name,
+                    .gpuTimer=OpenGLGPUTimer::isSupported() ? new OpenGLGPUTimer() : nullptr
+            });
+            currentPass = (int) passHistories.size() - 1;
+        }
+        auto &passHistory = passHistories.at(currentPass);
+        if (passHistory.gpuTimer) {
+            passHistory.gpuTimer->begin();
+        }
+        currentPassCounters = counters;
+        currentPassStart = std::chrono::high_resolution_clock::now();
+    }
+
+    OpenGLRenderStats::Sample OpenGLRenderStats::endPass() {
+        if (currentPass == -1) {
+            Logger::fatal("Cannot end pass since no pass is running");
+        }
+        Sample sample;
+        sample.cpuTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - currentPassStart).count();
+        sample.counters = counters - currentPassCounters;
+        auto &passHistory = passHistories.at(currentPass);
+        if (passHistory.gpuTimer) {
+            passHistory.gpuTimer->end();
+            sample.gpuTime = passHistory.gpuTimer->getElapsedTime();
+        }
+        if (passHistory.samples.size() < historySize) {
+            passHistory.samples.push_back(sample);
+        } else {
+            passHistory.samples.at(passHistory.next) = sample;
+        }
+        passHistory.next = (passHistory.next + 1) % historySize;
+        currentPass = -1;
+        return sample;
+    }
+
+    const std::vector<OpenGLRenderStats::PassHistory> &OpenGLRenderStats::getPassHistories() {
+        return passHistories;
+    }
+
+    void OpenGLRenderStats::clearPassHistories() {
+        // passes and their GPU timers are kept since this can be called while a pass is running (ex: from the editor)
+        for (auto &passHistory: passHistories) {
+            passHistory.samples.clear();
+            passHistory.next = 0;
+        }
+    }
+
+    bool OpenGLRenderStats::exportCSV(const std::filesystem::path &path) {
+        std::ofstream out(path);
+        if (!out) {
+            Logger::error("Unable to write render stats to " + path.string());
+            return false;
+        }
+        out << "pass,sample,cpu_ms,gpu_ms,draw_calls,triangles,texture_binds,program_switches,uniform_uploads\n";
+        for (const auto &passHistory: passHistories) {
+            auto samples = passHistory.getOrderedSamples();
+            for (int i = 0; i < samples.size(); i++) {
+                const auto &sample = samples.at(i);
+                out << passHistory.name << "," << i << "," << sample.cpuTime << ",";
+                if (sample.gpuTime >= 0) {
+                    out << sample.gpuTime;
+                }
+                out << "," << sample.counters.drawCalls
+                    << "," << sample.counters.triangles
+                    << "," << sample.counters.textureBinds
+                    << "," << sample.counters.programSwitches
+                    << "," << sample.counters.uniformUploads << "\n";
+            }
+        }
+        Logger::info("Wrote render stats to " + path.string());
+        return true;
+    }
+}
@@ -0,0 +1,93 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/OpenGLRenderTargetPool.h"
+
+#include <glad/glad.h>
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    bool RenderTargetDescription::operator==(const RenderTargetDescription &other) const {
+        return type == other.type && width == other.width && height == other.height;
+    }
+
+    bool RenderTargetDescription::operator!=(const RenderTargetDescription &other) const {
+        return !(*this == other);
+    }
+
+    OpenGLRenderTargetPool::~OpenGLRenderTargetPool() {
+        for (auto *renderTarget: renderTargets) {
+            destroy(renderTarget);
+        }
+        renderTargets.clear();
+    }
+
+    void OpenGLRenderTargetPool::beginFrame() {
+        frame++;
+        for (int i = (int) renderTargets.size() - 1; i >= 0; i--) {
+            auto *renderTarget = renderTargets.at(i);
+            if (!renderTarget->inUse && frame - renderTarget->lastUsedFrame > maxUnusedFrames) {
+                destroy(renderTarget);
+                renderTargets.erase(renderTargets.begin() + i);
+            }
+        }
+    }
+
+    OpenGLRenderTarget *OpenGLRenderTargetPool::acquire(const RenderTargetDescription &description) {
+        for (auto *renderTarget: renderTargets) {
+            if (!renderTarget->inUse && renderTarget->description == description) {
+                renderTarget->inUse = true;
+                renderTarget->lastUsedFrame = frame;
+                return renderTarget;
+            }
+        }
+        auto *renderTarget = new OpenGLRenderTarget();
+        renderTarget->description = description;
+        if (description.type == RenderTargetDescription::COLOR_DEPTH) {
+            renderTarget->frameBuffer = new OpenGLFrameBuffer();
+            renderTarget->frameBuffer->bindForWriting();
+            renderTarget->frameBuffer->resize(description.width, description.height);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        } else if (description.type == RenderTargetDescription::DEPTH) {
+            renderTarget->shadowMap = new OpenGLShadowMapFBO(description.width, description.height);
+        } else {
+            Logger::fatal("Unknown render target type " + std::to_string(static_cast<int>(description.type)));
+        }
+        renderTarget->inUse = true;
+        renderTarget->lastUsedFrame = frame;
+        renderTargets.push_back(renderTarget);
+        return renderTarget;
+    }
+
+    void OpenGLRenderTargetPool::release(OpenGLRenderTarget *renderTarget) {
+        if (renderTarget) {
+            renderTarget->inUse = false;
+            renderTarget->lastUsedFrame = frame;
+        }
+    }
+
+    int OpenGLRenderTargetPool::getNumRenderTargets() {
+        return (int) renderTargets.size();
+    }
+
+    void OpenGLRenderTargetPool::destroy(OpenGLRenderTarget *renderTarget) {
+        delete renderTarget->frameBuffer;
+        delete renderTarget->shadowMap;
+        delete renderTarget;
+    }
+}
@@ -17,6 +17,7 @@
  **********************************************************************************/
 
 #include "dream/renderer/OpenGLRenderer.h"
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glad/glad.h>
@@ -59,29 +60,17 @@ namespace Dream {
 
         skybox = new OpenGLSkybox();
 
-        outputRenderTextureFbo = new OpenGLFrameBuffer();
-
         directionalLightShadowTech = new DirectionalLightShadowTech();
 
         skinningTech = new SkinningTech();
 
+        vertexAnimationTech = new VertexAnimationTech();
+
         lightingTech = new LightingTech();
 
-        // TODO: maybe encapsulate this in directional light shadow tech?
-        for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
-            int scale = 1;
-            if (i == 0) {
-                scale = 8;
-            } else if (i == 1) {
-                scale = 4;
-            } else {
-                scale = 2;
-            }
+        renderGraph = new OpenGLRenderGraph();
 
-            const unsigned int SHADOW_WIDTH = 1024 * scale, SHADOW_HEIGHT = 1024 * scale;
-            auto shadowMapFbo = new OpenGLShadowMapFBO((int) SHADOW_WIDTH, (int) SHADOW_HEIGHT);
-            shadowMapFbos.push_back(shadowMapFbo);
-        }
+        renderTargetPool = new OpenGLRenderTargetPool();
 
         // load primitive shapes
         if (!Project::getResourceManager()->hasMeshData("sphere")) {
@@ -98,23 +87,58 @@ namespace Dream {
         delete this->singleTextureShader;
         delete this->physicsDebugShader;
         delete this->simpleDepthShader;
-        delete this->outputRenderTextureFbo;
-        for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
-            delete shadowMapFbos.at(i);
-        }
+        // graph returns its retained output to the pool, so it has to go first
+        delete this->renderGraph;
+        delete this->renderTargetPool;
         delete this->lightingTech;
         delete this->directionalLightShadowTech;
         delete this->skinningTech;
+        delete this->vertexAnimationTech;
         delete this->terrainShader;
     }
 
-    void OpenGLRenderer::render(int viewportWidth, int viewportHeight, bool fullscreen) {
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
+    void OpenGLRenderer::prepare() {
+        // GPU resources are created lazily on the thread that owns the GL context, so meshes, textures and
+        // terrains that were added to the scene show up in the next extracted frame
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::MeshComponent>()) {
+            Entity entity = {entityHandle, Project::getScene()};
+            // TODO: only load when necessary (add a flag internally - and reset it when fields are modified)
+            entity.getComponent<Component::MeshComponent>().loadMesh();
+            skinningTech->loadAnimator(entity);
+            if (entity.hasComponent<Component::MaterialComponent>()) {
+                entity.getComponent<Component::MaterialComponent>().loadTextures();
+            }
+        }
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::VertexAnimationComponent>()) {
+            vertexAnimationTech->loadVertexAnimation({entityHandle, Project::getScene()});
+        }
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::TerrainComponent>()) {
+            Entity entity = {entityHandle, Project::getScene()};
+            // TODO: store in resource manager instead
+            entity.getComponent<Component::TerrainComponent>().initializeTerrain();
+            if (auto *terrain = entity.getComponent<Component::TerrainComponent>().terrain) {
+                // upload chunks that were sculpted since the last frame
+                terrain->refreshTerrainTriangleList();
+            }
+            if (entity.hasComponent<Component::MaterialComponent>()) {
+                entity.getComponent<Component::MaterialComponent>().loadTextures();
+            }
+        }
+    }
+
+    void OpenGLRenderer::extract(int viewportWidth, int viewportHeight, bool fullscreen) {
+        FrameSnapshot &frame = frameSnapshots.getWriteBuffer();
+        frame.clear();
+        frame.viewportWidth = viewportWidth;
+        frame.viewportHeight = viewportHeight;
+        frame.fullscreen = fullscreen;
+        frame.config = Project::getConfig();
+        frame.interpolationAlpha = 1.0f;
+        if (Project::isPlaying() && Project::getScene()->getPhysicsComponentSystem()) {
+            frame.interpolationAlpha = Project::getScene()->getPhysicsComponentSystem()->getInterpolationAlpha();
+        }
 
         // update renderer camera using scene camera entity's position and camera attributes like yaw, pitch, and fov
-        std::optional<Camera> maybeCamera;
         auto sceneCameraEntity = Project::getScene()->getSceneCamera();
         auto mainCameraEntity = Project::getScene()->getMainCamera();
 
@@ -123,123 +147,244 @@ namespace Dream {
 
         // TODO: make camera use global position of entity for camera position
         if (sceneCameraEntity && !Project::isPlaying()) {
-            maybeCamera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
-            sceneCameraEntity.getComponent<Component::SceneCameraComponent>().updateRendererCamera(*maybeCamera, sceneCameraEntity);
+            frame.camera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
+            sceneCameraEntity.getComponent<Component::SceneCameraComponent>().updateRendererCamera(*frame.camera, sceneCameraEntity);
         } else if (mainCameraEntity && Project::isPlaying()) {
-            maybeCamera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
-            mainCameraEntity.getComponent<Component::CameraComponent>().updateRendererCamera(*maybeCamera, mainCameraEntity);
+            frame.camera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
+            mainCameraEntity.getComponent<Component::CameraComponent>().updateRendererCamera(*frame.camera, mainCameraEntity,
+                                                                                             frame.interpolationAlpha);
+        }
+
+        if (frame.camera) {
+            frame.shadowDirectionalLightDirection = directionalLightShadowTech->getDirectionalLightDirection();
+            lightingTech->getLights(frame);
+            extractEntities(Project::getScene()->getRootEntity(), frame);
+
+            for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::TerrainComponent>()) {
+                Entity entity = {entityHandle, Project::getScene()};
+                if (auto terrain = entity.getComponent<Component::TerrainComponent>().terrain) {
+                    frame.terrains.push_back({
+                            .terrain=terrain,
+                            .model=entity.getComponent<Component::TransformComponent>().getTransform(entity),
+                            .material=lightingTech->getMaterial(entity)
+                    });
+                }
+            }
+
+            frame.drawPhysicsDebug = frame.config.physicsConfig.physicsDebugger && (!Project::isPlaying() || (Project::isPlaying() && frame.config.physicsConfig.physicsDebuggerWhilePlaying));
+            if (frame.drawPhysicsDebug && Project::getScene()->getPhysicsComponentSystem()) {
+                Project::getScene()->getPhysicsComponentSystem()->getDebugLines(frame.physicsDebugLines);
+            }
+        }
+
+        frameSnapshots.publish();
+    }
+
+    void OpenGLRenderer::extractEntities(Entity entity, FrameSnapshot &frame, int bonePaletteOffset, int numBones) {
+        // crowd instances drawn from baked clips replace the meshes below them
+        if (vertexAnimationTech->getInstance(entity, frame, lightingTech)) {
+            return;
+        }
+        // meshes of an animated model are usually children of the entity with the animator
+        skinningTech->getJointMatrices(entity, frame, bonePaletteOffset, numBones);
+        if (entity.hasComponent<Component::MeshComponent>()) {
+            auto &meshComponent = entity.getComponent<Component::MeshComponent>();
+            if (!meshComponent.fileId.empty() || meshComponent.meshType != Component::MeshComponent::FROM_FILE) {
+                auto guid = meshComponent.getMeshGuid();
+                auto fileId = meshComponent.getMeshFileID();
+                // meshes that are not loaded yet are created by prepare() and drawn starting next frame
+                if (Project::getResourceManager()->hasMeshData(guid, fileId)) {
+                    auto mesh = Project::getResourceManager()->getMeshData(guid, fileId);
+                    if (auto openGLMesh = std::dynamic_pointer_cast<OpenGLMesh>(mesh)) {
+                        MeshDrawItem drawItem = {
+                                .mesh=openGLMesh,
+                                .model=entity.getComponent<Component::TransformComponent>().getInterpolatedTransform(entity, frame.interpolationAlpha),
+                                .material=lightingTech->getMaterial(entity),
+                                .bonePaletteOffset=bonePaletteOffset,
+                                .numBones=numBones
+                        };
+                        if (numBones > 0 && frame.config.renderingConfig.preSkinning && skinningTech->canPreSkin()) {
+                            drawItem.skinnedVertexBuffer = frame.numSkinnedMeshes++;
+                        }
+                        frame.meshes.push_back(std::move(drawItem));
+                    } else {
+                        Logger::fatal("Unable to dynamic cast Mesh to type OpenGLMesh for entity " + entity.getComponent<Component::IDComponent>().id);
+                    }
+                }
+            }
         }
 
-        if (maybeCamera) {
-            auto camera = *maybeCamera;
+        // extract child entities
+        Entity child = entity.getComponent<Component::HierarchyComponent>().first;
+        while (child) {
+            extractEntities(child, frame, bonePaletteOffset, numBones);
+            child = child.getComponent<Component::HierarchyComponent>().next;
+        }
+    }
+
+    void OpenGLRenderer::submit() {
+        frameSnapshots.update();
+        const FrameSnapshot &frame = frameSnapshots.getReadBuffer();
+        int viewportWidth = frame.viewportWidth;
+        int viewportHeight = frame.viewportHeight;
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+
+        // describe the frame as a graph of passes so passes that do not contribute to the output are skipped
+        // and render targets come from a pool instead of being owned by the renderer
+        renderGraph->reset();
+        auto output = renderGraph->createRenderTarget("output", {
+                .type=RenderTargetDescription::COLOR_DEPTH,
+                .width=std::max(viewportWidth * 2, 1),
+                .height=std::max(viewportHeight * 2, 1)
+        });
+        renderGraph->setOutput(output);
+
+        auto bindOutput = [&]() {
+            auto outputFbo = renderGraph->getFrameBuffer(output);
+            outputFbo->bindForWriting();
+            glViewport(0, 0, outputFbo->getWidth(), outputFbo->getHeight());
+        };
+
+        // shadow map textures are only known once the graph acquires them from the pool
+        std::vector<int> shadowMaps;
+        auto resolveShadowMaps = [&]() {
+            shadowMapFbos.clear();
+            for (int shadowMap: shadowMaps) {
+                shadowMapFbos.push_back(renderGraph->getShadowMap(shadowMap));
+            }
+        };
+
+        // passes execute after this block, so camera state is captured by value
+        if (frame.camera) {
+            auto camera = *frame.camera;
+
+            // skin animated meshes once so the shadow cascades and the main pass do not each blend the bones again
+            renderGraph->addPass("skinning", {}, {}, [&]() {
+                skinningTech->skinMeshes(frame);
+            }, frame.numSkinnedMeshes > 0);
+
+            renderGraph->addPass("vertex animation instances", {}, {}, [&]() {
+                vertexAnimationTech->prepareBatches(frame);
+            }, !frame.vertexAnimationBatches.empty());
 
             // light spaces matrices for shadow cascades
-            auto lightSpaceMatrices = directionalLightShadowTech->getLightSpaceMatrices(camera, directionalLightShadowTech->getDirectionalLightDirection());
+            auto lightSpaceMatrices = directionalLightShadowTech->getLightSpaceMatrices(camera, frame.shadowDirectionalLightDirection);
+
+            // TODO: maybe encapsulate this in directional light shadow tech?
+            for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
+                int scale = 1;
+                if (i == 0) {
+                    scale = 8;
+                } else if (i == 1) {
+                    scale = 4;
+                } else {
+                    scale = 2;
+                }
+                shadowMaps.push_back(renderGraph->createRenderTarget("shadow cascade " + std::to_string(i), {
+                        .type=RenderTargetDescription::DEPTH,
+                        .width=1024 * scale,
+                        .height=1024 * scale
+                }));
+            }
 
-            {
-                // render scene from light's point of view
+            for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
+                renderGraph->addPass("shadow cascade " + std::to_string(i), {}, {shadowMaps.at(i)}, [&, i, camera, lightSpaceMatrices]() mutable {
+                    // render scene from light's point of view
+                    resolveShadowMaps();
+                    auto shadowMapFbo = shadowMapFbos.at(i);
 #ifndef EMSCRIPTEN
-                glEnable(GL_DEPTH_CLAMP);
+                    glEnable(GL_DEPTH_CLAMP);
 #endif
-                for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
                     simpleDepthShader->use();
                     simpleDepthShader->setMat4("lightSpaceMatrix", lightSpaceMatrices.at(i));
-                    glViewport(0, 0, (int) shadowMapFbos.at(i)->getWidth(), (int) shadowMapFbos.at(i)->getHeight());
-                    shadowMapFbos.at(i)->bind();
+                    glViewport(0, 0, shadowMapFbo->getWidth(), shadowMapFbo->getHeight());
+                    shadowMapFbo->bind();
                     glClear(GL_DEPTH_BUFFER_BIT);
-                    drawTerrains(camera, simpleDepthShader);
-                    drawEntities(Project::getScene()->getRootEntity(), camera, simpleDepthShader);
-                    shadowMapFbos.at(i)->unbind();
-                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-                    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-                }
+                    // shadow maps are depth clamped so chunks in front of the near plane still cast shadows,
+                    // and terrain detail matters less in the larger (further) cascades
+                    drawTerrains(frame, simpleDepthShader, lightSpaceMatrices.at(i), i == 0 ? 1 : 2, false);
+                    drawMeshes(frame, simpleDepthShader);
+                    if (!frame.vertexAnimationBatches.empty()) {
+                        auto *vertexAnimationShader = vertexAnimationTech->getShader(VertexAnimationTech::DEPTH);
+                        vertexAnimationShader->use();
+                        vertexAnimationShader->setMat4("projection", lightSpaceMatrices.at(i));
+                        vertexAnimationShader->setMat4("view", glm::mat4(1.0f));
+                        drawVertexAnimations(frame, vertexAnimationShader);
+                    }
+                    shadowMapFbo->unbind();
 #ifndef EMSCRIPTEN
-                glDisable(GL_DEPTH_CLAMP);
+                    glDisable(GL_DEPTH_CLAMP);
 #endif
+                });
             }
 
-            {
-                // bind frame buffer for drawing to output render texture
-                glViewport(0, 0, viewportWidth * 2, viewportHeight * 2);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-                this->outputRenderTextureFbo->bindForWriting();
-                this->resizeFrameBuffer();
+            renderGraph->addPass("clear output", {}, {output}, [&]() {
+                bindOutput();
                 glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
                 glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            }
+            });
 
-            {
-                // draw meshes
-                if (Project::getConfig().renderingConfig.renderingType == Config::RenderingConfig::FINAL) {
+            renderGraph->addPass("meshes", shadowMaps, {output}, [&, camera, lightSpaceMatrices]() mutable {
+                bindOutput();
+                resolveShadowMaps();
+                if (frame.config.renderingConfig.renderingType == Config::RenderingConfig::FINAL) {
                     lightingShader->use();
-                    lightingShader->setMat4("projection", camera.getProjectionMatrix());
-                    lightingShader->setMat4("view", camera.getViewMatrix());
-                    lightingShader->setFloat("farPlane", camera.zFar);
-                    glm::vec3 viewPos = camera.position;
-                    lightingShader->setVec3("viewPos", viewPos);
-                    lightingShader->setVec3("shadowDirectionalLightDir", directionalLightShadowTech->getDirectionalLightDirection());
-                    for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
-                        lightingShader->setMat4("lightSpaceMatrices[" + std::to_string(i) + "]", lightSpaceMatrices.at(i));
+                    setCameraUniforms(lightingShader, camera, lightSpaceMatrices, frame);
+                    drawMeshes(frame, lightingShader);
+                    if (!frame.vertexAnimationBatches.empty()) {
+                        auto *vertexAnimationShader = vertexAnimationTech->getShader(VertexAnimationTech::LIT);
+                        vertexAnimationShader->use();
+                        setCameraUniforms(vertexAnimationShader, camera, lightSpaceMatrices, frame);
+                        drawVertexAnimations(frame, vertexAnimationShader);
                     }
-                    auto shadowCascadeLevels = directionalLightShadowTech->getShadowCascadeLevels(camera);
-                    for (int i = 0; i < shadowCascadeLevels.size(); ++i) {
-                        lightingShader->setFloat("cascadePlaneDistances[" + std::to_string(i) + "]", shadowCascadeLevels.at(i));
-                    }
-                    drawEntities(Project::getScene()->getRootEntity(), camera, lightingShader);
                 } else {
                     singleTextureShader->use();
                     singleTextureShader->setMat4("projection", camera.getProjectionMatrix());
                     singleTextureShader->setMat4("view", camera.getViewMatrix());
-                    drawEntities(Project::getScene()->getRootEntity(), camera, singleTextureShader);
+                    drawMeshes(frame, singleTextureShader);
+                    if (!frame.vertexAnimationBatches.empty()) {
+                        auto *vertexAnimationShader = vertexAnimationTech->getShader(VertexAnimationTech::SINGLE_TEXTURE);
+                        vertexAnimationShader->use();
+                        vertexAnimationShader->setMat4("projection", camera.getProjectionMatrix());
+                        vertexAnimationShader->setMat4("view", camera.getViewMatrix());
+                        drawVertexAnimations(frame, vertexAnimationShader);
+                    }
                 }
-            }
+            });
 
-            {
+            renderGraph->addPass("terrains", shadowMaps, {output}, [&, camera, lightSpaceMatrices]() mutable {
+                bindOutput();
+                resolveShadowMaps();
                 glEnable(GL_CULL_FACE);
                 glCullFace(GL_BACK);
-                // draw terrains
                 terrainShader->use();
-                terrainShader->setMat4("projection", camera.getProjectionMatrix());
-                terrainShader->setMat4("view", camera.getViewMatrix());
-                terrainShader->setFloat("farPlane", camera.zFar);
-                glm::vec3 viewPos = camera.position;
-                terrainShader->setVec3("viewPos", viewPos);
-                terrainShader->setVec3("shadowDirectionalLightDir", directionalLightShadowTech->getDirectionalLightDirection());
-                for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
-                    terrainShader->setMat4("lightSpaceMatrices[" + std::to_string(i) + "]", lightSpaceMatrices.at(i));
-                }
-                auto shadowCascadeLevels = directionalLightShadowTech->getShadowCascadeLevels(camera);
-                for (int i = 0; i < shadowCascadeLevels.size(); ++i) {
-                    terrainShader->setFloat("cascadePlaneDistances[" + std::to_string(i) + "]", shadowCascadeLevels.at(i));
-                }
-                drawTerrains(camera, terrainShader);
+                setCameraUniforms(terrainShader, camera, lightSpaceMatrices, frame);
+                drawTerrains(frame, terrainShader, camera.getProjectionMatrix() * camera.getViewMatrix());
                 glDisable(GL_CULL_FACE);
-            }
+            });
 
-            {
-                // draw physics debug
-                if (Project::getConfig().physicsConfig.physicsDebugger && (!Project::isPlaying() || (Project::isPlaying() && Project::getConfig().physicsConfig.physicsDebuggerWhilePlaying))) {
-                    if (Project::getConfig().physicsConfig.depthTest) {
-                        glEnable(GL_DEPTH_TEST);
-                    } else {
-                        glDisable(GL_DEPTH_TEST);
-                    }
-                    physicsDebugShader->use();
-                    physicsDebugShader->setMat4("projection", camera.getProjectionMatrix());
-                    physicsDebugShader->setMat4("view", camera.getViewMatrix());
-                    if (Project::getScene()->getPhysicsComponentSystem()) {
-                        Project::getScene()->getPhysicsComponentSystem()->debugDrawWorld();
-                    }
-                    if (!Project::getConfig().physicsConfig.depthTest) {
-                        glEnable(GL_DEPTH_TEST);
-                    }
+            renderGraph->addPass("physics debug", {}, {output}, [&, camera]() mutable {
+                bindOutput();
+                if (frame.config.physicsConfig.depthTest) {
+                    glEnable(GL_DEPTH_TEST);
+                } else {
+                    glDisable(GL_DEPTH_TEST);
                 }
-            }
+                physicsDebugShader->use();
+                physicsDebugShader->setMat4("projection", camera.getProjectionMatrix());
+                physicsDebugShader->setMat4("view", camera.getViewMatrix());
+                OpenGLPhysicsDebugDrawer::drawLines(frame.physicsDebugLines);
+                if (!frame.config.physicsConfig.depthTest) {
+                    glEnable(GL_DEPTH_TEST);
+                }
+            }, frame.drawPhysicsDebug);
 
-            // draw skybox
-            {
+            renderGraph->addPass("skybox", {}, {output}, [&, camera]() mutable {
                 // draw skybox as last
+                bindOutput();
                 glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
                 skyboxShader->use();
                 auto skyboxView = glm::mat4(glm::mat3(camera.getViewMatrix()));
@@ -250,130 +395,120 @@ namespace Dream {
                 glBindVertexArray(skybox->getVAO());
                 glActiveTexture(GL_TEXTURE0);
                 glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->getTexture());
+                OpenGLRenderStats::countTextureBind();
                 glDrawArrays(GL_TRIANGLES, 0, 36);
+                OpenGLRenderStats::countDrawCall(12);
                 glBindVertexArray(0);
                 glDepthFunc(GL_LESS); // set depth function back to default
-            }
+            });
         } else {
-            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderGraph->addPass("clear output", {}, {output}, [&]() {
+                bindOutput();
+                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            });
         }
 
+        renderGraph->compile();
+        renderGraph->execute(renderTargetPool);
+
         // bind the default screen frame buffer
-        this->outputRenderTextureFbo->unbind();
+        auto outputFbo = renderGraph->getOutputFrameBuffer();
+        outputFbo->unbind();
 
         // clear framebuffer and return its texture
-        this->outputRenderTextureFbo->clear();
+        outputFbo->clear();
 
-        if (fullscreen) {
-            this->outputRenderTextureFbo->renderScreenQuad();
+        if (frame.fullscreen) {
+            glViewport(0, 0, viewportWidth * 2, viewportHeight * 2);
+            outputFbo->renderScreenQuad();
         }
     }
 
-    void OpenGLRenderer::drawTerrains(Camera camera, OpenGLShader* shader) {
-        auto terrainEntities = Project::getScene()->getEntitiesWithComponents<Component::TerrainComponent>();
-        for (auto entityHandle: terrainEntities) {
-            Entity entity = {entityHandle, Project::getScene()};
-            // render terrain
-            if (!entity.getComponent<Component::TerrainComponent>().guid.empty()) {
-                if (!entity.getComponent<Component::TerrainComponent>().terrain) {
-                    // TODO: store in resource manager instead
-                    // load terrain if necessary
-//                    entity.getComponent<Component::TerrainComponent>().terrain = new OpenGLBaseTerrain(4.0, 200.0);
-//                    auto terrainFilePath = Project::getResourceManager()->getFilePathFromGUID(entity.getComponent<Component::TerrainComponent>().guid);
-//                    entity.getComponent<Component::TerrainComponent>().terrain->loadFromFile(terrainFilePath.c_str());
-                    entity.getComponent<Component::TerrainComponent>().initializeTerrain();
-                }
-                for (int i = 0; i < MAX_BONES; i++) {
-                    shader->setMat4("finalBonesMatrices[" + std::to_string(i) + "]", glm::mat4(1.0));
-                }
-                glm::mat4 model = entity.getComponent<Component::TransformComponent>().getTransform(entity);
-                shader->setMat4("model", model);
-                lightingTech->setTextureAndColorUniforms(entity, shadowMapFbos, directionalLightShadowTech, shader);
-                entity.getComponent<Component::TerrainComponent>().terrain->setShaderUniforms(shader);
-                entity.getComponent<Component::TerrainComponent>().terrain->render();
+    void OpenGLRenderer::drawTerrains(const FrameSnapshot &frame, OpenGLShader *shader, const glm::mat4 &viewProjection,
+                                      int lodBias, bool cullDepth) {
+        for (const auto &drawItem: frame.terrains) {
+            for (int i = 0; i < MAX_BONES; i++) {
+                shader->setMat4("finalBonesMatrices[" + std::to_string(i) + "]", glm::mat4(1.0));
             }
+            shader->setMat4("model", drawItem.model);
+            lightingTech->setTextureAndColorUniforms(frame, drawItem.material, shadowMapFbos, directionalLightShadowTech, shader);
+            drawItem.terrain->setShaderUniforms(shader);
+            drawItem.terrain->render(drawItem.model, viewProjection, frame.camera->position, lodBias, cullDepth);
         }
     }
 
-    void OpenGLRenderer::drawEntities(Entity entity, Camera camera, OpenGLShader* shader) {
-        // set bones for animated meshes
-        skinningTech->setJointUniforms(entity, shader);
-
-        // draw mesh of entity
-        if (entity.hasComponent<Component::MeshComponent>()) {
-            // load mesh of entity
-            // TODO: only load when necessary (add a flag internally - and reset it when fields are modified)
-            entity.getComponent<Component::MeshComponent>().loadMesh();
+    void OpenGLRenderer::drawMeshes(const FrameSnapshot &frame, OpenGLShader *shader) {
+        for (const auto &drawItem: frame.meshes) {
+            // set bones for animated meshes that were not skinned earlier in the frame
+            if (drawItem.skinnedVertexBuffer == -1) {
+                skinningTech->setJointUniforms(frame, drawItem, shader);
+            }
 
             // set textures and colors used for the shader code to color, light, and shade the entity
-            lightingTech->setTextureAndColorUniforms(entity, shadowMapFbos, directionalLightShadowTech, shader);
-
-            // get transform of entity
-            glm::mat4 model = entity.getComponent<Component::TransformComponent>().getTransform(entity);
-            shader->setMat4("model", model);
-
-            // draw mesh of entity
-            if (!entity.getComponent<Component::MeshComponent>().fileId.empty() || entity.getComponent<Component::MeshComponent>().meshType != Component::MeshComponent::FROM_FILE) {
-                auto guid = entity.getComponent<Component::MeshComponent>().getMeshGuid();
-                auto fileId = entity.getComponent<Component::MeshComponent>().getMeshFileID();
-                auto mesh = Project::getResourceManager()->getMeshData(guid, fileId);
-                if (auto openGLMesh = std::dynamic_pointer_cast<OpenGLMesh>(mesh)) {
-                    drawMesh(openGLMesh);
-                } else {
-                    Logger::fatal("Unable to dynamic cast Mesh to type OpenGLMesh for entity " + entity.getComponent<Component::IDComponent>().id);
-                }
+            lightingTech->setTextureAndColorUniforms(frame, drawItem.material, shadowMapFbos, directionalLightShadowTech, shader);
+
+            shader->setMat4("model", drawItem.model);
+            drawMesh(drawItem.mesh, skinningTech->getVertexArray(drawItem));
+        }
+    }
+
+    void OpenGLRenderer::drawVertexAnimations(const FrameSnapshot &frame, OpenGLShader *shader) {
+        for (int batch = 0; batch < frame.vertexAnimationBatches.size(); batch++) {
+            const auto &subMeshes = frame.vertexAnimationBatches[batch].subMeshes;
+            for (int subMesh = 0; subMesh < subMeshes.size(); subMesh++) {
+                lightingTech->setTextureAndColorUniforms(frame, subMeshes[subMesh].material, shadowMapFbos, directionalLightShadowTech, shader);
+                vertexAnimationTech->drawInstances(frame, batch, subMesh, shader);
             }
         }
+    }
 
-        // draw child entities
-        Entity child = entity.getComponent<Component::HierarchyComponent>().first;
-        while (child) {
-            drawEntities(child, camera, shader);
-            child = child.getComponent<Component::HierarchyComponent>().next;
+    void OpenGLRenderer::setCameraUniforms(OpenGLShader *shader, Camera &camera, const std::vector<glm::mat4> &lightSpaceMatrices,
+                                           const FrameSnapshot &frame) {
+        shader->setMat4("projection", camera.getProjectionMatrix());
+        shader->setMat4("view", camera.getViewMatrix());
+        shader->setFloat("farPlane", camera.zFar);
+        shader->setVec3("viewPos", camera.position);
+        shader->setVec3("shadowDirectionalLightDir", frame.shadowDirectionalLightDirection);
+        for (int i = 0; i < directionalLightShadowTech->getNumCascades(); ++i) {
+            shader->setMat4("lightSpaceMatrices[" + std::to_string(i) + "]", lightSpaceMatrices.at(i));
+        }
+        auto shadowCascadeLevels = directionalLightShadowTech->getShadowCascadeLevels(camera);
+        for (int i = 0; i < shadowCascadeLevels.size(); ++i) {
+            shader->setFloat("cascadePlaneDistances[" + std::to_string(i) + "]", shadowCascadeLevels.at(i));
         }
     }
 
-    void OpenGLRenderer::drawMesh(std::shared_ptr<OpenGLMesh> openGLMesh) {
+    void OpenGLRenderer::drawMesh(std::shared_ptr<OpenGLMesh> openGLMesh, unsigned int vao) {
         if (!openGLMesh->getIndices().empty()) {
             // case where vertices are indexed
             auto numIndices = openGLMesh->getIndices().size();
-            glBindVertexArray(openGLMesh->getVAO());
+            glBindVertexArray(vao);
             glDrawElements(GL_TRIANGLES, (int) numIndices, GL_UNSIGNED_INT, nullptr);
+            OpenGLRenderStats::countDrawCall((long long) numIndices / 3);
             glBindVertexArray(0);
         } else if (!openGLMesh->getVertices().empty()) {
             // case where vertices are not indexed
-            glBindVertexArray(openGLMesh->getVAO());
+            glBindVertexArray(vao);
             glDrawArrays(GL_TRIANGLES, 0, (int) openGLMesh->getVertices().size());
+            OpenGLRenderStats::countDrawCall((long long) openGLMesh->getVertices().size() / 3);
             glBindVertexArray(0);
         } else {
             Logger::fatal("Unable to render mesh");
         }
     }
 
-    void OpenGLRenderer::resizeFrameBuffer() {
-        // resize framebuffer whenever there is a new viewport size
-        GLint viewportWidth = this->getViewportDimensions().first;
-        GLint viewportHeight = this->getViewportDimensions().second;
-        if (outputRenderTextureFbo->getWidth() != viewportWidth || outputRenderTextureFbo->getHeight() != viewportHeight) {
-            outputRenderTextureFbo->resize(viewportWidth, viewportHeight);
-        }
-    }
-
     void OpenGLRenderer::printGLVersion() {
         Logger::info("GL Vendor: " + std::string((const char *) glGetString(GL_VENDOR)));
         Logger::info("GL Renderer: " + std::string((const char *) glGetString(GL_RENDERER)));
         Logger::info("GL Version: " + std::string((const char *) glGetString(GL_VERSION)));
     }
 
-    std::pair<int, int> OpenGLRenderer::getViewportDimensions() {
-        GLint dims[4] = {0};
-        glGetIntegerv(GL_VIEWPORT, dims);
-        return std::make_pair(dims[2], dims[3]);
+    unsigned int OpenGLRenderer::getOutputRenderTexture() {
+        return renderGraph->getOutputFrameBuffer()->getTexture();
     }
 
-    unsigned int OpenGLRenderer::getOutputRenderTexture() {
-//        return this->shadowMapFbos.at(0)->getTexture();
-        return this->outputRenderTextureFbo->getTexture();
+    OpenGLRenderGraph *OpenGLRenderer::getRenderGraph() {
+        return renderGraph;
     }
 }
@@ -18,6 +18,7 @@
 
 #include "dream/renderer/OpenGLShader.h"
 #include "dream/util/Logger.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 
 #include <string>
 #include <fstream>
@@ -27,7 +28,8 @@
 #include <glad/glad.h>
 
 namespace Dream {
-    OpenGLShader::OpenGLShader(const char *vertexPath, const char *fragmentPath, const char *geometryPath) {
+    OpenGLShader::OpenGLShader(const char *vertexPath, const char *fragmentPath, const char *geometryPath,
+                               const std::vector<std::string> &transformFeedbackVaryings) {
         if (!std::filesystem::exists(vertexPath)) {
             Logger::fatal("Vertex shader file does not exist " + std::string(vertexPath));
         }
@@ -111,6 +113,14 @@ namespace Dream {
         glAttachShader(ID, fragment);
         if (geometryPath != nullptr)
             glAttachShader(ID, geometry);
+        // varyings have to be specified before linking
+        if (!transformFeedbackVaryings.empty()) {
+            std::vector<const char *> varyings;
+            for (const auto &varying: transformFeedbackVaryings) {
+                varyings.push_back(varying.c_str());
+            }
+            glTransformFeedbackVaryings(ID, (int) varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+        }
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessery
@@ -121,51 +131,75 @@ namespace Dream {
     }
 
     void OpenGLShader::use() {
+        // only count actual changes of program, the editor binds its own programs so this is approximate across frames
+        if (ID != currentProgram) {
+            OpenGLRenderStats::countProgramSwitch();
+            currentProgram = ID;
+        }
         glUseProgram(ID);
     }
 
     void OpenGLShader::setBool(const std::string &name, bool value) const {
         glUniform1i(glGetUniformLocation(ID, name.c_str()), (int) value);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setInt(const std::string &name, int value) const {
         glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setFloat(const std::string &name, float value) const {
         glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setVec2(const std::string &name, const glm::vec2 &value) const {
         glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setVec3(const std::string &name, const glm::vec3 &value) const {
         glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setVec3(const std::string &name, float x, float y, float z) const {
         glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setVec4(const std::string &name, const glm::vec4 &value) const {
         glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setVec4(const std::string &name, float x, float y, float z, float w) {
         glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setMat2(const std::string &name, const glm::mat2 &mat) const {
         glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setMat3(const std::string &name, const glm::mat3 &mat) const {
         glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::setMat4(const std::string &name, const glm::mat4 &mat) const {
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        OpenGLRenderStats::countUniformUpload();
+    }
+
+    void OpenGLShader::setMat4Array(const std::string &name, const glm::mat4 *mats, int count) const {
+        if (count <= 0) {
+            return;
+        }
+        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), count, GL_FALSE, &mats[0][0][0]);
+        OpenGLRenderStats::countUniformUpload();
     }
 
     void OpenGLShader::checkCompileErrors(int shader, std::string type) {
@@ -4,6 +4,7 @@
 
 #include "dream/renderer/OpenGLShadowMapFBO.h"
 #include "dream/renderer/OpenGLRenderer.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 
 namespace Dream {
     OpenGLShadowMapFBO::OpenGLShadowMapFBO(int width, int height) {
@@ -34,7 +35,8 @@ namespace Dream {
     }
 
     OpenGLShadowMapFBO::~OpenGLShadowMapFBO() {
-
+        glDeleteFramebuffers(1, &depthMapFBO);
+        glDeleteTextures(1, &depthMap);
     }
 
     void OpenGLShadowMapFBO::bind() {
@@ -48,6 +50,7 @@ namespace Dream {
     void OpenGLShadowMapFBO::bindForReading(int unit) {
         glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, depthMap);
+        OpenGLRenderStats::countTextureBind();
     }
 
     unsigned int OpenGLShadowMapFBO::getTexture() {
@@ -18,6 +18,7 @@
 
 #include "dream/renderer/OpenGLTexture.h"
 #include "dream/util/Logger.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 
 #include <cassert>
 
@@ -137,6 +138,7 @@ namespace Dream {
         if (unit >= 0)
             glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, id);
+        OpenGLRenderStats::countTextureBind();
     }
 
     void OpenGLTexture::unbind() {
@@ -5,6 +5,10 @@
 #include "dream/renderer/OpenGLTriangleList.h"
 #include "dream/renderer/OpenGLBaseTerrain.h"
 #include "dream/renderer/OpenGLRenderer.h"
+#include "dream/renderer/OpenGLRenderStats.h"
+#include "dream/util/MathUtils.h"
+#include <algorithm>
+#include <cmath>
 #include <utility>
 #include <vector>
 #include <functional>
@@ -15,126 +19,328 @@ namespace Dream {
 
     }
 
+    OpenGLTriangleList::~OpenGLTriangleList() {
+        destroy();
+    }
+
     void OpenGLTriangleList::createTriangleList(int width, int depth, const OpenGLBaseTerrain *pTerrain) {
-        if (m_vao != -1) {
-            glDeleteVertexArrays(1, &m_vao);
+        destroy();
+
+        m_width = width;
+        m_depth = depth;
+        m_worldScale = pTerrain->getWorldScale();
+        m_numChunksX = std::max((m_width - 2) / chunkSize + 1, 1);
+        m_numChunksZ = std::max((m_depth - 2) / chunkSize + 1, 1);
+
+        for (int cz = 0; cz < m_numChunksZ; cz++) {
+            for (int cx = 0; cx < m_numChunksX; cx++) {
+                Chunk chunk;
+                chunk.startX = cx * chunkSize;
+                chunk.startZ = cz * chunkSize;
+                chunk.width = std::min(chunkSize, m_width - 1 - chunk.startX) + 1;
+                chunk.depth = std::min(chunkSize, m_depth - 1 - chunk.startZ) + 1;
+                while ((2 << chunk.maxLod) <= chunkSize && (chunk.width - 1) % (2 << chunk.maxLod) == 0 &&
+                       (chunk.depth - 1) % (2 << chunk.maxLod) == 0) {
+                    chunk.maxLod++;
+                }
+                createGLState(chunk);
+                populateBuffers(pTerrain, chunk);
+                m_chunks.push_back(chunk);
+            }
         }
+        m_chunkLods.resize(m_chunks.size(), 0);
+
+        buildNode(0, 0, m_numChunksX - 1, m_numChunksZ - 1);
+        updateNodeBounds(0);
 
-        if (m_vb != -1) {
-            glDeleteBuffers(1, &m_vb);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void OpenGLTriangleList::markDirty(int minX, int minZ, int maxX, int maxZ) {
+        minX = std::max(minX, 0);
+        minZ = std::max(minZ, 0);
+        maxX = std::min(maxX, m_width - 1);
+        maxZ = std::min(maxZ, m_depth - 1);
+        if (m_chunks.empty() || minX > maxX || minZ > maxZ) {
+            return;
+        }
+        // vertices on a chunk border belong to both chunks
+        int minChunkX = std::max((minX - 1) / chunkSize, 0);
+        int minChunkZ = std::max((minZ - 1) / chunkSize, 0);
+        int maxChunkX = std::min(maxX / chunkSize, m_numChunksX - 1);
+        int maxChunkZ = std::min(maxZ / chunkSize, m_numChunksZ - 1);
+        for (int cz = minChunkZ; cz <= maxChunkZ; cz++) {
+            for (int cx = minChunkX; cx <= maxChunkX; cx++) {
+                auto &chunk = m_chunks[cz * m_numChunksX + cx];
+                if (maxX < chunk.startX || minX >= chunk.startX + chunk.width ||
+                    maxZ < chunk.startZ || minZ >= chunk.startZ + chunk.depth) {
+                    continue;
+                }
+                int localMinZ = std::max(minZ - chunk.startZ, 0);
+                int localMaxZ = std::min(maxZ - chunk.startZ, chunk.depth - 1);
+                if (chunk.dirtyMinZ == -1) {
+                    chunk.dirtyMinZ = localMinZ;
+                    chunk.dirtyMaxZ = localMaxZ;
+                } else {
+                    chunk.dirtyMinZ = std::min(chunk.dirtyMinZ, localMinZ);
+                    chunk.dirtyMaxZ = std::max(chunk.dirtyMaxZ, localMaxZ);
+                }
+            }
+        }
+    }
+
+    bool OpenGLTriangleList::updateDirtyChunks(const OpenGLBaseTerrain *pTerrain) {
+        bool updated = false;
+        std::vector<Vertex> Vertices;
+        for (auto &chunk: m_chunks) {
+            if (chunk.dirtyMinZ == -1) {
+                continue;
+            }
+            // rows are contiguous in the vertex buffer, so the modified rows are uploaded with a single call
+            initVertices(pTerrain, chunk, chunk.dirtyMinZ, chunk.dirtyMaxZ, Vertices);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vb);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (chunk.dirtyMinZ * chunk.width * sizeof(Vertex)),
+                            (GLsizeiptr) (Vertices.size() * sizeof(Vertex)), &Vertices[0]);
+            updateHeightRange(pTerrain, chunk);
+            chunk.dirtyMinZ = -1;
+            chunk.dirtyMaxZ = -1;
+            updated = true;
         }
+        if (updated) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            updateNodeBounds(0);
+        }
+        return updated;
+    }
 
-        if (m_ib != -1) {
-            glDeleteBuffers(1, &m_ib);
+    void OpenGLTriangleList::render(const glm::mat4 &clipFromLocal, glm::vec3 lodOrigin, int lodBias, bool cullDepth) {
+        if (m_chunks.empty()) {
+            return;
         }
 
-        m_width = width;
-        m_depth = depth;
+        // frustum planes in terrain-local space (Gribb-Hartmann), ordered left, right, bottom, top, near, far
+        glm::vec4 planes[6];
+        MathUtils::getFrustumPlanes(clipFromLocal, planes);
 
-        createGLState();
-        populateBuffers(pTerrain);
+        // levels of detail are chosen for every chunk (not just visible ones) since edges are stitched to neighbors
+        for (int i = 0; i < m_chunks.size(); i++) {
+            m_chunkLods[i] = selectLod(m_chunks[i], lodOrigin, lodBias);
+        }
 
-//        glBindVertexArray(0);
-//        glBindBuffer(GL_ARRAY_BUFFER, 0);
-//        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        std::vector<int> visibleChunks;
+        collectVisibleChunks(0, planes, cullDepth ? 6 : 4, visibleChunks);
+
+        for (int chunkIndex: visibleChunks) {
+            const auto &chunk = m_chunks[chunkIndex];
+            int cx = chunkIndex % m_numChunksX;
+            int cz = chunkIndex / m_numChunksX;
+            int step = 1 << m_chunkLods[chunkIndex];
+            // an edge only needs stitching when the neighbor is coarser, in which case it uses the neighbor's step
+            auto edgeStep = [&](int neighborX, int neighborZ) {
+                if (neighborX < 0 || neighborZ < 0 || neighborX >= m_numChunksX || neighborZ >= m_numChunksZ) {
+                    return 0;
+                }
+                int neighborStep = 1 << m_chunkLods[neighborZ * m_numChunksX + neighborX];
+                return neighborStep > step ? neighborStep : 0;
+            };
+            const auto &indexBuffer = getIndexBuffer({chunk.width, chunk.depth, step,
+                                                      edgeStep(cx - 1, cz), edgeStep(cx + 1, cz),
+                                                      edgeStep(cx, cz - 1), edgeStep(cx, cz + 1)});
+            glBindVertexArray(chunk.vao);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.ib);
+            glDrawElements(GL_TRIANGLES, indexBuffer.numIndices, GL_UNSIGNED_INT, NULL);
+            OpenGLRenderStats::countDrawCall(indexBuffer.numIndices / 3);
+            // restore the full resolution index buffer that is part of the vertex array state
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ib);
+        }
+        glBindVertexArray(0);
     }
 
-    void OpenGLTriangleList::render() {
-        glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, (m_depth - 1) * (m_width - 1) * 6, GL_UNSIGNED_INT, NULL);
-        glBindVertexArray(0);
+    const std::vector<OpenGLTriangleList::Chunk> &OpenGLTriangleList::getChunks() const {
+        return m_chunks;
     }
 
-    void OpenGLTriangleList::createGLState() {
-        glGenVertexArrays(1, &m_vao);
-        glBindVertexArray(m_vao);
-        glGenBuffers(1, &m_vb);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vb);
-        glGenBuffers(1, &m_ib);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ib);
-
-//        int POS_LOC = 0;
-//        size_t NumFloats = 0;
-//        glEnableVertexAttribArray(POS_LOC);
-//        glVertexAttribPointer(POS_LOC, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(NumFloats * sizeof(float)));
-//        NumFloats += 3;
-
-        // calculate stride from number of non-empty vertex attribute arrays
-        size_t stride = 3 * sizeof(float);  // positions
-        stride += 2 * sizeof(float);        // uvs
-        stride += 3 * sizeof(float);        // normals
-        stride += 3 * sizeof(float);        // tangents
-        stride += 3 * sizeof(float);        // bitangents
-        stride += MAX_BONE_INFLUENCE * sizeof(int);          // for bone ids
-        stride += MAX_BONE_INFLUENCE * sizeof(float);        // for weights
+    void OpenGLTriangleList::destroy() {
+        for (auto &chunk: m_chunks) {
+            glDeleteVertexArrays(1, &chunk.vao);
+            glDeleteBuffers(1, &chunk.vb);
+        }
+        m_chunks.clear();
+        m_nodes.clear();
+        m_chunkLods.clear();
+        for (auto &[key, indexBuffer]: m_indexBuffers) {
+            glDeleteBuffers(1, &indexBuffer.ib);
+        }
+        m_indexBuffers.clear();
+    }
+
+    int OpenGLTriangleList::buildNode(int minChunkX, int minChunkZ, int maxChunkX, int maxChunkZ) {
+        int nodeIndex = (int) m_nodes.size();
+        m_nodes.push_back(Node{
+                .minChunkX=minChunkX,
+                .minChunkZ=minChunkZ,
+                .maxChunkX=maxChunkX,
+                .maxChunkZ=maxChunkZ
+        });
+        if (minChunkX == maxChunkX && minChunkZ == maxChunkZ) {
+            return nodeIndex;
+        }
+        int midChunkX = (minChunkX + maxChunkX) / 2;
+        int midChunkZ = (minChunkZ + maxChunkZ) / 2;
+        int ranges[4][4] = {
+                {minChunkX,     minChunkZ,     midChunkX, midChunkZ},
+                {midChunkX + 1, minChunkZ,     maxChunkX, midChunkZ},
+                {minChunkX,     midChunkZ + 1, midChunkX, maxChunkZ},
+                {midChunkX + 1, midChunkZ + 1, maxChunkX, maxChunkZ}
+        };
+        for (int i = 0; i < 4; i++) {
+            // nodes that are a single chunk wide only split along one axis
+            if (ranges[i][0] > ranges[i][2] || ranges[i][1] > ranges[i][3]) {
+                continue;
+            }
+            int child = buildNode(ranges[i][0], ranges[i][1], ranges[i][2], ranges[i][3]);
+            m_nodes[nodeIndex].children[i] = child;
+        }
+        return nodeIndex;
+    }
+
+    void OpenGLTriangleList::updateNodeBounds(int nodeIndex) {
+        auto &node = m_nodes[nodeIndex];
+        bool leaf = true;
+        for (int child: node.children) {
+            if (child == -1) {
+                continue;
+            }
+            updateNodeBounds(child);
+            const auto &childNode = m_nodes[child];
+            node.boundsMin = leaf ? childNode.boundsMin : glm::min(node.boundsMin, childNode.boundsMin);
+            node.boundsMax = leaf ? childNode.boundsMax : glm::max(node.boundsMax, childNode.boundsMax);
+            leaf = false;
+        }
+        if (leaf) {
+            const auto &chunk = m_chunks[node.minChunkZ * m_numChunksX + node.minChunkX];
+            node.boundsMin = {(float) chunk.startX * m_worldScale, chunk.minHeight, (float) chunk.startZ * m_worldScale};
+            node.boundsMax = {(float) (chunk.startX + chunk.width - 1) * m_worldScale, chunk.maxHeight,
+                              (float) (chunk.startZ + chunk.depth - 1) * m_worldScale};
+        }
+    }
+
+    void OpenGLTriangleList::collectVisibleChunks(int nodeIndex, const glm::vec4 *planes, int numPlanes,
+                                                  std::vector<int> &visibleChunks) {
+        const auto &node = m_nodes[nodeIndex];
+        for (int i = 0; i < numPlanes; i++) {
+            // corner of the bounding box furthest along the plane normal
+            glm::vec3 positiveVertex = {
+                    planes[i].x >= 0 ? node.boundsMax.x : node.boundsMin.x,
+                    planes[i].y >= 0 ? node.boundsMax.y : node.boundsMin.y,
+                    planes[i].z >= 0 ? node.boundsMax.z : node.boundsMin.z
+            };
+            if (glm::dot(glm::vec3(planes[i]), positiveVertex) + planes[i].w < 0) {
+                return;
+            }
+        }
+        bool leaf = true;
+        for (int child: node.children) {
+            if (child != -1) {
+                collectVisibleChunks(child, planes, numPlanes, visibleChunks);
+                leaf = false;
+            }
+        }
+        if (leaf) {
+            visibleChunks.push_back(node.minChunkZ * m_numChunksX + node.minChunkX);
+        }
+    }
+
+    int OpenGLTriangleList::selectLod(const Chunk &chunk, glm::vec3 lodOrigin, int lodBias) const {
+        glm::vec3 boundsMin = {(float) chunk.startX * m_worldScale, chunk.minHeight, (float) chunk.startZ * m_worldScale};
+        glm::vec3 boundsMax = {(float) (chunk.startX + chunk.width - 1) * m_worldScale, chunk.maxHeight,
+                               (float) (chunk.startZ + chunk.depth - 1) * m_worldScale};
+        float distance = glm::distance(lodOrigin, glm::clamp(lodOrigin, boundsMin, boundsMax));
+        // full detail within one chunk of the camera, then one level coarser every time the distance doubles
+        float lodDistance = (float) chunkSize * m_worldScale;
+        int lod = distance < lodDistance ? 0 : (int) std::log2(distance / lodDistance) + 1;
+        return std::clamp(lod + lodBias, 0, chunk.maxLod);
+    }
+
+    const OpenGLTriangleList::IndexBuffer &OpenGLTriangleList::getIndexBuffer(const IndexBufferKey &key) {
+        auto it = m_indexBuffers.find(key);
+        if (it != m_indexBuffers.end()) {
+            return it->second;
+        }
+        std::vector<unsigned int> Indices;
+        initIndices(key, Indices);
+        IndexBuffer indexBuffer;
+        indexBuffer.numIndices = (int) Indices.size();
+        glGenBuffers(1, &indexBuffer.ib);
+        // bind through the currently bound vertex array since that is where the element buffer binding lives
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.ib);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(unsigned int), Indices.data(), GL_STATIC_DRAW);
+        return m_indexBuffers[key] = indexBuffer;
+    }
+
+    void OpenGLTriangleList::createGLState(Chunk &chunk) {
+        glGenVertexArrays(1, &chunk.vao);
+        glBindVertexArray(chunk.vao);
+        glGenBuffers(1, &chunk.vb);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vb);
+
+        // chunks with the same dimensions have identical (chunk-relative) indices
+        chunk.ib = getIndexBuffer({chunk.width, chunk.depth, 1, 0, 0, 0, 0}).ib;
+        // element buffer binding is part of the vertex array state
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ib);
+
+        size_t stride = sizeof(Vertex);
 
         // positions
-        size_t offset = 0;
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-        offset += 3 * sizeof(float);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, position));
 
         // uvs
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-        offset += 2 * sizeof(float);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, uv));
 
         // normals
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-        offset += 3 * sizeof(float);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, normal));
 
         // tangents
         glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-        offset += 3 * sizeof(float);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, tangent));
 
         // bitangents
         glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *) offset);
-        offset += 3 * sizeof(float);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, bitangent));
 
         // bone ids
         glEnableVertexAttribArray(5);
-        glVertexAttribIPointer(5, MAX_BONE_INFLUENCE, GL_INT, sizeof(Vertex), (void *) offsetof(Vertex, boneIDs));
-        offset += offsetof(Vertex, boneIDs);
+        glVertexAttribIPointer(5, MAX_BONE_INFLUENCE, GL_INT, stride, (void *) offsetof(Vertex, boneIDs));
 
         // weights
         glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, MAX_BONE_INFLUENCE, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                              (void *) offsetof(Vertex, boneWeights));
-        offset += offsetof(Vertex, boneWeights);
+        glVertexAttribPointer(6, MAX_BONE_INFLUENCE, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(Vertex, boneWeights));
     }
 
-    void OpenGLTriangleList::populateBuffers(const OpenGLBaseTerrain *pTerrain) {
+    void OpenGLTriangleList::populateBuffers(const OpenGLBaseTerrain *pTerrain, Chunk &chunk) {
         std::vector<Vertex> Vertices;
-        Vertices.resize(m_width * m_depth);
-
-        initVertices(pTerrain, Vertices);
+        initVertices(pTerrain, chunk, 0, chunk.depth - 1, Vertices);
 
-        std::vector<unsigned int> Indices;
-        int NumQuads = (m_width - 1) * (m_depth - 1);
-        Indices.resize(NumQuads * 6);
-        initIndices(Indices);
-
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertices[0]) * Vertices.size(), &Vertices[0], GL_STATIC_DRAW);
-//        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Indices[0]) * Indices.size(), &Indices[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vb);
+        // dynamic since sculpting updates parts of the buffer
+        glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), &Vertices[0], GL_DYNAMIC_DRAW);
 
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vb);
-        glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), &Vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ib);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(unsigned int), &Indices[0], GL_STATIC_DRAW);
+        updateHeightRange(pTerrain, chunk);
     }
 
-    void OpenGLTriangleList::initVertices(const OpenGLBaseTerrain *pTerrain, std::vector<Vertex> &Vertices) {
+    void OpenGLTriangleList::initVertices(const OpenGLBaseTerrain *pTerrain, const Chunk &chunk, int minZ, int maxZ,
+                                          std::vector<Vertex> &Vertices) {
+        Vertices.resize((maxZ - minZ + 1) * chunk.width);
         int Index = 0;
 
-        for (int z = 0; z < m_depth; z++) {
-            for (int x = 0; x < m_width; x++) {
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = 0; x < chunk.width; x++) {
                 assert(Index < Vertices.size());
-                Vertices[Index].initVertex(pTerrain, x, z);
+                Vertices[Index].initVertex(pTerrain, chunk.startX + x, chunk.startZ + z);
                 Index++;
             }
         }
@@ -142,35 +348,67 @@ namespace Dream {
         assert(Index == Vertices.size());
     }
 
-    void OpenGLTriangleList::initIndices(std::vector<unsigned int> &Indices) {
-        int Index = 0;
+    void OpenGLTriangleList::initIndices(const IndexBufferKey &key, std::vector<unsigned int> &Indices) {
+        auto [width, depth, step, leftStep, rightStep, bottomStep, topStep] = key;
+        Indices.clear();
 
-        for (int z = 0; z < m_depth - 1; z++) {
-            for (int x = 0; x < m_width - 1; x++) {
-                unsigned int IndexBottomLeft = z * m_width + x;
-                unsigned int IndexTopLeft = (z + 1) * m_width + x;
-                unsigned int IndexTopRight = (z + 1) * m_width + x + 1;
-                unsigned int IndexBottomRight = z * m_width + x + 1;
+        // vertices on an edge next to a coarser chunk are snapped to the coarser chunk's vertices, the triangles
+        // that collapse are dropped and the remaining ones fan out to the coarser edge
+        auto snap = [](int coordinate, int edgeStep, int last) {
+            if (edgeStep == 0 || coordinate == last) {
+                return coordinate;
+            }
+            return coordinate / edgeStep * edgeStep;
+        };
+        auto index = [&](int x, int z) {
+            int snappedX = x;
+            int snappedZ = z;
+            if (z == 0) {
+                snappedX = snap(x, bottomStep, width - 1);
+            } else if (z == depth - 1) {
+                snappedX = snap(x, topStep, width - 1);
+            }
+            if (x == 0) {
+                snappedZ = snap(z, leftStep, depth - 1);
+            } else if (x == width - 1) {
+                snappedZ = snap(z, rightStep, depth - 1);
+            }
+            return (unsigned int) (snappedZ * width + snappedX);
+        };
+        auto addTriangle = [&](unsigned int a, unsigned int b, unsigned int c) {
+            if (a != b && b != c && a != c) {
+                Indices.push_back(a);
+                Indices.push_back(b);
+                Indices.push_back(c);
+            }
+        };
+
+        for (int z = 0; z < depth - 1; z += step) {
+            for (int x = 0; x < width - 1; x += step) {
+                unsigned int IndexBottomLeft = index(x, z);
+                unsigned int IndexTopLeft = index(x, z + step);
+                unsigned int IndexTopRight = index(x + step, z + step);
+                unsigned int IndexBottomRight = index(x + step, z);
 
                 // Add top left triangle
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexBottomLeft;
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexTopLeft;
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexTopRight;
+                addTriangle(IndexBottomLeft, IndexTopLeft, IndexTopRight);
 
                 // Add bottom right triangle
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexBottomLeft;
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexTopRight;
-                assert(Index < Indices.size());
-                Indices[Index++] = IndexBottomRight;
+                addTriangle(IndexBottomLeft, IndexTopRight, IndexBottomRight);
             }
         }
+    }
 
-        assert(Index == Indices.size());
+    void OpenGLTriangleList::updateHeightRange(const OpenGLBaseTerrain *pTerrain, Chunk &chunk) {
+        chunk.minHeight = pTerrain->getHeight(chunk.startX, chunk.startZ);
+        chunk.maxHeight = chunk.minHeight;
+        for (int z = chunk.startZ; z < chunk.startZ + chunk.depth; z++) {
+            for (int x = chunk.startX; x < chunk.startX + chunk.width; x++) {
+                float height = pTerrain->getHeight(x, z);
+                chunk.minHeight = std::min(chunk.minHeight, height);
+                chunk.maxHeight = std::max(chunk.maxHeight, height);
+            }
+        }
     }
 
     void OpenGLTriangleList::Vertex::initVertex(const OpenGLBaseTerrain *pTerrain, int x, int z) {
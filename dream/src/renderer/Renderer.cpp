@@ -23,6 +23,20 @@ Dream::Renderer::Renderer() {
 }
 
 void Dream::Renderer::render(int viewportWidth, int viewportHeight, bool fullscreen) {
+    this->prepare();
+    this->extract(viewportWidth, viewportHeight, fullscreen);
+    this->submit();
+}
+
+void Dream::Renderer::prepare() {
+
+}
+
+void Dream::Renderer::extract(int viewportWidth, int viewportHeight, bool fullscreen) {
+
+}
+
+void Dream::Renderer::submit() {
 
 }
 
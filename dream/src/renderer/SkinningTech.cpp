@@ -3,11 +3,39 @@
 //
 
 #include "dream/renderer/SkinningTech.h"
+
+#include <filesystem>
+#include <glad/glad.h>
+#include "dream/project/Project.h"
+#include "dream/renderer/OpenGLRenderStats.h"
 #include "dream/scene/component/Component.h"
 
 namespace Dream {
-    void SkinningTech::setJointUniforms(Entity entity, OpenGLShader *shader) {
-        std::vector<glm::mat4> finalBoneMatrices;
+    namespace {
+        // skinned position, normal and tangent
+        const int skinnedVertexSize = 9 * sizeof(float);
+    }
+
+    SkinningTech::SkinningTech() {
+        auto vertexPath = Project::getPath().append("assets").append("shaders").append("skinning.vert");
+        auto fragmentPath = Project::getPath().append("assets").append("shaders").append("skinning.frag");
+        if (std::filesystem::exists(vertexPath) && std::filesystem::exists(fragmentPath)) {
+            skinningShader = new OpenGLShader(vertexPath.c_str(), fragmentPath.c_str(), nullptr,
+                                              {"skinnedPosition", "skinnedNormal", "skinnedTangent"});
+        } else {
+            Logger::warn("Project has no skinning shader, skinned meshes are skinned in every pass");
+        }
+    }
+
+    SkinningTech::~SkinningTech() {
+        for (auto &buffer: skinnedVertexBuffers) {
+            glDeleteVertexArrays(1, &buffer.vao);
+            glDeleteBuffers(1, &buffer.vbo);
+        }
+        delete skinningShader;
+    }
+
+    void SkinningTech::loadAnimator(Entity entity) {
         if (entity.hasComponent<Component::AnimatorComponent>()) {
             if (entity.hasComponent<Component::MeshComponent>()) {
                 entity.getComponent<Component::MeshComponent>().loadMesh();
@@ -17,11 +45,107 @@ namespace Dream {
             if (entity.getComponent<Component::AnimatorComponent>().needsToLoadAnimations) {
                 entity.getComponent<Component::AnimatorComponent>().loadStateMachine(entity);
             }
-            finalBoneMatrices = entity.getComponent<Component::AnimatorComponent>().m_FinalBoneMatrices;
         }
+    }
+
+    void SkinningTech::getJointMatrices(Entity entity, FrameSnapshot &frame, int &bonePaletteOffset, int &numBones) {
+        if (entity.hasComponent<Component::AnimatorComponent>() && !entity.getComponent<Component::AnimatorComponent>().needsToLoadAnimations) {
+            const auto &finalBoneMatrices = entity.getComponent<Component::AnimatorComponent>().m_FinalBoneMatrices;
+            bonePaletteOffset = (int) frame.bonePalettes.size();
+            numBones = (int) finalBoneMatrices.size();
+            frame.bonePalettes.insert(frame.bonePalettes.end(), finalBoneMatrices.begin(), finalBoneMatrices.end());
+        }
+    }
 
-        for (int i = 0; i < finalBoneMatrices.size(); i++) {
-            shader->setMat4("finalBonesMatrices[" + std::to_string(i) + "]", finalBoneMatrices[i]);
+    void SkinningTech::setJointUniforms(const FrameSnapshot &frame, const MeshDrawItem &drawItem, OpenGLShader *shader) {
+        if (drawItem.numBones > 0) {
+            shader->setMat4Array("finalBonesMatrices", &frame.bonePalettes.at(drawItem.bonePaletteOffset), drawItem.numBones);
         }
     }
-}
\ No newline at end of file
+
+    bool SkinningTech::canPreSkin() {
+        return skinningShader != nullptr;
+    }
+
+    void SkinningTech::skinMeshes(const FrameSnapshot &frame) {
+        if (!skinningShader || frame.numSkinnedMeshes == 0) {
+            return;
+        }
+        if (skinnedVertexBuffers.size() < frame.numSkinnedMeshes) {
+            skinnedVertexBuffers.resize(frame.numSkinnedMeshes);
+        }
+        skinningShader->use();
+        glEnable(GL_RASTERIZER_DISCARD);
+        for (const auto &drawItem: frame.meshes) {
+            if (drawItem.skinnedVertexBuffer == -1) {
+                continue;
+            }
+            auto &buffer = skinnedVertexBuffers.at(drawItem.skinnedVertexBuffer);
+            prepareSkinnedVertexBuffer(buffer, drawItem.mesh);
+            setJointUniforms(frame, drawItem, skinningShader);
+            // every vertex is skinned once as a point, indices are only needed when drawing
+            glBindVertexArray(drawItem.mesh->getVAO());
+            glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer.vbo);
+            glBeginTransformFeedback(GL_POINTS);
+            glDrawArrays(GL_POINTS, 0, (int) drawItem.mesh->getVertices().size());
+            glEndTransformFeedback();
+            OpenGLRenderStats::countDrawCall(0);
+        }
+        // WebGL does not allow drawing from a buffer that is still bound for transform feedback
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glBindVertexArray(0);
+        glDisable(GL_RASTERIZER_DISCARD);
+        // pre-skinned vertex arrays do not have bone ids, so shaders read this value and take the static mesh path
+        glVertexAttribI4i(5, -1, -1, -1, -1);
+    }
+
+    unsigned int SkinningTech::getVertexArray(const MeshDrawItem &drawItem) {
+        if (drawItem.skinnedVertexBuffer != -1 && drawItem.skinnedVertexBuffer < skinnedVertexBuffers.size()) {
+            return skinnedVertexBuffers.at(drawItem.skinnedVertexBuffer).vao;
+        }
+        return drawItem.mesh->getVAO();
+    }
+
+    void SkinningTech::prepareSkinnedVertexBuffer(SkinnedVertexBuffer &buffer, const std::shared_ptr<OpenGLMesh> &mesh) {
+        int numVertices = (int) mesh->getVertices().size();
+        if (buffer.mesh.lock() == mesh && buffer.capacity >= numVertices) {
+            return;
+        }
+        if (!buffer.vao) {
+            glGenVertexArrays(1, &buffer.vao);
+            glGenBuffers(1, &buffer.vbo);
+        }
+        glBindVertexArray(buffer.vao);
+        if (buffer.capacity < numVertices) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) numVertices * skinnedVertexSize, nullptr, GL_DYNAMIC_COPY);
+            buffer.capacity = numVertices;
+        }
+
+        // positions, normals and tangents come from the skinned buffer
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, skinnedVertexSize, (void *) 0);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, skinnedVertexSize, (void *) (3 * sizeof(float)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, skinnedVertexSize, (void *) (6 * sizeof(float)));
+
+        // uvs, bitangents and indices are not affected by skinning
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->getVBO());
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, uv));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, bitangent));
+        if (!mesh->getIndices().empty()) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->getEBO());
+        }
+
+        // bone ids and weights use the constant attribute value set after skinning
+        glDisableVertexAttribArray(5);
+        glDisableVertexAttribArray(6);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        buffer.mesh = mesh;
+    }
+}
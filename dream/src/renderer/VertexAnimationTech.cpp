@@ -0,0 +1,276 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/VertexAnimationTech.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <glad/glad.h>
+#include "dream/project/Project.h"
+#include "dream/renderer/OpenGLRenderStats.h"
+#include "dream/scene/component/Component.h"
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    VertexAnimationTech::VertexAnimationTech() {
+        auto shaderPath = Project::getPath().append("assets").append("shaders");
+        auto vertexPath = std::filesystem::path(shaderPath).append("vertex_animation.vert");
+        if (std::filesystem::exists(vertexPath)) {
+            // positions come from the baked texture, fragment shaders are the same as for skinned meshes
+            shaders[LIT] = new OpenGLShader(vertexPath.c_str(), std::filesystem::path(shaderPath).append("lighting_shader.frag").c_str());
+            shaders[SINGLE_TEXTURE] = new OpenGLShader(vertexPath.c_str(), std::filesystem::path(shaderPath).append("shader_single_texture.frag").c_str());
+            shaders[DEPTH] = new OpenGLShader(vertexPath.c_str(), std::filesystem::path(shaderPath).append("shadow_mapping_depth.frag").c_str());
+        } else {
+            Logger::warn("Project has no vertex animation shader, crowds are drawn with their animators");
+        }
+    }
+
+    VertexAnimationTech::~VertexAnimationTech() {
+        for (auto &[vertexAnimation, texture]: textures) {
+            glDeleteTextures(1, &texture.positions);
+            glDeleteTextures(1, &texture.normals);
+        }
+        for (auto &buffer: instanceBuffers) {
+            glDeleteVertexArrays((int) buffer.vaos.size(), buffer.vaos.data());
+            glDeleteBuffers(1, &buffer.vbo);
+        }
+        for (auto *shader: shaders) {
+            delete shader;
+        }
+    }
+
+    void VertexAnimationTech::loadVertexAnimation(Entity entity) {
+        if (entity.hasComponent<Component::VertexAnimationComponent>() &&
+            entity.getComponent<Component::VertexAnimationComponent>().needsToLoad) {
+            entity.getComponent<Component::VertexAnimationComponent>().loadVertexAnimation();
+        }
+    }
+
+    bool VertexAnimationTech::getInstance(Entity entity, FrameSnapshot &frame, LightingTech *lightingTech) {
+        if (!canDraw() || !entity.hasComponent<Component::VertexAnimationComponent>()) {
+            return false;
+        }
+        auto &component = entity.getComponent<Component::VertexAnimationComponent>();
+        const auto &vertexAnimation = component.vertexAnimation;
+        if (!component.isActive || !vertexAnimation || vertexAnimation->getNumClips() == 0) {
+            return false;
+        }
+
+        VertexAnimationBatch *batch = nullptr;
+        for (auto &existingBatch: frame.vertexAnimationBatches) {
+            if (existingBatch.vertexAnimation == vertexAnimation) {
+                batch = &existingBatch;
+                break;
+            }
+        }
+        if (!batch) {
+            // meshes and materials of the baked submeshes from the mesh entities below the first instance
+            VertexAnimationBatch newBatch = {.vertexAnimation=vertexAnimation};
+            std::vector<Entity> entities = {entity};
+            while (!entities.empty()) {
+                Entity current = entities.back();
+                entities.pop_back();
+                if (current.hasComponent<Component::MeshComponent>()) {
+                    auto &meshComponent = current.getComponent<Component::MeshComponent>();
+                    int subMesh = meshComponent.fileId.empty() ? -1 : vertexAnimation->findSubMesh(meshComponent.fileId);
+                    if (subMesh != -1 && Project::getResourceManager()->hasMeshData(meshComponent.guid, meshComponent.fileId)) {
+                        auto mesh = Project::getResourceManager()->getMeshData(meshComponent.guid, meshComponent.fileId);
+                        if (auto openGLMesh = std::dynamic_pointer_cast<OpenGLMesh>(mesh)) {
+                            newBatch.subMeshes.push_back({
+                                    .mesh=openGLMesh,
+                                    .subMesh=subMesh,
+                                    .material=lightingTech->getMaterial(current)
+                            });
+                        }
+                    }
+                }
+                Entity child = current.getComponent<Component::HierarchyComponent>().first;
+                while (child) {
+                    entities.push_back(child);
+                    child = child.getComponent<Component::HierarchyComponent>().next;
+                }
+            }
+            if (newBatch.subMeshes.empty()) {
+                // meshes are created by prepare() and drawn starting next frame
+                return false;
+            }
+            frame.vertexAnimationBatches.push_back(std::move(newBatch));
+            batch = &frame.vertexAnimationBatches.back();
+        }
+        batch->instances.push_back({
+                .model=entity.getComponent<Component::TransformComponent>().getInterpolatedTransform(entity, frame.interpolationAlpha),
+                .frames=glm::vec4(vertexAnimation->getFrameBlend(component.activeClip, component.activeTime), 0.0f)
+        });
+        return true;
+    }
+
+    bool VertexAnimationTech::canDraw() {
+        return shaders[LIT] != nullptr;
+    }
+
+    void VertexAnimationTech::prepareBatches(const FrameSnapshot &frame) {
+        for (auto &[vertexAnimation, texture]: textures) {
+            texture.framesSinceUse++;
+        }
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        for (const auto &batch: frame.vertexAnimationBatches) {
+            auto &texture = textures[batch.vertexAnimation.get()];
+            texture.framesSinceUse = 0;
+            if (texture.vertexAnimation) {
+                continue;
+            }
+            texture.vertexAnimation = batch.vertexAnimation;
+            const auto &vertexAnimation = *batch.vertexAnimation;
+            if (vertexAnimation.getTextureHeight() > maxTextureSize) {
+                Logger::warn("Vertex animation with " + std::to_string(vertexAnimation.getNumFrames()) + " frames of " +
+                             std::to_string(vertexAnimation.getNumVertices()) + " vertices does not fit into a texture");
+                continue;
+            }
+            // texels are fetched without filtering, frames are interpolated in the vertex shader
+            glGenTextures(1, &texture.positions);
+            glBindTexture(GL_TEXTURE_2D, texture.positions);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, vertexAnimation.getTextureWidth(), vertexAnimation.getTextureHeight(),
+                         0, GL_RGBA, GL_FLOAT, vertexAnimation.getPositions().data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            // normals do not need full precision
+            glGenTextures(1, &texture.normals);
+            glBindTexture(GL_TEXTURE_2D, texture.normals);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, vertexAnimation.getTextureWidth(), vertexAnimation.getTextureHeight(),
+                         0, GL_RGBA, GL_FLOAT, vertexAnimation.getNormals().data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        for (auto it = textures.begin(); it != textures.end();) {
+            if (it->second.framesSinceUse > maxUnusedFrames) {
+                glDeleteTextures(1, &it->second.positions);
+                glDeleteTextures(1, &it->second.normals);
+                it = textures.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        if (instanceBuffers.size() < frame.vertexAnimationBatches.size()) {
+            instanceBuffers.resize(frame.vertexAnimationBatches.size());
+        }
+        for (int i = 0; i < frame.vertexAnimationBatches.size(); i++) {
+            const auto &batch = frame.vertexAnimationBatches[i];
+            auto &buffer = instanceBuffers[i];
+            int numInstances = (int) batch.instances.size();
+            if (!buffer.vbo) {
+                glGenBuffers(1, &buffer.vbo);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+            if (buffer.capacity < numInstances) {
+                // crowds grow a few instances at a time, so leave room to not reallocate every frame
+                buffer.capacity = std::max(numInstances, buffer.capacity * 2);
+                glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (buffer.capacity * sizeof(VertexAnimationInstance)), nullptr, GL_STREAM_DRAW);
+            }
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) (numInstances * sizeof(VertexAnimationInstance)), batch.instances.data());
+            for (int subMesh = 0; subMesh < batch.subMeshes.size(); subMesh++) {
+                prepareVertexArray(buffer, subMesh, batch.subMeshes[subMesh].mesh);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    OpenGLShader *VertexAnimationTech::getShader(ShaderType type) {
+        return shaders[type];
+    }
+
+    void VertexAnimationTech::drawInstances(const FrameSnapshot &frame, int batch, int subMesh, OpenGLShader *shader) {
+        const auto &vertexAnimationBatch = frame.vertexAnimationBatches.at(batch);
+        auto texture = textures.find(vertexAnimationBatch.vertexAnimation.get());
+        if (texture == textures.end() || !texture->second.positions || batch >= instanceBuffers.size()) {
+            return;
+        }
+        const auto &vertexAnimation = *vertexAnimationBatch.vertexAnimation;
+        const auto &drawItem = vertexAnimationBatch.subMeshes.at(subMesh);
+        shader->setInt("vertexAnimationPositions", positionTextureUnit);
+        glActiveTexture(GL_TEXTURE0 + positionTextureUnit);
+        glBindTexture(GL_TEXTURE_2D, texture->second.positions);
+        shader->setInt("vertexAnimationNormals", normalTextureUnit);
+        glActiveTexture(GL_TEXTURE0 + normalTextureUnit);
+        glBindTexture(GL_TEXTURE_2D, texture->second.normals);
+        OpenGLRenderStats::countTextureBind();
+        OpenGLRenderStats::countTextureBind();
+        shader->setInt("vertexAnimationWidth", vertexAnimation.getTextureWidth());
+        shader->setInt("vertexAnimationNumVertices", vertexAnimation.getNumVertices());
+        shader->setInt("vertexAnimationFirstVertex", vertexAnimation.getSubMeshes().at(drawItem.subMesh).firstVertex);
+
+        auto numInstances = (int) vertexAnimationBatch.instances.size();
+        glBindVertexArray(instanceBuffers[batch].vaos.at(subMesh));
+        if (!drawItem.mesh->getIndices().empty()) {
+            auto numIndices = (int) drawItem.mesh->getIndices().size();
+            glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr, numInstances);
+            OpenGLRenderStats::countDrawCall((long long) numIndices / 3 * numInstances);
+        } else {
+            auto numVertices = (int) drawItem.mesh->getVertices().size();
+            glDrawArraysInstanced(GL_TRIANGLES, 0, numVertices, numInstances);
+            OpenGLRenderStats::countDrawCall((long long) numVertices / 3 * numInstances);
+        }
+        glBindVertexArray(0);
+    }
+
+    void VertexAnimationTech::prepareVertexArray(InstanceBuffer &buffer, int subMesh, const std::shared_ptr<OpenGLMesh> &mesh) {
+        if (buffer.vaos.size() <= subMesh) {
+            buffer.vaos.resize(subMesh + 1, 0);
+            buffer.meshes.resize(subMesh + 1);
+        }
+        if (buffer.vaos[subMesh] && buffer.meshes[subMesh].lock() == mesh) {
+            return;
+        }
+        if (!buffer.vaos[subMesh]) {
+            glGenVertexArrays(1, &buffer.vaos[subMesh]);
+        }
+        glBindVertexArray(buffer.vaos[subMesh]);
+
+        // positions and normals come from the baked texture, the bind pose position is only bound since some
+        // drivers expect attribute 0 to be enabled
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->getVBO());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, uv));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, tangent));
+        if (!mesh->getIndices().empty()) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->getEBO());
+        }
+
+        // model matrix (one column per attribute) and frames of each instance
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+        for (int column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(7 + column);
+            glVertexAttribPointer(7 + column, 4, GL_FLOAT, GL_FALSE, sizeof(VertexAnimationInstance),
+                                  (void *) (offsetof(VertexAnimationInstance, model) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(7 + column, 1);
+        }
+        glEnableVertexAttribArray(11);
+        glVertexAttribPointer(11, 4, GL_FLOAT, GL_FALSE, sizeof(VertexAnimationInstance),
+                              (void *) offsetof(VertexAnimationInstance, frames));
+        glVertexAttribDivisor(11, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        buffer.meshes[subMesh] = mesh;
+    }
+}
@@ -0,0 +1,312 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/renderer/VertexAnimationTexture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/quaternion.hpp>
+#include "dream/util/LZCompression.h"
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    namespace {
+        void writeString(std::ofstream &out, const std::string &value) {
+            auto size = (uint32_t) value.size();
+            out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+            out.write(value.data(), (std::streamsize) size);
+        }
+
+        bool readString(std::ifstream &in, std::string &value) {
+            uint32_t size = 0;
+            if (!in.read(reinterpret_cast<char *>(&size), sizeof(size))) {
+                return false;
+            }
+            value.resize(size);
+            return (bool) in.read(value.data(), (std::streamsize) size);
+        }
+
+        template<typename T>
+        void writeValue(std::ofstream &out, T value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool readValue(std::ifstream &in, T &value) {
+            return (bool) in.read(reinterpret_cast<char *>(&value), sizeof(T));
+        }
+
+        void writeTexels(std::ofstream &out, const std::vector<glm::vec4> &texels) {
+            auto data = LZCompression::compress(reinterpret_cast<const uint8_t *>(texels.data()), texels.size() * sizeof(glm::vec4));
+            writeValue<uint64_t>(out, data.size());
+            out.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+        }
+
+        bool readTexels(std::ifstream &in, std::vector<glm::vec4> &texels) {
+            uint64_t size = 0;
+            if (!readValue(in, size)) {
+                return false;
+            }
+            std::vector<uint8_t> data(size);
+            return in.read(reinterpret_cast<char *>(data.data()), (std::streamsize) size) &&
+                   LZCompression::decompress(data.data(), data.size(), reinterpret_cast<uint8_t *>(texels.data()),
+                                             texels.size() * sizeof(glm::vec4));
+        }
+    }
+
+    VertexAnimationTexture *VertexAnimationTexture::bake(const AnimationSkeleton &skeleton, int numBones,
+                                                         const std::vector<SourceMesh> &meshes,
+                                                         const std::vector<SourceClip> &clips, float framesPerSecond) {
+        auto *vertexAnimation = new VertexAnimationTexture();
+        vertexAnimation->framesPerSecond = framesPerSecond;
+        for (const auto &mesh: meshes) {
+            vertexAnimation->subMeshes.push_back({
+                    .fileId=mesh.fileId,
+                    .firstVertex=vertexAnimation->numVertices,
+                    .numVertices=(int) mesh.vertices.size()
+            });
+            vertexAnimation->numVertices += (int) mesh.vertices.size();
+        }
+        int numFrames = 0;
+        for (const auto &source: clips) {
+            float duration = source.clip->getDuration() / source.clip->getTicksPerSecond();
+            // one more frame than intervals so the last frame is the end of the clip
+            int clipFrames = std::max(2, (int) std::ceil(duration * framesPerSecond) + 1);
+            vertexAnimation->clips.push_back({
+                    .name=source.clip->getName(),
+                    .guid=source.guid,
+                    .firstFrame=numFrames,
+                    .numFrames=clipFrames,
+                    .duration=duration
+            });
+            numFrames += clipFrames;
+        }
+        vertexAnimation->allocate(numFrames);
+
+        int numJoints = skeleton.getNumJoints();
+        std::vector<glm::vec3> translations(numJoints);
+        std::vector<glm::quat> rotations(numJoints);
+        std::vector<glm::mat4> jointTransforms(numJoints);
+        std::vector<glm::mat4> boneMatrices(numBones, glm::mat4(1.0f));
+        AnimationClip::Cursor cursor;
+        for (int c = 0; c < clips.size(); c++) {
+            const auto &clip = *clips[c].clip;
+            const auto &bakedClip = vertexAnimation->clips[c];
+            clip.initCursor(cursor);
+            for (int frame = 0; frame < bakedClip.numFrames; frame++) {
+                float time = std::min((float) frame / framesPerSecond, bakedClip.duration);
+                clip.sample(time * clip.getTicksPerSecond(), cursor, translations.data(), rotations.data());
+                // same pose to bone matrices as the animator, parents come before their children
+                for (int joint = 0; joint < numJoints; joint++) {
+                    glm::mat4 local = glm::mat4_cast(rotations[joint]);
+                    local[3] = glm::vec4(translations[joint], 1.0f);
+                    int parent = skeleton.getParent(joint);
+                    jointTransforms[joint] = parent == -1 ? local : jointTransforms[parent] * local;
+                    int boneIndex = skeleton.getBoneIndex(joint);
+                    if (boneIndex != -1 && boneIndex < numBones) {
+                        boneMatrices[boneIndex] = jointTransforms[joint] * skeleton.getOffset(joint);
+                    }
+                }
+
+                // same blend as shader.vert
+                size_t texel = (size_t) (bakedClip.firstFrame + frame) * vertexAnimation->numVertices;
+                for (const auto &mesh: meshes) {
+                    for (const auto &vertex: mesh.vertices) {
+                        glm::vec4 position(0.0f);
+                        glm::vec3 normal(0.0f);
+                        bool skinned = false;
+                        for (int i = 0; i < MAX_BONE_INFLUENCE; i++) {
+                            int bone = vertex.boneIDs[i];
+                            if (bone < 0 || bone >= numBones) {
+                                continue;
+                            }
+                            position += boneMatrices[bone] * glm::vec4(vertex.position, 1.0f) * vertex.boneWeights[i];
+                            normal += glm::mat3(boneMatrices[bone]) * vertex.normal * vertex.boneWeights[i];
+                            skinned = true;
+                        }
+                        if (!skinned) {
+                            position = glm::vec4(vertex.position, 1.0f);
+                            normal = vertex.normal;
+                        }
+                        float length = glm::length(normal);
+                        vertexAnimation->positions[texel] = glm::vec4(glm::vec3(position), 1.0f);
+                        vertexAnimation->normals[texel] = glm::vec4(length > 0.0f ? normal / length : normal, 0.0f);
+                        texel++;
+                    }
+                }
+            }
+        }
+        return vertexAnimation;
+    }
+
+    VertexAnimationTexture *VertexAnimationTexture::load(const std::string &path) {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        char fileMagic[4] = {};
+        uint32_t fileVersion = 0;
+        if (!in || !in.read(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, magic, sizeof(magic)) != 0) {
+            return nullptr;
+        }
+        if (!readValue(in, fileVersion) || fileVersion != version) {
+            Logger::error("Unsupported vertex animation " + path);
+            return nullptr;
+        }
+        auto *vertexAnimation = new VertexAnimationTexture();
+        int32_t numSubMeshes = 0, numClips = 0, numFrames = 0;
+        bool valid = readValue(in, vertexAnimation->framesPerSecond) && readValue(in, vertexAnimation->numVertices) &&
+                     readValue(in, numSubMeshes) && numSubMeshes >= 0;
+        for (int i = 0; valid && i < numSubMeshes; i++) {
+            SubMesh subMesh;
+            valid = readString(in, subMesh.fileId) && readValue(in, subMesh.firstVertex) && readValue(in, subMesh.numVertices);
+            vertexAnimation->subMeshes.push_back(subMesh);
+        }
+        valid = valid && readValue(in, numClips) && numClips >= 0;
+        for (int i = 0; valid && i < numClips; i++) {
+            Clip clip;
+            valid = readString(in, clip.name) && readString(in, clip.guid) && readValue(in, clip.firstFrame) &&
+                    readValue(in, clip.numFrames) && readValue(in, clip.duration);
+            vertexAnimation->clips.push_back(clip);
+        }
+        valid = valid && readValue(in, numFrames) && numFrames >= 0 && vertexAnimation->numVertices >= 0;
+        if (valid) {
+            vertexAnimation->allocate(numFrames);
+            valid = readTexels(in, vertexAnimation->positions) && readTexels(in, vertexAnimation->normals);
+        }
+        if (!valid) {
+            Logger::error("Vertex animation " + path + " is corrupt");
+            delete vertexAnimation;
+            return nullptr;
+        }
+        return vertexAnimation;
+    }
+
+    bool VertexAnimationTexture::save(const std::string &path) const {
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Logger::error("Unable to write vertex animation " + path);
+            return false;
+        }
+        out.write(magic, sizeof(magic));
+        writeValue(out, version);
+        writeValue(out, framesPerSecond);
+        writeValue<int32_t>(out, numVertices);
+        writeValue<int32_t>(out, (int32_t) subMeshes.size());
+        for (const auto &subMesh: subMeshes) {
+            writeString(out, subMesh.fileId);
+            writeValue<int32_t>(out, subMesh.firstVertex);
+            writeValue<int32_t>(out, subMesh.numVertices);
+        }
+        writeValue<int32_t>(out, (int32_t) clips.size());
+        for (const auto &clip: clips) {
+            writeString(out, clip.name);
+            writeString(out, clip.guid);
+            writeValue<int32_t>(out, clip.firstFrame);
+            writeValue<int32_t>(out, clip.numFrames);
+            writeValue(out, clip.duration);
+        }
+        writeValue<int32_t>(out, numFrames);
+        writeTexels(out, positions);
+        writeTexels(out, normals);
+        return (bool) out;
+    }
+
+    void VertexAnimationTexture::allocate(int frames) {
+        numFrames = frames;
+        size_t numTexels = (size_t) numFrames * numVertices;
+        textureHeight = (int) std::max<size_t>(1, (numTexels + textureWidth - 1) / textureWidth);
+        positions.assign((size_t) textureWidth * textureHeight, glm::vec4(0.0f));
+        normals.assign((size_t) textureWidth * textureHeight, glm::vec4(0.0f));
+    }
+
+    float VertexAnimationTexture::getFramesPerSecond() const {
+        return framesPerSecond;
+    }
+
+    int VertexAnimationTexture::getNumVertices() const {
+        return numVertices;
+    }
+
+    int VertexAnimationTexture::getNumFrames() const {
+        return numFrames;
+    }
+
+    const std::vector<VertexAnimationTexture::SubMesh> &VertexAnimationTexture::getSubMeshes() const {
+        return subMeshes;
+    }
+
+    int VertexAnimationTexture::findSubMesh(const std::string &fileId) const {
+        for (int i = 0; i < subMeshes.size(); i++) {
+            if (subMeshes[i].fileId == fileId) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int VertexAnimationTexture::getNumClips() const {
+        return (int) clips.size();
+    }
+
+    const VertexAnimationTexture::Clip &VertexAnimationTexture::getClip(int clip) const {
+        return clips.at(clip);
+    }
+
+    int VertexAnimationTexture::findClip(const std::string &guid) const {
+        for (int i = 0; i < clips.size(); i++) {
+            if (clips[i].guid == guid) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    glm::vec3 VertexAnimationTexture::getFrameBlend(int clip, float time) const {
+        const auto &bakedClip = clips.at(clip);
+        if (bakedClip.duration <= 0.0f) {
+            return {(float) bakedClip.firstFrame, (float) bakedClip.firstFrame, 0.0f};
+        }
+        time = std::fmod(time, bakedClip.duration);
+        if (time < 0.0f) {
+            time += bakedClip.duration;
+        }
+        float frame = std::min(time * framesPerSecond, (float) (bakedClip.numFrames - 1));
+        int frame0 = std::min((int) frame, bakedClip.numFrames - 2);
+        // the last frame is shorter than the others when the duration is not a multiple of the frame time
+        float frameEnd = std::min((float) (frame0 + 1) / framesPerSecond, bakedClip.duration);
+        float frameStart = (float) frame0 / framesPerSecond;
+        float blend = std::clamp((time - frameStart) / (frameEnd - frameStart), 0.0f, 1.0f);
+        return {(float) (bakedClip.firstFrame + frame0), (float) (bakedClip.firstFrame + frame0 + 1), blend};
+    }
+
+    int VertexAnimationTexture::getTextureWidth() const {
+        return textureWidth;
+    }
+
+    int VertexAnimationTexture::getTextureHeight() const {
+        return textureHeight;
+    }
+
+    const std::vector<glm::vec4> &VertexAnimationTexture::getPositions() const {
+        return positions;
+    }
+
+    const std::vector<glm::vec4> &VertexAnimationTexture::getNormals() const {
+        return normals;
+    }
+}
@@ -66,6 +66,7 @@ namespace Dream {
         Component::MaterialComponent::serialize(out, *this);
         Component::LuaScriptComponent::serialize(out, *this);
         Component::AnimatorComponent::serialize(out, *this);
+        Component::VertexAnimationComponent::serialize(out, *this);
         Component::BoneComponent::serialize(out, *this);
         Component::SceneCameraComponent::serialize(out, *this);
         Component::CameraComponent::serialize(out, *this);
@@ -96,6 +97,7 @@ namespace Dream {
         Component::MaterialComponent::deserialize(node, *this);
         Component::LuaScriptComponent::deserialize(node, *this);
         Component::AnimatorComponent::deserialize(node, *this);
+        Component::VertexAnimationComponent::deserialize(node, *this);
         Component::BoneComponent::deserialize(node, *this);
         Component::SceneCameraComponent::deserialize(node, *this);
         Component::CameraComponent::deserialize(node, *this);
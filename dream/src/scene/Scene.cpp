@@ -233,4 +233,8 @@ namespace Dream {
     PhysicsComponentSystem* Scene::getPhysicsComponentSystem() {
         return physicsComponentSystem;
     }
+
+    TerrainComponentSystem* Scene::getTerrainComponentSystem() {
+        return terrainComponentSystem;
+    }
 }
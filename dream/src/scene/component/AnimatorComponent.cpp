@@ -16,6 +16,9 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  **********************************************************************************/
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
 #include <utility>
 
 #include "dream/scene/component/Component.h"
@@ -25,6 +28,53 @@
 #include "dream/util/MathUtils.h"
 
 namespace Dream::Component {
+    namespace {
+        AnimatorComponent::State readState(const YAML::Node &stateNode) {
+            AnimatorComponent::State state = {
+                    .Guid=stateNode["Guid"] ? stateNode["Guid"].as<std::string>() : "",
+                    .PlayOnce=stateNode["PlayOnce"].as<bool>(),
+                    .Name=stateNode["Name"] ? stateNode["Name"].as<std::string>() : ""
+            };
+            if (const YAML::Node &blendTreeNode = stateNode["BlendTree"]) {
+                state.BlendType = AnimatorController::parseBlendTreeType(blendTreeNode["Type"].as<std::string>());
+                state.BlendVariable1Idx = blendTreeNode["Variable1Idx"] ? blendTreeNode["Variable1Idx"].as<int>() : -1;
+                state.BlendVariable2Idx = blendTreeNode["Variable2Idx"] ? blendTreeNode["Variable2Idx"].as<int>() : -1;
+                for (const YAML::Node &motionNode: blendTreeNode["Motions"].as<std::vector<YAML::Node>>()) {
+                    state.Motions.push_back(AnimatorController::Description::Motion{
+                            .Guid=motionNode["Guid"].as<std::string>(),
+                            .X=motionNode["X"] ? motionNode["X"].as<float>() : 0,
+                            .Y=motionNode["Y"] ? motionNode["Y"].as<float>() : 0
+                    });
+                }
+            }
+            return state;
+        }
+
+        YAML::Node writeState(const AnimatorComponent::State &state) {
+            YAML::Node stateNode = YAML::Node(YAML::NodeType::Map);
+            stateNode["Guid"] = state.Guid;
+            stateNode["PlayOnce"] = state.PlayOnce;
+            stateNode["Name"] = state.Name;
+            if (state.BlendType != AnimatorController::BlendTreeType::NONE) {
+                YAML::Node blendTreeNode;
+                blendTreeNode["Type"] = AnimatorController::getBlendTreeTypeName(state.BlendType);
+                blendTreeNode["Variable1Idx"] = state.BlendVariable1Idx;
+                blendTreeNode["Variable2Idx"] = state.BlendVariable2Idx;
+                YAML::Node motionsNode = YAML::Node(YAML::NodeType::Sequence);
+                for (const auto &motion: state.Motions) {
+                    YAML::Node motionNode;
+                    motionNode["Guid"] = motion.Guid;
+                    motionNode["X"] = motion.X;
+                    motionNode["Y"] = motion.Y;
+                    motionsNode.push_back(motionNode);
+                }
+                blendTreeNode["Motions"] = motionsNode;
+                stateNode["BlendTree"] = blendTreeNode;
+            }
+            return stateNode;
+        }
+    }
+
     AnimatorComponent::AnimatorComponent() {
         this->blendFactor = 1.0;
         this->guid = "";
@@ -51,15 +101,9 @@ namespace Dream::Component {
         }
     }
 
-    AnimatorComponent::~AnimatorComponent() {
-        // TODO: delete each animation in map
-    }
-
     void AnimatorComponent::updateAnimation(float dt) {
-        if (currentState != -1 && nextState != -1) {
-            auto *animation1 = (Animation *) animationObjects[states[currentState].Guid];
-            auto *animation2 = (Animation *) animationObjects[states[nextState].Guid];
-            blendTwoAnimations(animation1, animation2, blendFactor, dt);
+        if (currentState != -1 && nextState != -1 && !clips.empty()) {
+            blendTwoAnimations(currentState, nextState, blendFactor, dt);
             blendFactor += 5.0f * dt;
             if (blendFactor > 1.0) {
                 blendFactor = 1.0;
@@ -74,57 +118,19 @@ namespace Dream::Component {
     }
 
     void AnimatorComponent::updateStateMachine(float dt) {
-//        std::cout << "===========" << std::endl;
-//        std::cout << "current state: " << currentState << std::endl;
-//        for (int i = 0; i < variableNames.size(); ++i) {
-//            std::cout << variableNames[i] << " : " << variableValues[i] << std::endl;
-//        }
-//        std::cout << "===========" << std::endl << std::endl;
-        if (currentState != -1 && currentState == nextState) {
-            for (const auto &transition: transitions) {
-                if (transition.OutputStateID == currentState) {
-                    bool allConditionsPassed = true;
-                    for (const auto &condition: transition.Conditions) {
-                        int variable1Value = condition.Variable1;
-                        int variable2Value = condition.Variable2;
-                        if (condition.Variable1Idx != -1) {
-                            variable1Value = variableValues.at(condition.Variable1Idx);
-                        }
-                        if (condition.Variable2Idx != -1) {
-                            variable2Value = variableValues.at(condition.Variable2Idx);
-                        }
-                        bool conditionPassed = false;
-                        if (condition.Operator == "==") {
-                            conditionPassed = variable1Value == variable2Value;
-                        } else if (condition.Operator == ">") {
-                            conditionPassed = variable1Value > variable2Value;
-                        } else if (condition.Operator == "<") {
-                            conditionPassed = variable1Value < variable2Value;
-                        } else if (condition.Operator == ">=") {
-                            conditionPassed = variable1Value >= variable2Value;
-                        } else if (condition.Operator == "<=") {
-                            conditionPassed = variable1Value <= variable2Value;
-                        } else if (condition.Operator == "!=") {
-                            conditionPassed = variable1Value != variable2Value;
-                        } else {
-                            Logger::fatal("Unknown operator for animator state machine " + condition.Operator);
-                        }
-                        if (!conditionPassed) {
-                            allConditionsPassed = false;
-                        }
-                    }
-                    if (allConditionsPassed) {
-                        int numRequiredTimesToPlay = states[currentState].PlayOnce ? 1 : 0;
-                        if (numTimesAnimationPlayed >= numRequiredTimesToPlay) {
-                            nextState = transition.InputStateID;
-                            blendFactor = transition.Blend ? 0.0 : 1.0;
-                            numTimesAnimationPlayed = 0;
-                            if (!transition.Blend) {
-                                currentTimeLayered = 0.0f;
-                                currentTimeBase = 0.0f;
-                            }
-                        }
-                        break;
+        if (controller && currentState != -1 && currentState == nextState) {
+            int transition = controller->findTransition(currentState, variableValues.data());
+            if (transition != -1) {
+                int numRequiredTimesToPlay = controller->getState(currentState).playOnce ? 1 : 0;
+                if (numTimesAnimationPlayed >= numRequiredTimesToPlay) {
+                    const auto &taken = controller->getTransition(transition);
+                    controller->consumeTriggers(transition, variableValues.data());
+                    nextState = taken.targetState;
+                    blendFactor = taken.blend ? 0.0 : 1.0;
+                    numTimesAnimationPlayed = 0;
+                    if (!taken.blend) {
+                        currentTimeLayered = 0.0f;
+                        currentTimeBase = 0.0f;
                     }
                 }
             }
@@ -152,219 +158,545 @@ namespace Dream::Component {
         }
     }
 
+    std::shared_ptr<const AnimationClip> AnimatorComponent::loadAnimationClip(const std::string &animationGuid, Entity modelEntity) {
+        auto *resourceManager = Project::getResourceManager();
+        std::string modelGuid = modelEntity.getComponent<MeshComponent>().guid;
+        if (!resourceManager->hasAnimationClip(animationGuid, modelGuid)) {
+            auto animationFilePath = resourceManager->getFilePathFromGUID(animationGuid);
+            Animation animation(animationFilePath, modelEntity, 0);
+            if (!resourceManager->hasAnimationSkeleton(modelGuid)) {
+                resourceManager->storeAnimationSkeleton(new AnimationSkeleton(animation.getRootNode(), animation.getBoneIdMap()), modelGuid);
+            }
+            resourceManager->storeAnimationClip(new AnimationClip(animation, *resourceManager->getAnimationSkeleton(modelGuid)), animationGuid, modelGuid);
+        }
+        return resourceManager->getAnimationClip(animationGuid, modelGuid);
+    }
+
     void AnimatorComponent::loadStateMachine(Entity modelEntity) {
         if (guid.empty()) {
             return;
         }
         currentState = 0;
         nextState = 0;
-        // reset animations state
-        states.clear();
-        transitions.clear();
-        variableNames.clear();
-        variableValues.clear();
-        // deserialize animator file
-        std::string animatorFilePath = Project::getResourceManager()->getFilePathFromGUID(guid);
-        YAML::Node doc = YAML::LoadFile(animatorFilePath);
+        loadController();
+        // compile the animation of each motion against the skeleton of the model, clips and skeletons are immutable
+        // so every animator playing an animation on the same model shares them
+        auto *resourceManager = Project::getResourceManager();
+        std::string modelGuid = modelEntity.getComponent<MeshComponent>().guid;
+        skeleton = nullptr;
+        clips.clear();
+        for (int i = 0; i < controller->getNumMotions(); i++) {
+            clips.push_back(loadAnimationClip(controller->getMotion(i).guid, modelEntity));
+        }
+        if (!clips.empty()) {
+            skeleton = resourceManager->getAnimationSkeleton(modelGuid);
+        }
+        if (skeleton) {
+            int numJoints = skeleton->getNumJoints();
+            evaluatedPose.resize(numJoints);
+            previousPose.resize(numJoints);
+            jointTransforms.resize(numJoints);
+            pendingBoneTransforms.clear();
+            pendingBoneTransforms.reserve(numJoints);
+            framesSinceEvaluation = -1;
+            boundsRadius = 0.0f;
+            cursors.resize(clips.size());
+            jointIsAnimated.assign(numJoints, false);
+            for (int i = 0; i < clips.size(); i++) {
+                clips[i]->initCursor(cursors[i]);
+                for (int joint = 0; joint < numJoints; joint++) {
+                    if (clips[i]->isJointAnimated(joint)) {
+                        jointIsAnimated[joint] = true;
+                    }
+                }
+            }
+            motionWeights.assign(clips.size(), 0.0f);
+
+            // layers start from their first frame, masks cover the listed joints and everything below them
+            layerTimes.assign(controller->getNumLayers(), 0.0f);
+            layerMasks.resize(controller->getNumLayers());
+            additiveReferencePoses.resize(controller->getNumLayers());
+            for (int layer = 0; layer < controller->getNumLayers(); layer++) {
+                const auto &layerInfo = controller->getLayer(layer);
+                layerMasks[layer].clear();
+                if (!layerInfo.mask.empty()) {
+                    layerMasks[layer].assign(numJoints, 0.0f);
+                    for (const auto &jointName: layerInfo.mask) {
+                        int maskJoint = skeleton->findJoint(jointName);
+                        if (maskJoint == -1) {
+                            Logger::warn("Cannot find joint " + jointName + " for mask of animator layer " + layerInfo.name);
+                        } else {
+                            layerMasks[layer][maskJoint] = 1.0f;
+                        }
+                    }
+                    // parents come before their children
+                    for (int joint = 0; joint < numJoints; joint++) {
+                        int parent = skeleton->getParent(joint);
+                        if (parent != -1 && layerMasks[layer][parent] > 0.0f) {
+                            layerMasks[layer][joint] = layerMasks[layer][parent];
+                        }
+                    }
+                }
+                if (layerInfo.additive) {
+                    additiveReferencePoses[layer].resize(numJoints);
+                    computeMotionWeights(layerInfo.motions);
+                    sampleMotions(layerInfo.motions, 0.0f, additiveReferencePoses[layer]);
+                }
+            }
+        }
+        boneEntities.clear();
+        loadBoneEntities(modelEntity);
+        jointEntities.clear();
+        if (skeleton) {
+            jointEntities.resize(skeleton->getNumJoints());
+            for (int joint = 0; joint < skeleton->getNumJoints(); joint++) {
+                int boneIndex = skeleton->getBoneIndex(joint);
+                if (boneIndex == -1) {
+                    continue;
+                }
+                if (boneEntities.count(boneIndex) > 0) {
+                    jointEntities[joint] = boneEntities[boneIndex];
+                } else {
+                    Logger::warn("Cannot find entity for bone " + skeleton->getJointName(joint) + " with ID " +
+                                 std::to_string(boneIndex));
+                }
+            }
+        }
+        findBoneReaders();
+        needsToFindBoneEntities = false;
+        this->needsToLoadAnimations = false;
+    }
+
+    void AnimatorComponent::loadBoneEntities(Entity entity) {
+        if (entity.hasComponent<BoneComponent>()) {
+            boneEntities[entity.getComponent<BoneComponent>().boneID] = entity;
+        }
+        Entity child = entity.getComponent<HierarchyComponent>().first;
+        while (child) {
+            loadBoneEntities(child);
+            child = child.getComponent<HierarchyComponent>().next;
+        }
+    }
+
+    void AnimatorComponent::loadController() {
+        auto *resourceManager = Project::getResourceManager();
+        if (!resourceManager->hasAnimatorController(guid)) {
+            auto description = loadAnimatorFile(resourceManager->getFilePathFromGUID(guid));
+            resourceManager->storeAnimatorController(new AnimatorController(description), guid);
+        }
+        auto loadedController = resourceManager->getAnimatorController(guid);
+        if (loadedController != controller) {
+            controller = loadedController;
+            controller->initParameters(variableValues);
+        }
+    }
+
+    AnimatorController::Description AnimatorComponent::loadAnimatorFile(const std::string &filePath) {
+        AnimatorController::Description description;
+        YAML::Node doc = YAML::LoadFile(filePath);
         // load states
-        auto animationsNode = doc[k_states].as<std::vector<YAML::Node>>();
-        for (const YAML::Node &animationNode: animationsNode) {
-            states.push_back(State{
-                    .Guid=animationNode["Guid"].as<std::string>(),
-                    .PlayOnce=animationNode["PlayOnce"].as<bool>(),
-                    .Name=animationNode["Name"].as<std::string>()
-            });
+        auto statesNode = doc[k_states].as<std::vector<YAML::Node>>();
+        for (const YAML::Node &stateNode: statesNode) {
+            description.states.push_back(readState(stateNode));
         }
-        // deserialize transitions
+        // load transitions
         auto transitionsNodes = doc[k_transitions].as<std::vector<YAML::Node>>();
         for (const YAML::Node &transitionNode: transitionsNodes) {
             std::vector<Condition> conditions;
             auto conditionNodes = transitionNode[k_transition_Conditions].as<std::vector<YAML::Node>>();
             for (const YAML::Node &conditionNode: conditionNodes) {
-                Condition condition = {
+                conditions.push_back(Condition{
                         .Variable1Idx=conditionNode["Variable1Idx"] ? conditionNode["Variable1Idx"].as<int>() : -1,
-                        .Variable1=conditionNode["Variable1"] ? conditionNode["Variable1"].as<int>() : 0,
+                        .Variable1=conditionNode["Variable1"] ? conditionNode["Variable1"].as<float>() : 0,
                         .Operator=conditionNode["Operator"] ? conditionNode["Operator"].as<std::string>() : "==",
                         .Variable2Idx=conditionNode["Variable2Idx"] ? conditionNode["Variable2Idx"].as<int>() : -1,
-                        .Variable2=conditionNode["Variable2"] ? conditionNode["Variable2"].as<int>() : 0,
-                };
-                conditions.push_back(condition);
+                        .Variable2=conditionNode["Variable2"] ? conditionNode["Variable2"].as<float>() : 0,
+                });
             }
-            auto inputNodeID = transitionNode[k_transition_InputStateID].as<int>();
-            auto outputNodeID = transitionNode[k_transition_OutputStateID].as<int>();
-            auto blend = transitionNode["Blend"].as<bool>();
-            AnimatorComponent::Transition transition = {
-                    .InputStateID=inputNodeID,
-                    .OutputStateID=outputNodeID,
+            description.transitions.push_back(Transition{
+                    .InputStateID=transitionNode[k_transition_InputStateID].as<int>(),
+                    .OutputStateID=transitionNode[k_transition_OutputStateID].as<int>(),
                     .Conditions=conditions,
-                    .Blend = blend
-            };
-            transitions.push_back(transition);
+                    .Blend=transitionNode["Blend"].as<bool>()
+            });
         }
-        // load variables
+        // load variables, files from before variables had types only have integers
         auto variablesNode = doc[k_variables].as<std::vector<YAML::Node>>();
         for (const YAML::Node &variableNode: variablesNode) {
-            auto name = variableNode[k_variable_name].as<std::string>();
-            int value = variableNode[k_variable_value].as<int>();
-            variableNames.emplace_back(name);
-            variableValues.emplace_back(value);
-        }
-        auto transitionsNode = doc[k_transitions].as<std::vector<YAML::Node>>();
-        // load animation data from animation files
-        if (!states.empty()) {
-            for (const auto &state: states) {
-                auto animationFilePath = Project::getResourceManager()->getFilePathFromGUID(state.Guid);
-                auto *anim = new Animation(animationFilePath, modelEntity, 0);
-                animationObjects[state.Guid] = anim;
-                if (animationObjects.size() > INT_MAX) {
-                    Logger::fatal("Too many animations to store in memory");
-                }
-                currentState = 0;
-                nextState = 0;
+            description.variables.push_back(Variable{
+                    .Name=variableNode[k_variable_name].as<std::string>(),
+                    .Type=variableNode[k_variable_type] ? AnimatorController::parseParameterType(variableNode[k_variable_type].as<std::string>())
+                                                        : AnimatorController::ParameterType::INT,
+                    .Value=variableNode[k_variable_value].as<float>()
+            });
+        }
+        // load layers (files from before layers do not have any)
+        if (doc[k_layers]) {
+            for (const YAML::Node &layerNode: doc[k_layers].as<std::vector<YAML::Node>>()) {
+                description.layers.push_back(AnimatorController::Description::Layer{
+                        .Name=layerNode["Name"] ? layerNode["Name"].as<std::string>() : "",
+                        .Motion=readState(layerNode["State"]),
+                        .Mask=layerNode["Mask"] ? layerNode["Mask"].as<std::vector<std::string>>() : std::vector<std::string>(),
+                        .Additive=layerNode["Additive"] && layerNode["Additive"].as<bool>(),
+                        .WeightVariableIdx=layerNode["WeightVariableIdx"] ? layerNode["WeightVariableIdx"].as<int>() : -1,
+                        .Weight=layerNode["Weight"] ? layerNode["Weight"].as<float>() : 1.0f
+                });
             }
         }
-        boneEntities.clear();
-        loadBoneEntities(modelEntity);
-        needsToFindBoneEntities = false;
-        this->needsToLoadAnimations = false;
+        return description;
     }
 
-    void AnimatorComponent::loadBoneEntities(Entity entity) {
-        if (entity.hasComponent<BoneComponent>()) {
-            boneEntities[entity.getComponent<BoneComponent>().boneID] = entity;
+    void AnimatorComponent::saveAnimatorFile(const std::string &filePath, const AnimatorController::Description &description) {
+        YAML::Emitter out;
+        out << YAML::BeginMap;
+        // serialize states
+        out << YAML::Key << k_states;
+        YAML::Node statesNode = YAML::Node(YAML::NodeType::Sequence);
+        for (const auto &state: description.states) {
+            statesNode.push_back(writeState(state));
         }
-        Entity child = entity.getComponent<HierarchyComponent>().first;
-        while (child) {
-            loadBoneEntities(child);
-            child = child.getComponent<HierarchyComponent>().next;
+        out << YAML::Value << statesNode;
+        // serialize transitions
+        out << YAML::Key << k_transitions;
+        YAML::Node transitionsNode = YAML::Node(YAML::NodeType::Sequence);
+        for (const auto &transition: description.transitions) {
+            YAML::Node transitionNode;
+            transitionNode[k_transition_InputStateID] = transition.InputStateID;
+            transitionNode[k_transition_OutputStateID] = transition.OutputStateID;
+            YAML::Node conditionsNode = YAML::Node(YAML::NodeType::Sequence);
+            for (const auto &condition: transition.Conditions) {
+                YAML::Node conditionNode;
+                conditionNode["Variable1Idx"] = condition.Variable1Idx;
+                conditionNode["Variable1"] = condition.Variable1;
+                conditionNode["Operator"] = condition.Operator;
+                conditionNode["Variable2Idx"] = condition.Variable2Idx;
+                conditionNode["Variable2"] = condition.Variable2;
+                conditionsNode.push_back(conditionNode);
+            }
+            transitionNode[k_transition_Conditions] = conditionsNode;
+            transitionNode["Blend"] = transition.Blend;
+            transitionsNode.push_back(transitionNode);
+        }
+        out << YAML::Value << transitionsNode;
+        // serialize variables
+        out << YAML::Key << k_variables;
+        YAML::Node variablesNode = YAML::Node(YAML::NodeType::Sequence);
+        for (const auto &variable: description.variables) {
+            YAML::Node variableNode;
+            variableNode[k_variable_name] = variable.Name;
+            variableNode[k_variable_type] = AnimatorController::getParameterTypeName(variable.Type);
+            variableNode[k_variable_value] = variable.Value;
+            variablesNode.push_back(variableNode);
         }
+        out << YAML::Value << variablesNode;
+        // serialize layers
+        if (!description.layers.empty()) {
+            out << YAML::Key << k_layers;
+            YAML::Node layersNode = YAML::Node(YAML::NodeType::Sequence);
+            for (const auto &layer: description.layers) {
+                YAML::Node layerNode;
+                layerNode["Name"] = layer.Name;
+                layerNode["State"] = writeState(layer.Motion);
+                layerNode["Mask"] = layer.Mask;
+                layerNode["Additive"] = layer.Additive;
+                layerNode["WeightVariableIdx"] = layer.WeightVariableIdx;
+                layerNode["Weight"] = layer.Weight;
+                layersNode.push_back(layerNode);
+            }
+            out << YAML::Value << layersNode;
+        }
+        out << YAML::EndMap;
+        std::ofstream fout(filePath.c_str());
+        fout << out.c_str();
+        fout.close();
     }
 
     int AnimatorComponent::setVariable(const std::string &variableName, int value) {
-        auto iter = std::find(variableNames.begin(), variableNames.end(), variableName);
-        if (iter != variableNames.end()) {
-            int index = (int) std::distance(variableNames.begin(), iter);
-            variableValues[index] = value;
-            return index;
-        } else {
+        int variable = findVariable(variableName);
+        if (variable != -1) {
+            variableValues[variable] = (float) value;
+        }
+        return variable;
+    }
+
+    int AnimatorComponent::findVariable(const std::string &variableName) {
+        // scripts may look up variables before the renderer loads the animator
+        if (!controller && !guid.empty()) {
+            loadController();
+        }
+        int variable = controller ? controller->findParameter(variableName) : -1;
+        if (variable == -1) {
             Logger::error("Unable to find variable " + variableName + " in animator");
-            return -1;
         }
+        return variable;
     }
 
-    void AnimatorComponent::calculateBlendedBoneTransform(void *pAnimationBaseV, const AssimpNodeData *node,
-                                                          void *pAnimationLayerV, const AssimpNodeData *nodeLayered,
-                                                          const float currentTimeBase, const float currentTimeLayered,
-                                                          const glm::mat4 &parentTransform,
-                                                          const float blendFactor,
-                                                          int depth) {
-        Animation *pAnimationBase = (Animation *) pAnimationBaseV;
-        Animation *pAnimationLayer = (Animation *) pAnimationLayerV;
-
-        const std::string &nodeName = node->name;
-
-        glm::mat4 nodeTransform = node->transformation;
-        AnimationBone *pBone = pAnimationBase->findBone(nodeName);
-        if (pBone) {
-            pBone->update(currentTimeBase);
-            nodeTransform = pBone->getLocalTransform();
-        }
-
-        glm::mat4 layeredNodeTransform = nodeLayered->transformation;
-        pBone = pAnimationLayer->findBone(nodeName);
-        if (pBone) {
-            pBone->update(currentTimeLayered);
-            layeredNodeTransform = pBone->getLocalTransform();
-        }
-
-        // Blend two matrices
-        const glm::quat rot0 = glm::quat_cast(nodeTransform);
-        const glm::quat rot1 = glm::quat_cast(layeredNodeTransform);
-        const glm::quat finalRot = glm::slerp(rot0, rot1, blendFactor);
-        glm::mat4 blendedMat = glm::mat4_cast(finalRot);
-        blendedMat[3] = (1.0f - blendFactor) * nodeTransform[3] + layeredNodeTransform[3] * blendFactor;
-
-        glm::mat4 globalTransformation = parentTransform * blendedMat;
-
-        const auto &boneInfoMap = pAnimationBase->getBoneIdMap();
-        if (boneInfoMap.find(nodeName) != boneInfoMap.end()) {
-            const int index = boneInfoMap.at(nodeName).id;
-            const glm::mat4 &offset = boneInfoMap.at(nodeName).offset;
-
-            m_FinalBoneMatrices[index] = globalTransformation * offset;
-
-            if (pBone) {
-                if (boneEntities.count(pBone->getBoneID()) > 0) {
-                    glm::vec3 scale;
-                    glm::quat rotation;
-                    glm::vec3 translation;
-                    if (depth == 1) {
-                        // we don't count 'RootNode' as a bone, so we have to do this to include its transformation
-                        // for the first layer of bones
-                        MathUtils::decomposeMatrix(parentTransform * blendedMat, translation, rotation, scale);
-                    } else {
-                        // all bones after the first layer (usually everything after hip bone for skeletons)
-                        MathUtils::decomposeMatrix(blendedMat, translation, rotation, scale);
-                    }
-                    boneEntities[pBone->getBoneID()].getComponent<TransformComponent>().translation = translation;
-                    boneEntities[pBone->getBoneID()].getComponent<TransformComponent>().rotation = rotation;
-                    boneEntities[pBone->getBoneID()].getComponent<TransformComponent>().scale = scale;
+    void AnimatorComponent::setInt(int variable, int value) {
+        if (variable >= 0 && variable < variableValues.size()) {
+            variableValues[variable] = (float) value;
+        }
+    }
+
+    void AnimatorComponent::setFloat(int variable, float value) {
+        if (variable >= 0 && variable < variableValues.size()) {
+            variableValues[variable] = value;
+        }
+    }
+
+    void AnimatorComponent::setBool(int variable, bool value) {
+        if (variable >= 0 && variable < variableValues.size()) {
+            variableValues[variable] = value ? 1.0f : 0.0f;
+        }
+    }
+
+    void AnimatorComponent::setTrigger(int variable) {
+        setBool(variable, true);
+    }
+
+    float AnimatorComponent::getVariable(int variable) {
+        if (variable >= 0 && variable < variableValues.size()) {
+            return variableValues[variable];
+        }
+        return 0.0f;
+    }
+
+    void AnimatorComponent::calculateBlendedPose(int baseState, int layeredState, float blendFactor) {
+        int numJoints = skeleton->getNumJoints();
+        const auto &layered = controller->getState(layeredState);
+        computeMotionWeights(layered.motions);
+        sampleMotions(layered.motions, currentTimeLayered, evaluatedPose);
+        if (blendFactor < 1.0f) {
+            // once the layered state is fully blended in the base pose does not contribute
+            const auto &base = controller->getState(baseState);
+            auto basePose = AnimationPosePool::acquire(numJoints);
+            computeMotionWeights(base.motions);
+            sampleMotions(base.motions, currentTimeBase, *basePose);
+            AnimationPose::blend(basePose->translations.data(), basePose->rotations.data(), evaluatedPose.translations.data(),
+                                 evaluatedPose.rotations.data(), numJoints, 1.0f - blendFactor);
+        }
+
+        for (int layer = 0; layer < controller->getNumLayers(); layer++) {
+            float weight = controller->getLayerWeight(layer, variableValues.data());
+            if (weight <= 0.0f) {
+                continue;
+            }
+            const auto &layerInfo = controller->getLayer(layer);
+            const float *mask = layerMasks[layer].empty() ? nullptr : layerMasks[layer].data();
+            auto layerPose = AnimationPosePool::acquire(numJoints);
+            computeMotionWeights(layerInfo.motions);
+            sampleMotions(layerInfo.motions, layerTimes[layer], *layerPose);
+            if (layerInfo.additive) {
+                const auto &reference = additiveReferencePoses[layer];
+                AnimationPose::addAdditive(reference.translations.data(), reference.rotations.data(),
+                                           layerPose->translations.data(), layerPose->rotations.data(),
+                                           evaluatedPose.translations.data(), evaluatedPose.rotations.data(),
+                                           numJoints, weight, mask);
+            } else {
+                AnimationPose::blend(layerPose->translations.data(), layerPose->rotations.data(), evaluatedPose.translations.data(),
+                                     evaluatedPose.rotations.data(), numJoints, weight, mask);
+            }
+        }
+    }
+
+    float AnimatorComponent::computeMotionWeights(const AnimatorController::BlendTree &tree) {
+        controller->getMotionWeights(tree, variableValues.data(), motionWeights.data());
+        float duration = 0.0f;
+        for (int motion = tree.firstMotion; motion < tree.firstMotion + tree.numMotions; motion++) {
+            const AnimationClip *clip = clips[motion].get();
+            duration += motionWeights[motion] * clip->getDuration() / clip->getTicksPerSecond();
+        }
+        // avoid dividing by zero for empty clips
+        return std::max(duration, 0.0001f);
+    }
+
+    void AnimatorComponent::sampleMotions(const AnimatorController::BlendTree &tree, float time, AnimationPose &pose) {
+        int numJoints = skeleton->getNumJoints();
+        // motions are played at the same normalized time so their cycles stay in step
+        int onlyMotion = -1;
+        for (int motion = tree.firstMotion; motion < tree.firstMotion + tree.numMotions; motion++) {
+            if (motionWeights[motion] >= 0.9999f) {
+                onlyMotion = motion;
+            }
+        }
+        if (onlyMotion != -1) {
+            const AnimationClip *clip = clips[onlyMotion].get();
+            clip->sample(time * clip->getDuration(), cursors[onlyMotion], pose.translations.data(), pose.rotations.data());
+            return;
+        }
+        std::fill_n(pose.translations.begin(), numJoints, glm::vec3(0.0f));
+        std::fill_n(pose.rotations.begin(), numJoints, glm::quat(0.0f, 0.0f, 0.0f, 0.0f));
+        auto motionPose = AnimationPosePool::acquire(numJoints);
+        for (int motion = tree.firstMotion; motion < tree.firstMotion + tree.numMotions; motion++) {
+            if (motionWeights[motion] <= 0.0001f) {
+                continue;
+            }
+            const AnimationClip *clip = clips[motion].get();
+            clip->sample(time * clip->getDuration(), cursors[motion], motionPose->translations.data(), motionPose->rotations.data());
+            AnimationPose::accumulate(motionPose->translations.data(), motionPose->rotations.data(), pose.translations.data(),
+                                      pose.rotations.data(), numJoints, motionWeights[motion]);
+        }
+        AnimationPose::normalizeRotations(pose.rotations.data(), numJoints);
+    }
+
+    void AnimatorComponent::calculateBoneTransforms(const glm::vec3 *translations, const glm::quat *rotations) {
+        pendingBoneTransforms.clear();
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+        // parents come before their children, so their model space transform is always ready
+        for (int joint = 0; joint < skeleton->getNumJoints(); joint++) {
+            glm::mat4 blendedMat = glm::mat4_cast(rotations[joint]);
+            blendedMat[3] = glm::vec4(translations[joint], 1.0f);
+            int parent = skeleton->getParent(joint);
+            jointTransforms[joint] = parent == -1 ? blendedMat : jointTransforms[parent] * blendedMat;
+
+            int boneIndex = skeleton->getBoneIndex(joint);
+            if (boneIndex == -1) {
+                continue;
+            }
+            m_FinalBoneMatrices[boneIndex] = jointTransforms[joint] * skeleton->getOffset(joint);
+            boundsMin = glm::min(boundsMin, glm::vec3(jointTransforms[joint][3]));
+            boundsMax = glm::max(boundsMax, glm::vec3(jointTransforms[joint][3]));
+
+            bool hasReaders = writeAllBoneTransforms || jointHasReaders[joint];
+            if (hasReaders && jointIsAnimated[joint] && jointEntities[joint]) {
+                BoneTransform boneTransform = {.joint=joint};
+                if (skeleton->getDepth(joint) == 1) {
+                    // we don't count 'RootNode' as a bone, so we have to do this to include its transformation
+                    // for the first layer of bones
+                    MathUtils::decomposeMatrix(jointTransforms[joint], boneTransform.translation, boneTransform.rotation, boneTransform.scale);
                 } else {
-                    Logger::warn("Cannot find entity for bone " + pBone->getBoneName() + " with ID " +
-                                 std::to_string(pBone->getBoneID()));
+                    // all bones after the first layer (usually everything after hip bone for skeletons)
+                    MathUtils::decomposeMatrix(blendedMat, boneTransform.translation, boneTransform.rotation, boneTransform.scale);
                 }
+                pendingBoneTransforms.push_back(boneTransform);
+            }
+        }
+        if (boundsMin.x <= boundsMax.x) {
+            // joints are inside the skin, so the sphere is padded to cover the mesh around them
+            boundsCenter = (boundsMin + boundsMax) * 0.5f;
+            boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f * 1.5f;
+        }
+    }
+
+    void AnimatorComponent::findBoneReaders() {
+        jointHasReaders.assign(jointEntities.size(), false);
+        for (int joint = 0; joint < jointEntities.size(); joint++) {
+            Entity boneEntity = jointEntities[joint];
+            if (!boneEntity) {
+                continue;
+            }
+            bool hasReaders = boneEntity.hasComponent<LuaScriptComponent>() ||
+                              (boneEntity.hasComponent<BoneComponent>() && boneEntity.getComponent<BoneComponent>().readByScript);
+            Entity child = boneEntity.getComponent<HierarchyComponent>().first;
+            while (child && !hasReaders) {
+                hasReaders = !child.hasComponent<BoneComponent>();
+                child = child.getComponent<HierarchyComponent>().next;
             }
+            jointHasReaders[joint] = hasReaders;
         }
+        // children come after their parents
+        for (int joint = (int) jointHasReaders.size() - 1; joint >= 0; joint--) {
+            int parent = skeleton->getParent(joint);
+            if (jointHasReaders[joint] && parent != -1) {
+                jointHasReaders[parent] = true;
+            }
+        }
+    }
 
-        for (size_t i = 0; i < node->children.size(); ++i)
-            calculateBlendedBoneTransform(pAnimationBase, &node->children[i], pAnimationLayer,
-                                          &nodeLayered->children[i], currentTimeBase, currentTimeLayered,
-                                          globalTransformation, blendFactor, depth + 1);
+    void AnimatorComponent::writeBoneTransforms() {
+        for (const auto &boneTransform: pendingBoneTransforms) {
+            auto &transform = jointEntities[boneTransform.joint].getComponent<TransformComponent>();
+            transform.translation = boneTransform.translation;
+            transform.rotation = boneTransform.rotation;
+            transform.scale = boneTransform.scale;
+        }
+        pendingBoneTransforms.clear();
     }
 
-    void AnimatorComponent::blendTwoAnimations(void *pBaseAnimationV, void *pLayeredAnimationV, float blendFactor,
-                                               float deltaTime) {
-        Animation *pBaseAnimation = (Animation *) pBaseAnimationV;
-        Animation *pLayeredAnimation = (Animation *) pLayeredAnimationV;
-        // Speed multipliers to correctly transition from one animation to another
-        float a = 1.0f;
-        float b = pBaseAnimation->getDuration() / pLayeredAnimation->getDuration();
-        const float animSpeedMultiplierUp = (1.0f - blendFactor) * a + b * blendFactor; // Lerp
-
-        a = pLayeredAnimation->getDuration() / pBaseAnimation->getDuration();
-        b = 1.0f;
-        const float animSpeedMultiplierDown = (1.0f - blendFactor) * a + b * blendFactor; // Lerp
-
-        // Current time of each animation, "scaled" by the above speed multiplier variables
-        currentTimeBase += pBaseAnimation->getTicksPerSecond() * deltaTime * animSpeedMultiplierUp;
-        if (states[currentState].PlayOnce && currentTimeBase >= pBaseAnimation->getDuration()) {
-            currentTimeBase = pBaseAnimation->getDuration() - 0.01f;
+    void AnimatorComponent::blendTwoAnimations(int baseState, int layeredState, float blendFactor, float deltaTime) {
+        const auto &base = controller->getState(baseState);
+        const auto &layered = controller->getState(layeredState);
+        float baseDuration = computeMotionWeights(base.motions);
+        float layeredDuration = computeMotionWeights(layered.motions);
+
+        // both states advance at a rate between their own, so blending between animations of different lengths
+        // (ex: walk and run cycles) keeps them in step
+        float rate = (1.0f - blendFactor) / baseDuration + blendFactor / layeredDuration;
+        currentTimeBase += rate * deltaTime;
+        if (base.playOnce && currentTimeBase >= 1.0f) {
+            currentTimeBase = 0.9999f;
         } else {
-            currentTimeBase = fmod(currentTimeBase, pBaseAnimation->getDuration());
+            currentTimeBase = fmod(currentTimeBase, 1.0f);
         }
 
-        currentTimeLayered += pLayeredAnimation->getTicksPerSecond() * deltaTime * animSpeedMultiplierDown;
+        currentTimeLayered += rate * deltaTime;
         if (currentState == nextState) {
-            if (currentTimeLayered > pLayeredAnimation->getDuration()) {
+            if (currentTimeLayered > 1.0f) {
                 numTimesAnimationPlayed += 1;
             }
         }
 
-        if (states[currentState].PlayOnce && currentTimeLayered >= pLayeredAnimation->getDuration()) {
-            currentTimeLayered = pLayeredAnimation->getDuration() - 0.01f;
+        if (layered.playOnce && currentTimeLayered >= 1.0f) {
+            currentTimeLayered = 0.9999f;
         } else {
-            currentTimeLayered = fmod(currentTimeLayered, pLayeredAnimation->getDuration());
+            currentTimeLayered = fmod(currentTimeLayered, 1.0f);
+        }
+
+        for (int layer = 0; layer < controller->getNumLayers(); layer++) {
+            const auto &layerInfo = controller->getLayer(layer);
+            if (controller->getLayerWeight(layer, variableValues.data()) <= 0.0f) {
+                // a layer that is faded out starts over the next time it is used (ex: an attack)
+                layerTimes[layer] = 0.0f;
+                continue;
+            }
+            layerTimes[layer] += deltaTime / computeMotionWeights(layerInfo.motions);
+            if (layerInfo.playOnce && layerTimes[layer] >= 1.0f) {
+                layerTimes[layer] = 0.9999f;
+            } else {
+                layerTimes[layer] = fmod(layerTimes[layer], 1.0f);
+            }
         }
 
-        calculateBlendedBoneTransform(pBaseAnimation, &pBaseAnimation->getRootNode(), pLayeredAnimation,
-                                      &pLayeredAnimation->getRootNode(), currentTimeBase, currentTimeLayered,
-                                      glm::mat4(1.0f), blendFactor);
+        if (!isVisible) {
+            // time still advances so the pose is right when the vertex animation hands the instance back
+            framesSinceEvaluation = -1;
+            return;
+        }
+        int numJoints = skeleton->getNumJoints();
+        if (evaluatePose || framesSinceEvaluation == -1) {
+            if (framesSinceEvaluation != -1) {
+                // the last evaluated pose becomes the one interpolated from
+                std::swap(previousPose, evaluatedPose);
+            }
+            calculateBlendedPose(baseState, layeredState, blendFactor);
+            if (framesSinceEvaluation == -1) {
+                std::copy_n(evaluatedPose.translations.begin(), numJoints, previousPose.translations.begin());
+                std::copy_n(evaluatedPose.rotations.begin(), numJoints, previousPose.rotations.begin());
+            }
+            framesSinceEvaluation = 0;
+        } else {
+            framesSinceEvaluation++;
+        }
+
+        // frames between evaluations interpolate from the previous evaluated pose to the last one (so the pose
+        // lags by up to one update interval)
+        float interpolationFactor = std::min((float) (framesSinceEvaluation + 1) / (float) updateInterval, 1.0f);
+        if (interpolationFactor < 1.0f) {
+            auto pose = AnimationPosePool::acquire(numJoints);
+            std::copy_n(previousPose.translations.begin(), numJoints, pose->translations.begin());
+            std::copy_n(previousPose.rotations.begin(), numJoints, pose->rotations.begin());
+            AnimationPose::blend(evaluatedPose.translations.data(), evaluatedPose.rotations.data(), pose->translations.data(),
+                                 pose->rotations.data(), numJoints, interpolationFactor);
+            calculateBoneTransforms(pose->translations.data(), pose->rotations.data());
+        } else {
+            calculateBoneTransforms(evaluatedPose.translations.data(), evaluatedPose.rotations.data());
+        }
     }
 
     std::string AnimatorComponent::getCurrentStateName() {
-        if (currentState == -1) {
+        if (!controller || currentState == -1) {
             return "";
         }
-        return states.at(currentState).Name;
+        return controller->getState(currentState).name;
     }
 }
\ No newline at end of file
@@ -92,13 +92,13 @@ namespace Dream::Component {
         up    = glm::normalize(glm::cross(right, front));
     }
 
-    void CameraComponent::updateRendererCamera(Dream::Camera &camera, Entity &sceneCameraEntity) {
+    void CameraComponent::updateRendererCamera(Dream::Camera &camera, Entity &sceneCameraEntity, float interpolationAlpha) {
         auto eulerAngles = glm::eulerAngles(sceneCameraEntity.getComponent<TransformComponent>().rotation);
         auto transformComponent = sceneCameraEntity.getComponent<TransformComponent>();
 //        camera.yaw = eulerAngles.x;
 //        camera.pitch = eulerAngles.y;
         camera.fov = fov;
-        camera.position = transformComponent.translation;
+        camera.position = glm::vec3(transformComponent.getInterpolatedTransform(sceneCameraEntity, interpolationAlpha)[3]);
         camera.zFar = zFar;
         camera.zNear = zNear;
 //        camera.updateCameraVectors();
@@ -20,6 +20,8 @@
 
 #include "dream/util/YAMLUtils.h"
 #include "dream/project/Project.h"
+#include "dream/scene/system/PhysicsShapeCache.h"
+#include "dream/scene/system/TerrainHeightfieldShape.h"
 
 namespace Dream::Component {
     CollisionComponent::CollisionComponent() {
@@ -31,72 +33,30 @@ namespace Dream::Component {
     }
 
     void CollisionComponent::updateColliderShape(Entity &entity) {
+        auto *physicsComponentSystem = Project::getScene()->getPhysicsComponentSystem();
         if (colliderShapeIndex == -1) {
             auto *colliderCompoundShape = new btCompoundShape();
-            colliderShapeIndex = Project::getScene()->getPhysicsComponentSystem()->addColliderShape(colliderCompoundShape);
+            colliderShapeIndex = physicsComponentSystem->addColliderShape(colliderCompoundShape);
         }
-
-        // remove current collision shapes in compound shape
-        for (int i = Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->getNumChildShapes() - 1; i >= 0; i--) {
-            Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->removeChildShapeByIndex(i);
+        btCompoundShape *colliderShape = physicsComponentSystem->getColliderShape(colliderShapeIndex);
+
+        // remove current collision shapes in compound shape, shared shapes go back to the cache
+        for (int i = colliderShape->getNumChildShapes() - 1; i >= 0; i--) {
+            btCollisionShape *childShape = colliderShape->getChildShape(i);
+            colliderShape->removeChildShapeByIndex(i);
+            if (childShape == heightfieldShape) {
+                delete childShape;
+            } else {
+                physicsComponentSystem->getShapeCache()->release(childShape);
+            }
         }
+        heightfieldShape = nullptr;
 
         for (const auto &collider: colliders) {
             btTransform t;
             t.setIdentity();
             t.setOrigin(btVector3(collider.offset.x, collider.offset.y, collider.offset.z));
-            if (collider.type == BOX) {
-                auto shape = new btBoxShape(
-                        btVector3(collider.halfExtents.x, collider.halfExtents.y, collider.halfExtents.z));
-                Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
-            } else if (collider.type == CAPSULE) {
-                btCapsuleShape *shape = nullptr;
-                if (collider.axis == Y) {
-                    shape = new btCapsuleShape(collider.radius, collider.height);
-                } else if (collider.axis == X) {
-                    shape = new btCapsuleShapeX(collider.radius, collider.height);
-                } else if (collider.axis == Z) {
-                    shape = new btCapsuleShapeZ(collider.radius, collider.height);
-                } else {
-                    Logger::fatal("Unknown capsule axis " + std::to_string(collider.axis));
-                }
-                Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
-            } else if (collider.type == CONE) {
-                btConeShape *shape = nullptr;
-                if (collider.axis == Y) {
-                    shape = new btConeShape(collider.radius, collider.height);
-                } else if (collider.axis == X) {
-                    shape = new btConeShapeX(collider.radius, collider.height);
-                } else if (collider.axis == Z) {
-                    shape = new btConeShapeZ(collider.radius, collider.height);
-                } else {
-                    Logger::fatal("Unknown cone axis " + std::to_string(collider.axis));
-                }
-                Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
-            } else if (collider.type == CYLINDER) {
-                btCylinderShape *shape = nullptr;
-                if (collider.axis == Y) {
-                    shape = new btCylinderShape(
-                            btVector3(collider.halfExtents.x, collider.halfExtents.y, collider.halfExtents.z));
-                } else if (collider.axis == X) {
-                    shape = new btCylinderShapeX(
-                            btVector3(collider.halfExtents.x, collider.halfExtents.y, collider.halfExtents.z));
-                } else if (collider.axis == Z) {
-                    shape = new btCylinderShapeZ(
-                            btVector3(collider.halfExtents.x, collider.halfExtents.y, collider.halfExtents.z));
-                } else {
-                    Logger::fatal("Unknown cylinder axis " + std::to_string(collider.axis));
-                }
-                Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
-            } else if (collider.type == MESH) {
-//                auto *shape = btTriangleMeshShape();
-//                colliderCompoundShape->addChildShape(t, shape);
-                // TODO
-                Logger::fatal("TODO: support mesh shape loading in CollisionComponent");
-            } else if (collider.type == SPHERE) {
-                auto *shape = new btSphereShape(collider.radius);
-                Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
-            } else if (collider.type == HEIGHT_MAP) {
+            if (collider.type == HEIGHT_MAP) {
                 if (!entity.hasComponent<TerrainComponent>()) {
                     Logger::fatal("Entity does not have terrain component, so terrain collider cannot be attached");
                 }
@@ -110,44 +70,43 @@ namespace Dream::Component {
 
                 if (terrain) {
                     float scale = terrain->getWorldScale();
-                    float minHeight = terrain->getMinHeight();
-                    float maxHeight = terrain->getMaxHeight();
-                    int width = (int) (terrain->getSize());
-                    int length = (int) (terrain->getSize());
-                    if (heightMapData) {
-                        delete heightMapData;
-                    }
-                    heightMapData = (float*) malloc(257 * 257 * sizeof(float));
-
-                    // TODO: don't fix size of heightMapData
-                    for (int x = 0; x < 257; x++) {
-                        for (int z = 0; z < 257; z++) {
-                            if (x > 256 || z > 256) {
-                                Logger::fatal("heightMapData is fixed at 257 by 257");
-                            }
-                            heightMapData[x * 257 + z] = 0.0f;
-                        }
-                    }
-
-                    // TODO: don't fix size of heightMapData
-                    for (int x = 0; x < width; x++) {
-                        for (int z = 0; z < length; z++) {
-                            if (x > 256 || z > 256) {
-                                Logger::fatal("heightMapData is fixed at 257 by 257");
-                            }
-                            float height = terrain->getHeight(x, z);
-                            heightMapData[z * 257 + x] = height;
-                        }
-                    }
-
-                    auto *shape = new btHeightfieldTerrainShape(width, length, heightMapData, 1.0, minHeight, maxHeight, 1, PHY_FLOAT, true);
+                    int size = (int) (terrain->getSize());
+                    // height map is stored row-major (z * size + x) just like bullet expects, so it is shared instead of copied
+                    auto *shape = new TerrainHeightfieldShape(size, size, terrain->getHeightMapData(),
+                                                              terrain->getMinHeight(), terrain->getMaxHeight());
                     shape->setLocalScaling(btVector3(scale, 1.0, scale));
-                    Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex)->addChildShape(t, shape);
+                    colliderShape->addChildShape(t, shape);
+                    heightfieldShape = shape;
                 } else {
                     Logger::fatal("Terrain not initialized, so collider cannot be derived");
                 }
             } else {
-                Logger::fatal("Unknown collider type " + std::to_string(static_cast<int>(collider.type)));
+                if (collider.type == MESH && entity.hasComponent<RigidBodyComponent>() &&
+                    entity.getComponent<RigidBodyComponent>().type == RigidBodyComponent::DYNAMIC) {
+                    Logger::warn("Mesh colliders only collide correctly on static and kinematic rigid bodies");
+                }
+                // primitives and meshes are immutable, so entities with the same collider share one shape
+                btCollisionShape *shape = physicsComponentSystem->getShapeCache()->acquire(collider);
+                if (shape) {
+                    colliderShape->addChildShape(t, shape);
+                }
+            }
+        }
+    }
+
+    void CollisionComponent::updateHeightfieldBounds(Entity &entity) {
+        if (!heightfieldShape || colliderShapeIndex == -1 || !entity.hasComponent<TerrainComponent>()) {
+            return;
+        }
+        OpenGLBaseTerrain *terrain = entity.getComponent<TerrainComponent>().terrain;
+        if (!terrain || !heightfieldShape->includeHeightRange(terrain->getMinHeight(), terrain->getMaxHeight())) {
+            return;
+        }
+        // compound shape caches the bounds of its children
+        auto *colliderShape = Project::getScene()->getPhysicsComponentSystem()->getColliderShape(colliderShapeIndex);
+        for (int i = 0; i < colliderShape->getNumChildShapes(); i++) {
+            if (colliderShape->getChildShape(i) == heightfieldShape) {
+                colliderShape->updateChildTransform(i, colliderShape->getChildTransform(i), true);
             }
         }
     }
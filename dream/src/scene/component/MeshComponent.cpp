@@ -43,7 +43,10 @@ namespace Dream::Component {
         this->meshType = FROM_FILE;
         this->guid = std::move(guid);
         this->m_BoneCount = (int) boneMap.size();
-        this->m_BoneInfoMap = std::move(boneMap);
+        if (!Project::getResourceManager()->hasBoneData(this->guid)) {
+            Project::getResourceManager()->storeBoneData(std::move(boneMap), this->guid);
+        }
+        this->m_BoneInfoMap = Project::getResourceManager()->getBoneData(this->guid);
     }
 
     MeshComponent::MeshComponent(Dream::Component::MeshComponent::MeshType meshType,
@@ -61,10 +64,14 @@ namespace Dream::Component {
             } else {
                 if (!this->guid.empty()) {
                     if (needsToLoadBones) {
-                        // TODO: THIS CREATES NEW POINTERS THAT ARE UNUSED, PASS OPTION TO LOAD MESH TO NOT CREATE NEW OBJECTS
-                        auto boneMap = Project::getAssetLoader()->loadMesh(this->guid);
-                        this->m_BoneCount = (int) boneMap.size();
-                        this->m_BoneInfoMap = std::move(boneMap);
+                        // bones are the same for every instance of the model, so only the first one imports the file
+                        if (!Project::getResourceManager()->hasBoneData(this->guid)) {
+                            // TODO: THIS CREATES NEW POINTERS THAT ARE UNUSED, PASS OPTION TO LOAD MESH TO NOT CREATE NEW OBJECTS
+                            auto boneMap = Project::getAssetLoader()->loadMesh(this->guid);
+                            Project::getResourceManager()->storeBoneData(std::move(boneMap), this->guid);
+                        }
+                        this->m_BoneInfoMap = Project::getResourceManager()->getBoneData(this->guid);
+                        this->m_BoneCount = (int) this->m_BoneInfoMap->size();
                         needsToLoadBones = false;
                     }
                 }
@@ -124,7 +131,7 @@ namespace Dream::Component {
         auto oldGUID = guid;
 
         // reset skeleton
-        this->m_BoneInfoMap.clear();
+        this->m_BoneInfoMap = nullptr;
         this->needsToLoadBones = true;
 
         // change mesh
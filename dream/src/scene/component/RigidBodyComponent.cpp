@@ -41,6 +41,7 @@ namespace Dream::Component {
                 << YAML::convert<glm::vec3>().encode(rigidBodyComponent.angularFactor);
             out << YAML::Key << k_friction << YAML::Value << rigidBodyComponent.friction;
             out << YAML::Key << k_restitution << YAML::Value << rigidBodyComponent.restitution;
+            out << YAML::Key << k_isTrigger << YAML::Value << rigidBodyComponent.isTrigger;
             out << YAML::EndMap;
         }
     }
@@ -57,6 +58,10 @@ namespace Dream::Component {
             YAML::convert<glm::vec3>().decode(node[componentName][k_angularFactor], angularFactor);
             auto friction = node[componentName][k_friction].as<float>();
             auto restitution = node[componentName][k_restitution].as<float>();
+            bool isTrigger = false;
+            if (node[componentName][k_isTrigger]) {
+                isTrigger = node[componentName][k_isTrigger].as<bool>();
+            }
             entity.addComponent<RigidBodyComponent>();
             entity.getComponent<RigidBodyComponent>().type = type;
             entity.getComponent<RigidBodyComponent>().mass = mass;
@@ -66,6 +71,7 @@ namespace Dream::Component {
             entity.getComponent<RigidBodyComponent>().angularFactor = angularFactor;
             entity.getComponent<RigidBodyComponent>().friction = friction;
             entity.getComponent<RigidBodyComponent>().restitution = restitution;
+            entity.getComponent<RigidBodyComponent>().isTrigger = isTrigger;
             entity.getComponent<RigidBodyComponent>().rigidBodyIndex = -1;
         }
     }
@@ -93,9 +99,12 @@ namespace Dream::Component {
         btCompoundShape* colliderShape = Project::getScene()->getPhysicsComponentSystem()->getColliderShape(entity.getComponent<CollisionComponent>().colliderShapeIndex);
 
         if (rigidBodyIndex == -1) {
-            auto *motionState = new btDefaultMotionState(
+            auto *motionState = Project::getScene()->getPhysicsComponentSystem()->createMotionState(
+                    (entt::entity) entity,
                     btTransform(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w),
                                 btVector3(translation.x, translation.y, translation.z)));
+            previousTranslation = translation;
+            previousRotation = rotation;
             btRigidBody::btRigidBodyConstructionInfo rigidBodyCI(mass, motionState, colliderShape, localInertia);
             auto *rigidBody = new btRigidBody(rigidBodyCI);
             rigidBodyIndex = Project::getScene()->getPhysicsComponentSystem()->addRigidBody(rigidBody);
@@ -111,8 +120,7 @@ namespace Dream::Component {
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setRestitution(restitution);
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setLinearFactor(btVector3(linearFactor.x, linearFactor.y, linearFactor.z));
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setAngularFactor(btVector3(angularFactor.x, angularFactor.y, angularFactor.z));
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setActivationState(DISABLE_DEACTIVATION);
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->forceActivationState(ACTIVE_TAG);
         } else if (type == RigidBodyComponent::KINEMATIC) {
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setMassProps(0, localInertia);
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setCollisionFlags(Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
@@ -136,8 +144,7 @@ namespace Dream::Component {
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setRestitution(restitution);
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setLinearFactor(btVector3(0, 0, 0));
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setAngularFactor(btVector3(0, 0, 0));
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setActivationState(DISABLE_DEACTIVATION);
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->forceActivationState(ACTIVE_TAG);
 //            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setMassProps(0, localInertia);
 //            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setCollisionFlags(Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
 //            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setFriction(friction);
@@ -153,12 +160,21 @@ namespace Dream::Component {
         } else {
             Logger::fatal("Unknown rigid body type " + std::to_string(static_cast<int>(type)));
         }
+
+        // triggers still get contacts (so they report overlaps) but never push other bodies
+        auto *rigidBody = Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex);
+        if (isTrigger) {
+            rigidBody->setCollisionFlags(rigidBody->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+        } else {
+            rigidBody->setCollisionFlags(rigidBody->getCollisionFlags() & ~btCollisionObject::CF_NO_CONTACT_RESPONSE);
+        }
     }
 
     void RigidBodyComponent::setLinearVelocity(glm::vec3 newLinearVelocity) {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setLinearVelocity(btVector3(newLinearVelocity.x, newLinearVelocity.y, newLinearVelocity.z));
         }
     }
@@ -177,6 +193,7 @@ namespace Dream::Component {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->setAngularVelocity(btVector3(newAngularVelocity.x, newAngularVelocity.y, newAngularVelocity.z));
         }
     }
@@ -195,7 +212,9 @@ namespace Dream::Component {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getWorldTransform().setRotation(btQuaternion(rot.x, rot.y, rot.z, rot.w));
+            btTransform trans = Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getWorldTransform();
+            trans.setRotation(btQuaternion(rot.x, rot.y, rot.z, rot.w));
+            Project::getScene()->getPhysicsComponentSystem()->setRigidBodyTransform(rigidBodyIndex, trans);
         }
     }
 
@@ -203,7 +222,9 @@ namespace Dream::Component {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
-            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getWorldTransform().setOrigin(btVector3(translation.x, translation.y, translation.z));
+            btTransform trans = Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->getWorldTransform();
+            trans.setOrigin(btVector3(translation.x, translation.y, translation.z));
+            Project::getScene()->getPhysicsComponentSystem()->setRigidBodyTransform(rigidBodyIndex, trans);
         }
     }
 
@@ -221,6 +242,7 @@ namespace Dream::Component {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->applyCentralImpulse(btVector3(impulseDirection.x, impulseDirection.y, impulseDirection.z));
         }
     }
@@ -229,6 +251,7 @@ namespace Dream::Component {
         if (rigidBodyIndex == -1) {
             Logger::warn("Rigid body not initialized");
         } else {
+            Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->activate();
             Project::getScene()->getPhysicsComponentSystem()->getRigidBody(rigidBodyIndex)->applyCentralForce(btVector3(forceDirection.x, forceDirection.y, forceDirection.z));
         }
     }
@@ -50,6 +50,23 @@ namespace Dream::Component {
         return parentModel * model;
     }
 
+    glm::mat4 TransformComponent::getInterpolatedTransform(Entity &curEntity, float alpha) {
+        glm::vec3 curTranslation = translation;
+        glm::quat curRotation = rotation;
+        if (curEntity.hasComponent<RigidBodyComponent>()) {
+            auto &rigidBodyComponent = curEntity.getComponent<RigidBodyComponent>();
+            curTranslation = glm::mix(rigidBodyComponent.previousTranslation, translation, alpha);
+            curRotation = glm::slerp(rigidBodyComponent.previousRotation, rotation, alpha);
+        }
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), curTranslation) * glm::toMat4(curRotation) *
+                          glm::scale(glm::mat4(1.0f), scale);
+        Entity parent = curEntity.getComponent<HierarchyComponent>().parent;
+        if (parent) {
+            return parent.getComponent<TransformComponent>().getInterpolatedTransform(parent, alpha) * model;
+        }
+        return model;
+    }
+
     void TransformComponent::serialize(YAML::Emitter &out, Entity &entity) {
         if (entity.hasComponent<TransformComponent>()) {
             auto &transformComponent = entity.getComponent<TransformComponent>();
@@ -0,0 +1,111 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <algorithm>
+#include <utility>
+
+#include "dream/scene/component/Component.h"
+#include "dream/project/Project.h"
+#include "dream/util/Logger.h"
+
+namespace Dream::Component {
+    VertexAnimationComponent::VertexAnimationComponent(std::string guid) {
+        this->guid = std::move(guid);
+    }
+
+    void VertexAnimationComponent::loadVertexAnimation() {
+        needsToLoad = false;
+        vertexAnimation = nullptr;
+        if (guid.empty()) {
+            return;
+        }
+        auto *resourceManager = Project::getResourceManager();
+        if (!resourceManager->hasVertexAnimation(guid)) {
+            std::string path = resourceManager->getFilePathFromGUID(guid);
+            auto *loaded = VertexAnimationTexture::load(path);
+            if (!loaded) {
+                Logger::error("Unable to load vertex animation " + path);
+                return;
+            }
+            resourceManager->storeVertexAnimation(loaded, guid);
+        }
+        vertexAnimation = resourceManager->getVertexAnimation(guid);
+    }
+
+    void VertexAnimationComponent::update(float dt, const AnimatorComponent *animator) {
+        time += dt * speed;
+        if (!vertexAnimation || vertexAnimation->getNumClips() == 0) {
+            return;
+        }
+        activeClip = std::clamp(clip, 0, vertexAnimation->getNumClips() - 1);
+        activeTime = time + timeOffset;
+
+        // the state being blended to, playing the motion of its blend tree with the most weight
+        if (animator && animator->controller && animator->nextState >= 0 &&
+            animator->nextState < animator->controller->getNumStates()) {
+            const auto &tree = animator->controller->getState(animator->nextState).motions;
+            int motion = -1;
+            float motionWeight = -1.0f;
+            for (int i = tree.firstMotion; i < tree.firstMotion + tree.numMotions; i++) {
+                float weight = i < animator->motionWeights.size() ? animator->motionWeights[i] : 0.0f;
+                if (weight > motionWeight) {
+                    motion = i;
+                    motionWeight = weight;
+                }
+            }
+            int bakedClip = motion == -1 ? -1 : vertexAnimation->findClip(animator->controller->getMotion(motion).guid);
+            if (bakedClip != -1) {
+                activeClip = bakedClip;
+                activeTime = animator->currentTimeLayered * vertexAnimation->getClip(bakedClip).duration;
+            }
+        }
+    }
+
+    void VertexAnimationComponent::serialize(YAML::Emitter &out, Entity &entity) {
+        if (entity.hasComponent<VertexAnimationComponent>()) {
+            auto &component = entity.getComponent<VertexAnimationComponent>();
+            out << YAML::Key << componentName;
+            out << YAML::BeginMap;
+            out << YAML::Key << k_guid << YAML::Value << component.guid;
+            out << YAML::Key << k_clip << YAML::Value << component.clip;
+            out << YAML::Key << k_timeOffset << YAML::Value << component.timeOffset;
+            out << YAML::Key << k_speed << YAML::Value << component.speed;
+            out << YAML::Key << k_switchDistance << YAML::Value << component.switchDistance;
+            out << YAML::EndMap;
+        }
+    }
+
+    void VertexAnimationComponent::deserialize(YAML::Node node, Entity &entity) {
+        if (node[componentName]) {
+            auto guid = node[componentName][k_guid].as<std::string>();
+            auto &component = entity.addComponent<VertexAnimationComponent>(guid);
+            if (node[componentName][k_clip]) {
+                component.clip = node[componentName][k_clip].as<int>();
+            }
+            if (node[componentName][k_timeOffset]) {
+                component.timeOffset = node[componentName][k_timeOffset].as<float>();
+            }
+            if (node[componentName][k_speed]) {
+                component.speed = node[componentName][k_speed].as<float>();
+            }
+            if (node[componentName][k_switchDistance]) {
+                component.switchDistance = node[componentName][k_switchDistance].as<float>();
+            }
+        }
+    }
+}
@@ -17,8 +17,16 @@
  **********************************************************************************/
 
 #include "dream/scene/system/AnimatorComponentSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include "dream/project/Project.h"
 #include "dream/scene/component/Component.h"
+#include "dream/renderer/Camera.h"
+#include "dream/util/MathUtils.h"
+#include "dream/util/ThreadPool.h"
+#include "dream/window/Input.h"
 
 namespace Dream {
     void AnimatorComponentSystem::init() {
@@ -26,12 +34,108 @@ namespace Dream {
     }
 
     void AnimatorComponentSystem::update(float dt) {
+        frame++;
+        // same camera the renderer draws the scene from
+        hasView = false;
+        levelOfDetail = Project::getConfig().animationConfig.levelOfDetail;
+        auto [viewportWidth, viewportHeight] = Input::getRendererDimensions();
+        if (viewportWidth > 0 && viewportHeight > 0) {
+            Camera camera((float) viewportWidth, (float) viewportHeight);
+            auto sceneCameraEntity = Project::getScene()->getSceneCamera();
+            auto mainCameraEntity = Project::getScene()->getMainCamera();
+            if (sceneCameraEntity && !Project::isPlaying()) {
+                sceneCameraEntity.getComponent<Component::SceneCameraComponent>().updateRendererCamera(camera, sceneCameraEntity);
+                hasView = true;
+            } else if (mainCameraEntity && Project::isPlaying()) {
+                mainCameraEntity.getComponent<Component::CameraComponent>().updateRendererCamera(camera, mainCameraEntity);
+                hasView = true;
+            }
+            if (hasView) {
+                MathUtils::getFrustumPlanes(camera.getProjectionMatrix() * camera.getViewMatrix(), frustumPlanes);
+                viewPosition = camera.position;
+                tanHalfFov = std::tan(glm::radians(camera.fov) * 0.5f);
+            }
+        }
+
         auto animatorEntities = Project::getScene()->getEntitiesWithComponents<Component::AnimatorComponent>();
+        animators.clear();
         for (auto entityHandle: animatorEntities) {
             Entity entity = {entityHandle, Project::getScene()};
-            entity.getComponent<Component::AnimatorComponent>().updateAnimation(dt);
-            // TODO: this should be in fixed update?
-            entity.getComponent<Component::AnimatorComponent>().updateStateMachine(dt);
+            auto &animator = entity.getComponent<Component::AnimatorComponent>();
+            animators.push_back(&animator);
+            // the editor shows bone transforms, while playing they are only written when something reads them
+            animator.writeAllBoneTransforms = !Project::isPlaying();
+            if (Project::isPlaying() && --animator.framesUntilReaderCheck <= 0) {
+                animator.findBoneReaders();
+                animator.framesUntilReaderCheck = readerCheckInterval;
+            }
+            updateLevelOfDetail(animator, entity.getComponent<Component::TransformComponent>().getTransform(entity),
+                                (uint32_t) entityHandle);
+        }
+        // instances far from the camera are drawn from their baked clips, so an animator on them only advances time
+        vertexAnimations.clear();
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::VertexAnimationComponent>()) {
+            Entity entity = {entityHandle, Project::getScene()};
+            auto &vertexAnimation = entity.getComponent<Component::VertexAnimationComponent>();
+            auto *animator = entity.hasComponent<Component::AnimatorComponent>() ? &entity.getComponent<Component::AnimatorComponent>() : nullptr;
+            vertexAnimations.emplace_back(&vertexAnimation, animator);
+            vertexAnimation.isActive = false;
+            if (!vertexAnimation.vertexAnimation) {
+                continue;
+            }
+            if (animator) {
+                glm::vec3 position = entity.getComponent<Component::TransformComponent>().getTransform(entity)[3];
+                vertexAnimation.isActive = hasView && glm::distance(position, viewPosition) > vertexAnimation.switchDistance;
+                if (vertexAnimation.isActive) {
+                    animator->isVisible = false;
+                }
+            } else {
+                vertexAnimation.isActive = true;
+            }
+        }
+        // animators only touch their own data while evaluating, an animator is a few microseconds of work so
+        // ranges are kept big enough to be worth waking up a worker
+        ThreadPool::getInstance().parallelFor(0, (int) animators.size(), [this, dt](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                animators[i]->updateAnimation(dt);
+                // TODO: this should be in fixed update?
+                animators[i]->updateStateMachine(dt);
+            }
+        }, 4);
+        // bone entities belong to the scene, so they are written back from this thread only
+        for (auto *animator: animators) {
+            animator->writeBoneTransforms();
+        }
+        // after the state machines, since instances with an animator play the clip of its current state
+        for (auto [vertexAnimation, animator]: vertexAnimations) {
+            vertexAnimation->update(dt, animator);
+        }
+    }
+
+    void AnimatorComponentSystem::updateLevelOfDetail(Component::AnimatorComponent &animator, const glm::mat4 &model, uint32_t phase) {
+        animator.isVisible = true;
+        animator.updateInterval = 1;
+        animator.evaluatePose = true;
+        // bounds are known once the animator has been posed
+        if (!levelOfDetail || !hasView || animator.boundsRadius <= 0.0f) {
+            return;
+        }
+        glm::vec3 center = model * glm::vec4(animator.boundsCenter, 1.0f);
+        float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+        float radius = animator.boundsRadius * scale;
+        // offscreen animators can still cast shadows into view, so they keep being posed at the coarsest interval
+        int lod = (int) std::size(lodScreenSizes);
+        if (MathUtils::isSphereInFrustum(frustumPlanes, center, radius)) {
+            // fraction of the screen height covered by the bounds
+            float distance = glm::length(center - viewPosition);
+            float screenSize = distance > radius ? radius / (distance * tanHalfFov) : 1.0f;
+            lod = 0;
+            while (lod < std::size(lodScreenSizes) && screenSize < lodScreenSizes[lod]) {
+                lod++;
+            }
         }
+        animator.updateInterval = lodUpdateIntervals[lod];
+        // spread animators with the same interval over different frames
+        animator.evaluatePose = (frame + phase) % animator.updateInterval == 0;
     }
 }
@@ -17,16 +17,29 @@
  **********************************************************************************/
 
 #include "dream/scene/system/LuaScriptComponentSystem.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include "dream/project/Project.h"
 #include "dream/scene/component/Component.h"
 #include "dream/util/Logger.h"
 #include "dream/window/Input.h"
 #include "dream/window/KeyCodes.h"
 #include "dream/util/MathUtils.h"
+#include "dream/util/MD5.h"
 
 namespace Dream {
+    Entity exposeToScript(Entity entity) {
+        // scripts can read the transform of any entity they get, so bones stop being skipped by their animator
+        if (entity && entity.hasComponent<Component::BoneComponent>()) {
+            entity.getComponent<Component::BoneComponent>().readByScript = true;
+        }
+        return entity;
+    }
+
     Entity getEntityByTag(const std::string &tag) {
-        return Project::getScene()->getEntityByTag(tag);
+        return exposeToScript(Project::getScene()->getEntityByTag(tag));
     }
 
     bool checkRaycast(glm::vec3 from, glm::vec3 to) {
@@ -47,6 +60,27 @@ namespace Dream {
         }
     }
 
+    void physicsQuery(PhysicsQueryBatch &batch) {
+        if (!Project::getScene()->getPhysicsComponentSystem()) {
+            Logger::error("Physics component system not initialized");
+        } else {
+            Project::getScene()->getPhysicsComponentSystem()->query(batch);
+        }
+    }
+
+    Entity physicsQueryGetHitEntity(PhysicsQueryBatch &batch, int index) {
+        return exposeToScript({batch.getHitEntityHandle(index), Project::getScene()});
+    }
+
+    glm::vec3 getInterpolatedTranslation(Entity entity) {
+        // same placement as the renderer, so scripts following a rigid body (ex: cameras) do not jitter against it
+        float alpha = 1.0f;
+        if (Project::getScene()->getPhysicsComponentSystem()) {
+            alpha = Project::getScene()->getPhysicsComponentSystem()->getInterpolationAlpha();
+        }
+        return glm::vec3(entity.getComponent<Component::TransformComponent>().getInterpolatedTransform(entity, alpha)[3]);
+    }
+
     LuaScriptComponentSystem::LuaScriptComponentSystem() {
         // open libraries with lua
         lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::io);
@@ -216,6 +250,7 @@ namespace Dream {
                                  "getID", &Dream::Entity::getID,
                                  "isValid", &Dream::Entity::isValid,
                                  "getTransform", &Dream::Entity::getComponent<Dream::Component::TransformComponent>,
+                                 "getInterpolatedTranslation", getInterpolatedTranslation,
                                  "getCamera", &Dream::Entity::getComponent<Dream::Component::CameraComponent>,
                                  "getAnimator", &Dream::Entity::getComponent<Dream::Component::AnimatorComponent>,
                                  "getRigidBody", &Dream::Entity::getComponent<Dream::Component::RigidBodyComponent>
@@ -243,6 +278,18 @@ namespace Dream {
         lua.new_usertype<Component::AnimatorComponent>("AnimatorComponent",
                                                        "setVariable",
                                                        sol::as_function(&Component::AnimatorComponent::setVariable),
+                                                       "findVariable",
+                                                       sol::as_function(&Component::AnimatorComponent::findVariable),
+                                                       "setInt",
+                                                       sol::as_function(&Component::AnimatorComponent::setInt),
+                                                       "setFloat",
+                                                       sol::as_function(&Component::AnimatorComponent::setFloat),
+                                                       "setBool",
+                                                       sol::as_function(&Component::AnimatorComponent::setBool),
+                                                       "setTrigger",
+                                                       sol::as_function(&Component::AnimatorComponent::setTrigger),
+                                                       "getVariable",
+                                                       sol::as_function(&Component::AnimatorComponent::getVariable),
                                                        "getCurrentStateName",
                                                        sol::as_function(&Component::AnimatorComponent::getCurrentStateName)
         );
@@ -289,7 +336,23 @@ namespace Dream {
 
         lua.new_usertype<PhysicsComponentSystem>("PhysicsComponentSystem",
                                                  "checkRaycast", sol::as_function(&checkRaycast),
-                                                 "raycastGetFirstHit", sol::as_function(&raycastGetFirstHit)
+                                                 "raycastGetFirstHit", sol::as_function(&raycastGetFirstHit),
+                                                 "query", sol::as_function(&physicsQuery)
+        );
+
+        lua.new_usertype<PhysicsQueryBatch>("PhysicsQueryBatch",
+                                            sol::constructors<PhysicsQueryBatch(int)>(),
+                                            "clear", &PhysicsQueryBatch::clear,
+                                            "addRaycast", &PhysicsQueryBatch::addRaycast,
+                                            "addSphereSweep", &PhysicsQueryBatch::addSphereSweep,
+                                            "addCapsuleSweep", &PhysicsQueryBatch::addCapsuleSweep,
+                                            "addSphereOverlap", &PhysicsQueryBatch::addSphereOverlap,
+                                            "size", &PhysicsQueryBatch::size,
+                                            "hasHit", &PhysicsQueryBatch::hasHit,
+                                            "getHitEntity", &physicsQueryGetHitEntity,
+                                            "getHitPoint", &PhysicsQueryBatch::getHitPoint,
+                                            "getHitNormal", &PhysicsQueryBatch::getHitNormal,
+                                            "getHitFraction", &PhysicsQueryBatch::getHitFraction
         );
 
         lua.end();
@@ -307,6 +370,9 @@ namespace Dream {
     }
 
     void LuaScriptComponentSystem::update(float dt) {
+        updateCount++;
+        dispatchContactEvents();
+
         // update all entities with lua script
         auto luaScriptEntities = Project::getScene()->getEntitiesWithComponents<Component::LuaScriptComponent>();
         for (auto entityHandle: luaScriptEntities) {
@@ -317,16 +383,24 @@ namespace Dream {
                 component.loadScriptPath();
             }
             if (!component.scriptPath.empty()) {
-                sol::protected_function_result scriptCompileResult = lua.safe_script_file(component.scriptPath,
-                                                                                          &sol::script_pass_on_error);
-                if (scriptCompileResult.valid()) {
+                CompiledScript *compiledScript = getCompiledScript(scriptGuid, component.scriptPath);
+                if (compiledScript) {
+                    // only entities whose script handles contacts have them reported by the physics system
+                    bool handlesContacts = false;
+                    for (const auto &contactHandler: compiledScript->contactHandlers) {
+                        handlesContacts = handlesContacts || contactHandler.valid();
+                    }
+                    if (entity.hasComponent<Component::RigidBodyComponent>() &&
+                        entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex != -1) {
+                        Project::getScene()->getPhysicsComponentSystem()->setContactEventsEnabled(
+                                entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex, handlesContacts);
+                    }
                     if (component.needToInitTable) {
                         component.table = lua.create_table_with("value", "key");
                         component.needToInitTable = false;
                     }
                     lua["self"] = component.table;
-                    sol::protected_function scriptUpdateFunction = lua["update"];
-                    sol::protected_function_result functionResult = scriptUpdateFunction(entity, dt);
+                    sol::protected_function_result functionResult = compiledScript->updateFunction(entity, dt);
                     if (!functionResult.valid()) {
                         if (!LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid)) {
                             sol::error err = functionResult;
@@ -337,25 +411,204 @@ namespace Dream {
                         }
                     } else {
                         if (LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid) ||
-                            LuaScriptComponentSystem::modifiedScripts.count(scriptGuid)) {
+                            compiledScript->reportNextSuccess) {
                             Logger::debug("Script has no errors " + component.scriptPath);
                             LuaScriptComponentSystem::errorPrintedForScript.erase(scriptGuid);
-                            LuaScriptComponentSystem::modifiedScripts.erase(scriptGuid);
+                            compiledScript->reportNextSuccess = false;
                         }
                     }
-                } else {
-                    if (!LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid)) {
-                        sol::error err = scriptCompileResult;
-                        std::string what = err.what();
-                        Logger::error("Lua script parsing error " + what);
-                        LuaScriptComponentSystem::errorPrintedForScript.insert(scriptGuid);
-                        return;
-                    }
                 }
             }
         }
     }
 
+    LuaScriptComponentSystem::CompiledScript *LuaScriptComponentSystem::getCompiledScript(const std::string &scriptGuid,
+                                                                                          const std::string &scriptPath) {
+        auto &compiledScript = compiledScripts[scriptGuid];
+        if (compiledScript.lastCheckedUpdate == updateCount) {
+            return compiledScript.valid ? &compiledScript : nullptr;
+        }
+        compiledScript.lastCheckedUpdate = updateCount;
+        std::error_code errorCode;
+        auto lastWriteTime = std::filesystem::last_write_time(scriptPath, errorCode);
+        bool modified = LuaScriptComponentSystem::modifiedScripts.count(scriptGuid);
+        if (!modified && compiledScript.scriptPath == scriptPath && compiledScript.lastWriteTime == lastWriteTime) {
+            return compiledScript.valid ? &compiledScript : nullptr;
+        }
+
+        LuaScriptComponentSystem::modifiedScripts.erase(scriptGuid);
+        compiledScript.scriptPath = scriptPath;
+        compiledScript.lastWriteTime = lastWriteTime;
+        compiledScript.valid = false;
+        compiledScript.reportNextSuccess = modified;
+        compiledScript.updateFunction = sol::protected_function();
+        for (auto &contactHandler: compiledScript.contactHandlers) {
+            contactHandler = sol::protected_function();
+        }
+
+        sol::protected_function chunk = loadScript(scriptGuid, scriptPath);
+        if (!chunk.valid()) {
+            return nullptr;
+        }
+        // every script gets its own globals so functions of one script do not replace those of another,
+        // engine bindings and 'self' are still found through the fallback to the shared globals
+        compiledScript.environment = sol::environment(lua, sol::create, lua.globals());
+        sol::set_environment(compiledScript.environment, chunk);
+        sol::protected_function_result chunkResult = chunk();
+        if (!chunkResult.valid()) {
+            if (!LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid)) {
+                sol::error err = chunkResult;
+                std::string what = err.what();
+                Logger::error("Lua script parsing error " + what);
+                LuaScriptComponentSystem::errorPrintedForScript.insert(scriptGuid);
+            }
+            return nullptr;
+        }
+        compiledScript.updateFunction = compiledScript.environment["update"];
+        for (int i = 0; i < contactHandlerNames.size(); i++) {
+            compiledScript.contactHandlers.at(i) = compiledScript.environment[contactHandlerNames.at(i)];
+        }
+        compiledScript.valid = true;
+        return &compiledScript;
+    }
+
+    sol::protected_function LuaScriptComponentSystem::loadScript(const std::string &scriptGuid,
+                                                                 const std::string &scriptPath) {
+        std::ifstream sourceFile(scriptPath, std::ios::in | std::ios::binary);
+        std::stringstream sourceStream;
+        sourceStream << sourceFile.rdbuf();
+        std::string source = sourceStream.str();
+        if (!sourceFile) {
+            if (!LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid)) {
+                Logger::error("Unable to read Lua script " + scriptPath);
+                LuaScriptComponentSystem::errorPrintedForScript.insert(scriptGuid);
+            }
+            return {};
+        }
+
+        // the path is part of the hash since the bytecode keeps it for error messages
+        std::string chunkName = "@" + scriptPath;
+        MD5 md5;
+        md5.update(chunkName.data(), (MD5::size_type) chunkName.size());
+        md5.update(source.data(), (MD5::size_type) source.size());
+        md5.finalize();
+        std::string sourceHash = md5.hexdigest();
+        std::filesystem::path bytecodePath = getBytecodeCachePath().append(scriptGuid + ".luac");
+
+        std::string bytecode = loadBytecode(bytecodePath, sourceHash);
+        if (!bytecode.empty()) {
+            sol::load_result bytecodeChunk = lua.load_buffer(bytecode.data(), bytecode.size(), chunkName,
+                                                             sol::load_mode::binary);
+            if (bytecodeChunk.valid()) {
+                sol::protected_function chunk = bytecodeChunk;
+                return chunk;
+            }
+            // ex: written by a build with a different lua version
+            Logger::warn("Cached bytecode " + bytecodePath.string() + " could not be loaded, it will be compiled again");
+        }
+
+        sol::load_result sourceChunk = lua.load(source, chunkName, sol::load_mode::text);
+        if (!sourceChunk.valid()) {
+            if (!LuaScriptComponentSystem::errorPrintedForScript.count(scriptGuid)) {
+                sol::error err = sourceChunk;
+                std::string what = err.what();
+                Logger::error("Lua script parsing error " + what);
+                LuaScriptComponentSystem::errorPrintedForScript.insert(scriptGuid);
+            }
+            return {};
+        }
+        sol::protected_function chunk = sourceChunk;
+        saveBytecode(bytecodePath, sourceHash, chunk);
+        return chunk;
+    }
+
+    std::string LuaScriptComponentSystem::loadBytecode(const std::filesystem::path &path,
+                                                       const std::string &sourceHash) {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        char fileMagic[4] = {};
+        uint32_t fileVersion = 0;
+        if (!in || !in.read(fileMagic, sizeof(fileMagic)) ||
+            std::memcmp(fileMagic, bytecodeMagic, sizeof(bytecodeMagic)) != 0) {
+            return "";
+        }
+        if (!in.read(reinterpret_cast<char *>(&fileVersion), sizeof(fileVersion)) || fileVersion != bytecodeVersion) {
+            return "";
+        }
+        char fileHash[32] = {};
+        if (!in.read(fileHash, sizeof(fileHash)) ||
+            sourceHash.compare(0, std::string::npos, fileHash, sizeof(fileHash)) != 0) {
+            return "";
+        }
+        // lua checks the header of the bytecode itself (version, number and pointer sizes) when it is loaded
+        std::stringstream bytecodeStream;
+        bytecodeStream << in.rdbuf();
+        return bytecodeStream.str();
+    }
+
+    void LuaScriptComponentSystem::saveBytecode(const std::filesystem::path &path, const std::string &sourceHash,
+                                                const sol::protected_function &chunk) {
+        std::error_code errorCode;
+        std::filesystem::create_directories(path.parent_path(), errorCode);
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (errorCode || !out) {
+            Logger::warn("Unable to write cached bytecode " + path.string());
+            return;
+        }
+        // debug information is kept so errors still report line numbers
+        auto bytecode = chunk.dump();
+        auto bytecodeView = bytecode.as_string_view();
+        out.write(bytecodeMagic, sizeof(bytecodeMagic));
+        out.write(reinterpret_cast<const char *>(&bytecodeVersion), sizeof(bytecodeVersion));
+        out.write(sourceHash.data(), (std::streamsize) sourceHash.size());
+        out.write(bytecodeView.data(), (std::streamsize) bytecodeView.size());
+    }
+
+    std::filesystem::path LuaScriptComponentSystem::getBytecodeCachePath() {
+        return Project::getPath().append("cache").append("lua");
+    }
+
+    void LuaScriptComponentSystem::dispatchContactEvents() {
+        auto *physicsComponentSystem = Project::getScene()->getPhysicsComponentSystem();
+        if (!physicsComponentSystem) {
+            return;
+        }
+        // indexed since handlers may remove entities, which also drops their events from the queue
+        const auto &events = physicsComponentSystem->getContactEvents();
+        for (int i = 0; i < events.size(); i++) {
+            // both entities of a pair get the event, each with the normal pointing away from the other entity
+            PhysicsContactEvent event = events.at(i);
+            dispatchContactEvent(event, event.entityA, event.entityB, event.normal);
+            dispatchContactEvent(event, event.entityB, event.entityA, -event.normal);
+        }
+        physicsComponentSystem->clearContactEvents();
+    }
+
+    void LuaScriptComponentSystem::dispatchContactEvent(const PhysicsContactEvent &event, entt::entity entityHandle,
+                                                        entt::entity otherEntityHandle, glm::vec3 normal) {
+        Entity entity = {entityHandle, Project::getScene()};
+        if (!entity.hasComponent<Component::LuaScriptComponent>()) {
+            return;
+        }
+        auto &component = entity.getComponent<Component::LuaScriptComponent>();
+        auto compiledScript = compiledScripts.find(component.guid);
+        if (compiledScript == compiledScripts.end() || !compiledScript->second.valid) {
+            return;
+        }
+        auto &contactHandler = compiledScript->second.contactHandlers.at((event.trigger ? 3 : 0) + event.phase);
+        if (!contactHandler.valid()) {
+            return;
+        }
+        lua["self"] = component.table;
+        Entity otherEntity = exposeToScript({otherEntityHandle, Project::getScene()});
+        sol::protected_function_result functionResult = contactHandler(entity, otherEntity, event.point, normal);
+        if (!functionResult.valid() && !LuaScriptComponentSystem::errorPrintedForScript.count(component.guid)) {
+            sol::error err = functionResult;
+            std::string what = err.what();
+            Logger::error("Lua function call error " + what);
+            LuaScriptComponentSystem::errorPrintedForScript.insert(component.guid);
+        }
+    }
+
     void LuaScriptComponentSystem::init() {
 
     }
@@ -17,16 +17,48 @@
  **********************************************************************************/
 
 #include "dream/scene/system/PhysicsComponentSystem.h"
+
+#include <algorithm>
 #include "dream/project/Project.h"
 #include "dream/scene/component/Component.h"
+#include "dream/scene/system/PhysicsShapeCache.h"
+#include "dream/scene/system/PhysicsTaskScheduler.h"
+#include "dream/util/ThreadPool.h"
+
+#ifdef BT_THREADSAFE
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#endif
 
 namespace Dream {
     PhysicsComponentSystem::PhysicsComponentSystem() {
-        collisionConfiguration = new btDefaultCollisionConfiguration();
-        dispatcher = new btCollisionDispatcher(collisionConfiguration);
+        shapeCache = new PhysicsShapeCache();
         overlappingPairCache = new btDbvtBroadphase();
-        solver = new btSequentialImpulseConstraintSolver;
-        dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, overlappingPairCache, solver, collisionConfiguration);
+#ifdef BT_THREADSAFE
+        if (Project::getConfig().physicsConfig.multithreaded) {
+            // narrowphase and island solving are split across the engine's thread pool
+            btSetTaskScheduler(&PhysicsTaskScheduler::getInstance());
+            btDefaultCollisionConstructionInfo constructionInfo;
+            // threads allocate manifolds and collision algorithms concurrently, so the pools must not run dry mid-step
+            constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+            constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+            collisionConfiguration = new btDefaultCollisionConfiguration(constructionInfo);
+            dispatcher = new btCollisionDispatcherMt(collisionConfiguration, 40);
+            auto *solverPoolMt = new btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads());
+            solverPool = solverPoolMt;
+            solver = new btSequentialImpulseConstraintSolverMt();
+            dynamicsWorld = new btDiscreteDynamicsWorldMt(dispatcher, overlappingPairCache, solverPoolMt, solver,
+                                                          collisionConfiguration);
+            multithreaded = true;
+        }
+#endif
+        if (!multithreaded) {
+            collisionConfiguration = new btDefaultCollisionConfiguration();
+            dispatcher = new btCollisionDispatcher(collisionConfiguration);
+            solver = new btSequentialImpulseConstraintSolver;
+            dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, overlappingPairCache, solver, collisionConfiguration);
+        }
         dynamicsWorld->setGravity(btVector3(0, -10, 0));
         openGlPhysicsDebugDrawer.setDebugMode(btIDebugDraw::DBG_DrawWireframe);
         dynamicsWorld->setDebugDrawer(&openGlPhysicsDebugDrawer);
@@ -36,50 +68,185 @@ namespace Dream {
 //        clearWorld();
         delete dynamicsWorld;
         delete solver;
+        delete solverPool;
         delete overlappingPairCache;
         delete dispatcher;
         delete collisionConfiguration;
+        delete shapeCache;
     }
 
     void PhysicsComponentSystem::update(float dt) {
-        // update dynamic world
-        float timeStep = dt;
-        dynamicsWorld->stepSimulation(timeStep);
+        // height map colliders read the terrain directly, so only their bounds need to follow sculpting
+        for (auto entityHandle: Project::getScene()->getEntitiesWithComponents<Component::CollisionComponent, Component::TerrainComponent>()) {
+            Entity entity = {entityHandle, Project::getScene()};
+            entity.getComponent<Component::CollisionComponent>().updateHeightfieldBounds(entity);
+        }
+
+        if (Project::isPlaying()) {
+            step(dt);
+            return;
+        }
 
-        // update all entities with rigid bodies
+        createRigidBodies();
+        // the editor moves entities, so bodies follow them (only the ones that were actually moved)
         auto rigidBodyEntities = Project::getScene()->getEntitiesWithComponents<Component::RigidBodyComponent>();
         for (auto entityHandle: rigidBodyEntities) {
+            auto &rigidBodyComponent = rigidBodyEntities.get<Component::RigidBodyComponent>(entityHandle);
+            if (rigidBodyComponent.rigidBodyIndex == -1) {
+                continue;
+            }
+            Entity entity = {entityHandle, Project::getScene()};
+            auto &transformComponent = entity.getComponent<Component::TransformComponent>();
+            auto *rigidBody = rigidBodies.at(rigidBodyComponent.rigidBodyIndex);
+            auto *motionState = (PhysicsMotionState *) rigidBody->getMotionState();
+            auto entityTrans = transformComponent.translation;
+            auto entityRot = transformComponent.rotation;
+            btTransform trans(btQuaternion(entityRot.x, entityRot.y, entityRot.z, entityRot.w),
+                              btVector3(entityTrans.x, entityTrans.y, entityTrans.z));
+            rigidBodyComponent.previousTranslation = entityTrans;
+            rigidBodyComponent.previousRotation = entityRot;
+            if (trans.getOrigin() == motionState->getTransform().getOrigin() &&
+                trans.getRotation() == motionState->getTransform().getRotation()) {
+                continue;
+            }
+            rigidBody->setWorldTransform(trans);
+            motionState->resetWorldTransform(trans);
+            dynamicsWorld->updateSingleAabb(rigidBody);
+        }
+    }
+
+    void PhysicsComponentSystem::createRigidBodies() {
+        auto rigidBodyEntities = Project::getScene()->getEntitiesWithComponents<Component::RigidBodyComponent>();
+        for (auto entityHandle: rigidBodyEntities) {
+            auto &rigidBodyComponent = rigidBodyEntities.get<Component::RigidBodyComponent>(entityHandle);
+            if (rigidBodyComponent.rigidBodyIndex != -1 && !rigidBodyComponent.shouldBeAddedToWorld) {
+                continue;
+            }
             Entity entity = {entityHandle, Project::getScene()};
-            if (entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex == -1) {
+            if (rigidBodyComponent.rigidBodyIndex == -1) {
                 // initialize rigid body if necessary
-                entity.getComponent<Component::RigidBodyComponent>().updateRigidBody(entity);
+                rigidBodyComponent.updateRigidBody(entity);
             }
-            if (entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex == -1) {
+            if (rigidBodyComponent.rigidBodyIndex == -1) {
                 Logger::warn("Rigid body not initialized for entity " + entity.getComponent<Component::TagComponent>().tag);
                 continue;
             }
-            int idx = entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex;
-            auto *rigidBody = rigidBodies.at(idx);
-            if (entity.getComponent<Component::RigidBodyComponent>().shouldBeAddedToWorld) {
+            if (rigidBodyComponent.shouldBeAddedToWorld) {
                 // add rigid body to world if necessary
-                dynamicsWorld->addRigidBody(rigidBody);
-                entity.getComponent<Component::RigidBodyComponent>().shouldBeAddedToWorld = false;
+                dynamicsWorld->addRigidBody(rigidBodies.at(rigidBodyComponent.rigidBodyIndex));
+                rigidBodyComponent.shouldBeAddedToWorld = false;
             }
-            // update transform and rotation components of entity
-            btTransform trans = rigidBody->getWorldTransform();
+        }
+    }
+
+    void PhysicsComponentSystem::step(float dt) {
+        createRigidBodies();
+
+        // bodies that stopped moving are no longer interpolated from where they were two steps ago
+        for (auto entityHandle: movedEntities) {
+            Entity entity = {entityHandle, Project::getScene()};
+            if (entity.isValid() && entity.hasComponent<Component::RigidBodyComponent>()) {
+                auto &rigidBodyComponent = entity.getComponent<Component::RigidBodyComponent>();
+                auto &transformComponent = entity.getComponent<Component::TransformComponent>();
+                rigidBodyComponent.previousTranslation = transformComponent.translation;
+                rigidBodyComponent.previousRotation = transformComponent.rotation;
+            }
+        }
+        movedEntities.clear();
+
+        // update dynamic world, the application already runs fixed steps so bullet takes exactly one step of dt
+        // (the default would substep at 60 Hz and interpolate motion states on its own)
+        float timeStep = dt;
+        dynamicsWorld->stepSimulation(timeStep, 1, timeStep);
+
+        // only bodies reported by their motion state moved, sleeping and static bodies are never visited
+        for (auto *motionState: changedMotionStates) {
+            motionState->clearChanged();
+            Entity entity = {motionState->getEntityHandle(), Project::getScene()};
+            if (!entity.isValid() || !entity.hasComponent<Component::RigidBodyComponent>()) {
+                continue;
+            }
+            auto &rigidBodyComponent = entity.getComponent<Component::RigidBodyComponent>();
             auto &transformComponent = entity.getComponent<Component::TransformComponent>();
-            if (Project::isPlaying()) {
-                transformComponent.translation = glm::vec3(trans.getOrigin().getX(), trans.getOrigin().getY(),
-                                                           trans.getOrigin().getZ());
-                transformComponent.rotation = glm::quat(trans.getRotation().getW(), trans.getRotation().getX(),
-                                                        trans.getRotation().getY(), trans.getRotation().getZ());
-            } else {
-                auto entityTrans = transformComponent.translation;
-                auto entityRot = transformComponent.rotation;
-                rigidBody->getWorldTransform().setOrigin(btVector3(entityTrans.x, entityTrans.y, entityTrans.z));
-                rigidBody->getWorldTransform().setRotation(btQuaternion(entityRot.x, entityRot.y, entityRot.z, entityRot.w));
+            rigidBodyComponent.previousTranslation = transformComponent.translation;
+            rigidBodyComponent.previousRotation = transformComponent.rotation;
+            const btTransform &trans = motionState->getTransform();
+            transformComponent.translation = glm::vec3(trans.getOrigin().getX(), trans.getOrigin().getY(),
+                                                       trans.getOrigin().getZ());
+            transformComponent.rotation = glm::quat(trans.getRotation().getW(), trans.getRotation().getX(),
+                                                    trans.getRotation().getY(), trans.getRotation().getZ());
+            movedEntities.push_back(entity.entityHandle);
+        }
+        changedMotionStates.clear();
+
+        collectContacts();
+    }
+
+    void PhysicsComponentSystem::collectContacts() {
+        for (int i = 0; i < dispatcher->getNumManifolds(); i++) {
+            const btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(i);
+            const btCollisionObject *bodyA = manifold->getBody0();
+            const btCollisionObject *bodyB = manifold->getBody1();
+            if (manifold->getNumContacts() == 0 || (bodyA->getUserIndex2() != contactEventsUserIndex &&
+                                                    bodyB->getUserIndex2() != contactEventsUserIndex)) {
+                continue;
+            }
+            entt::entity entityA = getEntityHandle(bodyA);
+            entt::entity entityB = getEntityHandle(bodyB);
+            if (entityA == entt::null || entityB == entt::null) {
+                continue;
             }
+            // manifolds keep points until they are further apart than bullet's contact breaking threshold
+            const btManifoldPoint *deepestPoint = &manifold->getContactPoint(0);
+            for (int j = 1; j < manifold->getNumContacts(); j++) {
+                if (manifold->getContactPoint(j).getDistance() < deepestPoint->getDistance()) {
+                    deepestPoint = &manifold->getContactPoint(j);
+                }
+            }
+            bool trigger = (bodyA->getCollisionFlags() | bodyB->getCollisionFlags()) &
+                           btCollisionObject::CF_NO_CONTACT_RESPONSE;
+            const btVector3 &point = deepestPoint->getPositionWorldOnB();
+            const btVector3 &normal = deepestPoint->m_normalWorldOnB;
+            contactTracker.addContact(entityA, entityB, trigger, {point.getX(), point.getY(), point.getZ()},
+                                      {normal.getX(), normal.getY(), normal.getZ()});
         }
+        contactTracker.endStep();
+    }
+
+    void PhysicsComponentSystem::setContactEventsEnabled(int rigidBodyIndex, bool enabled) {
+        rigidBodies.at(rigidBodyIndex)->setUserIndex2(enabled ? contactEventsUserIndex : -1);
+    }
+
+    const std::vector<PhysicsContactEvent> &PhysicsComponentSystem::getContactEvents() {
+        return contactTracker.getEvents();
+    }
+
+    void PhysicsComponentSystem::clearContactEvents() {
+        contactTracker.clearEvents();
+    }
+
+    bool PhysicsComponentSystem::isMultithreaded() {
+        return multithreaded;
+    }
+
+    btMotionState *PhysicsComponentSystem::createMotionState(entt::entity entityHandle, const btTransform &transform) {
+        return new PhysicsMotionState(transform, entityHandle, &changedMotionStates);
+    }
+
+    void PhysicsComponentSystem::setRigidBodyTransform(int index, const btTransform &transform) {
+        auto *rigidBody = rigidBodies.at(index);
+        rigidBody->setWorldTransform(transform);
+        // bullet reads the transform of kinematic bodies from their motion state
+        rigidBody->getMotionState()->setWorldTransform(transform);
+        rigidBody->activate();
+    }
+
+    void PhysicsComponentSystem::setInterpolationAlpha(float alpha) {
+        interpolationAlpha = alpha;
+    }
+
+    float PhysicsComponentSystem::getInterpolationAlpha() {
+        return interpolationAlpha;
     }
 
     void PhysicsComponentSystem::init() {
@@ -87,35 +254,144 @@ namespace Dream {
     }
 
     bool PhysicsComponentSystem::checkRaycast(glm::vec3 rayFromWorld, glm::vec3 rayToWorld) {
-        auto rfw = btVector3(rayFromWorld.x, rayFromWorld.y, rayFromWorld.z);
-        auto rtw = btVector3(rayToWorld.x, rayToWorld.y, rayToWorld.z);
-        btCollisionWorld::ClosestRayResultCallback raycastResult(rfw, rtw);
-        dynamicsWorld->rayTest(rfw, rtw, raycastResult);
-        if (raycastResult.hasHit()) {
-            return true;
-        } else {
-            return false;
-        }
+        PhysicsQueryHit hit;
+        runQuery({.type=PhysicsQuery::RAYCAST, .from=rayFromWorld, .to=rayToWorld}, hit);
+        return hit.hit;
     }
 
     glm::vec3 PhysicsComponentSystem::raycastGetFirstHit(glm::vec3 rayFromWorld, glm::vec3 rayToWorld) {
-        auto rfw = btVector3(rayFromWorld.x, rayFromWorld.y, rayFromWorld.z);
-        auto rtw = btVector3(rayToWorld.x, rayToWorld.y, rayToWorld.z);
-        btCollisionWorld::ClosestRayResultCallback raycastResult(rfw, rtw);
-        dynamicsWorld->rayTest(rfw, rtw, raycastResult);
-        if (raycastResult.hasHit()) {
-            btVector3 hitPoint = raycastResult.m_hitPointWorld;
-            return {hitPoint.getX(), hitPoint.getY(), hitPoint.getZ()};
-        } else {
-            Logger::warn("No raycast hit result for raycastGetFirstHit()");
-            return {0, 0, 0};
+        // misses are expected (ex: probing for ground), so they are not logged
+        PhysicsQueryHit hit;
+        runQuery({.type=PhysicsQuery::RAYCAST, .from=rayFromWorld, .to=rayToWorld}, hit);
+        return hit.point;
+    }
+
+    void PhysicsComponentSystem::query(PhysicsQueryBatch &batch) {
+        const auto &queries = batch.getQueries();
+        auto &hits = batch.getHits();
+#ifdef BT_THREADSAFE
+        // ray and convex sweep tests only read the world (broadphase ray tests keep a traversal stack per thread), so
+        // they run concurrently
+        ThreadPool::getInstance().parallelFor(0, (int) queries.size(), [&](int rangeBegin, int rangeEnd) {
+            for (int i = rangeBegin; i < rangeEnd; i++) {
+                if (queries.at(i).type != PhysicsQuery::SPHERE_OVERLAP) {
+                    runQuery(queries.at(i), hits.at(i));
+                }
+            }
+        }, 16);
+        // overlap tests create and release contact manifolds through the world's dispatcher, which is not locked
+        for (int i = 0; i < queries.size(); i++) {
+            if (queries.at(i).type == PhysicsQuery::SPHERE_OVERLAP) {
+                runQuery(queries.at(i), hits.at(i));
+            }
+        }
+#else
+        for (int i = 0; i < queries.size(); i++) {
+            runQuery(queries.at(i), hits.at(i));
+        }
+#endif
+    }
+
+    void PhysicsComponentSystem::runQuery(const PhysicsQuery &query, PhysicsQueryHit &hit) {
+        hit = PhysicsQueryHit();
+        btVector3 from(query.from.x, query.from.y, query.from.z);
+        btVector3 to(query.to.x, query.to.y, query.to.z);
+        const btCollisionObject *hitObject = nullptr;
+        btVector3 hitPoint;
+        btVector3 hitNormal;
+        if (query.type == PhysicsQuery::RAYCAST) {
+            btCollisionWorld::ClosestRayResultCallback result(from, to);
+            dynamicsWorld->rayTest(from, to, result);
+            if (result.hasHit()) {
+                hitObject = result.m_collisionObject;
+                hitPoint = result.m_hitPointWorld;
+                hitNormal = result.m_hitNormalWorld;
+                hit.fraction = result.m_closestHitFraction;
+            }
+        } else if (query.type == PhysicsQuery::SPHERE_SWEEP || query.type == PhysicsQuery::CAPSULE_SWEEP) {
+            btSphereShape sphere(query.radius);
+            // bullet's capsule height does not include the caps
+            btCapsuleShape capsule(query.radius, std::max(query.height - 2.0f * query.radius, 0.0f));
+            btConvexShape *shape = &sphere;
+            if (query.type == PhysicsQuery::CAPSULE_SWEEP) {
+                shape = &capsule;
+            }
+            btTransform fromTransform;
+            fromTransform.setIdentity();
+            fromTransform.setOrigin(from);
+            btTransform toTransform;
+            toTransform.setIdentity();
+            toTransform.setOrigin(to);
+            btCollisionWorld::ClosestConvexResultCallback result(from, to);
+            dynamicsWorld->convexSweepTest(shape, fromTransform, toTransform, result);
+            if (result.hasHit()) {
+                hitObject = result.m_hitCollisionObject;
+                hitPoint = result.m_hitPointWorld;
+                hitNormal = result.m_hitNormalWorld;
+                hit.fraction = result.m_closestHitFraction;
+            }
+        } else if (query.type == PhysicsQuery::SPHERE_OVERLAP) {
+            // keeps the deepest contact with the sphere
+            struct OverlapResultCallback : public btCollisionWorld::ContactResultCallback {
+                const btCollisionObject *sphereObject = nullptr;
+                const btCollisionObject *hitObject = nullptr;
+                btVector3 hitPoint;
+                btVector3 hitNormal;
+                btScalar distance = BT_LARGE_FLOAT;
+
+                btScalar addSingleResult(btManifoldPoint &point, const btCollisionObjectWrapper *wrapper0, int, int,
+                                         const btCollisionObjectWrapper *wrapper1, int, int) override {
+                    if (point.getDistance() < distance) {
+                        distance = point.getDistance();
+                        // normal on B points from B towards A, so flip it when the sphere is B
+                        bool sphereIsA = wrapper0->getCollisionObject() == sphereObject;
+                        hitObject = sphereIsA ? wrapper1->getCollisionObject() : wrapper0->getCollisionObject();
+                        hitPoint = sphereIsA ? point.getPositionWorldOnB() : point.getPositionWorldOnA();
+                        hitNormal = sphereIsA ? point.m_normalWorldOnB : -point.m_normalWorldOnB;
+                    }
+                    return 0;
+                }
+            };
+            btSphereShape sphere(query.radius);
+            btCollisionObject sphereObject;
+            sphereObject.setCollisionShape(&sphere);
+            btTransform transform;
+            transform.setIdentity();
+            transform.setOrigin(from);
+            sphereObject.setWorldTransform(transform);
+            OverlapResultCallback result;
+            result.sphereObject = &sphereObject;
+            dynamicsWorld->contactTest(&sphereObject, result);
+            if (result.hitObject) {
+                hitObject = result.hitObject;
+                hitPoint = result.hitPoint;
+                hitNormal = result.hitNormal;
+                hit.fraction = 0;
+            }
         }
+        if (hitObject) {
+            hit.hit = true;
+            hit.entityHandle = getEntityHandle(hitObject);
+            hit.point = {hitPoint.getX(), hitPoint.getY(), hitPoint.getZ()};
+            hit.normal = {hitNormal.getX(), hitNormal.getY(), hitNormal.getZ()};
+        }
+    }
+
+    entt::entity PhysicsComponentSystem::getEntityHandle(const btCollisionObject *collisionObject) {
+        const btRigidBody *rigidBody = btRigidBody::upcast(collisionObject);
+        if (rigidBody) {
+            auto *motionState = dynamic_cast<const PhysicsMotionState *>(rigidBody->getMotionState());
+            if (motionState) {
+                return motionState->getEntityHandle();
+            }
+        }
+        return entt::null;
     }
 
-    void PhysicsComponentSystem::debugDrawWorld() {
+    void PhysicsComponentSystem::getDebugLines(std::vector<glm::vec3> &points) {
         if (dynamicsWorld) {
             dynamicsWorld->debugDrawWorld();
-            openGlPhysicsDebugDrawer.doDrawing();
+            openGlPhysicsDebugDrawer.takeLines(points);
         }
     }
 
@@ -128,6 +404,10 @@ namespace Dream {
         return colliderShapes.at(index);
     }
 
+    PhysicsShapeCache *PhysicsComponentSystem::getShapeCache() {
+        return shapeCache;
+    }
+
     int PhysicsComponentSystem::addRigidBody(btRigidBody* rigidBody) {
         rigidBodies.push_back(rigidBody);
         return (int) rigidBodies.size() - 1;
@@ -140,7 +420,13 @@ namespace Dream {
     void PhysicsComponentSystem::removeRigidBody(int index) {
         // delete rigid bodies
         dynamicsWorld->removeRigidBody(rigidBodies.at(index));
-        delete rigidBodies.at(index)->getMotionState();
+        auto *motionState = (PhysicsMotionState *) rigidBodies.at(index)->getMotionState();
+        changedMotionStates.erase(std::remove(changedMotionStates.begin(), changedMotionStates.end(), motionState),
+                                  changedMotionStates.end());
+        movedEntities.erase(std::remove(movedEntities.begin(), movedEntities.end(), motionState->getEntityHandle()),
+                            movedEntities.end());
+        contactTracker.removeEntity(motionState->getEntityHandle());
+        delete motionState;
         delete rigidBodies.at(index);
         rigidBodies.erase(rigidBodies.begin() + index);
 
@@ -157,8 +443,18 @@ namespace Dream {
     }
 
     void PhysicsComponentSystem::deleteCollisionShape(int index) {
-        // delete collision shapes
-        delete colliderShapes.at(index);
+        // delete collision shapes, children are shared through the shape cache except height maps
+        auto *colliderShape = colliderShapes.at(index);
+        for (int i = colliderShape->getNumChildShapes() - 1; i >= 0; i--) {
+            auto *childShape = colliderShape->getChildShape(i);
+            colliderShape->removeChildShapeByIndex(i);
+            if (childShape->getShapeType() == TERRAIN_SHAPE_PROXYTYPE) {
+                delete childShape;
+            } else {
+                shapeCache->release(childShape);
+            }
+        }
+        delete colliderShape;
         colliderShapes.erase(colliderShapes.begin() + index);
 
         // push back index for collision entities
@@ -169,6 +465,7 @@ namespace Dream {
                 entity.getComponent<Component::CollisionComponent>().colliderShapeIndex -= 1;
             } else if (entity.getComponent<Component::CollisionComponent>().colliderShapeIndex == index) {
                 entity.getComponent<Component::CollisionComponent>().colliderShapeIndex = -1;
+                entity.getComponent<Component::CollisionComponent>().heightfieldShape = nullptr;
             }
         }
     }
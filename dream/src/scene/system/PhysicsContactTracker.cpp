@@ -0,0 +1,85 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/PhysicsContactTracker.h"
+
+#include <algorithm>
+
+namespace Dream {
+    void PhysicsContactTracker::addContact(entt::entity entityA, entt::entity entityB, bool trigger, glm::vec3 point,
+                                           glm::vec3 normal) {
+        if (!contactKeys.insert(getPairKey(entityA, entityB)).second) {
+            return;
+        }
+        contacts.push_back({
+                .trigger=trigger,
+                .entityA=entityA,
+                .entityB=entityB,
+                .point=point,
+                .normal=normal
+        });
+    }
+
+    void PhysicsContactTracker::endStep() {
+        for (const auto &contact: contacts) {
+            auto &event = events.emplace_back(contact);
+            bool touchedBefore = previousContactKeys.count(getPairKey(contact.entityA, contact.entityB));
+            event.phase = touchedBefore ? PhysicsContactEvent::STAY : PhysicsContactEvent::ENTER;
+        }
+        for (const auto &contact: previousContacts) {
+            if (!contactKeys.count(getPairKey(contact.entityA, contact.entityB))) {
+                auto &event = events.emplace_back(contact);
+                event.phase = PhysicsContactEvent::EXIT;
+            }
+        }
+        // the current step becomes the previous one, swapping keeps the memory of both
+        std::swap(contacts, previousContacts);
+        std::swap(contactKeys, previousContactKeys);
+        contacts.clear();
+        contactKeys.clear();
+    }
+
+    void PhysicsContactTracker::removeEntity(entt::entity entityHandle) {
+        auto involvesEntity = [entityHandle](const PhysicsContactEvent &contact) {
+            return contact.entityA == entityHandle || contact.entityB == entityHandle;
+        };
+        for (const auto &contact: previousContacts) {
+            if (involvesEntity(contact)) {
+                previousContactKeys.erase(getPairKey(contact.entityA, contact.entityB));
+            }
+        }
+        previousContacts.erase(std::remove_if(previousContacts.begin(), previousContacts.end(), involvesEntity),
+                               previousContacts.end());
+        events.erase(std::remove_if(events.begin(), events.end(), involvesEntity), events.end());
+    }
+
+    const std::vector<PhysicsContactEvent> &PhysicsContactTracker::getEvents() {
+        return events;
+    }
+
+    void PhysicsContactTracker::clearEvents() {
+        events.clear();
+    }
+
+    uint64_t PhysicsContactTracker::getPairKey(entt::entity entityA, entt::entity entityB) {
+        auto a = (uint64_t) entt::to_integral(entityA);
+        auto b = (uint64_t) entt::to_integral(entityB);
+        // the same pair may be reported in either order
+        return std::min(a, b) << 32 | std::max(a, b);
+    }
+}
@@ -0,0 +1,60 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/PhysicsMotionState.h"
+
+namespace Dream {
+    PhysicsMotionState::PhysicsMotionState(const btTransform &transform, entt::entity entityHandle,
+                                           std::vector<PhysicsMotionState *> *changed) {
+        this->transform = transform;
+        this->entityHandle = entityHandle;
+        this->changed = changed;
+    }
+
+    void PhysicsMotionState::getWorldTransform(btTransform &worldTrans) const {
+        worldTrans = transform;
+    }
+
+    void PhysicsMotionState::setWorldTransform(const btTransform &worldTrans) {
+        // bullet reports every active body after each step, even the ones resting on something
+        if (worldTrans.getOrigin() == transform.getOrigin() && worldTrans.getRotation() == transform.getRotation()) {
+            return;
+        }
+        transform = worldTrans;
+        if (!isChanged) {
+            isChanged = true;
+            changed->push_back(this);
+        }
+    }
+
+    void PhysicsMotionState::resetWorldTransform(const btTransform &worldTrans) {
+        transform = worldTrans;
+    }
+
+    void PhysicsMotionState::clearChanged() {
+        isChanged = false;
+    }
+
+    const btTransform &PhysicsMotionState::getTransform() const {
+        return transform;
+    }
+
+    entt::entity PhysicsMotionState::getEntityHandle() const {
+        return entityHandle;
+    }
+}
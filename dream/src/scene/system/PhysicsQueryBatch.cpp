@@ -0,0 +1,96 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/PhysicsQueryBatch.h"
+
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    PhysicsQueryBatch::PhysicsQueryBatch(int capacity) {
+        queries.reserve(capacity);
+        hits.reserve(capacity);
+    }
+
+    void PhysicsQueryBatch::clear() {
+        queries.clear();
+        hits.clear();
+    }
+
+    int PhysicsQueryBatch::addRaycast(glm::vec3 from, glm::vec3 to) {
+        return addQuery({.type=PhysicsQuery::RAYCAST, .from=from, .to=to});
+    }
+
+    int PhysicsQueryBatch::addSphereSweep(glm::vec3 from, glm::vec3 to, float radius) {
+        return addQuery({.type=PhysicsQuery::SPHERE_SWEEP, .from=from, .to=to, .radius=radius});
+    }
+
+    int PhysicsQueryBatch::addCapsuleSweep(glm::vec3 from, glm::vec3 to, float radius, float height) {
+        return addQuery({.type=PhysicsQuery::CAPSULE_SWEEP, .from=from, .to=to, .radius=radius, .height=height});
+    }
+
+    int PhysicsQueryBatch::addSphereOverlap(glm::vec3 center, float radius) {
+        return addQuery({.type=PhysicsQuery::SPHERE_OVERLAP, .from=center, .to=center, .radius=radius});
+    }
+
+    int PhysicsQueryBatch::size() const {
+        return (int) queries.size();
+    }
+
+    const std::vector<PhysicsQuery> &PhysicsQueryBatch::getQueries() const {
+        return queries;
+    }
+
+    std::vector<PhysicsQueryHit> &PhysicsQueryBatch::getHits() {
+        return hits;
+    }
+
+    bool PhysicsQueryBatch::hasHit(int index) const {
+        return getHit(index).hit;
+    }
+
+    entt::entity PhysicsQueryBatch::getHitEntityHandle(int index) const {
+        return getHit(index).entityHandle;
+    }
+
+    glm::vec3 PhysicsQueryBatch::getHitPoint(int index) const {
+        return getHit(index).point;
+    }
+
+    glm::vec3 PhysicsQueryBatch::getHitNormal(int index) const {
+        return getHit(index).normal;
+    }
+
+    float PhysicsQueryBatch::getHitFraction(int index) const {
+        return getHit(index).fraction;
+    }
+
+    int PhysicsQueryBatch::addQuery(const PhysicsQuery &query) {
+        queries.push_back(query);
+        hits.emplace_back();
+        return (int) queries.size() - 1;
+    }
+
+    const PhysicsQueryHit &PhysicsQueryBatch::getHit(int index) const {
+        // indices come from scripts, so a bad one must not stop the application
+        if (index < 0 || index >= hits.size()) {
+            Logger::error("Physics query index " + std::to_string(index) + " is out of range");
+            return missedHit;
+        }
+        return hits.at(index);
+    }
+}
@@ -0,0 +1,286 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/PhysicsShapeCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include "dream/project/Project.h"
+#include "dream/util/Logger.h"
+#include "dream/util/MD5.h"
+
+namespace Dream {
+    namespace {
+        template<typename T>
+        void writeValue(std::ofstream &out, T value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool readValue(std::ifstream &in, T &value) {
+            return (bool) in.read(reinterpret_cast<char *>(&value), sizeof(T));
+        }
+    }
+
+    PhysicsShapeCache::~PhysicsShapeCache() {
+        for (auto &[key, cachedShape]: shapes) {
+            destroy(cachedShape);
+        }
+        shapes.clear();
+        shapeKeys.clear();
+    }
+
+    btCollisionShape *PhysicsShapeCache::acquire(const Component::CollisionComponent::Collider &collider) {
+        std::string key = getKey(collider);
+        auto cachedShapeIterator = shapes.find(key);
+        if (cachedShapeIterator == shapes.end()) {
+            CachedShape cachedShape;
+            if (collider.type == Component::CollisionComponent::MESH) {
+                cachedShape.meshData = new MeshData();
+                cachedShape.shape = createMeshShape(collider.assetGUID, cachedShape.meshData);
+            } else {
+                cachedShape.shape = createPrimitiveShape(collider);
+            }
+            if (!cachedShape.shape) {
+                destroy(cachedShape);
+                return nullptr;
+            }
+            cachedShapeIterator = shapes.emplace(key, cachedShape).first;
+            shapeKeys[cachedShape.shape] = key;
+        }
+        cachedShapeIterator->second.references++;
+        return cachedShapeIterator->second.shape;
+    }
+
+    void PhysicsShapeCache::release(btCollisionShape *shape) {
+        auto keyIterator = shapeKeys.find(shape);
+        if (keyIterator == shapeKeys.end()) {
+            Logger::error("Released collision shape is not in the shape cache");
+            return;
+        }
+        std::string key = keyIterator->second;
+        auto &cachedShape = shapes.at(key);
+        cachedShape.references--;
+        if (cachedShape.references <= 0) {
+            destroy(cachedShape);
+            shapes.erase(key);
+            shapeKeys.erase(shape);
+        }
+    }
+
+    int PhysicsShapeCache::getNumShapes() {
+        return (int) shapes.size();
+    }
+
+    std::filesystem::path PhysicsShapeCache::getBvhCachePath() {
+        return Project::getPath().append("cache").append("physics");
+    }
+
+    std::string PhysicsShapeCache::getKey(const Component::CollisionComponent::Collider &collider) {
+        // only the parameters used by the type are part of the key, floats are written exactly
+        std::ostringstream key;
+        key << std::hexfloat << static_cast<int>(collider.type);
+        if (collider.type == Component::CollisionComponent::BOX) {
+            key << "/" << collider.halfExtents.x << "/" << collider.halfExtents.y << "/" << collider.halfExtents.z;
+        } else if (collider.type == Component::CollisionComponent::CAPSULE ||
+                   collider.type == Component::CollisionComponent::CONE) {
+            key << "/" << static_cast<int>(collider.axis) << "/" << collider.radius << "/" << collider.height;
+        } else if (collider.type == Component::CollisionComponent::CYLINDER) {
+            key << "/" << static_cast<int>(collider.axis) << "/" << collider.halfExtents.x << "/"
+                << collider.halfExtents.y << "/" << collider.halfExtents.z;
+        } else if (collider.type == Component::CollisionComponent::SPHERE) {
+            key << "/" << collider.radius;
+        } else if (collider.type == Component::CollisionComponent::MESH) {
+            key << "/" << collider.assetGUID;
+        }
+        return key.str();
+    }
+
+    btCollisionShape *PhysicsShapeCache::createPrimitiveShape(const Component::CollisionComponent::Collider &collider) {
+        using Component::CollisionComponent;
+        btVector3 halfExtents(collider.halfExtents.x, collider.halfExtents.y, collider.halfExtents.z);
+        if (collider.type == CollisionComponent::BOX) {
+            return new btBoxShape(halfExtents);
+        } else if (collider.type == CollisionComponent::CAPSULE) {
+            if (collider.axis == CollisionComponent::Y) {
+                return new btCapsuleShape(collider.radius, collider.height);
+            } else if (collider.axis == CollisionComponent::X) {
+                return new btCapsuleShapeX(collider.radius, collider.height);
+            } else if (collider.axis == CollisionComponent::Z) {
+                return new btCapsuleShapeZ(collider.radius, collider.height);
+            }
+            Logger::fatal("Unknown capsule axis " + std::to_string(collider.axis));
+        } else if (collider.type == CollisionComponent::CONE) {
+            if (collider.axis == CollisionComponent::Y) {
+                return new btConeShape(collider.radius, collider.height);
+            } else if (collider.axis == CollisionComponent::X) {
+                return new btConeShapeX(collider.radius, collider.height);
+            } else if (collider.axis == CollisionComponent::Z) {
+                return new btConeShapeZ(collider.radius, collider.height);
+            }
+            Logger::fatal("Unknown cone axis " + std::to_string(collider.axis));
+        } else if (collider.type == CollisionComponent::CYLINDER) {
+            if (collider.axis == CollisionComponent::Y) {
+                return new btCylinderShape(halfExtents);
+            } else if (collider.axis == CollisionComponent::X) {
+                return new btCylinderShapeX(halfExtents);
+            } else if (collider.axis == CollisionComponent::Z) {
+                return new btCylinderShapeZ(halfExtents);
+            }
+            Logger::fatal("Unknown cylinder axis " + std::to_string(collider.axis));
+        } else if (collider.type == CollisionComponent::SPHERE) {
+            return new btSphereShape(collider.radius);
+        } else {
+            Logger::fatal("Collider type " + std::to_string(static_cast<int>(collider.type)) + " is not a primitive");
+        }
+        return nullptr;
+    }
+
+    btCollisionShape *PhysicsShapeCache::createMeshShape(const std::string &assetGUID, MeshData *meshData) {
+        std::string path = Project::getResourceManager()->getFilePathFromGUID(assetGUID);
+        if (assetGUID.empty() || !std::filesystem::exists(path)) {
+            Logger::error("Mesh collider file at path '" + path + "' with guid '" + assetGUID + "' does not exist");
+            return nullptr;
+        }
+        // the collider covers the whole model, so node transforms are baked into the vertices
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
+                                                       aiProcess_PreTransformVertices);
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+            Logger::error("Assimp importing error " + std::string(importer.GetErrorString()));
+            return nullptr;
+        }
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+            aiMesh *mesh = scene->mMeshes[i];
+            int firstVertex = (int) meshData->positions.size() / 3;
+            for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+                meshData->positions.push_back(mesh->mVertices[v].x);
+                meshData->positions.push_back(mesh->mVertices[v].y);
+                meshData->positions.push_back(mesh->mVertices[v].z);
+            }
+            for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+                // points and lines left after triangulation do not collide
+                if (mesh->mFaces[f].mNumIndices != 3) {
+                    continue;
+                }
+                for (unsigned int j = 0; j < 3; j++) {
+                    meshData->indices.push_back(firstVertex + (int) mesh->mFaces[f].mIndices[j]);
+                }
+            }
+        }
+        if (meshData->indices.empty()) {
+            Logger::error("Mesh collider file at path '" + path + "' has no triangles");
+            return nullptr;
+        }
+        meshData->meshInterface = new btTriangleIndexVertexArray((int) meshData->indices.size() / 3,
+                                                                 meshData->indices.data(), 3 * sizeof(int),
+                                                                 (int) meshData->positions.size() / 3,
+                                                                 meshData->positions.data(), 3 * sizeof(btScalar));
+
+        // the BVH only depends on the triangles, so a serialized one is reused as long as they are unchanged
+        MD5 md5;
+        md5.update(reinterpret_cast<const char *>(meshData->positions.data()),
+                   (MD5::size_type) (meshData->positions.size() * sizeof(btScalar)));
+        md5.update(reinterpret_cast<const char *>(meshData->indices.data()),
+                   (MD5::size_type) (meshData->indices.size() * sizeof(int)));
+        md5.finalize();
+        std::string trianglesHash = md5.hexdigest();
+        std::filesystem::path bvhPath = getBvhCachePath().append(assetGUID + ".bvh");
+
+        btOptimizedBvh *bvh = loadBvh(bvhPath, trianglesHash, meshData->bvhBuffer);
+        if (bvh) {
+            auto *shape = new btBvhTriangleMeshShape(meshData->meshInterface, true, false);
+            shape->setOptimizedBvh(bvh);
+            return shape;
+        }
+        auto *shape = new btBvhTriangleMeshShape(meshData->meshInterface, true, true);
+        saveBvh(bvhPath, trianglesHash, shape->getOptimizedBvh());
+        return shape;
+    }
+
+    btOptimizedBvh *PhysicsShapeCache::loadBvh(const std::filesystem::path &path, const std::string &trianglesHash,
+                                               void *&bvhBuffer) {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        char fileMagic[4] = {};
+        uint32_t fileVersion = 0, scalarSize = 0, pointerSize = 0, bufferSize = 0;
+        if (!in || !in.read(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, bvhMagic, sizeof(bvhMagic)) != 0) {
+            return nullptr;
+        }
+        // the BVH is stored in memory layout, so it can only be reused by a build with the same layout
+        if (!readValue(in, fileVersion) || fileVersion != bvhVersion || !readValue(in, scalarSize) ||
+            scalarSize != sizeof(btScalar) || !readValue(in, pointerSize) || pointerSize != sizeof(void *)) {
+            return nullptr;
+        }
+        char fileHash[32] = {};
+        if (!in.read(fileHash, sizeof(fileHash)) || trianglesHash.compare(0, std::string::npos, fileHash, sizeof(fileHash)) != 0) {
+            return nullptr;
+        }
+        if (!readValue(in, bufferSize) || bufferSize == 0) {
+            return nullptr;
+        }
+        // BVH nodes are read in place, so the buffer has to be aligned like bullet allocates them
+        void *buffer = btAlignedAlloc(bufferSize, 16);
+        if (!in.read(static_cast<char *>(buffer), bufferSize)) {
+            Logger::warn("Serialized BVH " + path.string() + " is corrupt, it will be built again");
+            btAlignedFree(buffer);
+            return nullptr;
+        }
+        bvhBuffer = buffer;
+        return btOptimizedBvh::deSerializeInPlace(buffer, bufferSize, false);
+    }
+
+    void PhysicsShapeCache::saveBvh(const std::filesystem::path &path, const std::string &trianglesHash,
+                                    btOptimizedBvh *bvh) {
+        std::error_code errorCode;
+        std::filesystem::create_directories(path.parent_path(), errorCode);
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (errorCode || !out) {
+            Logger::warn("Unable to write serialized BVH " + path.string());
+            return;
+        }
+        unsigned int bufferSize = bvh->calculateSerializeBufferSize();
+        void *buffer = btAlignedAlloc(bufferSize, 16);
+        if (bvh->serializeInPlace(buffer, bufferSize, false)) {
+            out.write(bvhMagic, sizeof(bvhMagic));
+            writeValue(out, bvhVersion);
+            writeValue<uint32_t>(out, sizeof(btScalar));
+            writeValue<uint32_t>(out, sizeof(void *));
+            out.write(trianglesHash.data(), (std::streamsize) trianglesHash.size());
+            writeValue<uint32_t>(out, bufferSize);
+            out.write(static_cast<const char *>(buffer), bufferSize);
+        }
+        btAlignedFree(buffer);
+    }
+
+    void PhysicsShapeCache::destroy(CachedShape &cachedShape) {
+        delete cachedShape.shape;
+        cachedShape.shape = nullptr;
+        if (cachedShape.meshData) {
+            delete cachedShape.meshData->meshInterface;
+            if (cachedShape.meshData->bvhBuffer) {
+                btAlignedFree(cachedShape.meshData->bvhBuffer);
+            }
+            delete cachedShape.meshData;
+            cachedShape.meshData = nullptr;
+        }
+    }
+}
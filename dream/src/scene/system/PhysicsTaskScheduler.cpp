@@ -0,0 +1,65 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/PhysicsTaskScheduler.h"
+
+#ifdef BT_THREADSAFE
+
+#include <mutex>
+#include "dream/util/ThreadPool.h"
+
+namespace Dream {
+    PhysicsTaskScheduler &PhysicsTaskScheduler::getInstance() {
+        static PhysicsTaskScheduler instance;
+        return instance;
+    }
+
+    PhysicsTaskScheduler::PhysicsTaskScheduler() : btITaskScheduler("Dream") {}
+
+    int PhysicsTaskScheduler::getMaxNumThreads() const {
+        return getNumThreads();
+    }
+
+    int PhysicsTaskScheduler::getNumThreads() const {
+        // bullet sizes per thread storage with this and indexes it with the order threads first touch the world,
+        // the pool workers and both threads stepping the world (main thread in the editor, simulation thread when
+        // fullscreen) can touch it, so there is one more than the pool workers plus the calling thread
+        return ThreadPool::getInstance().getNumThreads() + 1;
+    }
+
+    void PhysicsTaskScheduler::setNumThreads(int numThreads) {}
+
+    void PhysicsTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) {
+        ThreadPool::getInstance().parallelFor(iBegin, iEnd, [&body](int begin, int end) {
+            body.forLoop(begin, end);
+        }, grainSize);
+    }
+
+    btScalar PhysicsTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) {
+        std::mutex mutex;
+        btScalar sum = 0;
+        ThreadPool::getInstance().parallelFor(iBegin, iEnd, [&](int begin, int end) {
+            btScalar rangeSum = body.sumLoop(begin, end);
+            std::lock_guard<std::mutex> lock(mutex);
+            sum += rangeSum;
+        }, grainSize);
+        return sum;
+    }
+}
+
+#endif
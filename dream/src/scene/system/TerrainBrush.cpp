@@ -0,0 +1,109 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/TerrainBrush.h"
+
+#include <algorithm>
+#include <cmath>
+#include "dream/util/ThreadPool.h"
+
+namespace Dream {
+    std::optional<TerrainBrush::Region> TerrainBrush::apply(float *heights, int size, int centerX, int centerZ, float dt) {
+        if (centerX < 0 || centerZ < 0 || centerX >= size || centerZ >= size) {
+            return std::nullopt;
+        }
+        const auto &weights = getKernel();
+        int kernelWidth = 2 * kernelRadius + 1;
+        Region region = {
+                .minX=std::max(centerX - kernelRadius, 0),
+                .minZ=std::max(centerZ - kernelRadius, 0),
+                .maxX=std::min(centerX + kernelRadius, size - 1),
+                .maxZ=std::min(centerZ + kernelRadius, size - 1)
+        };
+        int regionWidth = region.maxX - region.minX + 1;
+
+        // smoothing reads the heights from before this application so rows can be processed in any order
+        int snapshotWidth = regionWidth + 2;
+        if (mode == SMOOTH) {
+            int snapshotDepth = region.maxZ - region.minZ + 3;
+            snapshot.resize(snapshotWidth * snapshotDepth);
+            for (int z = 0; z < snapshotDepth; z++) {
+                int sourceZ = std::clamp(region.minZ - 1 + z, 0, size - 1);
+                for (int x = 0; x < snapshotWidth; x++) {
+                    int sourceX = std::clamp(region.minX - 1 + x, 0, size - 1);
+                    snapshot[z * snapshotWidth + x] = heights[sourceZ * size + sourceX];
+                }
+            }
+        }
+
+        float delta = (mode == LOWER ? -strength : strength) * dt;
+        float blend = blendRate * dt;
+        float target = heights[centerZ * size + centerX];
+        Mode brushMode = mode;
+        const float *snapshotData = snapshot.data();
+
+        // each row is a contiguous run of heights and kernel weights, which the compiler vectorizes
+        ThreadPool::getInstance().parallelFor(region.minZ, region.maxZ + 1, [&](int beginZ, int endZ) {
+            for (int z = beginZ; z < endZ; z++) {
+                float *row = heights + z * size + region.minX;
+                const float *weightRow = weights.data() + (z - centerZ + kernelRadius) * kernelWidth + (region.minX - centerX + kernelRadius);
+                if (brushMode == RAISE || brushMode == LOWER) {
+                    for (int x = 0; x < regionWidth; x++) {
+                        row[x] += delta * weightRow[x];
+                    }
+                } else if (brushMode == FLATTEN) {
+                    for (int x = 0; x < regionWidth; x++) {
+                        row[x] += (target - row[x]) * std::min(blend * weightRow[x], 1.0f);
+                    }
+                } else {
+                    const float *above = snapshotData + (z - region.minZ) * snapshotWidth;
+                    const float *center = above + snapshotWidth;
+                    const float *below = center + snapshotWidth;
+                    for (int x = 0; x < regionWidth; x++) {
+                        float average = (above[x] + above[x + 1] + above[x + 2] +
+                                         center[x] + center[x + 1] + center[x + 2] +
+                                         below[x] + below[x + 1] + below[x + 2]) * (1.0f / 9.0f);
+                        row[x] += (average - row[x]) * std::min(blend * weightRow[x], 1.0f);
+                    }
+                }
+            }
+        }, 8);
+        return region;
+    }
+
+    const std::vector<float> &TerrainBrush::getKernel() {
+        int brushRadius = std::max(radius, 0);
+        if (brushRadius == kernelRadius) {
+            return kernel;
+        }
+        kernelRadius = brushRadius;
+        int kernelWidth = 2 * kernelRadius + 1;
+        kernel.assign(kernelWidth * kernelWidth, 0.0f);
+        // gaussian falloff that is 1 at the center, cut off outside the radius so the brush is round
+        float sigma = std::max((float) kernelRadius / 2.0f, 0.5f);
+        for (int z = -kernelRadius; z <= kernelRadius; z++) {
+            for (int x = -kernelRadius; x <= kernelRadius; x++) {
+                float distanceSquared = (float) (x * x + z * z);
+                if (distanceSquared <= (float) (kernelRadius * kernelRadius)) {
+                    kernel[(z + kernelRadius) * kernelWidth + (x + kernelRadius)] = std::exp(-distanceSquared / (2.0f * sigma * sigma));
+                }
+            }
+        }
+        return kernel;
+    }
+}
@@ -17,6 +17,11 @@
  **********************************************************************************/
 
 #include "dream/scene/system/TerrainComponentSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <btBulletDynamicsCommon.h>
 #include "dream/project/Project.h"
 #include "dream/scene/Entity.h"
 #include "dream/scene/component/Component.h"
@@ -24,56 +29,6 @@
 #include "dream/window/KeyCodes.h"
 
 namespace Dream {
-    void gaussianFilter(double GKernel[][5]) {
-        // initialising standard deviation to 1.0
-        double sigma = 1.0;
-        double r, s = 2.0 * sigma * sigma;
-
-        // sum is for normalization
-        double sum = 0.0;
-
-        // generating 5x5 kernel
-        for (int x = -2; x <= 2; x++) {
-            for (int y = -2; y <= 2; y++) {
-                r = sqrt(x * x + y * y);
-                GKernel[x + 2][y + 2] = (exp(-(r * r) / s)) / (M_PI * s);
-                sum += GKernel[x + 2][y + 2];
-            }
-        }
-
-        // normalising the Kernel
-        for (int i = 0; i < 5; ++i)
-            for (int j = 0; j < 5; ++j)
-                GKernel[i][j] /= sum;
-    }
-
-    std::optional<glm::vec3> intersectRayWithPlane(
-            glm::vec3 p, glm::vec3 v,  // ray
-            glm::vec3 n, float d  // plane
-    ) {
-        float denom = dot(n, v);
-
-        // Prevent divide by zero:
-        if (abs(denom) <= 1e-4f)
-            return std::nullopt;
-
-        // If you want to ensure the ray reflects off only
-        // the "top" half of the plane, use this instead:
-        //
-        // if (-denom <= 1e-4f)
-        //     return std::nullopt;
-
-        float t = -(dot(n, p) + d) / dot(n, v);
-
-        // Use pointy end of the ray.
-        // It is technically correct to compare t < 0,
-        // but that may be undesirable in a raytracer.
-        if (t <= 1e-4)
-            return std::nullopt;
-
-        return p + t * v;
-    }
-
     void TerrainComponentSystem::init() {
 
     }
@@ -83,68 +38,117 @@ namespace Dream {
         if (!sceneCameraEntity || sceneCameraEntity.getComponent<Component::SceneCameraComponent>().mode != Component::SceneCameraComponent::Mode::TERRAIN_PAINT) {
             return;
         }
+        if (Project::isPlaying() || !Input::getButtonDown(Key::LeftMouse)) {
+            return;
+        }
+
+        int viewportWidth = Input::getRendererDimensions().first;
+        int viewportHeight = Input::getRendererDimensions().second;
+        Camera camera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
+        sceneCameraEntity.getComponent<Component::SceneCameraComponent>().updateRendererCamera(camera, sceneCameraEntity);
+
+        // unproject the mouse onto the near and far planes to get a world space ray
+        glm::vec2 mouse = Input::getRelativeMousePosition();
+        glm::mat4 invVP = glm::inverse(camera.getProjectionMatrix() * camera.getViewMatrix());
+        glm::vec4 nearPoint = invVP * glm::vec4(mouse.x, -mouse.y, -1.0f, 1.0f);
+        glm::vec4 farPoint = invVP * glm::vec4(mouse.x, -mouse.y, 1.0f, 1.0f);
+        glm::vec3 rayOrigin = glm::vec3(nearPoint) / nearPoint.w;
+        glm::vec3 rayEnd = glm::vec3(farPoint) / farPoint.w;
+
         // update all entities with terrain components
         auto terrainEntities = Project::getScene()->getEntitiesWithComponents<Component::TerrainComponent>();
         for (auto entityHandle: terrainEntities) {
             Entity entity = {entityHandle, Project::getScene()};
-            if (!Project::isPlaying() && Input::getButtonDown(Key::LeftMouse)) {
-                glm::vec3 terrainTranslation = entity.getComponent<Component::TransformComponent>().translation;
-                // TODO: make renderer agnostic
-                OpenGLBaseTerrain *terrain = entity.getComponent<Component::TerrainComponent>().terrain;
-                if (terrain) {
-                    int viewportWidth = Input::getRendererDimensions().first;
-                    int viewportHeight = Input::getRendererDimensions().second;
-
-                    Camera camera = {(float) viewportWidth * 2.0f, (float) viewportHeight * 2.0f};
-                    sceneCameraEntity.getComponent<Component::SceneCameraComponent>().updateRendererCamera(camera, sceneCameraEntity);
-
-                    float mouseX = Input::getRelativeMousePosition().x;
-                    float mouseY = Input::getRelativeMousePosition().y;
-
-                    glm::mat4 proj = camera.getProjectionMatrix();
-                    glm::mat4 view = camera.getViewMatrix();
-
-                    glm::mat4 invVP = glm::inverse(proj * view);
-                    glm::vec4 screenPos = glm::vec4(mouseX, -mouseY, 1.0f, 1.0f);
-                    glm::vec4 worldPos = invVP * screenPos;
-
-                    glm::vec3 dir = glm::normalize(glm::vec3(worldPos));
-
-                    // TODO: use raycasting to get x, z position of terrain to modify
-//                    auto sceneCameraFront = sceneCameraEntity.getComponent<Component::SceneCameraComponent>().front;
-                    auto sceneCameraCenter = sceneCameraEntity.getComponent<Component::TransformComponent>().translation;
-
-                    float d = 0;
-                    auto maybeIntersectionPoint = intersectRayWithPlane(sceneCameraCenter, dir,glm::vec3(0, 1, 0), d);
-
-                    if (maybeIntersectionPoint) {
-                        glm::vec3 intersectionPoint = *maybeIntersectionPoint;
-
-                        float xCoordOnPlane = (intersectionPoint.x - terrainTranslation.x) / terrain->getWorldScale();
-                        float zCoordOnPlane = (intersectionPoint.z - terrainTranslation.z) / terrain->getWorldScale();
-
-                        // get width and height, then project
-                        int x = (int) xCoordOnPlane;
-                        int z = (int) zCoordOnPlane;
-
-                        int startX = x - 5 / 2;
-                        int startZ = z - 5 / 2;
+            // TODO: make renderer agnostic
+            OpenGLBaseTerrain *terrain = entity.getComponent<Component::TerrainComponent>().terrain;
+            if (!terrain) {
+                continue;
+            }
+            // cast in the local space of the terrain so it can be translated, rotated and scaled
+            glm::mat4 localFromWorld = glm::inverse(entity.getComponent<Component::TransformComponent>().getTransform(entity));
+            glm::vec3 localOrigin = glm::vec3(localFromWorld * glm::vec4(rayOrigin, 1.0f));
+            glm::vec3 localEnd = glm::vec3(localFromWorld * glm::vec4(rayEnd, 1.0f));
+            auto hit = terrain->raycast(localOrigin, localEnd - localOrigin);
+            // a hit on a tile that is not loaded yet is against its flat placeholder, so load it and cast again
+            while (hit && terrain->loadTiles((int) std::floor(hit->x / terrain->getWorldScale()),
+                                             (int) std::floor(hit->z / terrain->getWorldScale()),
+                                             (int) std::ceil(hit->x / terrain->getWorldScale()),
+                                             (int) std::ceil(hit->z / terrain->getWorldScale()))) {
+                hit = terrain->raycast(localOrigin, localEnd - localOrigin);
+            }
+            if (!hit) {
+                continue;
+            }
+            int x = (int) std::round(hit->x / terrain->getWorldScale());
+            int z = (int) std::round(hit->z / terrain->getWorldScale());
+            // the brush (and smoothing the border around it) needs the real heights of tiles that are not loaded yet
+            terrain->loadTiles(x - brush.radius - 1, z - brush.radius - 1, x + brush.radius + 1, z + brush.radius + 1);
+            auto region = brush.apply(terrain->getHeightMapData(), (int) terrain->getSize(), x, z, dt);
+            if (region) {
+                terrain->markHeightsModified(region->minX, region->minZ, region->maxX, region->maxZ);
+            }
+        }
+    }
 
-                        double GKernel[5][5];
-                        gaussianFilter(GKernel);
-                        for (int i = 0; i < 5; ++i) {
-                            for (int j = 0; j < 5; ++j) {
-                                float deltaHeight = 200.0f;
-                                float currentHeight = terrain->getHeight(startX + i, startZ + j);
-                                float newHeight = currentHeight + deltaHeight * dt * GKernel[i][j];
-                                terrain->setHeight(startX + i, startZ + j, newHeight);
-                            }
-                        }
+    void TerrainComponentSystem::loadCollisionTiles() {
+        auto *physicsComponentSystem = Project::getScene()->getPhysicsComponentSystem();
+        if (!physicsComponentSystem) {
+            return;
+        }
+        // the next frame runs at most this many seconds of simulation
+        const auto &simulationConfig = Project::getConfig().simulationConfig;
+        float lookahead = (float) simulationConfig.maxStepsPerFrame / (float) std::max(simulationConfig.tickRate, 1);
 
-                        terrain->refreshTerrainTriangleList();
-                    }
+        auto rigidBodyEntities = Project::getScene()->getEntitiesWithComponents<Component::RigidBodyComponent>();
+        auto terrainEntities = Project::getScene()->getEntitiesWithComponents<Component::TerrainComponent>();
+        for (auto terrainHandle: terrainEntities) {
+            Entity terrainEntity = {terrainHandle, Project::getScene()};
+            OpenGLBaseTerrain *terrain = terrainEntity.getComponent<Component::TerrainComponent>().terrain;
+            if (!terrain) {
+                continue;
+            }
+            glm::mat4 localFromWorld = glm::inverse(terrainEntity.getComponent<Component::TransformComponent>().getTransform(terrainEntity));
+            for (auto rigidBodyHandle: rigidBodyEntities) {
+                Entity entity = {rigidBodyHandle, Project::getScene()};
+                int rigidBodyIndex = entity.getComponent<Component::RigidBodyComponent>().rigidBodyIndex;
+                if (rigidBodyIndex == -1) {
+                    continue;
                 }
+                btRigidBody *rigidBody = physicsComponentSystem->getRigidBody(rigidBodyIndex);
+                if (rigidBody->isStaticObject() || !rigidBody->getCollisionShape()) {
+                    continue;
+                }
+                btVector3 aabbMin, aabbMax;
+                rigidBody->getCollisionShape()->getAabb(rigidBody->getWorldTransform(), aabbMin, aabbMax);
+                const btVector3 &velocity = rigidBody->getLinearVelocity();
+                glm::vec3 reach = glm::abs(glm::vec3(velocity.x(), velocity.y(), velocity.z())) * lookahead;
+                glm::vec3 worldMin = glm::vec3(aabbMin.x(), aabbMin.y(), aabbMin.z()) - reach;
+                glm::vec3 worldMax = glm::vec3(aabbMax.x(), aabbMax.y(), aabbMax.z()) + reach;
+
+                // bounds of the corners in the local space of the terrain, which can be rotated and scaled
+                glm::vec3 localMin = glm::vec3(std::numeric_limits<float>::max());
+                glm::vec3 localMax = glm::vec3(std::numeric_limits<float>::lowest());
+                for (int corner = 0; corner < 8; corner++) {
+                    glm::vec3 worldCorner = {corner & 1 ? worldMax.x : worldMin.x, corner & 2 ? worldMax.y : worldMin.y,
+                                             corner & 4 ? worldMax.z : worldMin.z};
+                    glm::vec3 localCorner = glm::vec3(localFromWorld * glm::vec4(worldCorner, 1.0f));
+                    localMin = glm::min(localMin, localCorner);
+                    localMax = glm::max(localMax, localCorner);
+                }
+                float worldScale = terrain->getWorldScale();
+                float terrainExtent = terrain->getSize() * worldScale;
+                if (localMax.x < 0 || localMax.z < 0 || localMin.x > terrainExtent || localMin.z > terrainExtent) {
+                    continue;
+                }
+                localMin = glm::max(localMin, glm::vec3(0.0f));
+                localMax = glm::min(localMax, glm::vec3(terrainExtent));
+                terrain->loadTiles((int) std::floor(localMin.x / worldScale) - 1, (int) std::floor(localMin.z / worldScale) - 1,
+                                   (int) std::ceil(localMax.x / worldScale) + 1, (int) std::ceil(localMax.z / worldScale) + 1);
             }
         }
     }
-}
\ No newline at end of file
+
+    TerrainBrush &TerrainComponentSystem::getBrush() {
+        return brush;
+    }
+}
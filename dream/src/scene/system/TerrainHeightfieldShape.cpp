@@ -0,0 +1,45 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/scene/system/TerrainHeightfieldShape.h"
+
+#include <algorithm>
+
+namespace Dream {
+    TerrainHeightfieldShape::TerrainHeightfieldShape(int width, int length, const float *heightData, float minHeight,
+                                                     float maxHeight)
+            : btHeightfieldTerrainShape(width, length, heightData, 1.0, minHeight, maxHeight, 1, PHY_FLOAT, true) {
+
+    }
+
+    bool TerrainHeightfieldShape::includeHeightRange(float minHeight, float maxHeight) {
+        // bullet offsets the heights by the local origin (center of the bounds when the shape was created) and
+        // assumes the bounds are centered on it, so grow them symmetrically instead of moving the origin
+        btScalar origin = m_localOrigin[m_upAxis];
+        btScalar halfHeight = (m_localAabbMax[m_upAxis] - m_localAabbMin[m_upAxis]) * btScalar(0.5);
+        btScalar requiredHalfHeight = std::max(maxHeight - origin, origin - minHeight);
+        if (requiredHalfHeight <= halfHeight) {
+            return false;
+        }
+        m_minHeight = origin - requiredHalfHeight;
+        m_maxHeight = origin + requiredHalfHeight;
+        m_localAabbMin[m_upAxis] = m_minHeight;
+        m_localAabbMax[m_upAxis] = m_maxHeight;
+        return true;
+    }
+}
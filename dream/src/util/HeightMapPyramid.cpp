@@ -0,0 +1,233 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/HeightMapPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Dream {
+    namespace {
+        // ray vs axis-aligned box (slab test), returns the entry and exit distances along the ray
+        bool intersectBox(glm::vec3 origin, glm::vec3 inverseDirection, glm::vec3 boxMin, glm::vec3 boxMax,
+                          float &tEnter, float &tExit) {
+            tEnter = 0.0f;
+            tExit = std::numeric_limits<float>::max();
+            for (int axis = 0; axis < 3; axis++) {
+                if (std::isinf(inverseDirection[axis])) {
+                    // parallel to the slab, 0 * infinity would give NaN
+                    if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) {
+                        return false;
+                    }
+                    continue;
+                }
+                float t0 = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+                float t1 = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+                tEnter = std::max(tEnter, std::min(t0, t1));
+                tExit = std::min(tExit, std::max(t0, t1));
+            }
+            return tEnter <= tExit;
+        }
+
+        // Moller-Trumbore ray vs triangle (double sided)
+        bool intersectTriangle(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, glm::vec3 c, float &t) {
+            glm::vec3 edge1 = b - a;
+            glm::vec3 edge2 = c - a;
+            glm::vec3 p = glm::cross(direction, edge2);
+            float determinant = glm::dot(edge1, p);
+            if (std::abs(determinant) < 1e-8f) {
+                return false;
+            }
+            float inverseDeterminant = 1.0f / determinant;
+            glm::vec3 s = origin - a;
+            float u = glm::dot(s, p) * inverseDeterminant;
+            if (u < 0.0f || u > 1.0f) {
+                return false;
+            }
+            glm::vec3 q = glm::cross(s, edge1);
+            float v = glm::dot(direction, q) * inverseDeterminant;
+            if (v < 0.0f || u + v > 1.0f) {
+                return false;
+            }
+            t = glm::dot(edge2, q) * inverseDeterminant;
+            return t >= 0.0f;
+        }
+    }
+
+    void HeightMapPyramid::build(const float *heightMap, int heightMapSize) {
+        heights = heightMap;
+        size = heightMapSize;
+        levels.clear();
+        int width = std::max(size - 1, 1);
+        while (true) {
+            Level level;
+            level.width = width;
+            level.minHeights.resize(width * width);
+            level.maxHeights.resize(width * width);
+            levels.push_back(std::move(level));
+            if (width == 1) {
+                break;
+            }
+            width = (width + 1) / 2;
+        }
+        update(0, 0, size - 1, size - 1);
+    }
+
+    void HeightMapPyramid::update(int minX, int minZ, int maxX, int maxZ) {
+        if (levels.empty()) {
+            return;
+        }
+        // a vertex is shared by the (up to) four cells around it
+        int minCellX = std::max(minX - 1, 0);
+        int minCellZ = std::max(minZ - 1, 0);
+        int maxCellX = std::min(maxX, levels.at(0).width - 1);
+        int maxCellZ = std::min(maxZ, levels.at(0).width - 1);
+        for (int level = 0; level < levels.size(); level++) {
+            for (int z = minCellZ; z <= maxCellZ; z++) {
+                for (int x = minCellX; x <= maxCellX; x++) {
+                    updateNode(level, x, z);
+                }
+            }
+            minCellX /= 2;
+            minCellZ /= 2;
+            maxCellX /= 2;
+            maxCellZ /= 2;
+        }
+    }
+
+    std::optional<glm::vec3> HeightMapPyramid::raycast(glm::vec3 origin, glm::vec3 direction) const {
+        if (levels.empty() || size < 2 || glm::length(direction) == 0.0f) {
+            return std::nullopt;
+        }
+        direction = glm::normalize(direction);
+        // division by zero gives infinity which the slab test handles
+        glm::vec3 inverseDirection = 1.0f / direction;
+        float closestT = std::numeric_limits<float>::max();
+        raycastNode((int) levels.size() - 1, 0, 0, origin, direction, inverseDirection, closestT);
+        if (closestT == std::numeric_limits<float>::max()) {
+            return std::nullopt;
+        }
+        return origin + closestT * direction;
+    }
+
+    int HeightMapPyramid::getNumLevels() const {
+        return (int) levels.size();
+    }
+
+    std::pair<float, float> HeightMapPyramid::getHeightRange(int level, int x, int z) const {
+        const auto &pyramidLevel = levels.at(level);
+        return {pyramidLevel.minHeights.at(z * pyramidLevel.width + x), pyramidLevel.maxHeights.at(z * pyramidLevel.width + x)};
+    }
+
+    void HeightMapPyramid::updateNode(int level, int x, int z) {
+        auto &pyramidLevel = levels.at(level);
+        float minHeight = std::numeric_limits<float>::max();
+        float maxHeight = std::numeric_limits<float>::lowest();
+        if (level == 0) {
+            for (int dz = 0; dz <= 1; dz++) {
+                for (int dx = 0; dx <= 1; dx++) {
+                    float height = heights[std::min(z + dz, size - 1) * size + std::min(x + dx, size - 1)];
+                    minHeight = std::min(minHeight, height);
+                    maxHeight = std::max(maxHeight, height);
+                }
+            }
+        } else {
+            const auto &childLevel = levels.at(level - 1);
+            for (int dz = 0; dz <= 1; dz++) {
+                for (int dx = 0; dx <= 1; dx++) {
+                    int childX = x * 2 + dx;
+                    int childZ = z * 2 + dz;
+                    if (childX < childLevel.width && childZ < childLevel.width) {
+                        minHeight = std::min(minHeight, childLevel.minHeights[childZ * childLevel.width + childX]);
+                        maxHeight = std::max(maxHeight, childLevel.maxHeights[childZ * childLevel.width + childX]);
+                    }
+                }
+            }
+        }
+        pyramidLevel.minHeights[z * pyramidLevel.width + x] = minHeight;
+        pyramidLevel.maxHeights[z * pyramidLevel.width + x] = maxHeight;
+    }
+
+    void HeightMapPyramid::raycastNode(int level, int x, int z, glm::vec3 origin, glm::vec3 direction,
+                                       glm::vec3 inverseDirection, float &closestT) const {
+        const auto &pyramidLevel = levels.at(level);
+        int cellsPerNode = 1 << level;
+        int numCells = levels.at(0).width;
+        glm::vec3 boxMin = {(float) (x * cellsPerNode), pyramidLevel.minHeights[z * pyramidLevel.width + x], (float) (z * cellsPerNode)};
+        glm::vec3 boxMax = {(float) std::min((x + 1) * cellsPerNode, numCells), pyramidLevel.maxHeights[z * pyramidLevel.width + x],
+                            (float) std::min((z + 1) * cellsPerNode, numCells)};
+        float tEnter, tExit;
+        if (!intersectBox(origin, inverseDirection, boxMin, boxMax, tEnter, tExit) || tEnter > closestT) {
+            return;
+        }
+        if (level == 0) {
+            raycastCell(x, z, origin, direction, closestT);
+            return;
+        }
+
+        // visit children front to back so nodes behind an earlier hit are skipped
+        const auto &childLevel = levels.at(level - 1);
+        std::pair<float, int> children[4];
+        int numChildren = 0;
+        for (int dz = 0; dz <= 1; dz++) {
+            for (int dx = 0; dx <= 1; dx++) {
+                int childX = x * 2 + dx;
+                int childZ = z * 2 + dz;
+                if (childX >= childLevel.width || childZ >= childLevel.width) {
+                    continue;
+                }
+                int childCellsPerNode = cellsPerNode / 2;
+                glm::vec3 childMin = {(float) (childX * childCellsPerNode), childLevel.minHeights[childZ * childLevel.width + childX],
+                                      (float) (childZ * childCellsPerNode)};
+                glm::vec3 childMax = {(float) std::min((childX + 1) * childCellsPerNode, numCells),
+                                      childLevel.maxHeights[childZ * childLevel.width + childX],
+                                      (float) std::min((childZ + 1) * childCellsPerNode, numCells)};
+                float childEnter, childExit;
+                if (intersectBox(origin, inverseDirection, childMin, childMax, childEnter, childExit)) {
+                    children[numChildren++] = {childEnter, childZ * childLevel.width + childX};
+                }
+            }
+        }
+        std::sort(children, children + numChildren);
+        for (int i = 0; i < numChildren; i++) {
+            if (children[i].first > closestT) {
+                break;
+            }
+            raycastNode(level - 1, children[i].second % childLevel.width, children[i].second / childLevel.width,
+                        origin, direction, inverseDirection, closestT);
+        }
+    }
+
+    void HeightMapPyramid::raycastCell(int x, int z, glm::vec3 origin, glm::vec3 direction, float &closestT) const {
+        auto vertex = [&](int vertexX, int vertexZ) {
+            return glm::vec3((float) vertexX, heights[vertexZ * size + vertexX], (float) vertexZ);
+        };
+        glm::vec3 bottomLeft = vertex(x, z);
+        glm::vec3 topLeft = vertex(x, z + 1);
+        glm::vec3 topRight = vertex(x + 1, z + 1);
+        glm::vec3 bottomRight = vertex(x + 1, z);
+        float t;
+        if (intersectTriangle(origin, direction, bottomLeft, topLeft, topRight, t) && t < closestT) {
+            closestT = t;
+        }
+        if (intersectTriangle(origin, direction, bottomLeft, topRight, bottomRight, t) && t < closestT) {
+            closestT = t;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/LZCompression.h"
+
+#include <cstring>
+
+namespace Dream {
+    namespace {
+        const int minMatchLength = 4;
+        const int maxOffset = 65535;
+        const int hashBits = 12;
+
+        uint32_t read32(const uint8_t *data) {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        void writeLength(std::vector<uint8_t> &out, size_t length) {
+            // lengths that do not fit in the 4 bits of the token continue in bytes of 255
+            while (length >= 255) {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back((uint8_t) length);
+        }
+
+        void writeSequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t numLiterals, size_t offset, size_t matchLength) {
+            size_t matchCode = matchLength > 0 ? matchLength - minMatchLength : 0;
+            out.push_back((uint8_t) ((numLiterals >= 15 ? 15 : numLiterals) << 4 | (matchCode >= 15 ? 15 : matchCode)));
+            if (numLiterals >= 15) {
+                writeLength(out, numLiterals - 15);
+            }
+            out.insert(out.end(), literals, literals + numLiterals);
+            if (matchLength > 0) {
+                out.push_back((uint8_t) (offset & 0xFF));
+                out.push_back((uint8_t) (offset >> 8));
+                if (matchCode >= 15) {
+                    writeLength(out, matchCode - 15);
+                }
+            }
+        }
+
+        bool readLength(const uint8_t *source, size_t sourceSize, size_t &position, size_t &length) {
+            uint8_t value;
+            do {
+                if (position >= sourceSize) {
+                    return false;
+                }
+                value = source[position++];
+                length += value;
+            } while (value == 255);
+            return true;
+        }
+    }
+
+    std::vector<uint8_t> LZCompression::compress(const uint8_t *source, size_t sourceSize) {
+        std::vector<uint8_t> out;
+        out.reserve(sourceSize / 2 + 16);
+        std::vector<int64_t> hashTable(1 << hashBits, -1);
+        size_t position = 0;
+        size_t anchor = 0;
+        while (position + minMatchLength <= sourceSize) {
+            uint32_t sequence = read32(source + position);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - hashBits);
+            int64_t candidate = hashTable[hash];
+            hashTable[hash] = (int64_t) position;
+            if (candidate < 0 || position - candidate > maxOffset || read32(source + candidate) != sequence) {
+                position++;
+                continue;
+            }
+            size_t matchLength = minMatchLength;
+            while (position + matchLength < sourceSize && source[candidate + matchLength] == source[position + matchLength]) {
+                matchLength++;
+            }
+            writeSequence(out, source + anchor, position - anchor, position - candidate, matchLength);
+            position += matchLength;
+            anchor = position;
+        }
+        // the last sequence only has literals, which also marks the end of the data
+        writeSequence(out, source + anchor, sourceSize - anchor, 0, 0);
+        return out;
+    }
+
+    bool LZCompression::decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize) {
+        size_t position = 0;
+        size_t outPosition = 0;
+        while (position < sourceSize) {
+            uint8_t token = source[position++];
+            size_t numLiterals = token >> 4;
+            if (numLiterals == 15 && !readLength(source, sourceSize, position, numLiterals)) {
+                return false;
+            }
+            if (numLiterals > sourceSize - position || numLiterals > destinationSize - outPosition) {
+                return false;
+            }
+            std::memcpy(destination + outPosition, source + position, numLiterals);
+            position += numLiterals;
+            outPosition += numLiterals;
+            if (position == sourceSize) {
+                break;
+            }
+            if (sourceSize - position < 2) {
+                return false;
+            }
+            size_t offset = source[position] | (source[position + 1] << 8);
+            position += 2;
+            size_t matchLength = (token & 15);
+            if (matchLength == 15 && !readLength(source, sourceSize, position, matchLength)) {
+                return false;
+            }
+            matchLength += minMatchLength;
+            if (offset == 0 || offset > outPosition || matchLength > destinationSize - outPosition) {
+                return false;
+            }
+            // byte by byte since the match may overlap the bytes it produces (runs)
+            for (size_t i = 0; i < matchLength; i++) {
+                destination[outPosition + i] = destination[outPosition - offset + i];
+            }
+            outPosition += matchLength;
+        }
+        return outPosition == destinationSize;
+    }
+}
@@ -18,6 +18,7 @@
 
 #include "dream/util/MathUtils.h"
 #include "dream/util/Logger.h"
+#include <glm/gtc/matrix_access.hpp>
 #include <glm/gtx/vector_angle.hpp>
 
 namespace Dream {
@@ -111,4 +112,27 @@ namespace Dream {
     float MathUtils::distance(glm::vec3 p1, glm::vec3 p2) {
         return glm::distance(p1, p2);
     }
-}
\ No newline at end of file
+
+    void MathUtils::getFrustumPlanes(const glm::mat4 &clipFromLocal, glm::vec4 planes[6]) {
+        glm::vec4 row0 = glm::row(clipFromLocal, 0);
+        glm::vec4 row1 = glm::row(clipFromLocal, 1);
+        glm::vec4 row2 = glm::row(clipFromLocal, 2);
+        glm::vec4 row3 = glm::row(clipFromLocal, 3);
+        planes[0] = row3 + row0;
+        planes[1] = row3 - row0;
+        planes[2] = row3 + row1;
+        planes[3] = row3 - row1;
+        planes[4] = row3 + row2;
+        planes[5] = row3 - row2;
+    }
+
+    bool MathUtils::isSphereInFrustum(const glm::vec4 planes[6], glm::vec3 center, float radius) {
+        for (int i = 0; i < 6; i++) {
+            glm::vec3 normal = glm::vec3(planes[i]);
+            if (glm::dot(normal, center) + planes[i].w < -radius * glm::length(normal)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,87 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/SimulationClock.h"
+
+#include <algorithm>
+
+namespace Dream {
+    SimulationClock::SimulationClock(int tickRate, int maxStepsPerFrame) {
+        setTickRate(tickRate);
+        setMaxStepsPerFrame(maxStepsPerFrame);
+    }
+
+    void SimulationClock::setTickRate(int tickRate) {
+        step = std::chrono::nanoseconds(std::chrono::seconds(1)) / std::max(tickRate, 1);
+    }
+
+    int SimulationClock::getTickRate() const {
+        return (int) (std::chrono::nanoseconds(std::chrono::seconds(1)) / step);
+    }
+
+    void SimulationClock::setMaxStepsPerFrame(int maxStepsPerFrame) {
+        this->maxStepsPerFrame = std::max(maxStepsPerFrame, 1);
+    }
+
+    void SimulationClock::setDeterministic(bool deterministic) {
+        this->deterministic = deterministic;
+    }
+
+    bool SimulationClock::isDeterministic() const {
+        return deterministic;
+    }
+
+    int SimulationClock::advance(std::chrono::nanoseconds elapsed) {
+        if (deterministic) {
+            accumulator = std::chrono::nanoseconds(0);
+            tick++;
+            return 1;
+        }
+        accumulator += std::max(elapsed, std::chrono::nanoseconds(0));
+        auto steps = accumulator / step;
+        if (steps > maxStepsPerFrame) {
+            // catching up on all of it would take even longer than this frame did, so the extra time is lost
+            droppedTicks += steps - maxStepsPerFrame;
+            steps = maxStepsPerFrame;
+            accumulator %= step;
+        } else {
+            accumulator -= steps * step;
+        }
+        tick += steps;
+        return (int) steps;
+    }
+
+    double SimulationClock::getFixedDeltaTime() const {
+        return std::chrono::duration<double>(step).count();
+    }
+
+    float SimulationClock::getAlpha() const {
+        if (deterministic) {
+            return 1.0f;
+        }
+        return (float) accumulator.count() / (float) step.count();
+    }
+
+    uint64_t SimulationClock::getTick() const {
+        return tick;
+    }
+
+    uint64_t SimulationClock::getDroppedTicks() const {
+        return droppedTicks;
+    }
+}
@@ -0,0 +1,77 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/ThreadPool.h"
+
+#include <algorithm>
+
+namespace Dream {
+    ThreadPool &ThreadPool::getInstance() {
+        static ThreadPool instance;
+        return instance;
+    }
+
+    ThreadPool::ThreadPool() {
+#ifndef EMSCRIPTEN
+        int numWorkers = (int) std::thread::hardware_concurrency() - 1;
+        for (int i = 0; i < numWorkers; i++) {
+            workers.push_back(new WorkerThread());
+        }
+#endif
+    }
+
+    ThreadPool::~ThreadPool() {
+        for (auto *worker: workers) {
+            delete worker;
+        }
+        workers.clear();
+    }
+
+    void ThreadPool::parallelFor(int begin, int end, const std::function<void(int, int)> &job, int minRangeSize) {
+        if (end <= begin) {
+            return;
+        }
+        int count = end - begin;
+        int numRanges = std::min(getNumThreads(), std::max(count / std::max(minRangeSize, 1), 1));
+        if (numRanges <= 1 || insideParallelFor) {
+            job(begin, end);
+            return;
+        }
+        int rangeSize = (count + numRanges - 1) / numRanges;
+        int numWorkerRanges = 0;
+        // first ranges go to the workers and the last one runs on the calling thread
+        for (int rangeBegin = begin; rangeBegin + rangeSize < end; rangeBegin += rangeSize) {
+            int rangeEnd = rangeBegin + rangeSize;
+            workers.at(numWorkerRanges++)->run([&job, rangeBegin, rangeEnd]() {
+                insideParallelFor = true;
+                job(rangeBegin, rangeEnd);
+                insideParallelFor = false;
+            });
+        }
+        insideParallelFor = true;
+        job(begin + numWorkerRanges * rangeSize, end);
+        insideParallelFor = false;
+        for (int i = 0; i < numWorkerRanges; i++) {
+            workers.at(i)->wait();
+        }
+    }
+
+    int ThreadPool::getNumThreads() {
+        return (int) workers.size() + 1;
+    }
+}
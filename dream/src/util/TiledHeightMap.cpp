@@ -0,0 +1,307 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/TiledHeightMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "dream/util/LZCompression.h"
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    TiledHeightMap::~TiledHeightMap() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            requestedTiles.clear();
+        }
+        delete loader;
+    }
+
+    bool TiledHeightMap::open(const std::string &filePath) {
+        std::ifstream in(filePath, std::ios::in | std::ios::binary);
+        Header header = {};
+        if (!in || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+            return false;
+        }
+        if (header.version != version || header.size < 2 || header.tileSize < 1) {
+            Logger::error("Unsupported tiled height map " + filePath);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(fileMutex);
+        path = filePath;
+        size = (int) header.size;
+        tileSize = (int) header.tileSize;
+        numTilesPerSide = (size + tileSize - 1) / tileSize;
+        tiles.resize(numTilesPerSide * numTilesPerSide);
+        if (!in.read(reinterpret_cast<char *>(tiles.data()), (std::streamsize) (tiles.size() * sizeof(Tile)))) {
+            Logger::error("Tiled height map " + filePath + " is missing its tile directory");
+            tiles.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool TiledHeightMap::write(const std::string &filePath, const float *heights, int size, int tileSize) {
+        int numTilesPerSide = (size + tileSize - 1) / tileSize;
+        std::vector<Tile> tiles(numTilesPerSide * numTilesPerSide);
+        std::vector<std::vector<uint8_t>> tileData(tiles.size());
+        uint64_t offset = sizeof(Header) + tiles.size() * sizeof(Tile);
+        for (int tileZ = 0; tileZ < numTilesPerSide; tileZ++) {
+            for (int tileX = 0; tileX < numTilesPerSide; tileX++) {
+                int tile = tileZ * numTilesPerSide + tileX;
+                tileData[tile] = encodeTile(heights, size, tileX * tileSize, tileZ * tileSize,
+                                            std::min((tileX + 1) * tileSize, size), std::min((tileZ + 1) * tileSize, size),
+                                            tiles[tile].minHeight, tiles[tile].maxHeight);
+                tiles[tile].offset = offset;
+                tiles[tile].compressedSize = (uint32_t) tileData[tile].size();
+                tiles[tile].capacity = tiles[tile].compressedSize;
+                offset += tiles[tile].compressedSize;
+            }
+        }
+
+        std::ofstream out(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Logger::error("Unable to write tiled height map " + filePath);
+            return false;
+        }
+        Header header = {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.size = (uint32_t) size;
+        header.tileSize = (uint32_t) tileSize;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(tiles.data()), (std::streamsize) (tiles.size() * sizeof(Tile)));
+        for (const auto &data: tileData) {
+            out.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+        }
+        return (bool) out;
+    }
+
+    bool TiledHeightMap::writeTiles(const float *heights, const std::vector<int> &tilesToWrite) {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file) {
+            Logger::error("Unable to write tiled height map " + path);
+            return false;
+        }
+        file.seekp(0, std::ios::end);
+        auto endOfFile = (uint64_t) file.tellp();
+        for (int tile: tilesToWrite) {
+            int minX, minZ, maxX, maxZ;
+            getTileBounds(tile, minX, minZ, maxX, maxZ);
+            auto data = encodeTile(heights, size, minX, minZ, maxX, maxZ, tiles[tile].minHeight, tiles[tile].maxHeight);
+            // tiles that grew are moved to the end of the file, their old space is left unused until a full write
+            if (data.size() > tiles[tile].capacity) {
+                tiles[tile].offset = endOfFile;
+                tiles[tile].capacity = (uint32_t) data.size();
+                endOfFile += data.size();
+            }
+            tiles[tile].compressedSize = (uint32_t) data.size();
+            file.seekp((std::streamoff) tiles[tile].offset);
+            file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+        }
+        file.seekp(sizeof(Header));
+        file.write(reinterpret_cast<const char *>(tiles.data()), (std::streamsize) (tiles.size() * sizeof(Tile)));
+        return (bool) file;
+    }
+
+    bool TiledHeightMap::readTile(int tile, float *heights) {
+        std::vector<float> tileHeights;
+        if (!decodeTile(tile, tileHeights)) {
+            return false;
+        }
+        int minX, minZ, maxX, maxZ;
+        getTileBounds(tile, minX, minZ, maxX, maxZ);
+        int width = maxX - minX;
+        for (int z = minZ; z < maxZ; z++) {
+            std::copy_n(tileHeights.data() + (z - minZ) * width, width, heights + z * size + minX);
+        }
+        return true;
+    }
+
+    void TiledHeightMap::requestTiles(const std::vector<int> &tilesToLoad) {
+        bool startLoader = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            requestedTiles.insert(requestedTiles.end(), tilesToLoad.begin(), tilesToLoad.end());
+#ifndef EMSCRIPTEN
+            // the loader keeps going until the queue is empty, so it only has to be started when it is idle
+            startLoader = !requestedTiles.empty() && !loading;
+            loading = loading || startLoader;
+#endif
+        }
+        if (startLoader) {
+            if (!loader) {
+                loader = new WorkerThread();
+            }
+            loader->run([this]() {
+                loadRequestedTiles();
+            });
+        }
+    }
+
+    std::vector<std::pair<int, std::vector<float>>> TiledHeightMap::takeLoadedTiles() {
+#ifdef EMSCRIPTEN
+        // no threads on the web build, so a few tiles are decoded per frame instead
+        for (int i = 0; i < 4; i++) {
+            int tile;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (requestedTiles.empty()) {
+                    break;
+                }
+                tile = requestedTiles.front();
+                requestedTiles.pop_front();
+            }
+            std::vector<float> tileHeights;
+            if (decodeTile(tile, tileHeights)) {
+                loadedTiles.emplace_back(tile, std::move(tileHeights));
+            }
+        }
+#endif
+        std::vector<std::pair<int, std::vector<float>>> result;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        result.swap(loadedTiles);
+        return result;
+    }
+
+    bool TiledHeightMap::isLoading() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return loading || !requestedTiles.empty();
+    }
+
+    const std::string &TiledHeightMap::getPath() {
+        return path;
+    }
+
+    int TiledHeightMap::getSize() {
+        return size;
+    }
+
+    int TiledHeightMap::getTileSize() {
+        return tileSize;
+    }
+
+    int TiledHeightMap::getNumTilesPerSide() {
+        return numTilesPerSide;
+    }
+
+    int TiledHeightMap::getNumTiles() {
+        return (int) tiles.size();
+    }
+
+    TiledHeightMap::Tile TiledHeightMap::getTile(int tile) {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        return tiles.at(tile);
+    }
+
+    void TiledHeightMap::getTileBounds(int tile, int &minX, int &minZ, int &maxX, int &maxZ) {
+        minX = (tile % numTilesPerSide) * tileSize;
+        minZ = (tile / numTilesPerSide) * tileSize;
+        maxX = std::min(minX + tileSize, size);
+        maxZ = std::min(minZ + tileSize, size);
+    }
+
+    std::vector<uint8_t> TiledHeightMap::encodeTile(const float *heights, int size, int minX, int minZ, int maxX, int maxZ,
+                                                    float &minHeight, float &maxHeight) {
+        int width = maxX - minX;
+        int numHeights = width * (maxZ - minZ);
+        minHeight = heights[minZ * size + minX];
+        maxHeight = minHeight;
+        for (int z = minZ; z < maxZ; z++) {
+            for (int x = minX; x < maxX; x++) {
+                minHeight = std::min(minHeight, heights[z * size + x]);
+                maxHeight = std::max(maxHeight, heights[z * size + x]);
+            }
+        }
+        float scale = maxHeight > minHeight ? 65535.0f / (maxHeight - minHeight) : 0.0f;
+
+        // neighboring heights are similar, so the differences between quantized heights are mostly small numbers,
+        // and storing all low bytes before all high bytes gives the compressor long runs to work with
+        std::vector<uint8_t> planes(numHeights * 2);
+        uint16_t previous = 0;
+        for (int z = minZ; z < maxZ; z++) {
+            for (int x = minX; x < maxX; x++) {
+                auto quantized = (uint16_t) std::lround((heights[z * size + x] - minHeight) * scale);
+                auto delta = (uint16_t) (quantized - previous);
+                int i = (z - minZ) * width + (x - minX);
+                planes[i] = (uint8_t) (delta & 0xFF);
+                planes[numHeights + i] = (uint8_t) (delta >> 8);
+                previous = quantized;
+            }
+        }
+        return LZCompression::compress(planes.data(), planes.size());
+    }
+
+    bool TiledHeightMap::decodeTile(int tile, std::vector<float> &tileHeights) {
+        int minX, minZ, maxX, maxZ;
+        getTileBounds(tile, minX, minZ, maxX, maxZ);
+        int numHeights = (maxX - minX) * (maxZ - minZ);
+
+        Tile tileInfo;
+        std::vector<uint8_t> data;
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            tileInfo = tiles.at(tile);
+            std::ifstream in(path, std::ios::in | std::ios::binary);
+            data.resize(tileInfo.compressedSize);
+            in.seekg((std::streamoff) tileInfo.offset);
+            if (!in.read(reinterpret_cast<char *>(data.data()), (std::streamsize) data.size())) {
+                Logger::error("Unable to read tile " + std::to_string(tile) + " of " + path);
+                return false;
+            }
+        }
+
+        std::vector<uint8_t> planes(numHeights * 2);
+        if (!LZCompression::decompress(data.data(), data.size(), planes.data(), planes.size())) {
+            Logger::error("Tile " + std::to_string(tile) + " of " + path + " is corrupt");
+            return false;
+        }
+        float step = (tileInfo.maxHeight - tileInfo.minHeight) / 65535.0f;
+        tileHeights.resize(numHeights);
+        uint16_t quantized = 0;
+        for (int i = 0; i < numHeights; i++) {
+            quantized += (uint16_t) (planes[i] | planes[numHeights + i] << 8);
+            tileHeights[i] = tileInfo.minHeight + (float) quantized * step;
+        }
+        return true;
+    }
+
+    void TiledHeightMap::loadRequestedTiles() {
+        while (true) {
+            int tile;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (requestedTiles.empty()) {
+                    loading = false;
+                    return;
+                }
+                tile = requestedTiles.front();
+                requestedTiles.pop_front();
+            }
+            std::vector<float> tileHeights;
+            if (decodeTile(tile, tileHeights)) {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                loadedTiles.emplace_back(tile, std::move(tileHeights));
+            }
+        }
+    }
+}
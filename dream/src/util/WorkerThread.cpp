@@ -0,0 +1,75 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/util/WorkerThread.h"
+
+#include <utility>
+
+namespace Dream {
+    WorkerThread::~WorkerThread() {
+        if (thread.joinable()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return !busy; });
+                stopping = true;
+            }
+            condition.notify_all();
+            thread.join();
+        }
+    }
+
+    void WorkerThread::run(std::function<void()> newJob) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return !busy; });
+            job = std::move(newJob);
+            busy = true;
+        }
+        if (!thread.joinable()) {
+            // started lazily so builds without thread support never create it unless it is used
+            thread = std::thread(&WorkerThread::loop, this);
+        }
+        condition.notify_all();
+    }
+
+    void WorkerThread::wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return !busy; });
+    }
+
+    void WorkerThread::loop() {
+        while (true) {
+            std::function<void()> currentJob;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return stopping || (busy && job); });
+                if (stopping) {
+                    return;
+                }
+                currentJob = std::move(job);
+                job = nullptr;
+            }
+            currentJob();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy = false;
+            }
+            condition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include "dream/window/EGLHeadlessWindow.h"
+
+#ifdef DREAM_EGL
+
+#include <cstring>
+#include <string>
+#include <glad/glad.h>
+#include <EGL/eglext.h>
+#include "dream/util/Logger.h"
+
+namespace Dream {
+    EGLHeadlessWindow::EGLHeadlessWindow(int width, int height) : Window() {
+        this->width = width;
+        this->height = height;
+
+        // prefer the surfaceless platform (mesa) since it does not need a display server
+        display = EGL_NO_DISPLAY;
+        const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay) {
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major, minor;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            Logger::fatal("Unable to initialize EGL display");
+        }
+        Logger::info("EGL Version: " + std::to_string(major) + "." + std::to_string(minor));
+
+        const EGLint configAttributes[] = {
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_RED_SIZE, 8,
+                EGL_GREEN_SIZE, 8,
+                EGL_BLUE_SIZE, 8,
+                EGL_DEPTH_SIZE, 24,
+                EGL_NONE
+        };
+        EGLConfig config;
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0) {
+            Logger::fatal("Unable to find EGL config for headless OpenGL rendering");
+        }
+
+        const EGLint surfaceAttributes[] = {
+                EGL_WIDTH, width,
+                EGL_HEIGHT, height,
+                EGL_NONE
+        };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+        if (surface == EGL_NO_SURFACE) {
+            Logger::fatal("Unable to create EGL pbuffer surface");
+        }
+
+        eglBindAPI(EGL_OPENGL_API);
+        const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            Logger::fatal("Unable to create EGL OpenGL 3.3 core context");
+        }
+        if (!eglMakeCurrent(display, surface, surface, context)) {
+            Logger::fatal("Unable to make EGL context current");
+        }
+
+        gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+    }
+
+    EGLHeadlessWindow::~EGLHeadlessWindow() {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+
+    void EGLHeadlessWindow::swapBuffers() {
+        // nothing is presented, wait for the GPU so frame times include the work that was submitted
+        glFinish();
+    }
+
+    std::pair<int, int> EGLHeadlessWindow::getWindowDimensions() {
+        return std::make_pair(width, height);
+    }
+}
+
+#endif
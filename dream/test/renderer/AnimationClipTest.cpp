@@ -0,0 +1,97 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "dream/renderer/AnimationClip.h"
+
+/**
+ * Test constant and linear tracks are reduced to one and two keys and sampling stays within the tolerance
+ */
+TEST(AnimationClipTest, CompressesTracks) {
+    int numKeys = 31;
+    std::vector<Dream::AnimationClip::SourceTrack> tracks(3);
+    for (int key = 0; key < numKeys; key++) {
+        float time = (float) key;
+        // joint 0 does not move, joint 1 moves and turns at a constant rate, joint 2 swings back and forth
+        tracks[0].positions.push_back({glm::vec3(1.0f, 2.0f, 3.0f), time});
+        tracks[0].rotations.push_back({glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), time});
+        tracks[1].positions.push_back({glm::vec3(time, 0.0f, -2.0f * time), time});
+        tracks[1].rotations.push_back({glm::angleAxis(time * 0.05f, glm::vec3(1.0f, 0.0f, 0.0f)), time});
+        tracks[2].positions.push_back({glm::vec3(0.0f, std::sin(time * 0.3f), 0.0f), time});
+        tracks[2].rotations.push_back({glm::angleAxis(std::sin(time * 0.3f), glm::vec3(0.0f, 0.0f, 1.0f)), time});
+    }
+    for (auto &track: tracks) {
+        track.animated = true;
+        track.numScales = numKeys;
+    }
+    Dream::AnimationCompressionSettings settings;
+    Dream::AnimationClip clip("test", (float) (numKeys - 1), 30.0f, tracks, settings);
+
+    const auto &stats = clip.getCompressionStats();
+    EXPECT_EQ(stats.sourceKeys, numKeys * 9);
+    EXPECT_EQ(stats.constantTracks, 2);
+    EXPECT_LT(stats.compressedKeys, numKeys * 3);
+    EXPECT_LT(stats.compressedBytes, stats.sourceBytes / 4);
+    // quantization adds a little on top of the tolerance used to drop keys
+    EXPECT_LT(stats.maxTranslationError, settings.translationTolerance + 1e-3f);
+    EXPECT_LT(stats.maxRotationError, settings.rotationTolerance + 1e-3f);
+
+    Dream::AnimationClip::Cursor cursor;
+    clip.initCursor(cursor);
+    glm::vec3 translations[3];
+    glm::quat rotations[3];
+    clip.sample(10.5f, cursor, translations, rotations);
+    EXPECT_NEAR(glm::length(translations[0] - glm::vec3(1.0f, 2.0f, 3.0f)), 0.0f, 1e-3f);
+    EXPECT_NEAR(glm::length(translations[1] - glm::vec3(10.5f, 0.0f, -21.0f)), 0.0f, 1e-2f);
+    EXPECT_NEAR(std::abs(glm::dot(rotations[1], glm::angleAxis(0.525f, glm::vec3(1.0f, 0.0f, 0.0f)))), 1.0f, 1e-5f);
+    EXPECT_NEAR(translations[2].y, std::sin(10.5f * 0.3f), 0.02f);
+}
+
+/**
+ * Test a slow rotation at a constant rate, with a wobble far below the tolerance (ex: noise from exporting), is reduced
+ * to its first and last key
+ */
+TEST(AnimationClipTest, ReducesSlowRotation) {
+    int numKeys = 121;
+    glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f));
+    std::vector<Dream::AnimationClip::SourceTrack> tracks(1);
+    for (int key = 0; key < numKeys; key++) {
+        float time = (float) key;
+        tracks[0].positions.push_back({glm::vec3(0.0f), time});
+        tracks[0].rotations.push_back({glm::angleAxis(time * 0.02f + 0.0005f * std::sin(time * 1.7f), axis), time});
+    }
+    tracks[0].animated = true;
+    Dream::AnimationCompressionSettings settings;
+    Dream::AnimationClip clip("test", (float) (numKeys - 1), 30.0f, tracks, settings);
+
+    // one key for the constant translation, two for the rotation
+    const auto &stats = clip.getCompressionStats();
+    EXPECT_EQ(stats.compressedKeys, 3);
+    EXPECT_LT(stats.maxRotationError, settings.rotationTolerance);
+
+    Dream::AnimationClip::Cursor cursor;
+    clip.initCursor(cursor);
+    glm::vec3 translation;
+    glm::quat rotation;
+    clip.sample(60.5f, cursor, &translation, &rotation);
+    float cosHalfAngle = std::abs(glm::dot(rotation, glm::angleAxis(1.21f, axis)));
+    EXPECT_LT(2.0f * std::acos(std::min(cosHalfAngle, 1.0f)), settings.rotationTolerance);
+}
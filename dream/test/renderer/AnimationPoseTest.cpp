@@ -0,0 +1,66 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/renderer/AnimationPose.h"
+
+/**
+ * Test masked blending only moves the masked joints and additive poses apply their difference from the reference
+ */
+TEST(AnimationPoseTest, BlendsMaskedAndAdditivePoses) {
+    glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::quat turn = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec3 translations[2] = {glm::vec3(0.0f), glm::vec3(0.0f)};
+    glm::quat rotations[2] = {identity, identity};
+    glm::vec3 otherTranslations[2] = {glm::vec3(2.0f), glm::vec3(2.0f)};
+    glm::quat otherRotations[2] = {turn, turn};
+    float mask[2] = {0.0f, 1.0f};
+    Dream::AnimationPose::blend(otherTranslations, otherRotations, translations, rotations, 2, 0.5f, mask);
+    EXPECT_EQ(translations[0], glm::vec3(0.0f));
+    EXPECT_EQ(translations[1], glm::vec3(1.0f));
+    EXPECT_NEAR(glm::angle(rotations[1]), glm::radians(45.0f), 1e-4f);
+
+    glm::vec3 referenceTranslations[2] = {glm::vec3(1.0f), glm::vec3(1.0f)};
+    glm::quat referenceRotations[2] = {turn, turn};
+    glm::quat twice = turn * turn;
+    glm::quat additiveRotations[2] = {twice, twice};
+    Dream::AnimationPose::addAdditive(referenceTranslations, referenceRotations, otherTranslations, additiveRotations,
+                                      translations, rotations, 2, 1.0f);
+    EXPECT_EQ(translations[0], glm::vec3(1.0f));
+    EXPECT_NEAR(glm::angle(rotations[0]), glm::radians(90.0f), 1e-4f);
+}
+
+/**
+ * Test poses returned to the pool of a thread are handed out again
+ */
+TEST(AnimationPoseTest, ReusesPooledPoses) {
+    int numFreePoses = Dream::AnimationPosePool::getNumFreePoses();
+    Dream::AnimationPose *first;
+    {
+        auto pose = Dream::AnimationPosePool::acquire(10);
+        first = &*pose;
+        EXPECT_EQ(pose->translations.size(), 10);
+        EXPECT_EQ(pose->rotations.size(), 10);
+    }
+    EXPECT_EQ(Dream::AnimationPosePool::getNumFreePoses(), numFreePoses + 1);
+    auto pose = Dream::AnimationPosePool::acquire(20);
+    EXPECT_EQ(&*pose, first);
+    EXPECT_EQ(pose->translations.size(), 20);
+    auto otherPose = Dream::AnimationPosePool::acquire(20);
+    EXPECT_NE(&*otherPose, first);
+}
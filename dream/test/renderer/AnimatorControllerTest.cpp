@@ -0,0 +1,165 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "dream/renderer/AnimatorController.h"
+
+/**
+ * Test transitions are grouped by the state they leave from and the first one whose conditions pass is taken
+ */
+TEST(AnimatorControllerTest, FindsTransitions) {
+    using Description = Dream::AnimatorController::Description;
+    Description description;
+    description.states = {{.Guid="idle"}, {.Guid="walk"}, {.Guid="run"}};
+    description.variables = {{.Name="speed", .Type=Dream::AnimatorController::ParameterType::FLOAT, .Value=0.0f}};
+    // transitions out of idle are declared apart from each other to check their order is kept
+    description.transitions = {
+            {.InputStateID=2, .OutputStateID=0, .Conditions={{.Variable1Idx=0, .Operator=">=", .Variable2=2.5f}}, .Blend=true},
+            {.InputStateID=0, .OutputStateID=1, .Conditions={{.Variable1Idx=0, .Operator="==", .Variable2=0.0f}}, .Blend=true},
+            {.InputStateID=1, .OutputStateID=0, .Conditions={{.Variable1Idx=0, .Operator=">", .Variable2=0.0f}}, .Blend=false}
+    };
+    Dream::AnimatorController controller(description);
+    EXPECT_EQ(controller.getState(0).numTransitions, 2);
+    EXPECT_EQ(controller.getState(1).numTransitions, 1);
+    EXPECT_EQ(controller.getState(2).numTransitions, 0);
+    EXPECT_EQ(controller.findParameter("speed"), 0);
+    EXPECT_EQ(controller.findParameter("missing"), -1);
+
+    std::vector<float> values;
+    controller.initParameters(values);
+    EXPECT_EQ(controller.findTransition(0, values.data()), -1);
+    values[0] = 1.0f;
+    EXPECT_EQ(controller.getTransition(controller.findTransition(0, values.data())).targetState, 1);
+    values[0] = 3.0f;
+    EXPECT_EQ(controller.getTransition(controller.findTransition(0, values.data())).targetState, 2);
+    values[0] = 0.0f;
+    EXPECT_EQ(controller.getTransition(controller.findTransition(1, values.data())).targetState, 0);
+}
+
+/**
+ * Test triggers are reset once a transition reading them is taken
+ */
+TEST(AnimatorControllerTest, ConsumesTriggers) {
+    using Description = Dream::AnimatorController::Description;
+    Description description;
+    description.states = {{.Guid="idle"}, {.Guid="jump"}};
+    description.variables = {
+            {.Name="grounded", .Type=Dream::AnimatorController::ParameterType::BOOL, .Value=1.0f},
+            {.Name="jump", .Type=Dream::AnimatorController::ParameterType::TRIGGER}
+    };
+    description.transitions = {
+            {.InputStateID=1, .OutputStateID=0, .Conditions={
+                    {.Variable1Idx=0, .Operator="==", .Variable2=1.0f},
+                    {.Variable1Idx=1, .Operator="==", .Variable2=1.0f}
+            }, .Blend=true}
+    };
+    Dream::AnimatorController controller(description);
+    std::vector<float> values;
+    controller.initParameters(values);
+    EXPECT_EQ(controller.findTransition(0, values.data()), -1);
+    values[1] = 1.0f;
+    int transition = controller.findTransition(0, values.data());
+    ASSERT_NE(transition, -1);
+    controller.consumeTriggers(transition, values.data());
+    EXPECT_EQ(values[0], 1.0f);
+    EXPECT_EQ(values[1], 0.0f);
+}
+
+/**
+ * Test 1D blend trees blend the two motions around the parameter and 2D weights add up to 1
+ */
+TEST(AnimatorControllerTest, WeightsBlendTreeMotions) {
+    using Description = Dream::AnimatorController::Description;
+    Description description;
+    description.variables = {
+            {.Name="speed", .Type=Dream::AnimatorController::ParameterType::FLOAT},
+            {.Name="direction", .Type=Dream::AnimatorController::ParameterType::FLOAT}
+    };
+    // motions of the 1D tree are out of order to check they are sorted
+    description.states = {
+            {.Name="locomotion", .BlendType=Dream::AnimatorController::BlendTreeType::SIMPLE_1D, .BlendVariable1Idx=0,
+                    .Motions={{.Guid="run", .X=4.0f}, {.Guid="idle", .X=0.0f}, {.Guid="walk", .X=1.0f}}},
+            {.Name="strafe", .BlendType=Dream::AnimatorController::BlendTreeType::FREEFORM_2D, .BlendVariable1Idx=1,
+                    .BlendVariable2Idx=0, .Motions={{.Guid="idle"}, {.Guid="left", .X=-1.0f, .Y=1.0f},
+                                                    {.Guid="forward", .Y=1.0f}, {.Guid="right", .X=1.0f, .Y=1.0f}}}
+    };
+    Dream::AnimatorController controller(description);
+    EXPECT_EQ(controller.getNumMotions(), 7);
+    const auto &locomotion = controller.getState(0).motions;
+    EXPECT_EQ(controller.getMotion(locomotion.firstMotion).guid, "idle");
+    EXPECT_EQ(controller.getMotion(locomotion.firstMotion + 2).guid, "run");
+
+    std::vector<float> values = {2.5f, 0.0f};
+    std::vector<float> weights(controller.getNumMotions());
+    controller.getMotionWeights(locomotion, values.data(), weights.data());
+    EXPECT_FLOAT_EQ(weights[0], 0.0f);
+    EXPECT_FLOAT_EQ(weights[1], 0.5f);
+    EXPECT_FLOAT_EQ(weights[2], 0.5f);
+    values[0] = 10.0f;
+    controller.getMotionWeights(locomotion, values.data(), weights.data());
+    EXPECT_FLOAT_EQ(weights[2], 1.0f);
+
+    // speed drives y and direction drives x, on a motion it has all the weight, between motions the weight is shared
+    const auto &strafe = controller.getState(1).motions;
+    values = {1.0f, 0.0f};
+    controller.getMotionWeights(strafe, values.data(), weights.data());
+    EXPECT_FLOAT_EQ(weights[strafe.firstMotion + 2], 1.0f);
+    values = {0.5f, 0.5f};
+    controller.getMotionWeights(strafe, values.data(), weights.data());
+    float totalWeight = 0.0f;
+    for (int i = 0; i < strafe.numMotions; i++) {
+        EXPECT_GE(weights[strafe.firstMotion + i], 0.0f);
+        totalWeight += weights[strafe.firstMotion + i];
+    }
+    EXPECT_NEAR(totalWeight, 1.0f, 1e-5f);
+    EXPECT_FLOAT_EQ(weights[strafe.firstMotion + 1], 0.0f);
+}
+
+/**
+ * Test removing a variable clears every reference to it and shifts references to the variables after it
+ */
+TEST(AnimatorControllerTest, RemovesVariable) {
+    using Description = Dream::AnimatorController::Description;
+    Description description;
+    description.variables = {{.Name="speed"}, {.Name="direction"}, {.Name="aim"}};
+    description.states = {
+            {.Name="strafe", .BlendType=Dream::AnimatorController::BlendTreeType::FREEFORM_2D, .BlendVariable1Idx=1,
+                    .BlendVariable2Idx=2}
+    };
+    description.transitions = {
+            {.InputStateID=0, .OutputStateID=0, .Conditions={{.Variable1Idx=1, .Operator=">"},
+                                                             {.Variable1Idx=2, .Operator="<"}}, .Blend=true}
+    };
+    Description::Layer layer;
+    layer.Motion.BlendVariable1Idx = 2;
+    layer.Motion.BlendVariable2Idx = 1;
+    layer.WeightVariableIdx = 1;
+    description.layers = {layer};
+
+    Dream::AnimatorController::removeVariable(description, 1);
+    ASSERT_EQ(description.variables.size(), 2);
+    EXPECT_EQ(description.variables[1].Name, "aim");
+    EXPECT_EQ(description.states[0].BlendVariable1Idx, -1);
+    EXPECT_EQ(description.states[0].BlendVariable2Idx, 1);
+    ASSERT_EQ(description.transitions[0].Conditions.size(), 1);
+    EXPECT_EQ(description.transitions[0].Conditions[0].Variable1Idx, 1);
+    EXPECT_EQ(description.layers[0].Motion.BlendVariable1Idx, 1);
+    EXPECT_EQ(description.layers[0].Motion.BlendVariable2Idx, -1);
+    EXPECT_EQ(description.layers[0].WeightVariableIdx, -1);
+}
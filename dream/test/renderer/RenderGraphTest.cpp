@@ -0,0 +1,80 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/renderer/OpenGLRenderGraph.h"
+
+/**
+ * Test OpenGLRenderGraph compile() culls passes that do not contribute to the output
+ */
+TEST(RenderGraphTest, CullsUnusedPasses) {
+    Dream::OpenGLRenderGraph graph;
+    auto output = graph.createRenderTarget("output", {Dream::RenderTargetDescription::COLOR_DEPTH, 800, 600});
+    auto shadowMap = graph.createRenderTarget("shadow map", {Dream::RenderTargetDescription::DEPTH, 1024, 1024});
+    auto unused = graph.createRenderTarget("unused", {Dream::RenderTargetDescription::COLOR_DEPTH, 800, 600});
+    graph.setOutput(output);
+    graph.addPass("shadow", {}, {shadowMap}, []() {});
+    graph.addPass("unused", {}, {unused}, []() {});
+    graph.addPass("meshes", {shadowMap}, {output}, []() {});
+    graph.addPass("debug", {}, {output}, []() {}, false);
+    graph.compile();
+    EXPECT_FALSE(graph.getPasses().at(0).culled);
+    EXPECT_TRUE(graph.getPasses().at(1).culled);
+    EXPECT_FALSE(graph.getPasses().at(2).culled);
+    EXPECT_TRUE(graph.getPasses().at(3).culled);
+    EXPECT_EQ(graph.getResources().at(unused).physicalIndex, -1);
+    EXPECT_EQ(graph.getNumPhysicalRenderTargets(), 2);
+}
+
+/**
+ * Test OpenGLRenderGraph compile() aliases render targets whose lifetimes do not overlap
+ */
+TEST(RenderGraphTest, AliasesRenderTargets) {
+    Dream::OpenGLRenderGraph graph;
+    Dream::RenderTargetDescription description = {Dream::RenderTargetDescription::COLOR_DEPTH, 800, 600};
+    auto a = graph.createRenderTarget("a", description);
+    auto b = graph.createRenderTarget("b", description);
+    auto c = graph.createRenderTarget("c", description);
+    auto output = graph.createRenderTarget("output", description);
+    graph.setOutput(output);
+    graph.addPass("write a", {}, {a}, []() {});
+    graph.addPass("a to b", {a}, {b}, []() {});
+    graph.addPass("b to c", {b}, {c}, []() {});
+    graph.addPass("c to output", {c}, {output}, []() {});
+    graph.compile();
+    // a is dead by the time c is written, b is still being read while c is written
+    EXPECT_EQ(graph.getResources().at(a).physicalIndex, graph.getResources().at(c).physicalIndex);
+    EXPECT_NE(graph.getResources().at(b).physicalIndex, graph.getResources().at(c).physicalIndex);
+    EXPECT_EQ(graph.getNumPhysicalRenderTargets(), 2);
+}
+
+/**
+ * Test OpenGLRenderGraph compile() keeps enabled passes that write no render targets (ex: skinning into vertex buffers)
+ */
+TEST(RenderGraphTest, KeepsPassesWithoutWrites) {
+    Dream::OpenGLRenderGraph graph;
+    auto output = graph.createRenderTarget("output", {Dream::RenderTargetDescription::COLOR_DEPTH, 800, 600});
+    graph.setOutput(output);
+    graph.addPass("skinning", {}, {}, []() {});
+    graph.addPass("disabled skinning", {}, {}, []() {}, false);
+    graph.addPass("meshes", {}, {output}, []() {});
+    graph.compile();
+    EXPECT_FALSE(graph.getPasses().at(0).culled);
+    EXPECT_TRUE(graph.getPasses().at(1).culled);
+    EXPECT_FALSE(graph.getPasses().at(2).culled);
+}
@@ -0,0 +1,89 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <memory>
+#include "dream/renderer/VertexAnimationTexture.h"
+
+namespace {
+    /**
+     * Skeleton with a root and a single bone that moves one unit along x every three ticks over one second
+     */
+    Dream::VertexAnimationTexture *bakeSlidingBone() {
+        Dream::AssimpNodeData bone = {.transformation=glm::mat4(1.0f), .name="bone", .childrenCount=0};
+        Dream::AssimpNodeData root = {.transformation=glm::mat4(1.0f), .name="root", .childrenCount=1, .children={bone}};
+        Dream::AnimationSkeleton skeleton(root, {{"bone", {.id=0, .offset=glm::mat4(1.0f)}}});
+
+        std::vector<Dream::AnimationClip::SourceTrack> tracks(2);
+        tracks[1].animated = true;
+        tracks[1].positions = {{glm::vec3(0.0f), 0.0f}, {glm::vec3(10.0f, 0.0f, 0.0f), 30.0f}};
+        tracks[1].rotations = {{glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 0.0f}};
+        auto clip = std::make_shared<Dream::AnimationClip>("slide", 30.0f, 30.0f, tracks);
+
+        Dream::Vertex skinned = {.position=glm::vec3(1.0f, 0.0f, 0.0f), .normal=glm::vec3(0.0f, 1.0f, 0.0f),
+                                 .boneIDs={0, -1, -1, -1}, .boneWeights={1.0f, 0.0f, 0.0f, 0.0f}};
+        Dream::Vertex unskinned = {.position=glm::vec3(0.0f, 2.0f, 0.0f), .normal=glm::vec3(0.0f, 0.0f, 1.0f),
+                                   .boneIDs={-1, -1, -1, -1}, .boneWeights={0.0f, 0.0f, 0.0f, 0.0f}};
+        return Dream::VertexAnimationTexture::bake(skeleton, 1, {{.fileId="body", .vertices={skinned}},
+                                                                 {.fileId="base", .vertices={unskinned}}},
+                                                   {{.guid="slide-guid", .clip=clip}}, 10.0f);
+    }
+}
+
+/**
+ * Test skinned vertices follow their bone in every frame while static vertices stay in place
+ */
+TEST(VertexAnimationTextureTest, BakesSkinnedVertices) {
+    std::unique_ptr<Dream::VertexAnimationTexture> vertexAnimation(bakeSlidingBone());
+    ASSERT_EQ(vertexAnimation->getNumVertices(), 2);
+    ASSERT_EQ(vertexAnimation->getNumClips(), 1);
+    EXPECT_EQ(vertexAnimation->getClip(0).numFrames, 11);
+    EXPECT_EQ(vertexAnimation->findSubMesh("base"), 1);
+    EXPECT_EQ(vertexAnimation->getSubMeshes().at(1).firstVertex, 1);
+    EXPECT_EQ(vertexAnimation->findClip("slide-guid"), 0);
+
+    const auto &positions = vertexAnimation->getPositions();
+    EXPECT_NEAR(positions[5 * 2].x, 6.0f, 0.02f);
+    EXPECT_NEAR(positions[10 * 2].x, 11.0f, 0.02f);
+    EXPECT_EQ(glm::vec3(positions[5 * 2 + 1]), glm::vec3(0.0f, 2.0f, 0.0f));
+    EXPECT_NEAR(vertexAnimation->getNormals()[5 * 2].y, 1.0f, 1e-4f);
+
+    glm::vec3 frameBlend = vertexAnimation->getFrameBlend(0, 1.25f);
+    EXPECT_FLOAT_EQ(frameBlend.x, 2.0f);
+    EXPECT_FLOAT_EQ(frameBlend.y, 3.0f);
+    EXPECT_NEAR(frameBlend.z, 0.5f, 1e-4f);
+}
+
+/**
+ * Test a saved vertex animation loads back with the same clips and texels
+ */
+TEST(VertexAnimationTextureTest, SavesAndLoads) {
+    std::unique_ptr<Dream::VertexAnimationTexture> vertexAnimation(bakeSlidingBone());
+    auto path = std::filesystem::temp_directory_path().append("dream-vertex-animation-test.vat");
+    ASSERT_TRUE(vertexAnimation->save(path));
+    std::unique_ptr<Dream::VertexAnimationTexture> loaded(Dream::VertexAnimationTexture::load(path));
+    std::filesystem::remove(path);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getNumFrames(), vertexAnimation->getNumFrames());
+    EXPECT_EQ(loaded->getClip(0).name, "slide");
+    EXPECT_FLOAT_EQ(loaded->getClip(0).duration, 1.0f);
+    EXPECT_EQ(loaded->getSubMeshes().at(0).fileId, "body");
+    EXPECT_EQ(loaded->getPositions(), vertexAnimation->getPositions());
+    EXPECT_EQ(loaded->getNormals(), vertexAnimation->getNormals());
+}
@@ -0,0 +1,82 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/project/Project.h"
+#include "dream/scene/component/Component.h"
+#include "dream/scene/system/PhysicsComponentSystem.h"
+
+/**
+ * Test a batch mixing every query type (big enough to be split across threads) gives each query the same result as
+ * running it alone, overlaps included since they cannot run concurrently
+ */
+TEST(PhysicsComponentSystemTest, MixedQueryBatchMatchesSingleQueries) {
+    using Dream::Component::CollisionComponent;
+    auto *physics = Dream::Project::getScene()->getPhysicsComponentSystem();
+    std::vector<Dream::Entity> boxes;
+    for (int i = 0; i < 3; i++) {
+        auto box = Dream::Project::getScene()->createEntity("Box");
+        box.getComponent<Dream::Component::TransformComponent>().translation = {(float) (i - 1) * 5.0f, 0, 0};
+        auto &collision = box.addComponent<CollisionComponent>();
+        collision.colliders.emplace_back();
+        box.addComponent<Dream::Component::RigidBodyComponent>().type = Dream::Component::RigidBodyComponent::STATIC;
+        boxes.push_back(box);
+    }
+    // adds the bodies to the world
+    physics->update(0.0f);
+
+    Dream::PhysicsQueryBatch batch(64);
+    for (int repeat = 0; repeat < 4; repeat++) {
+        for (int i = 0; i < 3; i++) {
+            float x = (float) (i - 1) * 5.0f;
+            batch.addRaycast({x, 5, 0}, {x, -5, 0});
+            batch.addSphereOverlap({x, 1.5f, 0}, 1.0f);
+            batch.addSphereSweep({x, 5, 0.5f}, {x, -5, 0.5f}, 0.5f);
+            batch.addSphereOverlap({x + 0.5f, 1.0f, 0.5f}, 0.75f);
+            batch.addSphereOverlap({x, 10, 0}, 1.0f);
+        }
+    }
+    physics->query(batch);
+    EXPECT_TRUE(batch.hasHit(1));
+    EXPECT_TRUE(batch.getHitEntityHandle(1) == (entt::entity) boxes.at(0));
+    EXPECT_FALSE(batch.hasHit(4));
+
+    for (int i = 0; i < batch.size(); i++) {
+        Dream::PhysicsQueryBatch single(1);
+        const auto &query = batch.getQueries().at(i);
+        if (query.type == Dream::PhysicsQuery::RAYCAST) {
+            single.addRaycast(query.from, query.to);
+        } else if (query.type == Dream::PhysicsQuery::SPHERE_SWEEP) {
+            single.addSphereSweep(query.from, query.to, query.radius);
+        } else {
+            single.addSphereOverlap(query.from, query.radius);
+        }
+        physics->query(single);
+        EXPECT_EQ(batch.hasHit(i), single.hasHit(0)) << "query " << i;
+        EXPECT_TRUE(batch.getHitEntityHandle(i) == single.getHitEntityHandle(0)) << "query " << i;
+        EXPECT_FLOAT_EQ(batch.getHitFraction(i), single.getHitFraction(0)) << "query " << i;
+        for (int axis = 0; axis < 3; axis++) {
+            EXPECT_FLOAT_EQ(batch.getHitPoint(i)[axis], single.getHitPoint(0)[axis]) << "query " << i;
+            EXPECT_FLOAT_EQ(batch.getHitNormal(i)[axis], single.getHitNormal(0)[axis]) << "query " << i;
+        }
+    }
+
+    for (auto &box: boxes) {
+        Dream::Project::getScene()->removeEntity(box);
+    }
+}
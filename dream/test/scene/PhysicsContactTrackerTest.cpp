@@ -0,0 +1,70 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/scene/system/PhysicsContactTracker.h"
+
+/**
+ * Test PhysicsContactTracker queues enter, stay and exit events for a pair across steps, in either report order
+ */
+TEST(PhysicsContactTrackerTest, EnterStayExit) {
+    Dream::PhysicsContactTracker tracker;
+    auto a = (entt::entity) 1;
+    auto b = (entt::entity) 2;
+    tracker.addContact(a, b, false, {0, 1, 0}, {0, 1, 0});
+    tracker.endStep();
+    tracker.addContact(b, a, false, {0, 2, 0}, {0, -1, 0});
+    // duplicate reports of a pair in the same step are ignored
+    tracker.addContact(a, b, false, {0, 3, 0}, {0, 1, 0});
+    tracker.endStep();
+    tracker.endStep();
+    tracker.endStep();
+
+    const auto &events = tracker.getEvents();
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events.at(0).phase, Dream::PhysicsContactEvent::ENTER);
+    EXPECT_EQ(events.at(1).phase, Dream::PhysicsContactEvent::STAY);
+    EXPECT_EQ(events.at(1).point, glm::vec3(0, 2, 0));
+    EXPECT_EQ(events.at(2).phase, Dream::PhysicsContactEvent::EXIT);
+    EXPECT_TRUE(events.at(2).entityA == b);
+
+    tracker.clearEvents();
+    EXPECT_TRUE(tracker.getEvents().empty());
+}
+
+/**
+ * Test PhysicsContactTracker forgets an entity that was removed, so no event refers to it
+ */
+TEST(PhysicsContactTrackerTest, RemoveEntity) {
+    Dream::PhysicsContactTracker tracker;
+    auto a = (entt::entity) 1;
+    auto b = (entt::entity) 2;
+    auto c = (entt::entity) 3;
+    tracker.addContact(a, b, true, {0, 0, 0}, {0, 1, 0});
+    tracker.addContact(a, c, false, {0, 0, 0}, {0, 1, 0});
+    tracker.endStep();
+    tracker.removeEntity(b);
+    ASSERT_EQ(tracker.getEvents().size(), 1);
+    EXPECT_TRUE(tracker.getEvents().at(0).entityB == c);
+
+    tracker.clearEvents();
+    tracker.endStep();
+    ASSERT_EQ(tracker.getEvents().size(), 1);
+    EXPECT_EQ(tracker.getEvents().at(0).phase, Dream::PhysicsContactEvent::EXIT);
+    EXPECT_TRUE(tracker.getEvents().at(0).entityB == c);
+}
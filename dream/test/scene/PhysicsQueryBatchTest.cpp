@@ -0,0 +1,61 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/scene/system/PhysicsQueryBatch.h"
+
+/**
+ * Test PhysicsQueryBatch gives each query a result at the same index and keeps its memory when cleared
+ */
+TEST(PhysicsQueryBatchTest, ReusesMemory) {
+    Dream::PhysicsQueryBatch batch(4);
+    EXPECT_EQ(batch.addRaycast({0, 1, 0}, {0, -1, 0}), 0);
+    EXPECT_EQ(batch.addSphereSweep({0, 1, 0}, {0, -1, 0}, 0.5f), 1);
+    EXPECT_EQ(batch.addCapsuleSweep({0, 1, 0}, {0, -1, 0}, 0.5f, 2.0f), 2);
+    EXPECT_EQ(batch.addSphereOverlap({0, 0, 0}, 1.0f), 3);
+    EXPECT_EQ(batch.size(), 4);
+    EXPECT_EQ(batch.getQueries().at(2).type, Dream::PhysicsQuery::CAPSULE_SWEEP);
+    EXPECT_EQ(batch.getQueries().at(3).to, glm::vec3(0, 0, 0));
+    EXPECT_FALSE(batch.hasHit(0));
+    EXPECT_TRUE(batch.getHitEntityHandle(0) == entt::null);
+    EXPECT_FLOAT_EQ(batch.getHitFraction(0), 1.0f);
+
+    const auto *queries = batch.getQueries().data();
+    const auto *hits = batch.getHits().data();
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0);
+    for (int i = 0; i < 4; i++) {
+        batch.addRaycast({0, 0, 0}, {1, 0, 0});
+    }
+    EXPECT_EQ(batch.getQueries().data(), queries);
+    EXPECT_EQ(batch.getHits().data(), hits);
+}
+
+/**
+ * Test reading a result out of range (ex: a 1-based loop in a script) returns a miss instead of stopping
+ */
+TEST(PhysicsQueryBatchTest, OutOfRangeIsMiss) {
+    Dream::PhysicsQueryBatch batch(1);
+    batch.addRaycast({0, 1, 0}, {0, -1, 0});
+    batch.getHits().at(0).hit = true;
+    EXPECT_TRUE(batch.hasHit(0));
+    EXPECT_FALSE(batch.hasHit(1));
+    EXPECT_FALSE(batch.hasHit(-1));
+    EXPECT_TRUE(batch.getHitEntityHandle(1) == entt::null);
+    EXPECT_FLOAT_EQ(batch.getHitFraction(1), 1.0f);
+}
@@ -0,0 +1,102 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "dream/scene/system/PhysicsShapeCache.h"
+
+using Dream::Component::CollisionComponent;
+
+/**
+ * Test colliders with the same parameters share one shape, and different parameters get their own
+ */
+TEST(PhysicsShapeCacheTest, SharesIdenticalColliders) {
+    Dream::PhysicsShapeCache cache;
+    CollisionComponent::Collider box;
+    box.type = CollisionComponent::BOX;
+    box.halfExtents = {1, 2, 3};
+    // the offset is applied by the compound shape, so it does not make a new shape
+    CollisionComponent::Collider offsetBox = box;
+    offsetBox.offset = {0, 5, 0};
+    CollisionComponent::Collider sphere;
+    sphere.type = CollisionComponent::SPHERE;
+    sphere.radius = 0.5f;
+
+    btCollisionShape *first = cache.acquire(box);
+    btCollisionShape *second = cache.acquire(offsetBox);
+    btCollisionShape *third = cache.acquire(sphere);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, third);
+    EXPECT_EQ(cache.getNumShapes(), 2);
+    cache.release(first);
+    cache.release(second);
+    cache.release(third);
+}
+
+/**
+ * Test a shape stays in the cache while it is used and is freed when the last collider releases it
+ */
+TEST(PhysicsShapeCacheTest, ReleaseFreesUnusedShape) {
+    Dream::PhysicsShapeCache cache;
+    CollisionComponent::Collider capsule;
+    capsule.type = CollisionComponent::CAPSULE;
+    capsule.axis = CollisionComponent::Z;
+
+    btCollisionShape *shape = cache.acquire(capsule);
+    EXPECT_EQ(cache.acquire(capsule), shape);
+    cache.release(shape);
+    EXPECT_EQ(cache.getNumShapes(), 1);
+    cache.release(shape);
+    EXPECT_EQ(cache.getNumShapes(), 0);
+    // the shape was freed, so the same parameters create a new one
+    shape = cache.acquire(capsule);
+    EXPECT_EQ(cache.getNumShapes(), 1);
+    cache.release(shape);
+    EXPECT_EQ(cache.getNumShapes(), 0);
+}
+
+/**
+ * Test a serialized BVH loads back with the same nodes, and is rejected when the triangles it was built from changed
+ */
+TEST(PhysicsShapeCacheTest, BvhRoundTrip) {
+    // two triangles making a quad
+    btScalar positions[] = {0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1};
+    int indices[] = {0, 1, 2, 0, 2, 3};
+    btTriangleIndexVertexArray meshInterface(2, indices, 3 * sizeof(int), 4, positions, 3 * sizeof(btScalar));
+    btBvhTriangleMeshShape shape(&meshInterface, true, true);
+    btOptimizedBvh *builtBvh = shape.getOptimizedBvh();
+
+    std::filesystem::path path = std::filesystem::temp_directory_path().append("dream-test").append("quad.bvh");
+    std::string trianglesHash = "0123456789abcdef0123456789abcdef";
+    Dream::PhysicsShapeCache::saveBvh(path, trianglesHash, builtBvh);
+
+    void *bvhBuffer = nullptr;
+    btOptimizedBvh *loadedBvh = Dream::PhysicsShapeCache::loadBvh(path, trianglesHash, bvhBuffer);
+    ASSERT_NE(loadedBvh, nullptr);
+    EXPECT_NE(bvhBuffer, nullptr);
+    EXPECT_EQ(loadedBvh->isQuantized(), builtBvh->isQuantized());
+    EXPECT_EQ(loadedBvh->calculateSerializeBufferSize(), builtBvh->calculateSerializeBufferSize());
+    EXPECT_EQ(loadedBvh->getQuantizedNodeArray().size(), builtBvh->getQuantizedNodeArray().size());
+    btAlignedFree(bvhBuffer);
+
+    bvhBuffer = nullptr;
+    EXPECT_EQ(Dream::PhysicsShapeCache::loadBvh(path, "fedcba9876543210fedcba9876543210", bvhBuffer), nullptr);
+    EXPECT_EQ(bvhBuffer, nullptr);
+    std::filesystem::remove_all(path.parent_path());
+}
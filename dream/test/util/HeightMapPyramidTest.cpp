@@ -0,0 +1,58 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "dream/util/HeightMapPyramid.h"
+
+/**
+ * Test rays hit the surface of the height map (not just its bounds) and miss when they pass over it
+ */
+TEST(HeightMapPyramidTest, RaycastHitsSurface) {
+    int size = 9;
+    std::vector<float> heights(size * size, 0.0f);
+    // single peak in the middle of the height map
+    heights[4 * size + 4] = 4.0f;
+    Dream::HeightMapPyramid pyramid;
+    pyramid.build(heights.data(), size);
+    EXPECT_EQ(pyramid.getNumLevels(), 4);
+    EXPECT_FLOAT_EQ(pyramid.getHeightRange(3, 0, 0).second, 4.0f);
+
+    // straight down onto the flat part
+    auto hit = pyramid.raycast({1.5f, 10.0f, 1.5f}, {0.0f, -1.0f, 0.0f});
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->y, 0.0f, 1e-4f);
+
+    // straight down onto the peak
+    hit = pyramid.raycast({4.0f, 10.0f, 4.0f}, {0.0f, -1.0f, 0.0f});
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->y, 4.0f, 1e-4f);
+
+    // horizontal ray below the peak hits its side, above the peak it misses
+    hit = pyramid.raycast({-5.0f, 2.0f, 4.0f}, {1.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->x, 3.5f, 1e-4f);
+    EXPECT_FALSE(pyramid.raycast({-5.0f, 5.0f, 4.0f}, {1.0f, 0.0f, 0.0f}).has_value());
+
+    // raising the heights after the pyramid was built is picked up by update()
+    heights[1 * size + 1] = 8.0f;
+    pyramid.update(1, 1, 1, 1);
+    hit = pyramid.raycast({1.0f, 10.0f, 1.0f}, {0.0f, -1.0f, 0.0f});
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->y, 8.0f, 1e-4f);
+}
@@ -0,0 +1,38 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "dream/util/MathUtils.h"
+
+/**
+ * Test spheres in front of the camera are inside the frustum, and spheres behind, beside or beyond the far plane are not
+ */
+TEST(MathUtilsTest, SphereInFrustum) {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec4 planes[6];
+    Dream::MathUtils::getFrustumPlanes(projection * view, planes);
+
+    EXPECT_TRUE(Dream::MathUtils::isSphereInFrustum(planes, {0.0f, 0.0f, -10.0f}, 1.0f));
+    EXPECT_FALSE(Dream::MathUtils::isSphereInFrustum(planes, {0.0f, 0.0f, 10.0f}, 1.0f));
+    EXPECT_FALSE(Dream::MathUtils::isSphereInFrustum(planes, {50.0f, 0.0f, -10.0f}, 1.0f));
+    EXPECT_FALSE(Dream::MathUtils::isSphereInFrustum(planes, {0.0f, 0.0f, -120.0f}, 1.0f));
+    // partly inside counts as visible
+    EXPECT_TRUE(Dream::MathUtils::isSphereInFrustum(planes, {0.0f, 0.0f, 0.5f}, 1.0f));
+}
@@ -0,0 +1,61 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dream/util/SimulationClock.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * Test SimulationClock runs one tick per whole step of accumulated time and exposes the remainder as the alpha
+ */
+TEST(SimulationClockTest, AccumulatesTicks) {
+    Dream::SimulationClock clock(100, 5);
+    EXPECT_DOUBLE_EQ(clock.getFixedDeltaTime(), 0.01);
+    EXPECT_EQ(clock.advance(5ms), 0);
+    EXPECT_FLOAT_EQ(clock.getAlpha(), 0.5f);
+    EXPECT_EQ(clock.advance(7ms), 1);
+    EXPECT_FLOAT_EQ(clock.getAlpha(), 0.2f);
+    EXPECT_EQ(clock.advance(20ms), 2);
+    EXPECT_FLOAT_EQ(clock.getAlpha(), 0.2f);
+    EXPECT_EQ(clock.getTick(), 3u);
+}
+
+/**
+ * Test SimulationClock drops time beyond the max steps per frame instead of catching up on it in later frames
+ */
+TEST(SimulationClockTest, ClampsCatchUp) {
+    Dream::SimulationClock clock(100, 4);
+    EXPECT_EQ(clock.advance(1005ms), 4);
+    EXPECT_EQ(clock.getDroppedTicks(), 96u);
+    EXPECT_FLOAT_EQ(clock.getAlpha(), 0.5f);
+    // the next frame is back to normal
+    EXPECT_EQ(clock.advance(10ms), 1);
+}
+
+/**
+ * Test SimulationClock runs exactly one tick per frame in deterministic mode
+ */
+TEST(SimulationClockTest, Deterministic) {
+    Dream::SimulationClock clock(60, 5);
+    clock.setDeterministic(true);
+    EXPECT_EQ(clock.advance(0ms), 1);
+    EXPECT_EQ(clock.advance(500ms), 1);
+    EXPECT_FLOAT_EQ(clock.getAlpha(), 1.0f);
+    EXPECT_EQ(clock.getTick(), 2u);
+}
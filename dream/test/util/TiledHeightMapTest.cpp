@@ -0,0 +1,64 @@
+/**********************************************************************************
+ *  Dream is a software for developing real-time 3D experiences.
+ *  Copyright (C) 2023 Deepak Ramalignam
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **********************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <vector>
+#include "dream/util/TiledHeightMap.h"
+
+/**
+ * Test heights survive being quantized, compressed and written per tile, including rewriting a single tile
+ */
+TEST(TiledHeightMapTest, RoundTripAndPartialWrite) {
+    int size = 100;
+    std::vector<float> heights(size * size);
+    for (int z = 0; z < size; z++) {
+        for (int x = 0; x < size; x++) {
+            heights[z * size + x] = 20.0f * std::sin((float) x * 0.1f) * std::cos((float) z * 0.05f);
+        }
+    }
+    auto path = std::filesystem::temp_directory_path().append("dream_tiled_height_map_test.save").string();
+    ASSERT_TRUE(Dream::TiledHeightMap::write(path, heights.data(), size, 32));
+
+    Dream::TiledHeightMap heightMap;
+    ASSERT_TRUE(heightMap.open(path));
+    EXPECT_EQ(heightMap.getSize(), size);
+    // the last row and column of tiles are partial
+    EXPECT_EQ(heightMap.getNumTilesPerSide(), 4);
+    std::vector<float> loaded(size * size, 0.0f);
+    for (int tile = 0; tile < heightMap.getNumTiles(); tile++) {
+        ASSERT_TRUE(heightMap.readTile(tile, loaded.data()));
+    }
+    // 16-bit quantization of a 40 unit range
+    for (int i = 0; i < size * size; i++) {
+        EXPECT_NEAR(loaded[i], heights[i], 1e-3f);
+    }
+
+    // raise a vertex in the last tile (which has to grow) and only rewrite that tile
+    heights[99 * size + 99] = 1000.0f;
+    ASSERT_TRUE(heightMap.writeTiles(heights.data(), {heightMap.getNumTiles() - 1}));
+    Dream::TiledHeightMap reopened;
+    ASSERT_TRUE(reopened.open(path));
+    EXPECT_FLOAT_EQ(reopened.getTile(reopened.getNumTiles() - 1).maxHeight, 1000.0f);
+    ASSERT_TRUE(reopened.readTile(reopened.getNumTiles() - 1, loaded.data()));
+    ASSERT_TRUE(reopened.readTile(0, loaded.data()));
+    EXPECT_NEAR(loaded[99 * size + 99], 1000.0f, 1e-3f);
+    EXPECT_NEAR(loaded[0], heights[0], 1e-3f);
+    std::filesystem::remove(path);
+}
@@ -1,4 +1,20 @@
+function onTriggerEnter(entity, other, point, normal)
+	-- walking into a door moves the character to the other side
+	local door1Entity = Scene.getEntityByTag("Door 1")
+	local door2Entity = Scene.getEntityByTag("Door 2")
+	if door1Entity:isValid() and other:getID() == door1Entity:getID() then
+		entity:getRigidBody():setTranslation(vec3:new(0.3, 0.03, -5.59))
+	elseif door2Entity:isValid() and other:getID() == door2Entity:getID() then
+		entity:getRigidBody():setTranslation(vec3:new(0.3, 0.03, 5.6))
+	end
+end
+
 function update(entity, dt)
+	-- look up animator variables once, the handles stay valid for the animator
+	if speedVariable == nil then
+		speedVariable = entity:getAnimator():findVariable("speed")
+	end
+
 	-- get main camera
 	local cameraEntity = Scene.getEntityByTag("camera")
 	if not cameraEntity:isValid() then
@@ -6,30 +22,6 @@ function update(entity, dt)
 		return
 	end
 	
-	-- check if user is close to either door
-	local entityTranslation = entity:getTransform().translation
-	local door1Entity = Scene.getEntityByTag("Door 1")
-	if not door1Entity:isValid() then
-		Logger.error("Door1 entity cannot be found by character controller")
-		return
-	end
-	local door1Translation = door1Entity:getTransform().translation
-
-	if MathUtils.distance(entityTranslation, door1Translation) < 1 then
-		entity:getRigidBody():setTranslation(vec3:new(0.3, 0.03, -5.59))
-	end
-
-	local door2Entity = Scene.getEntityByTag("Door 2")
-	if not door2Entity:isValid() then
-		Logger.error("Door2 entity cannot be found by character controller")
-		return
-	end
-	local door2Translation = door2Entity:getTransform().translation
-
-	if MathUtils.distance(entityTranslation, door2Translation) < 1 then
-		entity:getRigidBody():setTranslation(vec3:new(0.3, 0.03, 5.6))
-	end
-
 	-- get forward vector of camera and project onto xz plane
 	local cameraTranslation = cameraEntity:getTransform().translation
 	local knightTranslation = entity:getTransform().translation
@@ -88,13 +80,13 @@ function update(entity, dt)
 		-- update animation
 		-- entity:getAnimator():setVariable("speed", math.floor(translationalSpeed))
 		if Input.getButtonDown(Key.LeftShift) then
-			entity:getAnimator():setVariable("speed", 2)
+			entity:getAnimator():setInt(speedVariable, 2)
 		else
-			entity:getAnimator():setVariable("speed", 1)
+			entity:getAnimator():setInt(speedVariable, 1)
 		end
 	else
 		-- update animation
-		entity:getAnimator():setVariable("speed", 0)
+		entity:getAnimator():setInt(speedVariable, 0)
 	end
 
 	-- attack when mouse down
@@ -37,7 +37,8 @@ function update(entity, dt)
 	-- set position of camera based off spherical coordinate values
 	self.radius = 1.5
 	local lookAtOffset = vec3:new(0, 0.6, 0)
-	local targetTranslation = targetEntity:getTransform().translation + lookAtOffset
+	-- follow where the target is drawn rather than its latest physics step so it does not jitter on screen
+	local targetTranslation = targetEntity:getInterpolatedTranslation() + lookAtOffset
 
 	local xPos = targetTranslation.x - self.radius * math.sin(self.theta) * math.cos(self.phi)
 	local yPos = targetTranslation.y - self.radius * math.cos(self.theta)
@@ -0,0 +1,8 @@
+precision highp float;
+out vec4 FragColor;
+
+// skinning only runs the vertex shader (rasterization is discarded), programs still need a fragment shader to link
+void main()
+{
+    FragColor = vec4(0.0);
+}
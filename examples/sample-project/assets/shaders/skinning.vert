@@ -0,0 +1,50 @@
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in vec3 aTangent;
+layout (location = 5) in ivec4 boneIds;
+layout (location = 6) in vec4 weights;
+
+// captured with transform feedback (interleaved) and drawn by every pass in place of the bind pose
+out vec3 skinnedPosition;
+out vec3 skinnedNormal;
+out vec3 skinnedTangent;
+
+const int MAX_BONES = 200;
+const int MAX_BONE_INFLUENCE = 4;
+uniform mat4 finalBonesMatrices[MAX_BONES];
+
+void main()
+{
+    vec4 totalPosition = vec4(0.0f);
+    vec3 totalNormal = vec3(0.0);
+    vec3 totalTangent = vec3(0.0);
+
+    // same blend as shader.vert so pre-skinned meshes look the same
+    if (boneIds[0] == -1 && boneIds[1] == -1 && boneIds[2] == -1 && boneIds[3] == -1) {
+        totalPosition = vec4(aPos, 1.0f);
+        totalNormal = aNormal;
+        totalTangent = aTangent;
+    } else {
+        for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++) {
+            if(boneIds[i] == -1) {
+                continue;
+            }
+
+            if(boneIds[i] >= MAX_BONES) {
+                totalPosition = vec4(aPos, 1.0f);
+                break;
+            }
+
+            vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(aPos, 1.0f);
+            totalPosition += localPosition * weights[i];
+            totalNormal += mat3(finalBonesMatrices[boneIds[i]]) * aNormal;
+            totalTangent += mat3(finalBonesMatrices[boneIds[i]]) * aTangent * weights[i];
+        }
+    }
+
+    skinnedPosition = totalPosition.xyz;
+    skinnedNormal = totalNormal;
+    skinnedTangent = totalTangent;
+    // nothing is rasterized
+    gl_Position = vec4(0.0);
+}
@@ -0,0 +1,49 @@
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 3) in vec3 aTangent;
+// per instance
+layout (location = 7) in mat4 instanceModel;
+layout (location = 11) in vec4 instanceFrames;
+
+// same outputs as shader.vert so the fragment shaders of skinned meshes can be used
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+out mat3 TBN;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// skinned positions / normals of every vertex in every frame, wrapped into rows of vertexAnimationWidth texels
+uniform highp sampler2D vertexAnimationPositions;
+uniform highp sampler2D vertexAnimationNormals;
+uniform int vertexAnimationWidth;
+uniform int vertexAnimationNumVertices;
+uniform int vertexAnimationFirstVertex;
+
+ivec2 texelOf(int frame)
+{
+    int texel = frame * vertexAnimationNumVertices + vertexAnimationFirstVertex + gl_VertexID;
+    return ivec2(texel % vertexAnimationWidth, texel / vertexAnimationWidth);
+}
+
+void main()
+{
+    ivec2 texel0 = texelOf(int(instanceFrames.x));
+    ivec2 texel1 = texelOf(int(instanceFrames.y));
+    vec3 position = mix(texelFetch(vertexAnimationPositions, texel0, 0).xyz, texelFetch(vertexAnimationPositions, texel1, 0).xyz, instanceFrames.z);
+    vec3 normal = mix(texelFetch(vertexAnimationNormals, texel0, 0).xyz, texelFetch(vertexAnimationNormals, texel1, 0).xyz, instanceFrames.z);
+
+    FragPos = vec3(instanceModel * vec4(position, 1.0));
+    mat3 normalMatrix = transpose(inverse(mat3(instanceModel)));
+    vec3 N = normalize(normalMatrix * normal);
+    Normal = N;
+    TexCoord = aTexCoord;
+
+    // the tangent is not baked, so it is kept perpendicular to the animated normal
+    vec3 T = normalize(normalMatrix * aTangent);
+    T = normalize(T - dot(T, N) * N);
+    vec3 B = cross(N, T);
+    TBN = transpose(mat3(T, B, N));
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}